@@ -223,6 +223,21 @@ class TestSolve(unittest.TestCase):
         res, solution = self.solver.solve()
         self.assertEqual(res, False)
 
+    def test_add_clauses_array_empty_clause_skipped(self):
+        cls = array('i', [1, 0, 0, -1, 0])
+        self.solver.add_clauses(cls)
+        res, solution = self.solver.solve()
+        self.assertEqual(res, False)
+
+    def test_add_clauses_array_many(self):
+        cls = array('i', [])
+        for i in range(1, 300001):
+            cls.extend([-i, i + 1, 0])
+        cls.extend([1, 0, -300001, 0])
+        self.solver.add_clauses(cls)
+        res, solution = self.solver.solve()
+        self.assertEqual(res, False)
+
     def test_add_clauses_array_unterminated(self):
         cls = array('i', [1, 2, 0, 1, 2])
         self.assertRaises(ValueError, self.solver.add_clause, cls)
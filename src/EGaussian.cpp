@@ -58,6 +58,9 @@ using namespace CMSat;
 // if variable is not in Gaussian matrix , assiag unknown column
 static const uint32_t unassigned_col = std::numeric_limits<uint32_t>::max();
 
+// columns handled at a time by eliminate_m4r(), one byte of a row
+static const uint32_t m4r_strip_cols = 8;
+
 EGaussian::EGaussian(Solver* _solver, const GaussConf& _config, const uint32_t _matrix_no,
                      const vector<Xor>& _xorclauses)
     : solver(_solver), config(_config), matrix_no(_matrix_no), xorclauses(_xorclauses) {
@@ -169,10 +172,21 @@ uint32_t EGaussian::select_columnorder(matrixset& origMat) {
     var_to_col.resize(largest_used_var + 1);
 
     origMat.col_to_var.clear();
+
+    //Columns of the kept matrix go first, so its rows are eliminated already
+    for (uint32_t v : col_order) {
+        if (v < var_to_col.size() && var_to_col[v] == unassigned_col - 1) {
+            origMat.col_to_var.push_back(v);
+            var_to_col[v] = origMat.col_to_var.size() - 1;
+        }
+    }
+
     std::sort(vars_needed.begin(), vars_needed.end(), HeapSorter(solver->var_act_vsids));
 
     for (uint32_t v : vars_needed) {
-        assert(var_to_col[v] == unassigned_col - 1);
+        if (var_to_col[v] != unassigned_col - 1) {
+            continue;
+        }
         origMat.col_to_var.push_back(v);
         var_to_col[v] = origMat.col_to_var.size() - 1;
     }
@@ -246,6 +260,145 @@ void EGaussian::clear_gwatches(const uint32_t var) {
     solver->gwatches[var].shrink(i-j);
 }
 
+// Xor::operator< does not look at the rhs
+static bool xor_less(const Xor& a, const Xor& b)
+{
+    if (a < b || b < a) {
+        return a < b;
+    }
+    return a.rhs < b.rhs;
+}
+
+bool CMSat::clean_kept_xors(Solver* solver, vector<Xor>& xors)
+{
+    for (Xor& x : xors) {
+        for (uint32_t v : x) {
+            if (v >= solver->nVars() || solver->varData[v].removed != Removed::none) {
+                return false;
+            }
+        }
+        solver->clean_xor_vars_no_prop(x.get_vars(), x.rhs);
+    }
+    std::sort(xors.begin(), xors.end(), xor_less);
+    return true;
+}
+
+/**
+@brief Takes the rows of a kept matrix instead of the XORs it was made of
+
+Its rows are implied by the XORs it was made of, which are implied by the
+clauses, so they can be added to any matrix. They are eliminated already, so
+full_init() will have little to do. Our XORs that the kept matrix was made of
+are not added again. Which XORs we get is not stable between searches, as
+MatrixFinder XORs some of them together depending on all the others, hence
+the check by variables: the kept matrix must share a variable with ours, and
+its other variables must not be in any matrix. The variables in some matrix
+must be marked in solver->seen2. The kept matrix is removed from "kept".
+*/
+bool EGaussian::seed_from_kept(vector<GaussKept>& kept)
+{
+    assert(solver->decisionLevel() == 0);
+    input_xors = xorclauses;
+    clean_kept_xors(solver, input_xors);
+
+    for (const Xor& x : input_xors) {
+        for (uint32_t v : x) {
+            solver->seen[v] = 1;
+        }
+    }
+    auto found = kept.end();
+    for (auto it = kept.begin(); it != kept.end() && found == kept.end(); ++it) {
+        if (!clean_kept_xors(solver, it->input)
+            || !clean_kept_xors(solver, it->rows)
+        ) {
+            continue;
+        }
+
+        bool shared = false;
+        bool fits = true;
+        for (const Xor& x : it->input) {
+            for (uint32_t v : x) {
+                shared |= (bool)solver->seen[v];
+                fits &= solver->seen[v] || !solver->seen2[v];
+            }
+        }
+        if (shared && fits) {
+            found = it;
+        }
+    }
+    for (const Xor& x : input_xors) {
+        for (uint32_t v : x) {
+            solver->seen[v] = 0;
+        }
+    }
+    if (found == kept.end()) {
+        return false;
+    }
+
+    xorclauses = found->rows;
+    std::set_difference(input_xors.begin(), input_xors.end()
+        , found->input.begin(), found->input.end()
+        , std::back_inserter(xorclauses), xor_less);
+    col_order.swap(found->col_order);
+    full_elim_time = found->elim_time;
+    if (solver->conf.verbosity >= 2) {
+        cout << "c [gauss] matrix " << matrix_no << " seeded from kept matrix,"
+        << " rows: " << found->rows.size()
+        << " new XORs: " << xorclauses.size() - found->rows.size() << endl;
+    }
+    kept.erase(found);
+    return true;
+}
+
+GaussKept EGaussian::get_kept() const
+{
+    GaussKept k;
+    k.input = input_xors;
+    k.elim_time = full_elim_time;
+
+    vector<uint32_t> vars;
+    for (uint32_t row = 0; row < matrix.num_rows; row++) {
+        const PackedRow r = matrix.matrix.getMatrixAt(row);
+        vars.clear();
+        uint32_t basic = var_Undef;
+        for (uint32_t col = 0; col < matrix.num_cols; col++) {
+            if (r[col]) {
+                const uint32_t v = matrix.col_to_var[col];
+                vars.push_back(v);
+                if (basic == var_Undef && GasVar_state[v] == basic_var && !solver->seen[v]) {
+                    basic = v;
+                }
+            }
+        }
+        if (vars.empty()) {
+            continue;
+        }
+        k.rows.push_back(Xor(vars, r.rhs()));
+        if (basic != var_Undef) {
+            k.col_order.push_back(basic);
+            solver->seen[basic] = 1;
+        }
+    }
+    for (uint32_t v : matrix.col_to_var) {
+        if (!solver->seen[v]) {
+            k.col_order.push_back(v);
+        }
+    }
+    for (uint32_t v : k.col_order) {
+        solver->seen[v] = 0;
+    }
+
+    return k;
+}
+
+double EGaussian::get_time_saved() const
+{
+    if (col_order.empty() || full_elim_time < 0) {
+        return 0;
+    }
+    return std::max(0.0, full_elim_time - elim_time);
+}
+
 bool EGaussian::clean_xors()
 {
     for(Xor& x: xorclauses) {
@@ -281,7 +434,9 @@ bool EGaussian::full_init(bool& created) {
             return solver->okay();
         }
 
+        const double elim_start = cpuTime();
         eliminate(matrix); // gauss eliminate algorithm
+        elim_time += cpuTime() - elim_start;
 
         // find some row already true false, and insert watch list
         gret ret = adjust_matrix(matrix);
@@ -308,8 +463,13 @@ bool EGaussian::full_init(bool& created) {
         }
     }
 
+    if (col_order.empty()) {
+        full_elim_time = elim_time;
+    }
+
     if (solver->conf.verbosity >= 2) {
-        cout << "c [gauss] initialised matrix " << matrix_no << endl;
+        cout << "c [gauss] initialised matrix " << matrix_no
+        << " row kernels: " << row_kernels.name << endl;
     }
 
     // std::cout << cpuTime() - GaussConstructTime << "    t";
@@ -317,6 +477,14 @@ bool EGaussian::full_init(bool& created) {
 }
 
 void EGaussian::eliminate(matrixset& m) {
+    if (config.m4r_eliminate) {
+        eliminate_m4r(m);
+    } else {
+        eliminate_plain(m);
+    }
+}
+
+void EGaussian::eliminate_plain(matrixset& m) {
     uint32_t i = 0;
     uint32_t j = 0;
     PackedMatrix::iterator end = m.matrix.beginMatrix() + m.num_rows;
@@ -362,6 +530,114 @@ void EGaussian::eliminate(matrixset& m) {
     // print_matrix(m);
 }
 
+/**
+@brief Gauss-Jordan elimination, the Method of Four Russians way
+
+Columns are done in strips of m4r_strip_cols. First, the pivots of the strip
+are found, and they are reduced against each other. Then the sums of them are
+kept in m4r_table, so every other row is cleared in the strip with a single
+XOR, instead of one XOR per pivot.
+
+Gives the very same matrix as eliminate_plain().
+*/
+void EGaussian::eliminate_m4r(matrixset& m) {
+    const PackedMatrix::iterator begin = m.matrix.beginMatrix();
+    const PackedMatrix::iterator end = begin + m.num_rows;
+    m4r_table.resize(1U << m4r_strip_cols, m.num_cols);
+
+    uint32_t i = 0;
+    for (uint32_t j0 = 0; i != m.num_rows && j0 < m.num_cols; j0 += m4r_strip_cols) {
+        const uint32_t strip_end = std::min(j0 + m4r_strip_cols, m.num_cols);
+        uint32_t piv_row[m4r_strip_cols]; //by column in the strip
+        uint32_t piv_mask = 0; //columns in the strip that have a pivot
+
+        //Find the pivots of the strip, moving them up to row i
+        for (uint32_t j = j0; j != strip_end && i != m.num_rows; j++) {
+            const uint32_t at = j - j0;
+
+            //Bit "at" of a row gets flipped by the pivots at these columns
+            uint32_t flip = 0;
+            for (uint32_t p = 0; p != m4r_strip_cols; p++) {
+                if (((piv_mask >> p) & 1)
+                    && (((*(begin + piv_row[p])).get_byte(j0) >> at) & 1)
+                ) {
+                    flip |= 1U << p;
+                }
+            }
+
+            PackedMatrix::iterator rowIt = begin + i;
+            PackedMatrix::iterator row_with_1_in_col = rowIt;
+            for (; row_with_1_in_col != end; ++row_with_1_in_col) {
+                const uint32_t bits = (*row_with_1_in_col).get_byte(j0);
+                if (((bits >> at) ^ my_popcnt(bits & flip)) & 1) {
+                    break;
+                }
+            }
+            if (row_with_1_in_col == end) {
+                continue;
+            }
+
+            if (row_with_1_in_col != rowIt) {
+                (*rowIt).swapBoth(*row_with_1_in_col);
+            }
+            for (uint32_t p = 0; p != m4r_strip_cols; p++) {
+                if (((piv_mask >> p) & 1) && (*rowIt)[j0 + p]) {
+                    (*rowIt).xorBoth(*(begin + piv_row[p]));
+                }
+            }
+            for (uint32_t p = 0; p != m4r_strip_cols; p++) {
+                if (((piv_mask >> p) & 1) && (*(begin + piv_row[p]))[j]) {
+                    (*(begin + piv_row[p])).xorBoth(*rowIt);
+                }
+            }
+            piv_row[at] = i;
+            piv_mask |= 1U << at;
+            i++;
+            GasVar_state[m.col_to_var[j]] = basic_var; // this column is basic variable
+        }
+        if (piv_mask == 0) {
+            continue;
+        }
+
+        //Clear the pivot columns of all other rows
+        std::fill(m4r_built, m4r_built + (1U << m4r_strip_cols), 0);
+        uint32_t row_n = 0;
+        for (PackedMatrix::iterator k_row = begin; k_row != end; ++k_row, row_n++) {
+            const uint32_t x = (*k_row).get_byte(j0) & piv_mask;
+            if (x == 0) {
+                continue;
+            }
+
+            //Pivot rows only have their own pivot column set
+            if ((x & (x-1)) == 0 && piv_row[my_ctz64(x)] == row_n) {
+                continue;
+            }
+            (*k_row).xorBoth(m4r_table_entry(begin, piv_row, x));
+        }
+    }
+}
+
+/**
+@brief The sum of the pivots whose columns are set in x
+
+Filled on first use only, as sparse matrices only need a few of them.
+*/
+PackedRow EGaussian::m4r_table_entry(
+    const PackedMatrix::iterator begin
+    , const uint32_t* piv_row
+    , const uint32_t x
+) {
+    if (!m4r_built[x]) {
+        PackedRow entry = m4r_table.getMatrixAt(x);
+        entry = *(begin + piv_row[my_ctz64(x)]);
+        if (x & (x-1)) {
+            entry.xorBoth(m4r_table_entry(begin, piv_row, x & (x-1)));
+        }
+        m4r_built[x] = 1;
+    }
+    return m4r_table.getMatrixAt(x);
+}
+
 gret EGaussian::adjust_matrix(matrixset& m) {
     assert(solver->decisionLevel() == 0);
 
@@ -86,12 +86,25 @@ class EGaussian {
         uint32_t num_cols; // number of active columns in the matrix. The columns at the end that have all be zeroed are no longer active
     };
     matrixset matrix; // The current matrixset, i.e. the one we are working on, or the last one we worked on
+    vector<Xor> input_xors;  // XORs given, cleaned and sorted, to be matched against kept matrixes
+    vector<uint32_t> col_order; // columns to put first, from a kept matrix
+    double elim_time = 0;       // time spent eliminating in full_init()
+    double full_elim_time = -1; // same, when not seeded from a kept matrix
+    PackedMatrix m4r_table; // sums of the pivot rows of a strip, used by eliminate_m4r()
+    char m4r_built[256]; // which entries of m4r_table are filled for this strip
+    PackedRow m4r_table_entry(
+        const PackedMatrix::iterator begin
+        , const uint32_t* piv_row
+        , const uint32_t x
+    );
 
 
     bool clean_xors();
     void clear_gwatches(const uint32_t var);
     void print_matrix(matrixset& m) const ;   // print matrix
     void eliminate(matrixset& m) ;            //gaussian elimination
+    void eliminate_plain(matrixset& m);       //row-by-row Gauss-Jordan
+    void eliminate_m4r(matrixset& m);         //Method of Four Russians
     gret adjust_matrix(matrixset& matrix); // adjust matrix, include watch, check row is zero, etc.
 
     inline void propagation_twoclause();
@@ -114,7 +127,10 @@ class EGaussian {
 
     // functiion
     void canceling(const uint32_t sublevel); //functions used throughout the Solver
+    bool seed_from_kept(vector<GaussKept>& kept); // start from a kept matrix, if one fits. Returns whether it did
     bool full_init(bool& created);  // initial arrary. return true is fine , return false means solver already false;
+    GaussKept get_kept() const;      // what to keep of this matrix for the next search
+    double get_time_saved() const;   // time seeding saved in full_init()
     void fill_matrix(matrixset& origMat); // Fills the origMat matrix
     uint32_t select_columnorder(matrixset& origMat); // Fills var_to_col and col_to_var of the origMat matrix.
 
@@ -136,6 +152,9 @@ class EGaussian {
     void Debug_funtion(); // used to debug
 };
 
+// Cleans and sorts XORs of a kept matrix. False if they use a variable that has been removed since
+bool clean_kept_xors(Solver* solver, vector<Xor>& xors);
+
 }
 
 
@@ -0,0 +1,625 @@
+/******************************************
+Copyright (c) 2016, Mate Soos
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+***********************************************/
+
+#ifndef BACKGROUNDREADER_H
+#define BACKGROUNDREADER_H
+
+#include <stdio.h>
+#include <string.h>
+#include <cstdlib>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <iostream>
+
+#ifdef USE_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef USE_ZSTD
+#include <zstd.h>
+#endif
+
+#ifdef USE_LZMA
+#include <lzma.h>
+#endif
+
+//Turns the raw bytes of the input into the text of the CNF, one block at a
+//time. There is one of these for every supported compression format.
+class InputDecompressor
+{
+    public:
+        InputDecompressor(FILE* _in, std::vector<char>& _head) :
+            in(_in)
+        {
+            head.swap(_head);
+        }
+        virtual ~InputDecompressor()
+        {}
+        virtual const char* name() const = 0;
+
+        //Fills "out" with the next block of the CNF. Returns FALSE at the end
+        //of the input, or on an error, in which case "err" is set
+        virtual bool next(std::vector<char>& out) = 0;
+        std::string err;
+
+        static const size_t block_size = 1ULL << 20;
+
+    protected:
+        //Raw bytes, starting with the ones read to detect the format
+        size_t read_raw(char* buf, const size_t len)
+        {
+            size_t got = 0;
+            if (head_at < head.size()) {
+                got = std::min(len, head.size() - head_at);
+                memcpy(buf, head.data() + head_at, got);
+                head_at += got;
+            }
+            if (got < len) {
+                got += fread(buf + got, 1, len - got, in);
+                if (ferror(in)) {
+                    err = "could not read the input file";
+                }
+            }
+            return got;
+        }
+
+        FILE* in;
+        std::vector<char> head;
+        size_t head_at = 0;
+};
+
+class PlainInput: public InputDecompressor
+{
+    public:
+        using InputDecompressor::InputDecompressor;
+        const char* name() const override
+        {
+            return "plain";
+        }
+
+        bool next(std::vector<char>& out) override
+        {
+            out.resize(block_size);
+            out.resize(read_raw(out.data(), block_size));
+            return err.empty() && !out.empty();
+        }
+};
+
+#ifdef USE_ZLIB
+//Any gzip file, including ones with many members, decompressed serially
+class GzipInput: public InputDecompressor
+{
+    public:
+        GzipInput(FILE* _in, std::vector<char>& _head) :
+            InputDecompressor(_in, _head)
+            , inbuf(block_size)
+        {
+            memset(&strm, 0, sizeof(strm));
+            //32: detect and skip the gzip header
+            inflateInit2(&strm, 15+32);
+        }
+        ~GzipInput()
+        {
+            inflateEnd(&strm);
+        }
+        const char* name() const override
+        {
+            return "gzip";
+        }
+
+        bool next(std::vector<char>& out) override
+        {
+            out.resize(block_size);
+            strm.next_out = (Bytef*)out.data();
+            strm.avail_out = out.size();
+            while (strm.avail_out > 0 && !done) {
+                if (strm.avail_in == 0) {
+                    const size_t n = read_raw(inbuf.data(), inbuf.size());
+                    if (n == 0) {
+                        if (!at_member_end) {
+                            err = "unexpected end of gzip data";
+                        }
+                        break;
+                    }
+                    strm.next_in = (Bytef*)inbuf.data();
+                    strm.avail_in = n;
+                }
+
+                const int ret = inflate(&strm, Z_NO_FLUSH);
+                if (ret == Z_STREAM_END) {
+                    //Next member, if any
+                    at_member_end = true;
+                    inflateReset(&strm);
+                    continue;
+                }
+                if (ret == Z_DATA_ERROR && at_member_end) {
+                    //Not a new member, ignore trailing garbage like gzread()
+                    done = true;
+                    break;
+                }
+                if (ret != Z_OK && ret != Z_BUF_ERROR) {
+                    err = std::string("gzip data is corrupt: ")
+                        + (strm.msg ? strm.msg : "unknown error");
+                    return false;
+                }
+                at_member_end = false;
+            }
+            out.resize(out.size() - strm.avail_out);
+            return err.empty() && !out.empty();
+        }
+
+    private:
+        z_stream strm;
+        std::vector<char> inbuf;
+        //Set once a member has ended: only then can what follows be
+        //trailing garbage instead of corrupt data
+        bool at_member_end = false;
+        bool done = false;
+};
+
+//BGZF is gzip made of small members whose compressed size is in their
+//header. The members can be found without decompressing, so they are
+//decompressed in parallel.
+class BgzfInput: public InputDecompressor
+{
+    public:
+        BgzfInput(FILE* _in, std::vector<char>& _head, unsigned _num_threads) :
+            InputDecompressor(_in, _head)
+            , num_threads(std::max(1U, _num_threads))
+        {}
+        const char* name() const override
+        {
+            return "gzip (BGZF)";
+        }
+
+        //Size of the member starting at "p", 0 if it's not a whole, well
+        //formed BGZF member within the "avail" bytes, or if it claims to
+        //inflate to more than a BGZF block can hold
+        static size_t member_size(const char* p, const size_t avail)
+        {
+            const uint8_t* b = (const uint8_t*)p;
+            if (avail < 18
+                || b[0] != 0x1f || b[1] != 0x8b || b[2] != 8 || !(b[3] & 4)
+            ) {
+                return 0;
+            }
+            const size_t hdr = 12 + (b[10] | (b[11] << 8));
+            if (hdr + 8 > avail) {
+                return 0;
+            }
+            for(size_t at = 12; at + 4 <= hdr; ) {
+                const size_t slen = b[at+2] | (b[at+3] << 8);
+                if (at + 4 + slen > hdr) {
+                    return 0;
+                }
+                if (b[at] == 'B' && b[at+1] == 'C' && slen == 2) {
+                    const size_t sz = (b[at+4] | (b[at+5] << 8)) + 1;
+                    if (sz < hdr + 8 || sz > avail) {
+                        return 0;
+                    }
+                    const uint8_t* tail = b + sz - 4;
+                    const size_t isize = tail[0] | (tail[1] << 8) | (tail[2] << 16) | ((size_t)tail[3] << 24);
+                    if (isize > max_block_out_size) {
+                        return 0;
+                    }
+                    return sz;
+                }
+                at += 4 + slen;
+            }
+            return 0;
+        }
+
+        bool next(std::vector<char>& out) override
+        {
+            //Find the members of the next batch
+            members.clear();
+            size_t at = 0;
+            size_t out_size = 0;
+            while (at < batch_size) {
+                ensure(at + max_member_size);
+                if (raw.size() == at) {
+                    break;
+                }
+                const size_t sz = member_size(raw.data() + at, raw.size() - at);
+                if (sz == 0) {
+                    err = "not a valid BGZF block, or unexpected end of BGZF data";
+                    return false;
+                }
+                const uint8_t* tail = (const uint8_t*)raw.data() + at + sz - 4;
+                const size_t isize = tail[0] | (tail[1] << 8) | (tail[2] << 16) | ((size_t)tail[3] << 24);
+                members.push_back(Member {at, sz, out_size, isize});
+                at += sz;
+                out_size += isize;
+            }
+            if (!err.empty()) {
+                return false;
+            }
+
+            out.resize(out_size);
+            const size_t threads = std::min<size_t>(num_threads, members.size());
+            std::vector<std::string> errs(threads);
+            auto worker = [&](const size_t tid) {
+                for(size_t i = tid; i < members.size() && errs[tid].empty(); i += threads) {
+                    inflate_member(members[i], out.data(), errs[tid]);
+                }
+            };
+            std::vector<std::thread> thrs;
+            for(size_t i = 1; i < threads; i++) {
+                thrs.push_back(std::thread(worker, i));
+            }
+            if (threads > 0) {
+                worker(0);
+            }
+            for(std::thread& t: thrs) {
+                t.join();
+            }
+            for(const std::string& e: errs) {
+                if (!e.empty()) {
+                    err = e;
+                    return false;
+                }
+            }
+
+            raw.erase(raw.begin(), raw.begin() + at);
+            return !members.empty();
+        }
+
+    private:
+        struct Member {
+            size_t at;
+            size_t size;
+            size_t out_at;
+            size_t out_size;
+        };
+
+        bool ensure(const size_t sz)
+        {
+            while (raw.size() < sz) {
+                const size_t old = raw.size();
+                raw.resize(std::max(sz, old + block_size));
+                raw.resize(old + read_raw(raw.data() + old, raw.size() - old));
+                if (raw.size() == old) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        void inflate_member(const Member& m, char* out, std::string& e) const
+        {
+            const uint8_t* b = (const uint8_t*)raw.data() + m.at;
+            const size_t hdr = 12 + (b[10] | (b[11] << 8));
+            const uint8_t* tail = b + m.size - 8;
+            const uint32_t crc = tail[0] | (tail[1] << 8) | (tail[2] << 16) | ((uint32_t)tail[3] << 24);
+
+            z_stream s;
+            memset(&s, 0, sizeof(s));
+            inflateInit2(&s, -15);
+            s.next_in = (Bytef*)b + hdr;
+            s.avail_in = m.size - hdr - 8;
+            s.next_out = (Bytef*)out + m.out_at;
+            s.avail_out = m.out_size;
+            const int ret = inflate(&s, Z_FINISH);
+            const size_t done = s.total_out;
+            inflateEnd(&s);
+
+            if (ret != Z_STREAM_END || done != m.out_size
+                || crc32(crc32(0, Z_NULL, 0), (const Bytef*)out + m.out_at, m.out_size) != crc
+            ) {
+                e = "BGZF block is corrupt";
+            }
+        }
+
+        const unsigned num_threads;
+        static const size_t batch_size = 4ULL << 20;
+        //BSIZE is 16 bits
+        static const size_t max_member_size = 64*1024;
+        //So that a corrupt ISIZE can't make next() allocate gigabytes
+        static const size_t max_block_out_size = 64*1024;
+        std::vector<char> raw;
+        std::vector<Member> members;
+};
+#endif //USE_ZLIB
+
+#ifdef USE_ZSTD
+class ZstdInput: public InputDecompressor
+{
+    public:
+        ZstdInput(FILE* _in, std::vector<char>& _head) :
+            InputDecompressor(_in, _head)
+            , inbuf(block_size)
+        {
+            ds = ZSTD_createDStream();
+            ZSTD_initDStream(ds);
+        }
+        ~ZstdInput()
+        {
+            ZSTD_freeDStream(ds);
+        }
+        const char* name() const override
+        {
+            return "zstd";
+        }
+
+        bool next(std::vector<char>& out) override
+        {
+            out.resize(block_size);
+            ZSTD_outBuffer o = {out.data(), out.size(), 0};
+            while (o.pos < o.size) {
+                if (i.pos == i.size) {
+                    const size_t n = read_raw(inbuf.data(), inbuf.size());
+                    if (n == 0) {
+                        if (last_ret != 0) {
+                            err = "unexpected end of zstd data";
+                        }
+                        break;
+                    }
+                    i = {inbuf.data(), n, 0};
+                }
+                last_ret = ZSTD_decompressStream(ds, &o, &i);
+                if (ZSTD_isError(last_ret)) {
+                    err = std::string("zstd data is corrupt: ") + ZSTD_getErrorName(last_ret);
+                    return false;
+                }
+            }
+            out.resize(o.pos);
+            return err.empty() && !out.empty();
+        }
+
+    private:
+        ZSTD_DStream* ds;
+        ZSTD_inBuffer i = {NULL, 0, 0};
+        size_t last_ret = 0;
+        std::vector<char> inbuf;
+};
+#endif //USE_ZSTD
+
+#ifdef USE_LZMA
+class XzInput: public InputDecompressor
+{
+    public:
+        XzInput(FILE* _in, std::vector<char>& _head) :
+            InputDecompressor(_in, _head)
+            , inbuf(block_size)
+        {
+            if (lzma_stream_decoder(&strm, UINT64_MAX, LZMA_CONCATENATED) != LZMA_OK) {
+                err = "could not set up the xz decoder";
+            }
+        }
+        ~XzInput()
+        {
+            lzma_end(&strm);
+        }
+        const char* name() const override
+        {
+            return "xz";
+        }
+
+        bool next(std::vector<char>& out) override
+        {
+            if (!err.empty()) {
+                return false;
+            }
+            out.resize(block_size);
+            strm.next_out = (uint8_t*)out.data();
+            strm.avail_out = out.size();
+            while (strm.avail_out > 0 && !finished) {
+                if (strm.avail_in == 0 && action == LZMA_RUN) {
+                    const size_t n = read_raw(inbuf.data(), inbuf.size());
+                    if (n == 0) {
+                        action = LZMA_FINISH;
+                    }
+                    strm.next_in = (const uint8_t*)inbuf.data();
+                    strm.avail_in = n;
+                }
+
+                const lzma_ret ret = lzma_code(&strm, action);
+                if (ret == LZMA_STREAM_END) {
+                    finished = true;
+                } else if (ret != LZMA_OK) {
+                    err = "xz data is corrupt or truncated";
+                    return false;
+                }
+            }
+            out.resize(out.size() - strm.avail_out);
+            return err.empty() && !out.empty();
+        }
+
+    private:
+        lzma_stream strm = LZMA_STREAM_INIT;
+        lzma_action action = LZMA_RUN;
+        bool finished = false;
+        std::vector<char> inbuf;
+};
+#endif //USE_LZMA
+
+//Decompresses the input in a background thread, so parsing (and adding the
+//clauses to the solver) is not held up by it. The format is found from the
+//first bytes of the input.
+class BackgroundReader
+{
+    public:
+        BackgroundReader(FILE* in, const unsigned num_threads = 1)
+        {
+            std::vector<char> head(64*1024);
+            head.resize(fread(head.data(), 1, head.size(), in));
+            const uint8_t* b = (const uint8_t*)head.data();
+            const size_t sz = head.size();
+
+            if (sz >= 2 && b[0] == 0x1f && b[1] == 0x8b) {
+                #ifdef USE_ZLIB
+                if (num_threads > 1 && BgzfInput::member_size(head.data(), sz) > 0) {
+                    dec.reset(new BgzfInput(in, head, num_threads));
+                } else {
+                    dec.reset(new GzipInput(in, head));
+                }
+                #else
+                err = "input is gzip compressed, but gzip support was not compiled in";
+                #endif
+            } else if (sz >= 4 && b[0] == 0x28 && b[1] == 0xb5 && b[2] == 0x2f && b[3] == 0xfd) {
+                #ifdef USE_ZSTD
+                dec.reset(new ZstdInput(in, head));
+                #else
+                err = "input is zstd compressed, but zstd support was not compiled in";
+                #endif
+            } else if (sz >= 6 && memcmp(b, "\xfd" "7zXZ\0", 6) == 0) {
+                #ifdef USE_LZMA
+                dec.reset(new XzInput(in, head));
+                #else
+                err = "input is xz compressed, but xz support was not compiled in";
+                #endif
+            } else {
+                dec.reset(new PlainInput(in, head));
+            }
+
+            if (dec) {
+                thr = std::thread(&BackgroundReader::produce, this);
+            } else {
+                finished = true;
+            }
+        }
+
+        ~BackgroundReader()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mu);
+                stopping = true;
+            }
+            cv.notify_all();
+            if (thr.joinable()) {
+                thr.join();
+            }
+        }
+
+        const char* format() const
+        {
+            return dec ? dec->name() : "unknown";
+        }
+
+        //Like fread(). Exits on a read or decompression error, as the CNF
+        //would be truncated
+        size_t read(char* buf, const size_t len)
+        {
+            if (cur_at == cur.size() && !next_block()) {
+                return 0;
+            }
+
+            const size_t n = std::min(len, cur.size() - cur_at);
+            memcpy(buf, cur.data() + cur_at, n);
+            cur_at += n;
+            return n;
+        }
+
+        //Checks the start of the decompressed input without consuming it
+        bool starts_with(const char* data, const size_t len)
+        {
+            while (cur.size() - cur_at < len) {
+                if (!next_block()) {
+                    return false;
+                }
+            }
+            return memcmp(cur.data() + cur_at, data, len) == 0;
+        }
+
+    private:
+        //Takes the next block, keeping what is unread of the current one
+        bool next_block()
+        {
+            std::unique_lock<std::mutex> lock(mu);
+            cv.wait(lock, [&]{ return !blocks.empty() || finished; });
+            if (blocks.empty()) {
+                if (!err.empty()) {
+                    std::cerr << "ERROR! Could not read input: " << err << std::endl;
+                    std::exit(-1);
+                }
+                return false;
+            }
+            std::vector<char> block;
+            block.swap(blocks.front());
+            blocks.pop_front();
+            lock.unlock();
+            cv.notify_all();
+
+            block.insert(block.begin(), cur.begin() + cur_at, cur.end());
+            cur.swap(block);
+            cur_at = 0;
+            return true;
+        }
+
+        void produce()
+        {
+            std::vector<char> block;
+            bool more = true;
+            while (more) {
+                more = dec->next(block);
+                std::unique_lock<std::mutex> lock(mu);
+                if (!more) {
+                    err = dec->err;
+                }
+                if (!block.empty() && dec->err.empty()) {
+                    cv.wait(lock, [&]{ return blocks.size() < max_blocks || stopping; });
+                    if (stopping) {
+                        break;
+                    }
+                    blocks.push_back(std::vector<char>());
+                    blocks.back().swap(block);
+                }
+                lock.unlock();
+                cv.notify_all();
+            }
+
+            std::lock_guard<std::mutex> lock(mu);
+            finished = true;
+            cv.notify_all();
+        }
+
+        std::unique_ptr<InputDecompressor> dec;
+        std::thread thr;
+
+        //Shared with the background thread
+        std::mutex mu;
+        std::condition_variable cv;
+        std::deque<std::vector<char>> blocks;
+        static const size_t max_blocks = 4;
+        bool finished = false;
+        bool stopping = false;
+        std::string err;
+
+        //Block being read
+        std::vector<char> cur;
+        size_t cur_at = 0;
+};
+
+struct BG {
+    static inline int read(void* buf, size_t num, size_t count, BackgroundReader* r)
+    {
+        return r->read((char*)buf, num*count);
+    }
+};
+
+#endif //BACKGROUNDREADER_H
@@ -0,0 +1,173 @@
+/******************************************
+Copyright (c) 2016, Mate Soos
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+***********************************************/
+
+#ifndef BINARYCNF_H
+#define BINARYCNF_H
+
+#include <string.h>
+#include <ostream>
+#include <vector>
+#include <algorithm>
+#include "cryptominisat5/solvertypesmini.h"
+
+//Binary CNF format. All numbers are unsigned LEB128 varints:
+//
+//  "CMSBCNF" 0x01                                       -- magic + version
+//  num_vars num_clauses num_xors num_indep              -- header
+//  num_clauses x [size lit_0 (lit_1-lit_0) ...]         -- clauses
+//  num_xors    x [size*2+rhs var_0 (var_1-var_0) ...]   -- XOR clauses
+//  [var_0 (var_1-var_0) ...]                            -- independent vars
+//
+//Literals are Lit::toInt() values and vars are 0-based. Inside a clause, an
+//XOR or the independent set they are sorted, so all but the first are
+//stored as the (small) difference to the previous one. An empty clause makes
+//the CNF UNSAT.
+
+namespace CMSat {
+
+static const char binary_cnf_magic[8] = {'C', 'M', 'S', 'B', 'C', 'N', 'F', 1};
+
+inline bool is_binary_cnf(const char* data, const size_t len)
+{
+    return len >= sizeof(binary_cnf_magic)
+        && memcmp(data, binary_cnf_magic, sizeof(binary_cnf_magic)) == 0;
+}
+
+//Writes the binary CNF format. The counts must be given up-front, in
+//header(), and flush() must be called at the end. When "out" is NULL
+//nothing is written, only the clauses are counted, so a dump can be done in
+//two passes.
+class BinaryCNFWriter
+{
+    public:
+        explicit BinaryCNFWriter(std::ostream* _out) :
+            out(_out)
+        {
+            if (out) {
+                buf.reserve(buf_size + 64);
+            }
+        }
+
+        void header(
+            const uint64_t nvars
+            , const uint64_t ncls
+            , const uint64_t nxors
+            , const uint64_t nindep
+        ) {
+            if (!out) {
+                return;
+            }
+            buf.insert(buf.end(), binary_cnf_magic, binary_cnf_magic + sizeof(binary_cnf_magic));
+            varint(nvars);
+            varint(ncls);
+            varint(nxors);
+            varint(nindep);
+        }
+
+        void clause(const Lit* lits, const size_t size)
+        {
+            num_clauses++;
+            if (!out) {
+                return;
+            }
+            tmp.clear();
+            for(size_t i = 0; i < size; i++) {
+                tmp.push_back(lits[i].toInt());
+            }
+            varint(size);
+            sorted_deltas(tmp);
+        }
+
+        void clause(const std::vector<Lit>& lits)
+        {
+            clause(lits.data(), lits.size());
+        }
+
+        void xor_clause(const std::vector<uint32_t>& vars, const bool rhs)
+        {
+            num_xors++;
+            if (!out) {
+                return;
+            }
+            tmp = vars;
+            varint(((uint64_t)vars.size() << 1) | (uint64_t)rhs);
+            sorted_deltas(tmp);
+        }
+
+        //Comments are not stored
+        void comment(const char*)
+        {}
+
+        void independent_vars(const std::vector<uint32_t>& vars)
+        {
+            num_indep += vars.size();
+            if (!out) {
+                return;
+            }
+            tmp = vars;
+            sorted_deltas(tmp);
+        }
+
+        void flush()
+        {
+            if (out && !buf.empty()) {
+                out->write(buf.data(), buf.size());
+                buf.clear();
+            }
+        }
+
+        uint64_t num_clauses = 0;
+        uint64_t num_xors = 0;
+        uint64_t num_indep = 0;
+
+    private:
+        void varint(uint64_t x)
+        {
+            while (x >= 0x80) {
+                buf.push_back((char)((x & 0x7f) | 0x80));
+                x >>= 7;
+            }
+            buf.push_back((char)x);
+            if (buf.size() >= buf_size) {
+                flush();
+            }
+        }
+
+        void sorted_deltas(std::vector<uint32_t>& vals)
+        {
+            std::sort(vals.begin(), vals.end());
+            uint32_t prev = 0;
+            for(const uint32_t v: vals) {
+                varint(v - prev);
+                prev = v;
+            }
+        }
+
+        std::ostream* out;
+        std::vector<char> buf;
+        static const size_t buf_size = 1ULL << 20;
+        std::vector<uint32_t> tmp;
+};
+
+}
+
+#endif //BINARYCNF_H
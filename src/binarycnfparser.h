@@ -0,0 +1,316 @@
+/******************************************
+Copyright (c) 2016, Mate Soos
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+***********************************************/
+
+#ifndef BINARYCNFPARSER_H
+#define BINARYCNFPARSER_H
+
+#include "cryptominisat5/cryptominisat.h"
+#include "binarycnf.h"
+#include "backgroundreader.h"
+#include <string.h>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <iomanip>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+using namespace CMSat;
+using std::vector;
+using std::cout;
+using std::endl;
+
+//Reads the binary CNF format of binarycnf.h. An uncompressed file is
+//memory-mapped and decoded straight into flat buffers that are handed to
+//SATSolver::add_clauses(). Other input (compressed, stdin) is decoded from a
+//BackgroundReader.
+class BinaryCNFParser
+{
+    public:
+        BinaryCNFParser(SATSolver* solver, unsigned verbosity);
+        ~BinaryCNFParser();
+
+        //Returns FALSE if the file cannot be memory-mapped or is not in
+        //the binary CNF format
+        bool open(const std::string& fname);
+        bool parse();
+        bool parse(BackgroundReader* reader);
+
+        vector<uint32_t> independent_vars;
+        size_t batch_lits = 1ULL << 20;
+
+        //Stat
+        size_t norm_clauses_added = 0;
+        size_t xor_clauses_added = 0;
+
+    private:
+        struct MemSource {
+            const uint8_t* at;
+            const uint8_t* end;
+
+            bool get(uint8_t& b)
+            {
+                if (at == end) {
+                    return false;
+                }
+                b = *at++;
+                return true;
+            }
+        };
+
+        struct ReaderSource {
+            BackgroundReader* reader;
+            vector<char> buf = vector<char>(1ULL << 20);
+            size_t at = 0;
+            size_t size = 0;
+
+            bool get(uint8_t& b)
+            {
+                if (at == size) {
+                    size = reader->read(buf.data(), buf.size());
+                    at = 0;
+                    if (size == 0) {
+                        return false;
+                    }
+                }
+                b = buf[at++];
+                return true;
+            }
+        };
+
+        template<class S> bool parse_main(S& src);
+        template<class S> bool read_varint(S& src, uint64_t& ret, const char* what);
+        template<class S> bool read_sorted(S& src, uint64_t num, uint64_t limit, const char* what);
+        bool error(const std::string& err) const;
+
+        SATSolver* solver;
+        unsigned verbosity;
+        uint64_t num_vars = 0;
+        uint64_t bytes_read = 0;
+
+        //Reduce temp overhead
+        vector<Lit> lits;
+        vector<uint32_t> vars;
+
+        int fd = -1;
+        const char* data = NULL;
+        size_t size = 0;
+};
+
+inline BinaryCNFParser::BinaryCNFParser(SATSolver* _solver, unsigned _verbosity):
+    solver(_solver)
+    , verbosity(_verbosity)
+{
+}
+
+inline BinaryCNFParser::~BinaryCNFParser()
+{
+    #ifndef _WIN32
+    if (data != NULL) {
+        munmap((void*)data, size);
+    }
+    if (fd != -1) {
+        close(fd);
+    }
+    #endif
+}
+
+inline bool BinaryCNFParser::open(const std::string& fname)
+{
+    #ifdef _WIN32
+    return false;
+    #else
+    fd = ::open(fname.c_str(), O_RDONLY);
+    if (fd == -1) {
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0) {
+        return false;
+    }
+    void* ptr = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (ptr == MAP_FAILED) {
+        return false;
+    }
+    data = (const char*)ptr;
+    size = st.st_size;
+    if (!is_binary_cnf(data, size)) {
+        return false;
+    }
+    #ifdef MADV_SEQUENTIAL
+    madvise(ptr, size, MADV_SEQUENTIAL);
+    #endif
+    return true;
+    #endif
+}
+
+inline bool BinaryCNFParser::error(const std::string& err) const
+{
+    std::cerr
+    << "PARSE ERROR! In binary CNF at byte " << bytes_read
+    << ": " << err << endl;
+    return false;
+}
+
+template<class S>
+inline bool BinaryCNFParser::read_varint(S& src, uint64_t& ret, const char* what)
+{
+    ret = 0;
+    for(unsigned shift = 0; shift < 64; shift += 7) {
+        uint8_t b;
+        if (!src.get(b)) {
+            return error(std::string("unexpected end of file while reading ") + what);
+        }
+        bytes_read++;
+        ret |= (uint64_t)(b & 0x7f) << shift;
+        if ((b & 0x80) == 0) {
+            return true;
+        }
+    }
+    return error(std::string("varint too long while reading ") + what);
+}
+
+//Reads "num" sorted, delta-encoded values into "vars", each below "limit"
+template<class S>
+inline bool BinaryCNFParser::read_sorted(S& src, uint64_t num, uint64_t limit, const char* what)
+{
+    vars.clear();
+    uint64_t val = 0;
+    for(uint64_t i = 0; i < num; i++) {
+        uint64_t delta;
+        if (!read_varint(src, delta, what)) {
+            return false;
+        }
+        if (delta >= limit - val) {
+            return error(std::string(what) + " out of range of the "
+                + std::to_string(num_vars) + " vars in the header");
+        }
+        val += delta;
+        vars.push_back(val);
+    }
+    return true;
+}
+
+template<class S>
+inline bool BinaryCNFParser::parse_main(S& src)
+{
+    for(size_t i = 0; i < sizeof(binary_cnf_magic); i++) {
+        uint8_t b;
+        if (!src.get(b) || b != (uint8_t)binary_cnf_magic[i]) {
+            return error("not a binary CNF, or unsupported version");
+        }
+        bytes_read++;
+    }
+
+    uint64_t num_cls, num_xors, num_indep;
+    if (!read_varint(src, num_vars, "header")
+        || !read_varint(src, num_cls, "header")
+        || !read_varint(src, num_xors, "header")
+        || !read_varint(src, num_indep, "header")
+    ) {
+        return false;
+    }
+    if (num_vars > (1ULL << 28)) {
+        return error("too many vars in the header: " + std::to_string(num_vars));
+    }
+    if (verbosity) {
+        cout << "c -- header says num vars:   " << std::setw(12) << num_vars << endl;
+        cout << "c -- header says num clauses:" << std::setw(12) << num_cls << endl;
+    }
+    if (solver->nVars() < num_vars) {
+        solver->new_vars(num_vars - solver->nVars());
+    }
+
+    //Clauses, each ended by lit_Undef, added in batches
+    lits.clear();
+    for(uint64_t i = 0; i < num_cls; i++) {
+        uint64_t sz;
+        if (!read_varint(src, sz, "clause size")
+            || !read_sorted(src, sz, num_vars*2, "literal")
+        ) {
+            return false;
+        }
+        for(const uint32_t l: vars) {
+            lits.push_back(Lit::toLit(l));
+        }
+        lits.push_back(lit_Undef);
+        if (lits.size() >= batch_lits) {
+            solver->add_clauses(lits.data(), lits.size());
+            lits.clear();
+        }
+    }
+    if (!lits.empty()) {
+        solver->add_clauses(lits.data(), lits.size());
+    }
+    norm_clauses_added += num_cls;
+
+    for(uint64_t i = 0; i < num_xors; i++) {
+        uint64_t sz_rhs;
+        if (!read_varint(src, sz_rhs, "XOR size")
+            || !read_sorted(src, sz_rhs >> 1, num_vars, "XOR variable")
+        ) {
+            return false;
+        }
+        solver->add_xor_clause(vars, sz_rhs & 1);
+    }
+    xor_clauses_added += num_xors;
+
+    if (!read_sorted(src, num_indep, num_vars, "independent variable")) {
+        return false;
+    }
+    independent_vars.insert(independent_vars.end(), vars.begin(), vars.end());
+
+    uint8_t b;
+    if (src.get(b)) {
+        return error("unexpected data after the last section");
+    }
+
+    if (verbosity) {
+        cout
+        << "c -- clauses added: " << norm_clauses_added << endl
+        << "c -- xor clauses added: " << xor_clauses_added << endl;
+    }
+    return true;
+}
+
+inline bool BinaryCNFParser::parse()
+{
+    MemSource src;
+    src.at = (const uint8_t*)data;
+    src.end = (const uint8_t*)data + size;
+    return parse_main(src);
+}
+
+inline bool BinaryCNFParser::parse(BackgroundReader* reader)
+{
+    ReaderSource src;
+    src.reader = reader;
+    return parse_main(src);
+}
+
+#endif //BINARYCNFPARSER_H
@@ -159,6 +159,7 @@ void BVA::remove_duplicates_from_m_cls()
                     }
                     return false;
                 }
+                case CMSat::watch_shared_t:
                 case CMSat::watch_idx_t: {
                     // This should never be here
                     assert(false);
@@ -210,6 +211,7 @@ void BVA::remove_duplicates_from_m_cls()
                 break;
             }
 
+            case CMSat::watch_shared_t:
             case CMSat::watch_idx_t: {
                 // This should never be here
                 assert(false);
@@ -548,7 +550,7 @@ bool BVA::add_longer_clause(const Lit new_lit, const OccurClause& cl)
             Clause* newCl = solver->add_clause_int(
                 lits, //lits to add
                 false, //redundant?
-                orig_cl.stats,
+                solver->cl_alloc.stats(orig_cl),
                 false, //attach?
                 &lits, //put back final lits here
                 true, //DRAT
@@ -566,6 +568,7 @@ bool BVA::add_longer_clause(const Lit new_lit, const OccurClause& cl)
             break;
         }
 
+        case CMSat::watch_shared_t:
         case CMSat::watch_idx_t: {
             // This should never be here
             assert(false);
@@ -199,6 +199,10 @@ Literals are allocated by an external allocator that allocates enough space
 for the class that it can hold the literals as well. I.e. it malloc()-s
     sizeof(Clause)+LENGHT*sizeof(Lit)
 to hold the clause.
+
+Its ClauseStats must be accessed through ClauseAllocator::stats(). With
+SPLIT_CLAUSE_STATS they are not stored here, but in a separate array of the
+ClauseAllocator, and the clause only holds their index.
 */
 class Clause
 {
@@ -226,25 +230,18 @@ public:
 
 public:
     cl_abst_type abst;
+    #ifdef SPLIT_CLAUSE_STATS
+    uint32_t stats_idx; ///<Index of the ClauseStats in ClauseAllocator
+    #else
     ClauseStats stats;
+    #endif
     uint32_t mySize;
 
     template<class V>
-    Clause(const V& ps, const uint32_t _introduced_at_conflict
-        #ifdef STATS_NEEDED
-        , const int64_t _ID
-        #endif
-        )
+    explicit Clause(const V& ps)
     {
         //assert(ps.size() > 2);
 
-        stats.last_touched = _introduced_at_conflict;
-        #ifdef STATS_NEEDED
-        stats.introduced_at_conflict = _introduced_at_conflict;
-        stats.ID = _ID;
-        assert(_ID >= 0);
-        #endif
-        stats.glue = std::min<uint32_t>(stats.glue, ps.size());
         isFreed = false;
         mySize = ps.size();
         isRed = false;
@@ -345,16 +342,11 @@ public:
     void makeIrred()
     {
         assert(isRed);
-        #if STATS_NEEDED
-        stats.ID = 0;
-        #endif
         isRed = false;
     }
 
-    void makeRed(const uint32_t newGlue, const double init_activity = 1.0)
+    void makeRed()
     {
-        stats.glue = newGlue;
-        stats.activity = init_activity;
         isRed = true;
     }
 
@@ -419,11 +411,6 @@ public:
         isFreed = true;
     }
 
-    void combineStats(const ClauseStats& other)
-    {
-        stats = ClauseStats::combineStats(stats, other);
-    }
-
     void set_distilled(bool distilled)
     {
         is_distilled = distilled;
@@ -444,19 +431,19 @@ public:
         occurLinked = toset;
     }
 
-    void print_extra_stats() const
+    void print_extra_stats(const ClauseStats& cl_stats) const
     {
         cout
         << "Clause size " << std::setw(4) << size();
         if (red()) {
-            cout << " glue : " << std::setw(4) << stats.glue;
+            cout << " glue : " << std::setw(4) << cl_stats.glue;
         }
         #ifdef STATS_NEEDED
         cout
-        << " Confls: " << std::setw(10) << stats.conflicts_made
-        << " Props: " << std::setw(10) << stats.propagations_made
-        << " Looked at: " << std::setw(10)<< stats.clause_looked_at
-        << " UIP used: " << std::setw(10)<< stats.used_for_uip_creation;
+        << " Confls: " << std::setw(10) << cl_stats.conflicts_made
+        << " Props: " << std::setw(10) << cl_stats.propagations_made
+        << " Looked at: " << std::setw(10)<< cl_stats.clause_looked_at
+        << " UIP used: " << std::setw(10)<< cl_stats.used_for_uip_creation;
         #endif
         cout << endl;
     }
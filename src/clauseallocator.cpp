@@ -34,6 +34,7 @@ THE SOFTWARE.
 #include "searcher.h"
 #include "time_mem.h"
 #include "sqlstats.h"
+#include "hugepagealloc.h"
 #ifdef USE_GAUSS
 #include "EGaussian.h"
 #endif
@@ -56,108 +57,331 @@ using std::endl;
 //For listing each and every clause location:
 //#define DEBUG_CLAUSEALLOCATOR2
 
-#define MIN_LIST_SIZE (50000 * (sizeof(Clause) + 4*sizeof(Lit))/sizeof(BASE_DATA_TYPE))
+#define MIN_LIST_SIZE std::min<uint64_t>( \
+    50000 * (sizeof(Clause) + 4*sizeof(Lit))/sizeof(BASE_DATA_TYPE), ARENA_SEG_SLOTS/2)
 #define ALLOC_GROW_MULT 1.5
 
 #define MAXSIZE ((1ULL << (EFFECTIVELY_USEABLE_BITS))-1)
 
-ClauseAllocator::ClauseAllocator() :
-    dataStart(NULL)
-    , size(0)
-    , capacity(0)
-    , currentlyUsedSize(0)
+ClauseArena::~ClauseArena()
 {
-    assert(MIN_LIST_SIZE < MAXSIZE);
+    clear();
 }
 
-/**
-@brief Frees all stacks
-*/
-ClauseAllocator::~ClauseAllocator()
+void ClauseArena::clear()
 {
-    free(dataStart);
+    for(const Chunk& c: chunks) {
+        huge_free(c.base, c.slots*sizeof(BASE_DATA_TYPE));
+    }
+    segs.clear();
+    chunks.clear();
+    last_chunk = Chunk{NULL, 0, 0};
+    used = 0;
+    alloc_end = 0;
+    num_slots = 0;
 }
 
-void* ClauseAllocator::allocEnough(
-    uint32_t num_lits
-) {
-    //Try to quickly find a place at the end of a dataStart
-    uint64_t neededbytes = sizeof(Clause) + sizeof(Lit)*num_lits;
-    uint64_t needed
-        = neededbytes/sizeof(BASE_DATA_TYPE) + (bool)(neededbytes % sizeof(BASE_DATA_TYPE));
+void ClauseArena::swap(ClauseArena& other)
+{
+    std::swap(segs, other.segs);
+    std::swap(chunks, other.chunks);
+    std::swap(last_chunk, other.last_chunk);
+    std::swap(used, other.used);
+    std::swap(alloc_end, other.alloc_end);
+    std::swap(num_slots, other.num_slots);
+}
 
-    if (size + needed > capacity) {
-        //Grow by default, but don't go under or over the limits
-        uint64_t newcapacity = capacity * ALLOC_GROW_MULT;
-        newcapacity = std::max<size_t>(newcapacity, MIN_LIST_SIZE);
-        while (newcapacity < size+needed) {
-            newcapacity *= ALLOC_GROW_MULT;
+bool ClauseArena::copy_from(const ClauseArena& other, const bool explicit_huge)
+{
+    clear();
+
+    //Chunks are created in the order of their segments
+    vector<Chunk> by_seg = other.chunks;
+    std::sort(by_seg.begin(), by_seg.end(),
+        [](const Chunk& a, const Chunk& b) {
+            return a.first_seg < b.first_seg;
+        });
+    for(const Chunk& c: by_seg) {
+        if (!new_chunk(c.first_seg, c.slots, explicit_huge)) {
+            clear();
+            return false;
         }
-        assert(newcapacity >= size+needed);
-        newcapacity = std::min<size_t>(newcapacity, MAXSIZE);
-
-        //Oops, not enough space anyway
-        if (newcapacity < size + needed) {
-            std::cerr
-            << "ERROR: memory manager can't handle the load."
-#ifndef LARGE_OFFSETS
-            << " **PLEASE RECOMPILE WITH -DLARGEMEM=ON**"
-#endif
-            << " size: " << size
-            << " needed: " << needed
-            << " newcapacity: " << newcapacity
-            << endl;
-            std::cout
-            << "ERROR: memory manager can't handle the load."
-#ifndef LARGE_OFFSETS
-            << " **PLEASE RECOMPILE WITH -DLARGEMEM=ON**"
-#endif
-            << " size: " << size
-            << " needed: " << needed
-            << " newcapacity: " << newcapacity
-            << endl;
+        const uint64_t start = c.first_seg << ARENA_SEG_BITS;
+        if (other.used > start) {
+            const uint64_t num = std::min<uint64_t>(other.used - start, c.slots);
+            memcpy(segs[c.first_seg], c.base, num*sizeof(BASE_DATA_TYPE));
+        }
+    }
+    used = other.used;
+    assert(alloc_end == other.alloc_end);
+
+    return true;
+}
+
+uint64_t ClauseArena::place(const uint64_t num) const
+{
+    if (segs.empty()) {
+        return 0;
+    }
+
+    const uint64_t seg_end = (uint64_t)segs.size() << ARENA_SEG_BITS;
+    if (used + num <= seg_end) {
+        return used;
+    }
+    return seg_end;
+}
+
+bool ClauseArena::new_chunk(
+    const uint64_t first_seg
+    , const uint64_t slots
+    , const bool explicit_huge
+) {
+    Chunk c;
+    c.base = (BASE_DATA_TYPE*)huge_alloc(slots*sizeof(BASE_DATA_TYPE), explicit_huge);
+    if (c.base == NULL) {
+        return false;
+    }
+    c.first_seg = first_seg;
+    c.slots = slots;
+
+    //Segments before it may be holes, when copying
+    assert(segs.size() <= first_seg);
+    segs.resize(first_seg, NULL);
+    for(uint64_t at = 0; at < slots; at += ARENA_SEG_SLOTS) {
+        segs.push_back(c.base + at);
+    }
+    chunks.insert(std::upper_bound(chunks.begin(), chunks.end(), c,
+        [](const Chunk& a, const Chunk& b) {
+            return a.base < b.base;
+        }), c);
+    last_chunk = c;
+    alloc_end = (first_seg << ARENA_SEG_BITS) + slots;
+    num_slots += slots;
+
+    return true;
+}
 
-            throw std::bad_alloc();
+bool ClauseArena::reserve(const uint64_t num, const bool explicit_huge)
+{
+    if (!segs.empty() || num == 0) {
+        return true;
+    }
+
+    return new_chunk(0, std::min<uint64_t>(num, ARENA_SEG_SLOTS), explicit_huge);
+}
+
+BASE_DATA_TYPE* ClauseArena::alloc(const uint64_t num, const bool explicit_huge)
+{
+    const uint64_t at = place(num);
+    if (at + num > alloc_end) {
+        if (at + num <= ((uint64_t)segs.size() << ARENA_SEG_BITS)) {
+            //Only the first segment is ever partially allocated. Grow it
+            assert(segs.size() == 1);
+            uint64_t new_slots = alloc_end * ALLOC_GROW_MULT;
+            while (new_slots < at + num) {
+                new_slots *= ALLOC_GROW_MULT;
+            }
+            new_slots = std::min<uint64_t>(new_slots, ARENA_SEG_SLOTS);
+
+            BASE_DATA_TYPE* new_base = (BASE_DATA_TYPE*)huge_realloc(
+                segs[0]
+                , alloc_end*sizeof(BASE_DATA_TYPE)
+                , new_slots*sizeof(BASE_DATA_TYPE)
+                , explicit_huge
+            );
+            if (new_base == NULL) {
+                return NULL;
+            }
+            num_slots += new_slots - alloc_end;
+            alloc_end = new_slots;
+            segs[0] = new_base;
+            last_chunk = Chunk{new_base, 0, new_slots};
+            chunks[0] = last_chunk;
+        } else {
+            uint64_t slots;
+            if (segs.empty()) {
+                slots = std::max<uint64_t>(num, MIN_LIST_SIZE);
+                slots = std::min<uint64_t>(slots, ARENA_SEG_SLOTS);
+            } else {
+                slots = ARENA_SEG_SLOTS;
+            }
+            if (num > slots) {
+                slots = ((num + ARENA_SEG_MASK) >> ARENA_SEG_BITS) << ARENA_SEG_BITS;
+            }
+            if (!new_chunk(at >> ARENA_SEG_BITS, slots, explicit_huge)) {
+                return NULL;
+            }
         }
+    }
+    assert(at + num <= alloc_end);
 
-        //Reallocate data
-        BASE_DATA_TYPE* new_dataStart;
-        new_dataStart = (BASE_DATA_TYPE*)realloc(
-            dataStart
-            , newcapacity*sizeof(BASE_DATA_TYPE)
-        );
+    used = at + num;
+    return ptr(at);
+}
 
-        //Realloc failed?
-        if (new_dataStart == NULL) {
-            std::cerr
-            << "ERROR: while reallocating clause space"
-            << endl;
+void ClauseArena::shrink_by(const uint64_t num)
+{
+    assert(num <= used);
+    used -= num;
+}
+
+void ClauseArena::truncate(const uint64_t num, const bool explicit_huge)
+{
+    assert(num <= used);
+    used = num;
+    if (num == 0) {
+        clear();
+        return;
+    }
 
-            throw std::bad_alloc();
+    //Free the chunks that start after the segment holding the last slot
+    const uint64_t keep_segs = ((num - 1) >> ARENA_SEG_BITS) + 1;
+    vector<Chunk> kept;
+    for(const Chunk& c: chunks) {
+        if (c.first_seg >= keep_segs) {
+            huge_free(c.base, c.slots*sizeof(BASE_DATA_TYPE));
+            num_slots -= c.slots;
+        } else {
+            kept.push_back(c);
         }
-        dataStart = new_dataStart;
+    }
+    chunks.swap(kept);
 
-        //Update capacity to reflect the update
-        capacity = newcapacity;
+    last_chunk = chunks[0];
+    for(const Chunk& c: chunks) {
+        if (c.first_seg > last_chunk.first_seg) {
+            last_chunk = c;
+        }
     }
+    segs.resize(last_chunk.first_seg
+        + ((last_chunk.slots + ARENA_SEG_MASK) >> ARENA_SEG_BITS));
+    alloc_end = (last_chunk.first_seg << ARENA_SEG_BITS) + last_chunk.slots;
+
+    //Only the first segment is left: it may give back its unused end, too.
+    //If that fails, it just stays larger
+    const uint64_t want = std::max<uint64_t>((uint64_t)(num * ALLOC_GROW_MULT), MIN_LIST_SIZE);
+    if (segs.size() == 1 && want < alloc_end) {
+        BASE_DATA_TYPE* new_base = (BASE_DATA_TYPE*)huge_realloc(
+            segs[0]
+            , alloc_end*sizeof(BASE_DATA_TYPE)
+            , want*sizeof(BASE_DATA_TYPE)
+            , explicit_huge
+        );
+        if (new_base == NULL) {
+            return;
+        }
+        num_slots -= alloc_end - want;
+        alloc_end = want;
+        segs[0] = new_base;
+        last_chunk = Chunk{new_base, 0, want};
+        chunks[0] = last_chunk;
+    }
+}
 
-    //Add clause to the set
-    Clause* pointer = (Clause*)(dataStart + size);
-    size += needed;
-    currentlyUsedSize += needed;
+void ClauseArena::free_between(const uint64_t from, const uint64_t to)
+{
+    assert(to <= used);
+    vector<Chunk> kept;
+    for(const Chunk& c: chunks) {
+        const uint64_t start = c.first_seg << ARENA_SEG_BITS;
+        if (start >= from && start + c.slots <= to) {
+            //The last chunk holds the last slot, it is never freed here
+            assert(c.base != last_chunk.base);
+            huge_free(c.base, c.slots*sizeof(BASE_DATA_TYPE));
+            num_slots -= c.slots;
+            for(uint64_t at = 0; at < c.slots; at += ARENA_SEG_SLOTS) {
+                segs[c.first_seg + (at >> ARENA_SEG_BITS)] = NULL;
+            }
+        } else {
+            kept.push_back(c);
+        }
+    }
+    chunks.swap(kept);
+}
 
-    return pointer;
+ClOffset ClauseArena::get_offset(const BASE_DATA_TYPE* p) const
+{
+    //Nearly always asked about the clause that was just allocated
+    const Chunk* c = &last_chunk;
+    if (!(p >= c->base && p < c->base + c->slots)) {
+        auto it = std::upper_bound(chunks.begin(), chunks.end(), p,
+            [](const BASE_DATA_TYPE* a, const Chunk& b) {
+                return a < b.base;
+            });
+        assert(it != chunks.begin());
+        c = &*(--it);
+        assert(p < c->base + c->slots);
+    }
+
+    return (c->first_seg << ARENA_SEG_BITS) + (p - c->base);
 }
 
-/**
-@brief Given the pointer of the clause it finds a 32-bit offset for it
+uint64_t ClauseArena::mem_in_huge_pages() const
+{
+    vector<const void*> bases;
+    for(const Chunk& c: chunks) {
+        bases.push_back(c.base);
+    }
+    return huge_bytes_backing(bases);
+}
 
-Calculates the stack frame and the position of the pointer in the stack, and
-rerturns a 32-bit value that is a concatenation of these two
-*/
-ClOffset ClauseAllocator::get_offset(const Clause* ptr) const
+ClauseAllocator::ClauseAllocator() :
+    currentlyUsedSize(0)
 {
-    return ((BASE_DATA_TYPE*)ptr - dataStart);
+    assert(MIN_LIST_SIZE < MAXSIZE);
+    assert(MIN_LIST_SIZE < ARENA_SEG_SLOTS);
+}
+
+void* ClauseAllocator::allocEnough(
+    uint32_t num_lits
+) {
+    uint64_t neededbytes = sizeof(Clause) + sizeof(Lit)*num_lits;
+    uint64_t needed
+        = neededbytes/sizeof(BASE_DATA_TYPE) + (bool)(neededbytes % sizeof(BASE_DATA_TYPE));
+
+    //Oops, offsets cannot address that far
+    const uint64_t at = arena.place(needed);
+    if (at + needed > MAXSIZE) {
+        std::cerr
+        << "ERROR: memory manager can't handle the load."
+#if defined(LARGE_ARENA) && !defined(LARGE_OFFSETS)
+        << " **PLEASE RECOMPILE WITH -DLARGEMEM=ON**"
+#elif !defined(LARGE_OFFSETS)
+        << " **PLEASE RECOMPILE WITH -DLARGEARENA=ON or -DLARGEMEM=ON**"
+#endif
+        << " size: " << arena.size()
+        << " needed: " << needed
+        << " max: " << MAXSIZE
+        << endl;
+        std::cout
+        << "ERROR: memory manager can't handle the load."
+#if defined(LARGE_ARENA) && !defined(LARGE_OFFSETS)
+        << " **PLEASE RECOMPILE WITH -DLARGEMEM=ON**"
+#elif !defined(LARGE_OFFSETS)
+        << " **PLEASE RECOMPILE WITH -DLARGEARENA=ON or -DLARGEMEM=ON**"
+#endif
+        << " size: " << arena.size()
+        << " needed: " << needed
+        << " max: " << MAXSIZE
+        << endl;
+
+        throw std::bad_alloc();
+    }
+
+    if (arena.empty()) {
+        touched_node = current_numa_node();
+    }
+    BASE_DATA_TYPE* pointer = arena.alloc(needed, explicit_hugepages);
+    if (pointer == NULL) {
+        std::cerr
+        << "ERROR: while allocating clause space"
+        << endl;
+
+        throw std::bad_alloc();
+    }
+    currentlyUsedSize += needed;
+
+    return pointer;
 }
 
 /**
@@ -184,10 +408,15 @@ void ClauseAllocator::clauseFree(Clause* cl)
         uint64_t needed
             = neededbytes/sizeof(BASE_DATA_TYPE) + (bool)(neededbytes % sizeof(BASE_DATA_TYPE));
 
-        if (((BASE_DATA_TYPE*)cl + needed) == (dataStart + size)) {
-            size -= needed;
+        if (get_offset(cl) + needed == arena.size()) {
+            arena.shrink_by(needed);
             currentlyUsedSize -= needed;
             quick_freed = true;
+            #ifdef SPLIT_CLAUSE_STATS
+            if (cl->stats_idx+1 == cold_stats.size()) {
+                cold_stats.pop_back();
+            }
+            #endif
         }
     }
     #endif
@@ -213,37 +442,56 @@ void ClauseAllocator::clauseFree(ClOffset offset)
 }
 
 ClOffset ClauseAllocator::move_cl(
-    ClOffset* newDataStart
-    , ClOffset*& new_ptr
+    ClauseArena& new_arena
     , Clause* old
+    #ifdef SPLIT_CLAUSE_STATS
+    , vector<ClauseStats>& new_cold_stats
+    #endif
 ) const {
     uint64_t bytesNeeded = sizeof(Clause) + old->size()*sizeof(Lit);
     uint64_t sizeNeeded = bytesNeeded/sizeof(BASE_DATA_TYPE) + (bool)(bytesNeeded % sizeof(BASE_DATA_TYPE));
+    const ClOffset new_offset = new_arena.place(sizeNeeded);
+    BASE_DATA_TYPE* new_ptr = new_arena.alloc(sizeNeeded, explicit_hugepages);
+    if (new_ptr == NULL) {
+        std::cerr
+        << "ERROR: while allocating clause space"
+        << endl;
+
+        throw std::bad_alloc();
+    }
     memcpy(new_ptr, old, sizeNeeded*sizeof(BASE_DATA_TYPE));
+    #ifdef SPLIT_CLAUSE_STATS
+    ((Clause*)new_ptr)->stats_idx = new_cold_stats.size();
+    new_cold_stats.push_back(cold_stats[old->stats_idx]);
+    #endif
 
-    ClOffset new_offset = new_ptr-newDataStart;
     (*old)[0] = Lit::toLit(new_offset & 0xFFFFFFFF);
     #ifdef LARGE_OFFSETS
     (*old)[1] = Lit::toLit((new_offset>>32) & 0xFFFFFFFF);
     #endif
     old->reloced = true;
 
-    new_ptr += sizeNeeded;
     return new_offset;
 }
 
 /**
-@brief If needed, compacts stacks, removing unused clauses
+@brief If needed, compacts the arena, removing unused clauses
 
 Firstly, the algorithm determines if the number of useless slots is large or
 small compared to the problem size. If it is small, it does nothing. If it is
-large, then it allocates new stacks, copies the non-freed clauses to these new
-stacks, updates all pointers and offsets, and frees the original stacks.
+large, then it moves the non-freed clauses together, updates all pointers and
+offsets, and gives back the memory that is no longer needed.
+
+Normally the clauses are slid down in the arena they are in, so the memory
+use never goes above that of the arena. Laying the clauses out in the order
+of variable activity, or moving them to memory first touched by this thread
+("to_new_memory") needs a second arena while they are copied.
 */
 void ClauseAllocator::consolidate(
     Solver* solver
     , const bool force
     , bool lower_verb
+    , const bool to_new_memory
 ) {
     //If re-allocation is not really neccessary, don't do it
     //Neccesities:
@@ -251,7 +499,7 @@ void ClauseAllocator::consolidate(
     //   Avoiding segfault (max is 16 outerOffsets, more than 10 is near)
     //2) There is too much empty, unused space (>30%)
     if (!force
-        && (float_div(currentlyUsedSize, size) > 0.8 || currentlyUsedSize < (100ULL*1000ULL))
+        && (float_div(currentlyUsedSize, arena.size()) > 0.8 || currentlyUsedSize < (100ULL*1000ULL))
     ) {
         if (solver->conf.verbosity >= 3
             || (lower_verb && solver->conf.verbosity)
@@ -261,28 +509,236 @@ void ClauseAllocator::consolidate(
         return;
     }
     const double myTime = cpuTime();
+    const uint64_t old_size = arena.size();
+    if (solver->conf.consolidate_in_act_order || to_new_memory) {
+        copy_to_new_arena(solver);
+    } else {
+        compact_in_place(solver);
+    }
+    currentlyUsedSize = arena.size();
 
-    //Pointers that will be moved along
-    BASE_DATA_TYPE * const newDataStart = (BASE_DATA_TYPE*)malloc(currentlyUsedSize*sizeof(BASE_DATA_TYPE));
-    BASE_DATA_TYPE * new_ptr = newDataStart;
+    const double time_used = cpuTime() - myTime;
+    if (solver->conf.verbosity >= 2
+        || (lower_verb && solver->conf.verbosity)
+    ) {
+        cout << "c [mem] consolidate ";
+        cout << " old-sz: "; print_value_kilo_mega(old_size*sizeof(BASE_DATA_TYPE));
+        cout << " new-sz: "; print_value_kilo_mega(arena.size()*sizeof(BASE_DATA_TYPE));
+        cout << " new bits offs: " << std::fixed << std::setprecision(2) << std::log2(arena.size());
+        cout << solver->conf.print_times(time_used)
+        << endl;
+    }
+    if (solver->sqlStats) {
+        solver->sqlStats->time_passed_min(
+            solver
+            , "consolidate"
+            , time_used
+        );
+    }
+}
+
+static uint64_t slots_needed(const Clause* cl)
+{
+    const uint64_t bytes = sizeof(Clause) + cl->size()*sizeof(Lit);
+    return bytes/sizeof(BASE_DATA_TYPE) + (bool)(bytes % sizeof(BASE_DATA_TYPE));
+}
+
+///Offsets of all clauses in use, in the order they are in the arena
+void ClauseAllocator::get_clauses_in_use(
+    const Solver* solver
+    , vector<ClOffset>& offsets
+) const {
+    offsets.clear();
+    for(const auto& ws: solver->watches) {
+        for(const Watched& w: ws) {
+            if (w.isClause()) {
+                offsets.push_back(w.get_offset());
+            }
+        }
+    }
+    #ifdef USE_GAUSS
+    for (const EGaussian* gauss : solver->gmatrixes) {
+        for(const auto& gcl: gauss->clauses_toclear) {
+            offsets.push_back(gcl.first);
+        }
+    }
+    #endif
+    std::sort(offsets.begin(), offsets.end());
+    offsets.erase(std::unique(offsets.begin(), offsets.end()), offsets.end());
+}
+
+/**
+@brief Slides the clauses in use down to the start of the arena
+
+They are moved in the order of their offsets, and a clause only ever moves
+down, so none is overwritten before it has been moved. The new offsets are
+looked up by binary search in a table of the clauses, which is all the extra
+memory needed. A clause longer than a segment is not moved, and the whole
+segments left empty before it are freed.
+*/
+void ClauseAllocator::compact_in_place(Solver* solver)
+{
+    vector<ClOffset> old_offs;
+    get_clauses_in_use(solver, old_offs);
+    vector<ClOffset> new_offs(old_offs.size());
+
+    //Unused slots before the clauses that are not moved
+    vector<std::pair<uint64_t, uint64_t> > gaps;
+    uint64_t at = 0;
+    for(size_t i = 0; i < old_offs.size(); i++) {
+        const uint64_t needed = slots_needed(ptr(old_offs[i]));
+        if (needed > ARENA_SEG_SLOTS) {
+            //Its run of segments must stay together, it is not moved
+            new_offs[i] = old_offs[i];
+            gaps.push_back(std::make_pair(at, old_offs[i]));
+        } else {
+            //As in ClauseArena::place(), never straddle two segments
+            const uint64_t seg_end = ((at >> ARENA_SEG_BITS) + 1) << ARENA_SEG_BITS;
+            new_offs[i] = (at + needed <= seg_end) ? at : seg_end;
+
+            //Nor go into a segment freed by an earlier compaction
+            while (!arena.backed(new_offs[i])) {
+                new_offs[i] = ((new_offs[i] >> ARENA_SEG_BITS) + 1) << ARENA_SEG_BITS;
+            }
+        }
+        assert(new_offs[i] <= old_offs[i]);
+        at = new_offs[i] + needed;
+    }
+
+    #ifdef SPLIT_CLAUSE_STATS
+    vector<ClauseStats> new_cold_stats;
+    new_cold_stats.reserve(old_offs.size());
+    #endif
+    for(size_t i = 0; i < old_offs.size(); i++) {
+        Clause* cl = ptr(old_offs[i]);
+        #ifdef SPLIT_CLAUSE_STATS
+        new_cold_stats.push_back(cold_stats[cl->stats_idx]);
+        cl->stats_idx = new_cold_stats.size()-1;
+        #endif
+        if (new_offs[i] != old_offs[i]) {
+            memmove(arena.ptr(new_offs[i]), cl, slots_needed(cl)*sizeof(BASE_DATA_TYPE));
+        }
+    }
+    #ifdef SPLIT_CLAUSE_STATS
+    cold_stats.swap(new_cold_stats);
+    #endif
+
+    auto new_offset = [&](const ClOffset offs) -> ClOffset {
+        const auto it = std::lower_bound(old_offs.begin(), old_offs.end(), offs);
+        assert(it != old_offs.end() && *it == offs);
+        return new_offs[it - old_offs.begin()];
+    };
 
-    assert(sizeof(BASE_DATA_TYPE) % sizeof(Lit) == 0);
     for(auto& ws: solver->watches) {
         for(Watched& w: ws) {
+            if (w.isClause()) {
+                const ClOffset offs = new_offset(w.get_offset());
+                #ifdef INLINE_TERNARY_WATCH
+                if (w.isTernary()) {
+                    w = Watched(offs, w.getBlockedLit(), w.lit3());
+                    continue;
+                }
+                #endif
+                w = Watched(offs, w.getBlockedLit());
+            }
+        }
+    }
+
+    #ifdef USE_GAUSS
+    for (EGaussian* gauss : solver->gmatrixes) {
+        for(auto& gcl: gauss->clauses_toclear) {
+            gcl.first = new_offset(gcl.first);
+        }
+    }
+    #endif //USE_GAUSS
+
+    for(ClOffset& offs: solver->longIrredCls) {
+        offs = new_offset(offs);
+    }
+    for(auto& lredcls: solver->longRedCls) {
+        for(ClOffset& offs: lredcls) {
+            offs = new_offset(offs);
+        }
+    }
+
+    //Fix up propBy
+    for (size_t i = 0; i < solver->nVars(); i++) {
+        VarData& vdata = solver->varData[i];
+        if (vdata.reason.isClause()) {
+            if (vdata.removed == Removed::none
+                && solver->decisionLevel() >= vdata.level
+                && vdata.level != 0
+                && solver->value(i) != l_Undef
+            ) {
+                vdata.reason = PropBy(new_offset(vdata.reason.get_offset()));
+            } else {
+                vdata.reason = PropBy();
+            }
+        }
+    }
+
+    for(const auto& gap: gaps) {
+        arena.free_between(gap.first, gap.second);
+    }
+    arena.truncate(at, explicit_hugepages);
+}
+
+/**
+@brief Copies the clauses in use to a new arena, then frees the old one
+
+The clauses are laid out in the order they are first found by
+get_consolidate_lit_order(). The new memory is first touched by this
+thread, so it is on its NUMA node.
+*/
+void ClauseAllocator::copy_to_new_arena(Solver* solver)
+{
+    //Arena the clauses will be moved to
+    ClauseArena new_arena;
+    if (!new_arena.reserve(currentlyUsedSize, explicit_hugepages)) {
+        std::cerr
+        << "ERROR: while allocating clause space"
+        << endl;
+
+        throw std::bad_alloc();
+    }
+    #ifdef SPLIT_CLAUSE_STATS
+    size_t num_cls = solver->longIrredCls.size();
+    for(const auto& lredcls: solver->longRedCls) {
+        num_cls += lredcls.size();
+    }
+    vector<ClauseStats> new_cold_stats;
+    new_cold_stats.reserve(num_cls);
+    #endif
+
+    assert(sizeof(BASE_DATA_TYPE) % sizeof(Lit) == 0);
+    vector<Lit> lit_order;
+    get_consolidate_lit_order(solver, lit_order);
+    for(const Lit lit: lit_order) {
+        for(Watched& w: solver->watches[lit]) {
             if (w.isClause()) {
                 Clause* old = ptr(w.get_offset());
                 assert(!old->freed());
                 Lit blocked = w.getBlockedLit();
+                ClOffset new_offset;
                 if (old->reloced) {
-                    ClOffset new_offset = (*old)[0].toInt();
+                    new_offset = (*old)[0].toInt();
                     #ifdef LARGE_OFFSETS
                     new_offset += ((uint64_t)(*old)[1].toInt())<<32;
                     #endif
-                    w = Watched(new_offset, blocked);
                 } else {
-                    ClOffset new_offset = move_cl(newDataStart, new_ptr, old);
-                    w = Watched(new_offset, blocked);
+                    new_offset = move_cl(new_arena, old
+                        #ifdef SPLIT_CLAUSE_STATS
+                        , new_cold_stats
+                        #endif
+                    );
+                }
+                #ifdef INLINE_TERNARY_WATCH
+                if (w.isTernary()) {
+                    w = Watched(new_offset, blocked, w.lit3());
+                    continue;
                 }
+                #endif
+                w = Watched(new_offset, blocked);
             }
         }
     }
@@ -298,7 +754,11 @@ void ClauseAllocator::consolidate(
                 #endif
                 gcl.first = new_offset;
             } else {
-                ClOffset new_offset = move_cl(newDataStart, new_ptr, old);
+                ClOffset new_offset = move_cl(new_arena, old
+                    #ifdef SPLIT_CLAUSE_STATS
+                    , new_cold_stats
+                    #endif
+                );
                 gcl.first = new_offset;
             }
             assert(!old->freed());
@@ -333,31 +793,49 @@ void ClauseAllocator::consolidate(
         }
     }
 
-    //Update sizes
-    const uint64_t old_size = size;
-    size = new_ptr-newDataStart;
-    capacity = currentlyUsedSize;
-    currentlyUsedSize = size;
-    free(dataStart);
-    dataStart = newDataStart;
+    arena.swap(new_arena);
+    new_arena.clear();
+    touched_node = current_numa_node();
+    #ifdef SPLIT_CLAUSE_STATS
+    cold_stats.swap(new_cold_stats);
+    #endif
+}
 
-    const double time_used = cpuTime() - myTime;
-    if (solver->conf.verbosity >= 2
-        || (lower_verb && solver->conf.verbosity)
-    ) {
-        cout << "c [mem] consolidate ";
-        cout << " old-sz: "; print_value_kilo_mega(old_size*sizeof(BASE_DATA_TYPE));
-        cout << " new-sz: "; print_value_kilo_mega(size*sizeof(BASE_DATA_TYPE));
-        cout << " new bits offs: " << std::fixed << std::setprecision(2) << std::log2(size);
-        cout << solver->conf.print_times(time_used)
-        << endl;
+/**
+@brief The order in which the watchlists are walked when relocating clauses
+
+Clauses are laid out in the order they are first found. By default this is
+the order of the literals. With conf.consolidate_in_act_order, the literals
+of the most active variables come first, so the clauses that propagation
+visits most often end up next to each other at the start of the arena.
+*/
+void ClauseAllocator::get_consolidate_lit_order(
+    const Solver* solver
+    , vector<Lit>& lit_order
+) const {
+    lit_order.clear();
+    if (!solver->conf.consolidate_in_act_order) {
+        for(size_t i = 0; i < solver->watches.size(); i++) {
+            lit_order.push_back(Lit::toLit(i));
+        }
+        return;
     }
-    if (solver->sqlStats) {
-        solver->sqlStats->time_passed_min(
-            solver
-            , "consolidate"
-            , time_used
-        );
+
+    const vector<double>& act = solver->VSIDS ?
+        solver->var_act_vsids : solver->var_act_maple;
+    assert(act.size() >= solver->nVars());
+    vector<uint32_t> vars;
+    for(uint32_t i = 0; i < solver->nVars(); i++) {
+        vars.push_back(i);
+    }
+    std::stable_sort(vars.begin(), vars.end(),
+        [&](const uint32_t a, const uint32_t b) {
+            return act[a] > act[b];
+        }
+    );
+    for(const uint32_t var: vars) {
+        lit_order.push_back(Lit(var, false));
+        lit_order.push_back(Lit(var, true));
     }
 }
 
@@ -375,10 +853,39 @@ void ClauseAllocator::update_offsets(
     }
 }
 
+void ClauseAllocator::copy_from(const ClauseAllocator& other)
+{
+    if (!arena.copy_from(other.arena, explicit_hugepages)) {
+        throw std::bad_alloc();
+    }
+    currentlyUsedSize = other.currentlyUsedSize;
+    #ifdef SPLIT_CLAUSE_STATS
+    cold_stats = other.cold_stats;
+    #endif
+    touched_node = current_numa_node();
+}
+
+bool ClauseAllocator::touched_on_other_node() const
+{
+    const int node = current_numa_node();
+    return !arena.empty()
+        && node != -1
+        && touched_node != -1
+        && node != touched_node;
+}
+
+uint64_t ClauseAllocator::mem_in_huge_pages() const
+{
+    return arena.mem_in_huge_pages();
+}
+
 size_t ClauseAllocator::mem_used() const
 {
     uint64_t mem = 0;
-    mem += capacity*sizeof(BASE_DATA_TYPE);
+    mem += arena.capacity()*sizeof(BASE_DATA_TYPE);
+    #ifdef SPLIT_CLAUSE_STATS
+    mem += cold_stats.capacity()*sizeof(ClauseStats);
+    #endif
 
     return mem;
 }
@@ -42,6 +42,106 @@ class PropEngine;
 using std::map;
 using std::vector;
 
+///Top bits of a ClOffset pick the segment, these bits the slot inside it.
+///Segments are 16-32MB whatever the size of a slot. Can be made smaller to
+///test the segment boundaries on small problems
+#ifndef ARENA_SEG_BITS
+#if defined(LARGE_ARENA) && !defined(LARGE_OFFSETS)
+#define ARENA_SEG_BITS 20
+#else
+#define ARENA_SEG_BITS 22
+#endif
+#endif
+#define ARENA_SEG_SLOTS (1ULL << ARENA_SEG_BITS)
+#define ARENA_SEG_MASK (ARENA_SEG_SLOTS-1)
+
+/**
+@brief Segmented memory of the ClauseAllocator, addressed by slot number
+
+The slots (of BASE_DATA_TYPE) are numbered contiguously, but they are stored
+in segments of ARENA_SEG_SLOTS. Growing adds a segment instead of
+reallocating the whole arena, so there is no copy of the clause database,
+and no doubling of the memory use, when it grows. Only the first segment is
+grown by realloc (up to the full segment size), so that small problems do
+not reserve a whole segment.
+
+A clause never straddles two segments: if it does not fit at the end of the
+last one, the rest of that segment is left unused. Clauses longer than a
+segment get a run of consecutive segments that are allocated together.
+Segments in the middle can be freed by free_between(). They are left as
+holes, and nothing is placed in them again.
+*/
+class ClauseArena {
+    public:
+        ~ClauseArena();
+
+        inline BASE_DATA_TYPE* ptr(const ClOffset offset) const
+        {
+            return segs[offset >> ARENA_SEG_BITS] + (offset & ARENA_SEG_MASK);
+        }
+        ClOffset get_offset(const BASE_DATA_TYPE* p) const;
+
+        ///The offset that alloc(num) would return
+        uint64_t place(const uint64_t num) const;
+        ///Returns NULL if the system is out of memory
+        BASE_DATA_TYPE* alloc(const uint64_t num, const bool explicit_huge);
+        ///Give the first segment this many slots, if it's not allocated yet
+        bool reserve(const uint64_t num, const bool explicit_huge);
+        ///Give back the last num slots, that were allocated last
+        void shrink_by(const uint64_t num);
+        ///Keep only the first num slots, and free the memory after them
+        void truncate(const uint64_t num, const bool explicit_huge);
+        ///Free the chunks whose slots are all in [from, to), which is unused
+        void free_between(const uint64_t from, const uint64_t to);
+        ///False if the segment of "offset" was freed by free_between()
+        bool backed(const uint64_t offset) const
+        {
+            return segs[offset >> ARENA_SEG_BITS] != NULL;
+        }
+        void swap(ClauseArena& other);
+        ///Same segments, same contents, so offsets stay valid
+        bool copy_from(const ClauseArena& other, const bool explicit_huge);
+        void clear();
+
+        bool empty() const
+        {
+            return segs.empty();
+        }
+
+        ///Slot one after the last allocated one
+        uint64_t size() const
+        {
+            return used;
+        }
+
+        ///Number of slots obtained from the system
+        uint64_t capacity() const
+        {
+            return num_slots;
+        }
+
+        uint64_t mem_in_huge_pages() const;
+
+    private:
+        struct Chunk {
+            BASE_DATA_TYPE* base;
+            uint64_t first_seg;
+            uint64_t slots;
+        };
+        bool new_chunk(
+            const uint64_t first_seg
+            , const uint64_t slots
+            , const bool explicit_huge
+        );
+
+        vector<BASE_DATA_TYPE*> segs;
+        vector<Chunk> chunks; ///<Sorted by address, for get_offset()
+        Chunk last_chunk = {NULL, 0, 0};
+        uint64_t used = 0;
+        uint64_t alloc_end = 0; ///<Slots up to here are backed by memory
+        uint64_t num_slots = 0;
+};
+
 /**
 @brief Allocates memory for (xor) clauses
 
@@ -54,7 +154,6 @@ which is 32-bit, instead of their address, which might be 64-bit
 class ClauseAllocator {
     public:
         ClauseAllocator();
-        ~ClauseAllocator();
 
         template<class T>
         Clause* Clause_new(const T& ps, const uint32_t conflictNum
@@ -67,20 +166,51 @@ class ClauseAllocator {
             }
 
             void* mem = allocEnough(ps.size());
-            Clause* real = new (mem) Clause(ps, conflictNum
+            Clause* real = new (mem) Clause(ps);
+            #ifdef SPLIT_CLAUSE_STATS
+            real->stats_idx = cold_stats.size();
+            cold_stats.push_back(ClauseStats());
+            #endif
+
+            ClauseStats& st = stats(*real);
+            st.last_touched = conflictNum;
             #ifdef STATS_NEEDED
-            , ID
+            st.introduced_at_conflict = conflictNum;
+            st.ID = ID;
+            assert(ID >= 0);
             #endif
-            );
+            st.glue = std::min<uint32_t>(st.glue, ps.size());
 
             return real;
         }
 
-        ClOffset get_offset(const Clause* ptr) const;
+        inline ClOffset get_offset(const Clause* ptr) const
+        {
+            return arena.get_offset((const BASE_DATA_TYPE*)ptr);
+        }
 
         inline Clause* ptr(const ClOffset offset) const
         {
-            return (Clause*)(&dataStart[offset]);
+            return (Clause*)arena.ptr(offset);
+        }
+
+        ///The returned reference is only valid until the next Clause_new()
+        inline ClauseStats& stats(Clause& cl)
+        {
+            #ifdef SPLIT_CLAUSE_STATS
+            return cold_stats[cl.stats_idx];
+            #else
+            return cl.stats;
+            #endif
+        }
+
+        inline const ClauseStats& stats(const Clause& cl) const
+        {
+            #ifdef SPLIT_CLAUSE_STATS
+            return cold_stats[cl.stats_idx];
+            #else
+            return cl.stats;
+            #endif
         }
 
         void clauseFree(Clause* c); ///Frees memory and associated clause number
@@ -90,28 +220,52 @@ class ClauseAllocator {
             Solver* solver
             , const bool force = false
             , bool lower_verb = false
+            , const bool to_new_memory = false
         );
 
         size_t mem_used() const;
+        uint64_t mem_in_huge_pages() const;
+
+        ///Slots up to the end of the last clause, freed ones included
+        uint64_t arena_size() const
+        {
+            return arena.size();
+        }
+
+        ///Makes this a copy of "other", keeping all offsets
+        void copy_from(const ClauseAllocator& other);
+
+        ///Try reserved 2MB pages before transparent ones. Needs USE_HUGEPAGES
+        void set_explicit_hugepages(const bool val)
+        {
+            explicit_hugepages = val;
+        }
+
+        ///Was the memory of the clauses first written on another NUMA node?
+        bool touched_on_other_node() const;
 
     private:
         void update_offsets(vector<ClOffset>& offsets);
+        void compact_in_place(Solver* solver);
+        void copy_to_new_arena(Solver* solver);
+        void get_clauses_in_use(
+            const Solver* solver
+            , vector<ClOffset>& offsets
+        ) const;
+        void get_consolidate_lit_order(
+            const Solver* solver
+            , vector<Lit>& lit_order
+        ) const;
 
         ClOffset move_cl(
-            ClOffset* newDataStart
-            , ClOffset*& new_ptr
+            ClauseArena& new_arena
             , Clause* old
+            #ifdef SPLIT_CLAUSE_STATS
+            , vector<ClauseStats>& new_cold_stats
+            #endif
         ) const;
 
-        BASE_DATA_TYPE* dataStart; ///<Stack starts at these positions
-        uint64_t size; ///<The number of BASE_DATA_TYPE datapieces currently used in each stack
-        /**
-        @brief Clauses in the stack had this size when they were allocated
-        This my NOT be their current size: the clauses may be shrinked during
-        the running of the solver. Therefore, it is imperative that their orignal
-        size is saved. This way, we can later move clauses around.
-        */
-        uint64_t capacity; ///<The number of BASE_DATA_TYPE datapieces allocated
+        ClauseArena arena;
         /**
         @brief The estimated used size of the stack
         This is incremented by clauseSize each time a clause is allocated, and
@@ -121,6 +275,22 @@ class ClauseAllocator {
         */
         uint64_t currentlyUsedSize;
 
+        #ifdef SPLIT_CLAUSE_STATS
+        /**
+        @brief ClauseStats of the clauses in the arena, indexed by Clause::stats_idx
+
+        Kept apart so that propagation does not pull them into the cache. Slots
+        of freed clauses are reclaimed by consolidate(), which moves the stats
+        in the same order as the clauses.
+        */
+        vector<ClauseStats> cold_stats;
+        #endif
+
+        bool explicit_hugepages = false;
+
+        ///NUMA node of the thread that wrote the clauses, -1 if unknown
+        int touched_node = -1;
+
         void* allocEnough(const uint32_t num_lits);
 };
 
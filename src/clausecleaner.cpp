@@ -82,6 +82,15 @@ void ClauseCleaner::clean_implicit_watchlist(
             clean_binary_implicit(*i, j, lit);
             continue;
         }
+
+        //Propagated at level 0, so its clause is satisfied, and the other
+        //watch is enough
+        if (i->isShared()) {
+            if (solver->value(lit) == l_Undef) {
+                *j++ = *i;
+            }
+            continue;
+        }
     }
     watch_list.shrink_(i - j);
 }
@@ -218,6 +227,14 @@ inline bool ClauseCleaner::clean_clause(Clause& cl)
             solver->attach_bin_clause(cl[0], cl[1], cl.red());
             return true;
         } else {
+            #ifdef INLINE_TERNARY_WATCH
+            //Watches of clauses shrunk to 3-long can now hold both other lits
+            if (cl.size() == 3) {
+                const ClOffset offset = solver->cl_alloc.get_offset(&cl);
+                findWatchedOfCl(solver->watches[cl[0]], offset) = Watched(offset, cl[2], cl[1]);
+                findWatchedOfCl(solver->watches[cl[1]], offset) = Watched(offset, cl[2], cl[0]);
+            }
+            #endif
             if (cl.red()) {
                 solver->litStats.redLits -= i-j;
             } else {
@@ -28,17 +28,67 @@ THE SOFTWARE.
 
 using namespace CMSat;
 
-void ClauseDumper::write_unsat(std::ostream *out)
+//Writes DIMACS, the text counterpart of BinaryCNFWriter
+class TextCNFWriter
 {
+    public:
+        explicit TextCNFWriter(std::ostream* _out) :
+            out(_out)
+        {}
+
+        void comment(const char* str)
+        {
+            *out << "c " << str << endl;
+        }
+
+        void clause(const Lit* lits, const size_t size)
+        {
+            for(size_t i = 0; i < size; i++) {
+                *out << lits[i] << " ";
+            }
+            *out << "0\n";
+        }
+
+        void clause(const vector<Lit>& lits)
+        {
+            clause(lits.data(), lits.size());
+        }
+
+        void independent_vars(const vector<uint32_t>& vars)
+        {
+            if (vars.empty()) {
+                return;
+            }
+            *out << "c ind";
+            for(const uint32_t v: vars) {
+                *out << " " << v+1;
+            }
+            *out << " 0\n";
+        }
+
+    private:
+        std::ostream* out;
+};
+
+void ClauseDumper::write_unsat(std::ostream *out, const bool binary)
+{
+    if (binary) {
+        BinaryCNFWriter writer(out);
+        writer.header(0, 1, 0, 0);
+        writer.clause(NULL, 0);
+        writer.flush();
+        return;
+    }
+
     *out
     << "p cnf 0 1\n"
     << "0\n";
 }
 
-void ClauseDumper::open_file_and_write_unsat(const std::string& fname)
+void ClauseDumper::open_file_and_write_unsat(const std::string& fname, const bool binary)
 {
-    open_dump_file(fname);
-    write_unsat(outfile);
+    open_dump_file(fname, binary);
+    write_unsat(outfile, binary);
     delete outfile;
     outfile = NULL;
 }
@@ -119,9 +169,18 @@ size_t ClauseDumper::get_preprocessor_num_cls(bool outer_numbering) {
     return num_cls;
 }
 
-void ClauseDumper::dump_irred_clauses_preprocessor(std::ostream *out) {
+void ClauseDumper::dump_irred_clauses_preprocessor(std::ostream *out, const bool binary) {
     if (!solver->okay()) {
-        write_unsat(out);
+        write_unsat(out, binary);
+    } else if (binary) {
+        //The header needs the exact number of clauses
+        BinaryCNFWriter counter(NULL);
+        dump_irred_cls_for_preprocessor(counter, false);
+
+        BinaryCNFWriter writer(out);
+        writer.header(solver->nVars(), counter.num_clauses, 0, counter.num_indep);
+        dump_irred_cls_for_preprocessor(writer, false);
+        writer.flush();
     } else {
         *out
         << "p cnf " << solver->nVars()
@@ -131,11 +190,13 @@ void ClauseDumper::dump_irred_clauses_preprocessor(std::ostream *out) {
     }
 }
 
-void ClauseDumper::open_file_and_dump_irred_clauses_preprocessor(const string& irredDumpFname)
-{
-    open_dump_file(irredDumpFname);
+void ClauseDumper::open_file_and_dump_irred_clauses_preprocessor(
+    const string& irredDumpFname
+    , const bool binary
+) {
+    open_dump_file(irredDumpFname, binary);
     try {
-        dump_irred_clauses_preprocessor(outfile);
+        dump_irred_clauses_preprocessor(outfile, binary);
     } catch (std::ifstream::failure& e) {
         cout
         << "Error writing clause dump to file: " << e.what()
@@ -186,23 +247,6 @@ void ClauseDumper::dump_irred_cls(std::ostream *out, bool outer_numbering)
     dump_component_clauses(out, outer_numbering);
 }
 
-void ClauseDumper::dump_unit_cls(std::ostream *out, bool outer_numbering)
-{
-    *out << "c --------- unit clauses" << endl;
-    if (outer_numbering) {
-        //'trail' cannot be trusted between 0....size()
-        vector<Lit> lits = solver->get_zero_assigned_lits();
-        for(Lit lit: lits) {
-            *out << lit << " 0\n";
-        }
-    } else {
-        vector<Lit> units = solver->get_toplevel_units_internal(false);
-        for(Lit l: units) {
-            *out << l << " 0" << "\n";
-        }
-    }
-}
-
 uint32_t ClauseDumper::dump_blocked_clauses(std::ostream *out, bool outer_numbering) {
     assert(outer_numbering);
     uint32_t num_cls = 0;
@@ -222,12 +266,16 @@ uint32_t ClauseDumper::dump_component_clauses(std::ostream *out, bool outer_numb
     return num_cls;
 }
 
-void ClauseDumper::open_dump_file(const std::string& filename)
+void ClauseDumper::open_dump_file(const std::string& filename, const bool binary)
 {
     delete outfile;
     outfile = NULL;
     std::ofstream* f =  new std::ofstream;
-    f->open(filename.c_str());
+    if (binary) {
+        f->open(filename.c_str(), std::ios::out | std::ios::binary);
+    } else {
+        f->open(filename.c_str());
+    }
     if (!f->good()) {
         cout
         << "Cannot open file '"
@@ -310,9 +358,50 @@ void ClauseDumper::dump_clauses(
     }
 }
 
-void ClauseDumper::dump_vars_appearing_inverted(std::ostream *out, bool outer_numbering)
+vector<uint32_t> ClauseDumper::get_independent_vars_internal() const
+{
+    vector<uint32_t> ret;
+    if (!solver->conf.independent_vars) {
+        return ret;
+    }
+
+    for(uint32_t outside_var: *solver->conf.independent_vars) {
+        uint32_t outer_var = solver->map_to_with_bva(outside_var);
+        outer_var = solver->varReplacer->get_var_replaced_with_outer(outer_var);
+        const uint32_t int_var = solver->map_outer_to_inter(outer_var);
+        if (int_var < solver->nVars()) {
+            ret.push_back(int_var);
+        }
+    }
+    std::sort(ret.begin(), ret.end());
+    ret.erase(std::unique(ret.begin(), ret.end()), ret.end());
+    return ret;
+}
+
+void ClauseDumper::dump_irred_cls_for_preprocessor(std::ostream *out, const bool outer_numbering)
 {
-    *out << "c ------------ vars appearing inverted in cls" << endl;
+    TextCNFWriter writer(out);
+    dump_irred_cls_for_preprocessor(writer, outer_numbering);
+}
+
+//Shared by the text and the binary CNF dumps. The independent set is only
+//written in internal numbering, i.e. for the simplified CNF
+template<class S>
+void ClauseDumper::dump_irred_cls_for_preprocessor(S& writer, const bool outer_numbering)
+{
+    writer.comment("--------- unit clauses");
+    if (outer_numbering) {
+        //'trail' cannot be trusted between 0....size()
+        for(const Lit l: solver->get_zero_assigned_lits()) {
+            writer.clause(&l, 1);
+        }
+    } else {
+        for(const Lit l: solver->get_toplevel_units_internal(false)) {
+            writer.clause(&l, 1);
+        }
+    }
+
+    writer.comment("------------ vars appearing inverted in cls");
     for(size_t i = 0; i < solver->undef_must_set_vars.size(); i++) {
         if (!solver->undef_must_set_vars[i] ||
             solver->map_outer_to_inter(i) >= solver->nVars() ||
@@ -325,21 +414,49 @@ void ClauseDumper::dump_vars_appearing_inverted(std::ostream *out, bool outer_nu
         if (!outer_numbering) {
             l = solver->map_outer_to_inter(l);
         }
-        *out << l << " " << ~l << " 0" << "\n";
+        tmpCl.clear();
+        tmpCl.push_back(l);
+        tmpCl.push_back(~l);
+        writer.clause(tmpCl);
     }
-}
-
-void ClauseDumper::dump_irred_cls_for_preprocessor(std::ostream *out, const bool outer_numbering)
-{
-    dump_unit_cls(out, outer_numbering);
 
-    dump_vars_appearing_inverted(out, outer_numbering);
+    writer.comment("-------- irred bin cls");
+    for(size_t wsLit = 0; wsLit < solver->watches.size(); wsLit++) {
+        const Lit lit = Lit::toLit(wsLit);
+        for(const Watched& w: solver->watches[lit]) {
+            if (w.isBin() && !w.red() && lit < w.lit2()) {
+                tmpCl.clear();
+                tmpCl.push_back(lit);
+                tmpCl.push_back(w.lit2());
+                if (outer_numbering) {
+                    tmpCl[0] = solver->map_inter_to_outer(tmpCl[0]);
+                    tmpCl[1] = solver->map_inter_to_outer(tmpCl[1]);
+                }
+                writer.clause(tmpCl);
+            }
+        }
+    }
 
-    *out << "c -------- irred bin cls" << endl;
-    dump_bin_cls(out, false, true, outer_numbering);
+    writer.comment("-------- irred long cls");
+    for(const ClOffset offs: solver->longIrredCls) {
+        const Clause* cl = solver->cl_alloc.ptr(offs);
+        if (outer_numbering) {
+            writer.clause(solver->clause_outer_numbered(*cl));
+        } else {
+            writer.clause(cl->begin(), cl->size());
+        }
+    }
 
-    *out << "c -------- irred long cls" << endl;
-    dump_clauses(out, solver->longIrredCls, outer_numbering);
+    //As pairs of binary clauses
+    writer.comment("------------ equivalent literals");
+    vector<Lit> eq_cls;
+    solver->varReplacer->print_equivalent_literals(outer_numbering, NULL, &eq_cls);
+    for(size_t i = 0; i < eq_cls.size(); i += 2) {
+        std::sort(eq_cls.begin()+i, eq_cls.begin()+i+2);
+        writer.clause(&eq_cls[i], 2);
+    }
 
-    dump_eq_lits(out, outer_numbering);
+    if (!outer_numbering) {
+        writer.independent_vars(get_independent_vars_internal());
+    }
 }
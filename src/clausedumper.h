@@ -28,6 +28,7 @@ THE SOFTWARE.
 #include <limits>
 #include "cryptominisat5/solvertypesmini.h"
 #include "cloffset.h"
+#include "binarycnf.h"
 
 using std::vector;
 
@@ -49,15 +50,15 @@ public:
         }
     }
 
-    void write_unsat(std::ostream *out);
+    void write_unsat(std::ostream *out, const bool binary = false);
     void write_sat(std::ostream *out);
-    void dump_irred_clauses_preprocessor(std::ostream *out);
+    void dump_irred_clauses_preprocessor(std::ostream *out, const bool binary = false);
     void dump_irred_clauses(std::ostream *out);
     void dump_red_clauses(std::ostream *out);
 
-    void open_file_and_write_unsat(const std::string& fname);
+    void open_file_and_write_unsat(const std::string& fname, const bool binary = false);
     void open_file_and_write_sat(const std::string& fname);
-    void open_file_and_dump_irred_clauses_preprocessor(const std::string& fname);
+    void open_file_and_dump_irred_clauses_preprocessor(const std::string& fname, const bool binary = false);
     void open_file_and_dump_irred_clauses(const std::string& fname);
     void open_file_and_dump_red_clauses(const std::string& fname);
 
@@ -66,9 +67,11 @@ private:
     const Solver* solver;
     std::ofstream* outfile = NULL;
 
-    void open_dump_file(const std::string& filename);
+    void open_dump_file(const std::string& filename, const bool binary = false);
 
     void dump_irred_cls_for_preprocessor(std::ostream *out, bool outer_number);
+    template<class S> void dump_irred_cls_for_preprocessor(S& writer, bool outer_number);
+    vector<uint32_t> get_independent_vars_internal() const;
     void dump_bin_cls(std::ostream *out,
         const bool dumpRed
         , const bool dumpIrred
@@ -77,11 +80,9 @@ private:
     size_t get_preprocessor_num_cls(bool outer_numbering);
     void dump_red_cls(std::ostream *out, bool outer_numbering);
     void dump_eq_lits(std::ostream *out, bool outer_numbering);
-    void dump_unit_cls(std::ostream *out, bool outer_numbering);
     uint32_t dump_blocked_clauses(std::ostream *out, bool outer_numbering);
     void dump_irred_cls(std::ostream *out, bool outer_numbering);
     uint32_t dump_component_clauses(std::ostream *out, bool outer_numbering);
-    void dump_vars_appearing_inverted(std::ostream *out, bool outer_numbering);
     void dump_clauses(std::ostream *out,
         const vector<ClOffset>& cls
         , const bool outer_number
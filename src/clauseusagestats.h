@@ -53,17 +53,17 @@ struct ClauseUsageStats
         return *this;
     }
 
-    void addStat(const Clause&
+    void addStat(const ClauseStats&
     #ifdef STATS_NEEDED
-    cl
+    stats
     #endif
     ) {
         num++;
         #ifdef STATS_NEEDED
-        sumConfl += cl.stats.conflicts_made;
-        sumProp += cl.stats.propagations_made;
-        sumLookedAt += cl.stats.clause_looked_at;
-        sumUsedUIP += cl.stats.used_for_uip_creation;
+        sumConfl += stats.conflicts_made;
+        sumProp += stats.propagations_made;
+        sumLookedAt += stats.clause_looked_at;
+        sumUsedUIP += stats.used_for_uip_creation;
         #endif
     }
     void print() const;
@@ -28,6 +28,9 @@ THE SOFTWARE.
 
 using namespace CMSat;
 
+// Literal arrays are passed to add_clauses() without copying
+static_assert(sizeof(Lit) == sizeof(uint32_t), "Lit must be a 32bit integer");
+
 extern "C" {
 
 struct cmsat_solver {
@@ -199,6 +202,17 @@ CMS_DLL_PUBLIC int32_t cmsat_add_clause(cmsat_solver_t *s, const uint32_t *a, ui
   return s->solver.add_clause(s->lit_buffer) - 1;
 }
 
+/*
+ * Add many clauses at once:
+ * - n = number of elements in a
+ * - a = clauses, each one terminated by cmsat_lit_undef
+ * - return -1 if something was wrong
+ * - return 0 otherwise
+ */
+CMS_DLL_PUBLIC int32_t cmsat_add_clauses(cmsat_solver_t *s, const uint32_t *a, size_t n) {
+  return s->solver.add_clauses(reinterpret_cast<const Lit*>(a), n) - 1;
+}
+
 /*
  * Add an xor clause
  * - n = number of variables in the clause
@@ -34,6 +34,7 @@ THE SOFTWARE.
 #define CMS_DLL_PUBLIC __attribute__ ((visibility ("default")))
 #endif
 
+#include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
 
@@ -176,6 +177,19 @@ extern CMS_DLL_PUBLIC uint32_t cmsat_nvars(const cmsat_solver_t *s);
 extern CMS_DLL_PUBLIC int32_t cmsat_add_clause(cmsat_solver_t *s, const uint32_t *a, uint32_t n);
 
 
+/*
+ * Add many clauses at once, much faster than cmsat_add_clause:
+ * - n = number of elements in a
+ * - a = the clauses one after the other, each one terminated by cmsat_lit_undef
+ *   (the terminator of the last clause can be omitted)
+ * - literals are encoded as in cmsat_add_clause
+ *
+ * - return -1 if something was wrong (same as cmsat_add_clause)
+ * - return 0 otherwise
+ */
+extern CMS_DLL_PUBLIC int32_t cmsat_add_clauses(cmsat_solver_t *s, const uint32_t *a, size_t n);
+
+
 /*
  * Add an xor clause
  * - n = number of variables in the clause
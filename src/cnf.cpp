@@ -253,6 +253,36 @@ uint64_t CNF::print_mem_used_longclauses(const size_t totalMem) const
     return mem;
 }
 
+/**
+@brief Average distance in bytes between consecutive long clauses of watchlists
+
+The lower it is, the fewer cache lines and pages propagation touches while
+walking a watchlist.
+*/
+double CNF::avg_watched_cl_distance() const
+{
+    uint64_t sum = 0;
+    uint64_t num = 0;
+    for(const auto& ws: watches) {
+        uintptr_t last = 0;
+        for(const Watched& w: ws) {
+            if (!w.isClause()) {
+                continue;
+            }
+
+            //Offsets are segment+slot, only the addresses give a distance
+            const uintptr_t at = (uintptr_t)cl_alloc.ptr(w.get_offset());
+            if (last != 0) {
+                sum += (at > last) ? at - last : last - at;
+                num++;
+            }
+            last = at;
+        }
+    }
+
+    return float_div(sum, num);
+}
+
 size_t CNF::cl_size(const Watched& ws) const
 {
     switch(ws.getType()) {
@@ -366,6 +396,7 @@ size_t CNF::mem_used() const
     mem += seen.capacity()*sizeof(uint16_t);
     mem += seen2.capacity()*sizeof(uint8_t);
     mem += toClear.capacity()*sizeof(Lit);
+    mem += shared_watched.capacity()*sizeof(Lit);
 
     return mem;
 }
@@ -405,6 +436,51 @@ void CNF::load_state(SimpleInFile& f)
     watches.resize(nVars()*2);
 }
 
+/**
+@brief Copies the clauses and the variable data of "other"
+
+The variables must have already been created in the same outer order. The
+clause arena is copied as a whole, so the offsets in the watches and
+clause lists stay valid.
+*/
+void CNF::copy_state_from(const CNF& other)
+{
+    assert(nVarsOuter() == other.nVarsOuter());
+    assert(nVars() == other.nVars());
+
+    interToOuterMain = other.interToOuterMain;
+    outerToInterMain = other.outerToInterMain;
+    outer_to_with_bva_map = other.outer_to_with_bva_map;
+    num_bva_vars = other.num_bva_vars;
+    assigns = other.assigns;
+    varData = other.varData;
+    depth = other.depth;
+    if (conf.doStamp) {
+        stamp = other.stamp;
+    }
+    if (conf.doCache) {
+        implCache = other.implCache;
+    }
+    ok = other.ok;
+    VSIDS = other.VSIDS;
+    sumConflicts = other.sumConflicts;
+    latest_feature_calc = other.latest_feature_calc;
+    last_feature_calc_confl = other.last_feature_calc_confl;
+    cur_max_temp_red_lev2_cls = other.cur_max_temp_red_lev2_cls;
+    fresh_solver = other.fresh_solver;
+
+    cl_alloc.copy_from(other.cl_alloc);
+    watches.copy_from(other.watches);
+    longIrredCls = other.longIrredCls;
+    longRedCls = other.longRedCls;
+    shared_watched = other.shared_watched;
+    shared_longs_attached = other.shared_longs_attached;
+    xorclauses = other.xorclauses;
+    binTri = other.binTri;
+    litStats = other.litStats;
+    clauseID = other.clauseID;
+}
+
 
 void CNF::test_all_clause_attached() const
 {
@@ -485,6 +561,11 @@ void CNF::find_all_attach() const
                     << w.getBlockedLit() << " is." << endl;
                 }
                 assert(value(w.getBlockedLit()) != l_True && "Blocked lit is satisfied but clause is NOT!!");
+                #ifdef INLINE_TERNARY_WATCH
+                if (w.isTernary()) {
+                    assert(value(w.lit3()) != l_True && "Ternary inline lit is satisfied but clause is NOT!!");
+                }
+                #endif
             }
 
             //Assert watch correctness
@@ -693,13 +774,13 @@ bool CNF::no_marked_clauses() const
 {
     for(ClOffset offset: longIrredCls) {
         Clause* cl = cl_alloc.ptr(offset);
-        assert(!cl->stats.marked_clause);
+        assert(!cl_alloc.stats(*cl).marked_clause);
     }
 
     for(auto& lredcls: longRedCls) {
         for(ClOffset offset: lredcls) {
             Clause* cl = cl_alloc.ptr(offset);
-            assert(!cl->stats.marked_clause);
+            assert(!cl_alloc.stats(*cl).marked_clause);
         }
     }
 
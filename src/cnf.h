@@ -46,6 +46,7 @@ using std::numeric_limits;
 namespace CMSat {
 
 class ClauseAllocator;
+struct SharedClauses;
 
 struct BinTriStats
 {
@@ -112,6 +113,14 @@ public:
     //Clauses
     vector<ClOffset> longIrredCls;
 
+    //Irredundant long clauses shared with other threads, if any.
+    //These are not in longIrredCls, and only searching sees them: they are
+    //detached while simplifying. "shared_watched" has the two literals each
+    //is watched by, both lit_Undef if it's satisfied at level 0
+    const SharedClauses* shared_longs = NULL;
+    vector<Lit> shared_watched;
+    bool shared_longs_attached = false;
+
     //if the solver object only saw add_clause and new_var(s)
     bool fresh_solver = true;
 
@@ -181,6 +190,7 @@ public:
 
     uint64_t print_mem_used_longclauses(size_t totalMem) const;
     uint64_t mem_used_longclauses() const;
+    double avg_watched_cl_distance() const;
     template<class Function>
     void for_each_lit(
         const OccurClause& cl
@@ -294,6 +304,7 @@ protected:
 
     void save_state(SimpleOutFile& f) const;
     void load_state(SimpleInFile& f);
+    void copy_state_from(const CNF& other);
 
 private:
     std::atomic<bool> *must_interrupt_inter; ///<Interrupt cleanly ASAP if true
@@ -329,6 +340,7 @@ void CNF::for_each_lit(
             break;
         }
 
+        case watch_shared_t :
         case watch_idx_t :
             assert(false);
             break;
@@ -358,6 +370,7 @@ void CNF::for_each_lit_except_watched(
             break;
         }
 
+        case CMSat::watch_shared_t:
         case CMSat::watch_idx_t:
             assert(false);
             break;
@@ -458,7 +471,7 @@ inline void CNF::unmark_all_irred_clauses()
 {
     for(ClOffset offset: longIrredCls) {
         Clause* cl = cl_alloc.ptr(offset);
-        cl->stats.marked_clause = false;
+        cl_alloc.stats(*cl).marked_clause = false;
     }
 }
 
@@ -466,7 +479,7 @@ inline void CNF::unmark_all_red1_clauses()
 {
     for(ClOffset offset: longRedCls[1]) {
         Clause* cl = cl_alloc.ptr(offset);
-        cl->stats.marked_clause = false;
+        cl_alloc.stats(*cl).marked_clause = false;
     }
 }
 
@@ -505,7 +518,7 @@ inline void CNF::check_no_removed_or_freed_cl_in_watch() const
     for(watch_subarray_const ws: watches) {
         for(const Watched& w: ws) {
             assert(!w.isIdx());
-            if (w.isBin()) {
+            if (w.isBin() || w.isShared()) {
                 continue;
             }
             assert(w.isClause());
@@ -562,7 +575,7 @@ inline void CNF::check_clid_correct() const
     for(auto l: longRedCls) {
         for(ClOffset offs: l) {
             Clause * cl = cl_alloc.ptr(offs);
-            assert(!(cl->stats.ID == 0 && cl->red()));
+            assert(!(cl_alloc.stats(*cl).ID == 0 && cl->red()));
         }
     }
     #endif
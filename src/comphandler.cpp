@@ -72,6 +72,16 @@ void CompHandler::save_on_var_memory()
 {
 }
 
+void CompHandler::copy_state_from(const CompHandler& other)
+{
+    savedState = other.savedState;
+    removedClauses = other.removedClauses;
+    num_vars_removed = other.num_vars_removed;
+    components_solved = other.components_solved;
+    numRemovedHalfIrred = other.numRemovedHalfIrred;
+    numRemovedHalfRed = other.numRemovedHalfRed;
+}
+
 size_t CompHandler::mem_used() const
 {
     size_t mem = 0;
@@ -163,7 +173,7 @@ bool CompHandler::handle()
 
     solver->xorclauses.clear();
     #ifdef USE_GAUSS
-    solver->clearEnGaussMatrixes();
+    solver->clearEnGaussMatrixes(false);
     #endif
     map<uint32_t, vector<uint32_t> > reverseTable = compFinder->getReverseTable();
     assert(num_comps == compFinder->getReverseTable().size());
@@ -512,9 +522,9 @@ void CompHandler::moveClausesLong(
         //Add 'tmp' to the new solver
         if (cl.red()) {
             #ifdef STATS_NEEDED
-            cl.stats.introduced_at_conflict = 0;
+            solver->cl_alloc.stats(cl).introduced_at_conflict = 0;
             #endif
-            //newSolver->addRedClause(tmp, cl.stats);
+            //newSolver->addRedClause(tmp, solver->cl_alloc.stats(cl));
         } else {
             saveClause(cl);
             newSolver->add_clause(tmp);
@@ -63,6 +63,7 @@ class CompHandler
         void new_var(const uint32_t orig_outer);
         void new_vars(const size_t n);
         void save_on_var_memory();
+        void copy_state_from(const CompHandler& other);
         void addSavedState(vector<lbool>& solution, vector<Lit>& decisions);
         void readdRemovedClauses();
         const RemovedClauses& getRemovedClauses() const;
@@ -0,0 +1,331 @@
+/******************************************
+Copyright (c) 2016, Mate Soos
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+***********************************************/
+
+#ifndef COMPRESSEDOSTREAM_H
+#define COMPRESSEDOSTREAM_H
+
+#include <string.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <memory>
+#include <ostream>
+#include <streambuf>
+
+#ifdef USE_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef USE_ZSTD
+#include <zstd.h>
+#endif
+
+#ifdef USE_LZMA
+#include <lzma.h>
+#endif
+
+//Compresses data into an ostream. There is one of these for every supported
+//compression format. The fastest settings are used, as these compress
+//proofs while the solver runs.
+class OutputCompressor
+{
+    public:
+        explicit OutputCompressor(std::ostream* _out) :
+            out(_out)
+            , outbuf(block_size)
+        {}
+        virtual ~OutputCompressor()
+        {}
+
+        //Compresses "len" bytes. When "finish" is set, the compressed
+        //stream is ended, too
+        virtual bool write(const char* data, size_t len, bool finish) = 0;
+
+    protected:
+        bool write_out(const size_t len)
+        {
+            out->write(outbuf.data(), len);
+            return out->good();
+        }
+
+        std::ostream* out;
+        std::vector<char> outbuf;
+        static const size_t block_size = 1ULL << 20;
+};
+
+#ifdef USE_ZLIB
+class GzipOutput: public OutputCompressor
+{
+    public:
+        explicit GzipOutput(std::ostream* _out) :
+            OutputCompressor(_out)
+        {
+            memset(&strm, 0, sizeof(strm));
+            //16: write a gzip header
+            deflateInit2(&strm, Z_BEST_SPEED, Z_DEFLATED, 15+16, 8, Z_DEFAULT_STRATEGY);
+        }
+        ~GzipOutput()
+        {
+            deflateEnd(&strm);
+        }
+
+        bool write(const char* data, size_t len, bool finish) override
+        {
+            strm.next_in = (Bytef*)data;
+            strm.avail_in = len;
+            for (;;) {
+                strm.next_out = (Bytef*)outbuf.data();
+                strm.avail_out = outbuf.size();
+                const int ret = deflate(&strm, finish ? Z_FINISH : Z_NO_FLUSH);
+                if (ret == Z_STREAM_ERROR
+                    || !write_out(outbuf.size() - strm.avail_out)
+                ) {
+                    return false;
+                }
+                if (finish ? ret == Z_STREAM_END : strm.avail_out != 0) {
+                    return true;
+                }
+            }
+        }
+
+    private:
+        z_stream strm;
+};
+#endif
+
+#ifdef USE_ZSTD
+class ZstdOutput: public OutputCompressor
+{
+    public:
+        explicit ZstdOutput(std::ostream* _out) :
+            OutputCompressor(_out)
+        {
+            strm = ZSTD_createCStream();
+            ZSTD_initCStream(strm, 1);
+        }
+        ~ZstdOutput()
+        {
+            ZSTD_freeCStream(strm);
+        }
+
+        bool write(const char* data, size_t len, bool finish) override
+        {
+            ZSTD_inBuffer in = {data, len, 0};
+            while (in.pos < in.size) {
+                ZSTD_outBuffer o = {outbuf.data(), outbuf.size(), 0};
+                if (ZSTD_isError(ZSTD_compressStream(strm, &o, &in))
+                    || !write_out(o.pos)
+                ) {
+                    return false;
+                }
+            }
+            if (!finish) {
+                return true;
+            }
+
+            for (;;) {
+                ZSTD_outBuffer o = {outbuf.data(), outbuf.size(), 0};
+                const size_t left = ZSTD_endStream(strm, &o);
+                if (ZSTD_isError(left) || !write_out(o.pos)) {
+                    return false;
+                }
+                if (left == 0) {
+                    return true;
+                }
+            }
+        }
+
+    private:
+        ZSTD_CStream* strm;
+};
+#endif
+
+#ifdef USE_LZMA
+class XzOutput: public OutputCompressor
+{
+    public:
+        explicit XzOutput(std::ostream* _out) :
+            OutputCompressor(_out)
+        {
+            ok = lzma_easy_encoder(&strm, 0, LZMA_CHECK_CRC64) == LZMA_OK;
+        }
+        ~XzOutput()
+        {
+            lzma_end(&strm);
+        }
+
+        bool write(const char* data, size_t len, bool finish) override
+        {
+            if (!ok) {
+                return false;
+            }
+            strm.next_in = (const uint8_t*)data;
+            strm.avail_in = len;
+            for (;;) {
+                strm.next_out = (uint8_t*)outbuf.data();
+                strm.avail_out = outbuf.size();
+                const lzma_ret ret = lzma_code(&strm, finish ? LZMA_FINISH : LZMA_RUN);
+                if ((ret != LZMA_OK && ret != LZMA_STREAM_END)
+                    || !write_out(outbuf.size() - strm.avail_out)
+                ) {
+                    return false;
+                }
+                if (finish ? ret == LZMA_STREAM_END : strm.avail_out != 0) {
+                    return true;
+                }
+            }
+        }
+
+    private:
+        lzma_stream strm = LZMA_STREAM_INIT;
+        bool ok;
+};
+#endif
+
+class CompressedStreamBuf: public std::streambuf
+{
+    public:
+        explicit CompressedStreamBuf(OutputCompressor* _comp) :
+            comp(_comp)
+            , buf(1ULL << 20)
+        {
+            setp(buf.data(), buf.data() + buf.size());
+        }
+
+        //Ends the compressed stream, nothing can be written after
+        bool finish()
+        {
+            return drain() && comp->write(NULL, 0, true);
+        }
+
+    protected:
+        int overflow(int ch) override
+        {
+            if (!drain()) {
+                return traits_type::eof();
+            }
+            if (ch != traits_type::eof()) {
+                *pptr() = (char)ch;
+                pbump(1);
+            }
+            return traits_type::not_eof(ch);
+        }
+
+        std::streamsize xsputn(const char* s, std::streamsize n) override
+        {
+            if (n < epptr() - pptr()) {
+                memcpy(pptr(), s, n);
+                pbump(n);
+                return n;
+            }
+            if (!drain() || !comp->write(s, n, false)) {
+                return 0;
+            }
+            return n;
+        }
+
+        int sync() override
+        {
+            return drain() ? 0 : -1;
+        }
+
+    private:
+        bool drain()
+        {
+            const size_t len = pptr() - pbase();
+            setp(buf.data(), buf.data() + buf.size());
+            return len == 0 || comp->write(buf.data(), len, false);
+        }
+
+        std::unique_ptr<OutputCompressor> comp;
+        std::vector<char> buf;
+};
+
+//An ostream that writes into "file" compressed with "format", e.g. "gzip".
+//It owns "file", and the compressed data is only complete once it is
+//destroyed.
+class CompressedOStream: public std::ostream
+{
+    public:
+        CompressedOStream(std::ostream* _file, const std::string& format) :
+            std::ostream(NULL)
+            , file(_file)
+            , sbuf(make_compressor(file.get(), format))
+        {
+            rdbuf(&sbuf);
+        }
+
+        ~CompressedOStream()
+        {
+            sbuf.finish();
+            file->flush();
+        }
+
+        //Space-separated list of the formats compiled in
+        static std::string supported_formats()
+        {
+            std::string ret;
+            #ifdef USE_ZLIB
+            ret += " gzip";
+            #endif
+            #ifdef USE_ZSTD
+            ret += " zstd";
+            #endif
+            #ifdef USE_LZMA
+            ret += " xz";
+            #endif
+            return ret;
+        }
+
+        static bool supported(const std::string& format)
+        {
+            return (supported_formats() + " ").find(" " + format + " ") != std::string::npos;
+        }
+
+    private:
+        static OutputCompressor* make_compressor(std::ostream* out, const std::string& format)
+        {
+            #ifdef USE_ZLIB
+            if (format == "gzip") {
+                return new GzipOutput(out);
+            }
+            #endif
+            #ifdef USE_ZSTD
+            if (format == "zstd") {
+                return new ZstdOutput(out);
+            }
+            #endif
+            #ifdef USE_LZMA
+            if (format == "xz") {
+                return new XzOutput(out);
+            }
+            #endif
+            (void)out;
+            (void)format;
+            return NULL;
+        }
+
+        std::unique_ptr<std::ostream> file;
+        CompressedStreamBuf sbuf;
+};
+
+#endif //COMPRESSEDOSTREAM_H
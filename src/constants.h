@@ -64,6 +64,11 @@ THE SOFTWARE.
 #if defined(LARGE_OFFSETS)
 #define BASE_DATA_TYPE uint64_t
 #define EFFECTIVELY_USEABLE_BITS 62
+#elif defined(LARGE_ARENA)
+//Clauses start at 32B boundaries, so 30 bits of offset address 32GB
+struct CMSatArenaSlot { uint64_t data[4]; };
+#define BASE_DATA_TYPE CMSatArenaSlot
+#define EFFECTIVELY_USEABLE_BITS 30
 #else
 #define BASE_DATA_TYPE uint32_t
 #define EFFECTIVELY_USEABLE_BITS 30
@@ -0,0 +1,213 @@
+/******************************************
+Copyright (c) 2016, Mate Soos
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+***********************************************/
+
+
+#include "cpupin.h"
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <iostream>
+#include <cstdlib>
+#include <cerrno>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+using namespace CMSat;
+using std::string;
+using std::vector;
+
+#if defined(__linux__)
+static int parse_number(const string& str, const string& list)
+{
+    char* end = NULL;
+    errno = 0;
+    const long val = std::strtol(str.c_str(), &end, 10);
+    if (str.empty() || *end != '\0' || errno != 0 || val < 0 || val >= CPU_SETSIZE) {
+        const string err = "ERROR: Bad CPU or node number '" + str
+            + "' in the list '" + list + "' of thread pinning";
+        std::cerr << err << std::endl;
+        throw std::invalid_argument(err);
+    }
+    return val;
+}
+
+//E.g. "0-3,8,10-11" as in /sys/devices/system/node/node0/cpulist
+static vector<int> parse_list(const string& str)
+{
+    vector<int> ret;
+    std::stringstream ss(str);
+    string part;
+    while (std::getline(ss, part, ',')) {
+        if (part.empty() || part == "\n") {
+            continue;
+        }
+        const size_t dash = part.find('-');
+        const int from = parse_number(part.substr(0, dash), str);
+        const int to = (dash == string::npos) ? from : parse_number(part.substr(dash+1), str);
+        for(int i = from; i <= to; i++) {
+            ret.push_back(i);
+        }
+    }
+    return ret;
+}
+
+static vector<int> usable_cpus()
+{
+    vector<int> ret;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (pthread_getaffinity_np(pthread_self(), sizeof(set), &set) != 0) {
+        return ret;
+    }
+    for(int i = 0; i < CPU_SETSIZE; i++) {
+        if (CPU_ISSET(i, &set)) {
+            ret.push_back(i);
+        }
+    }
+    return ret;
+}
+
+static vector<int> node_cpus(const int node)
+{
+    std::ifstream f("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+    string line;
+    std::getline(f, line);
+    return parse_list(line);
+}
+
+static vector<vector<int> > all_node_cpus()
+{
+    vector<vector<int> > ret;
+    for(int node = 0; ; node++) {
+        vector<int> cpus = node_cpus(node);
+        if (cpus.empty()) {
+            break;
+        }
+        ret.push_back(cpus);
+    }
+
+    //No NUMA info, the whole machine is one node
+    if (ret.empty()) {
+        ret.push_back(usable_cpus());
+    }
+    return ret;
+}
+
+vector<vector<int> > CMSat::cpu_sets_for_threads(
+    const string& spec
+    , const size_t num_threads
+) {
+    vector<vector<int> > sets(num_threads);
+    if (spec.empty()) {
+        return sets;
+    }
+
+    if (spec == "cores") {
+        const vector<int> cpus = usable_cpus();
+        for(size_t i = 0; i < num_threads && !cpus.empty(); i++) {
+            sets[i].push_back(cpus[i % cpus.size()]);
+        }
+    } else if (spec == "numa") {
+        const vector<vector<int> > nodes = all_node_cpus();
+        for(size_t i = 0; i < num_threads; i++) {
+            sets[i] = nodes[i % nodes.size()];
+        }
+    } else if (spec.compare(0, 5, "cpus:") == 0) {
+        const vector<int> cpus = parse_list(spec.substr(5));
+        for(size_t i = 0; i < num_threads && !cpus.empty(); i++) {
+            sets[i].push_back(cpus[i % cpus.size()]);
+        }
+    } else if (spec.compare(0, 6, "nodes:") == 0) {
+        const vector<int> nodes = parse_list(spec.substr(6));
+        for(size_t i = 0; i < num_threads && !nodes.empty(); i++) {
+            sets[i] = node_cpus(nodes[i % nodes.size()]);
+        }
+    } else {
+        const string err = "ERROR: Unknown thread pinning '" + spec
+            + "', use 'cores', 'numa', 'cpus:A,B,..' or 'nodes:A,B,..'";
+        std::cerr << err << std::endl;
+        throw std::invalid_argument(err);
+    }
+
+    return sets;
+}
+
+bool CMSat::pin_this_thread(const vector<int>& cpus)
+{
+    if (cpus.empty()) {
+        return true;
+    }
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for(const int cpu: cpus) {
+        if (cpu >= 0 && cpu < CPU_SETSIZE) {
+            CPU_SET(cpu, &set);
+        }
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+vector<int> CMSat::this_thread_cpus()
+{
+    return usable_cpus();
+}
+
+#else
+vector<vector<int> > CMSat::cpu_sets_for_threads(
+    const string&
+    , const size_t num_threads
+) {
+    return vector<vector<int> >(num_threads);
+}
+
+bool CMSat::pin_this_thread(const vector<int>&)
+{
+    return true;
+}
+
+vector<int> CMSat::this_thread_cpus()
+{
+    return vector<int>();
+}
+#endif //__linux__
+
+CMSat::ScopedPin::ScopedPin(const vector<int>& cpus)
+{
+    if (cpus.empty()) {
+        return;
+    }
+    orig_cpus = this_thread_cpus();
+    ok = pin_this_thread(cpus);
+    if (!ok) {
+        orig_cpus.clear();
+    }
+}
+
+CMSat::ScopedPin::~ScopedPin()
+{
+    pin_this_thread(orig_cpus);
+}
@@ -0,0 +1,81 @@
+/******************************************
+Copyright (c) 2016, Mate Soos
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+***********************************************/
+
+
+#ifndef CPUPIN_H
+#define CPUPIN_H
+
+#include <string>
+#include <vector>
+
+namespace CMSat {
+
+/**
+@brief Which CPUs each solver thread may run on
+
+"spec" is one of:
+ - "cores": thread i on the i-th CPU the process may use
+ - "numa": threads spread round-robin over the NUMA nodes, each allowed
+   on all CPUs of its node
+ - "cpus:A,B,...": thread i on CPU number i (modulo the list)
+ - "nodes:A,B,...": thread i on all CPUs of NUMA node number i
+Returns an empty set for a thread that is not to be pinned. Only does
+anything on Linux.
+*/
+std::vector<std::vector<int> > cpu_sets_for_threads(
+    const std::string& spec
+    , const size_t num_threads
+);
+
+//False if the calling thread could not be pinned
+bool pin_this_thread(const std::vector<int>& cpus);
+
+//The CPUs the calling thread may run on, empty if unknown
+std::vector<int> this_thread_cpus();
+
+/**
+@brief Pins the calling thread while in scope
+
+The thread gets back the CPUs it had before when this goes out of scope.
+Used for thread 0 of the library, which is the caller's own thread.
+*/
+class ScopedPin
+{
+    public:
+        explicit ScopedPin(const std::vector<int>& cpus);
+        ~ScopedPin();
+        ScopedPin(const ScopedPin&) = delete;
+        ScopedPin& operator=(const ScopedPin&) = delete;
+
+        bool pinned() const
+        {
+            return ok;
+        }
+
+    private:
+        std::vector<int> orig_cpus; //empty if nothing is to be restored
+        bool ok = true;
+};
+
+}
+
+#endif //CPUPIN_H
@@ -25,12 +25,17 @@ THE SOFTWARE.
 #include "solver.h"
 #include "drat.h"
 #include "shareddata.h"
+#include "threadpool.h"
+#include "cpupin.h"
 #include <fstream>
 
 #include <thread>
 #include <mutex>
 #include <atomic>
-using std::thread;
+#include <chrono>
+#include <functional>
+#include <deque>
+#include <condition_variable>
 
 #define CACHE_SIZE 10ULL*1000ULL*1000UL
 #ifndef LIMITMEM
@@ -55,6 +60,7 @@ namespace CMSat {
         }
         ~CMSatPrivateData()
         {
+            delete pool;
             for(Solver* this_s: solvers) {
                 delete this_s;
             }
@@ -71,21 +77,43 @@ namespace CMSat {
         vector<Solver*> solvers;
         vector<double> cpu_times;
         SharedData *shared_data = NULL;
+        ThreadPool *pool = NULL; //started at the first multi-threaded call
+        vector<int> caller_cpus; //thread 0 is pinned to these during a run
         int which_solved = 0;
         std::atomic<bool>* must_interrupt;
         bool must_interrupt_needs_delete = false;
         unsigned cls = 0;
         unsigned vars_to_add = 0;
         vector<Lit> cls_lits;
+        vector<Lit> tmp_cl; //used by add_clauses()
         bool okay = true;
         std::ofstream* log = NULL;
         int sql = 0;
         double timeout = std::numeric_limits<double>::max();
         bool interrupted = false;
 
+        //Only thread 0 has the clauses until it has done the startup
+        //simplification and the others have been cloned from it
+        bool startup_clone_pending = false;
+
+        //Final conflict if cube-and-conquer refuted all cubes
+        vector<Lit> cube_conflict;
+        bool conflict_from_cubes = false;
+
         uint64_t previous_sum_conflicts = 0;
         uint64_t previous_sum_propagations = 0;
         uint64_t previous_sum_decisions = 0;
+
+        //Wrapped by each thread's Solver::progress_callback
+        std::function<bool(const SolveProgress&)> progress_callback;
+        uint64_t progress_every_confl = 10000;
+        std::mutex progress_mutex;
+
+        //Wall-clock time of solve() and simplify() calls
+        uint64_t num_solve_calls = 0;
+        double last_solve_time = 0;
+        double sum_solve_time = 0;
+        double max_solve_time = 0;
     };
 }
 
@@ -93,6 +121,8 @@ struct DataForThread
 {
     explicit DataForThread(CMSatPrivateData* data, const vector<Lit>* _assumptions = NULL) :
         solvers(data->solvers)
+        , shared_data(data->shared_data)
+        , clone_startup(data->startup_clone_pending)
         , cpu_times(data->cpu_times)
         , lits_to_add(&(data->cls_lits))
         , vars_to_add(data->vars_to_add)
@@ -109,8 +139,12 @@ struct DataForThread
         delete ret;
     }
     vector<Solver*>& solvers;
+    SharedData* shared_data;
+    const bool clone_startup;
     vector<double>& cpu_times;
     vector<Lit> *lits_to_add;
+    const Lit* caller_lits = NULL; ///<Added after lits_to_add, see SATSolver::add_clauses()
+    size_t caller_n_lits = 0;
     uint32_t vars_to_add;
     const vector<Lit> *assumptions;
     std::mutex* update_mutex;
@@ -141,6 +175,23 @@ DLL_PUBLIC SATSolver::~SATSolver()
     delete data;
 }
 
+static void set_progress_callback_of_threads(CMSatPrivateData* data)
+{
+    for(size_t i = 0; i < data->solvers.size(); i++) {
+        Solver& s = *data->solvers[i];
+        s.progress_every_confl = data->progress_every_confl;
+        if (!data->progress_callback) {
+            s.progress_callback = nullptr;
+            continue;
+        }
+        s.progress_callback = [data, i](SolveProgress& progress) {
+            progress.thread = i;
+            std::lock_guard<std::mutex> lock(data->progress_mutex);
+            return data->progress_callback(progress);
+        };
+    }
+}
+
 void update_config(SolverConf& conf, unsigned thread_num)
 {
     //Don't accidentally reconfigure everything to a specific value!
@@ -411,8 +462,13 @@ DLL_PUBLIC void SATSolver::set_num_threads(unsigned num)
             conf.doFindXors = 0;
         }
         data->solvers[i]->setConf(conf);
-        data->solvers[i]->set_shared_data((SharedData*)data->shared_data);
+        data->solvers[i]->set_shared_data((SharedData*)data->shared_data, i);
+        data->shared_data->thread_confs.push_back(conf);
     }
+    set_progress_callback_of_threads(data);
+    data->startup_clone_pending = (data->solvers[0]->conf.clone_startup_simplify
+        || data->solvers[0]->conf.share_irred_longs)
+        && !data->solvers[0]->conf.cube_and_conquer;
 }
 
 struct OneThreadAddCls
@@ -428,12 +484,24 @@ struct OneThreadAddCls
         Solver& solver = *data_for_thread.solvers[tid];
         solver.new_external_vars(data_for_thread.vars_to_add);
 
-        vector<Lit> lits;
-        vector<uint32_t> vars;
+        const vector<Lit>& orig_lits = (*data_for_thread.lits_to_add);
+        bool ret = add(solver, orig_lits.data(), orig_lits.size());
+        if (ret && data_for_thread.caller_n_lits > 0) {
+            ret = add_caller_lits(solver);
+        }
+
+        if (!ret) {
+            data_for_thread.update_mutex->lock();
+            *data_for_thread.ret = l_False;
+            data_for_thread.update_mutex->unlock();
+        }
+    }
+
+    //Clauses and XORs as buffered in CMSatPrivateData::cls_lits
+    bool add(Solver& solver, const Lit* orig_lits, const size_t size)
+    {
         bool ret = true;
         size_t at = 0;
-        const vector<Lit>& orig_lits = (*data_for_thread.lits_to_add);
-        const size_t size = orig_lits.size();
         while(at < size && ret) {
             if (orig_lits[at] == lit_Undef) {
                 lits.clear();
@@ -461,29 +529,88 @@ struct OneThreadAddCls
                 ret = solver.add_xor_clause_outer(vars, rhs);
             }
         }
+        return ret;
+    }
 
-        if (!ret) {
-            data_for_thread.update_mutex->lock();
-            *data_for_thread.ret = l_False;
-            data_for_thread.update_mutex->unlock();
+    //Clauses as given to SATSolver::add_clauses(): separated by lit_Undef,
+    //the last one not ended
+    bool add_caller_lits(Solver& solver)
+    {
+        const Lit* orig_lits = data_for_thread.caller_lits;
+        const size_t size = data_for_thread.caller_n_lits;
+        bool ret = true;
+        lits.clear();
+        for(size_t i = 0; i <= size && ret; i++) {
+            if (i == size || orig_lits[i] == lit_Undef) {
+                ret = solver.add_clause_outer(lits);
+                lits.clear();
+            } else {
+                lits.push_back(orig_lits[i]);
+            }
         }
+        return ret;
     }
 
     DataForThread& data_for_thread;
     const size_t tid;
+    vector<Lit> lits;
+    vector<uint32_t> vars;
 };
 
-static bool actually_add_clauses_to_threads(CMSatPrivateData* data)
-{
-    DataForThread data_for_thread(data);
-    std::vector<std::thread> thds;
-    for(size_t i = 0; i < data->solvers.size(); i++) {
-        thds.push_back(thread(OneThreadAddCls(data_for_thread, i)));
+//Threads are pinned before any of them adds clauses, so that each solver's
+//memory is first touched, hence allocated, on its own NUMA node. Thread 0 is
+//the caller's own thread, which is only pinned during run_threads()
+static ThreadPool& get_pool(CMSatPrivateData* data)
+{
+    if (data->pool == NULL) {
+        data->pool = new ThreadPool(data->solvers.size());
+        const vector<vector<int> > cpus = cpu_sets_for_threads(
+            data->solvers[0]->conf.pin_threads, data->solvers.size());
+        data->caller_cpus = cpus[0];
+        data->pool->run([&](const size_t tid) {
+            if (tid == 0) {
+                return;
+            }
+            if (!pin_this_thread(cpus[tid]) && data->solvers[0]->conf.verbosity) {
+                std::cerr << "c WARNING: could not pin thread " << tid << endl;
+            }
+        });
     }
-    for(std::thread& thread : thds){
-        thread.join();
+    return *data->pool;
+}
+
+//Runs job(tid) on every thread of the pool of "data". The caller's thread,
+//which does tid 0, is pinned meanwhile, and gets its own CPUs back after
+static void run_threads(
+    CMSatPrivateData* data
+    , const std::function<void(size_t)>& job
+) {
+    ThreadPool& pool = get_pool(data);
+    ScopedPin pin(data->caller_cpus);
+    if (!pin.pinned() && data->solvers[0]->conf.verbosity) {
+        std::cerr << "c WARNING: could not pin thread 0" << endl;
     }
-    bool ret = (*data_for_thread.ret == l_True);
+    pool.run(job);
+}
+
+//The buffered clauses are added first, then the caller's "lits" of
+//SATSolver::add_clauses(), without the final end marker, straight from its
+//buffer
+static bool actually_add_clauses_to_threads(
+    CMSatPrivateData* data
+    , const Lit* lits = NULL
+    , const size_t n_lits = 0
+) {
+    DataForThread data_for_thread(data);
+    data_for_thread.caller_lits = lits;
+    data_for_thread.caller_n_lits = n_lits;
+    const size_t num = data->startup_clone_pending ? 1 : data->solvers.size();
+    run_threads(data, [&](const size_t tid) {
+        if (tid < num) {
+            OneThreadAddCls(data_for_thread, tid)();
+        }
+    });
+    bool ret = (*data_for_thread.ret != l_False);
 
     //clear what has been added
     data->cls_lits.clear();
@@ -492,6 +619,129 @@ static bool actually_add_clauses_to_threads(CMSatPrivateData* data)
     return ret;
 }
 
+//Adds the clauses and variables that are still buffered
+static void flush_buffered(CMSatPrivateData* data)
+{
+    if (data->solvers.size() == 1) {
+        data->solvers[0]->new_vars(data->vars_to_add);
+        data->vars_to_add = 0;
+    } else if (!data->cls_lits.empty() || data->vars_to_add > 0) {
+        data->okay = actually_add_clauses_to_threads(data) && data->okay;
+    }
+}
+
+/**
+@brief Copies the solvers of "from", thread by thread, in memory
+
+Each solver is copied by the thread of "pool" that runs it, so that, if
+threads are pinned, the copy's memory is allocated on that thread's NUMA
+node. "from" must have no buffered clauses.
+*/
+static CMSatPrivateData* copy_private_data(
+    CMSatPrivateData* from
+    , std::atomic<bool>* must_interrupt
+    , CMSatPrivateData* pool_of
+) {
+    if (from->solvers[0]->drat->enabled()) {
+        const char err[] = "ERROR: A solver writing a DRAT proof cannot be copied";
+        std::cerr << err << endl;
+        throw std::runtime_error(err);
+    }
+    assert(from->cls_lits.empty() && from->vars_to_add == 0);
+
+    CMSatPrivateData* to = new CMSatPrivateData(must_interrupt);
+    const SharedClauses* longs = NULL;
+    for(size_t i = 0; i < from->solvers.size(); i++) {
+        to->solvers.push_back(new Solver(&from->solvers[i]->conf, to->must_interrupt));
+        to->cpu_times.push_back(0.0);
+    }
+    if (from->shared_data != NULL) {
+        to->shared_data = new SharedData(to->solvers.size());
+        to->shared_data->thread_confs = from->shared_data->thread_confs;
+        to->shared_data->irred_longs = from->shared_data->irred_longs;
+        longs = &to->shared_data->irred_longs;
+        for(size_t i = 0; i < to->solvers.size(); i++) {
+            to->solvers[i]->set_shared_data(to->shared_data, i);
+        }
+    }
+
+    if (to->solvers.size() == 1) {
+        to->solvers[0]->copy_state_from(*from->solvers[0]);
+    } else {
+        run_threads(pool_of, [&](const size_t tid) {
+            const Solver& orig = *from->solvers[tid];
+            to->solvers[tid]->copy_state_from(orig, orig.shared_longs ? longs : NULL);
+        });
+    }
+    to->cls = from->cls;
+    to->okay = from->okay;
+    to->timeout = from->timeout;
+    to->startup_clone_pending = from->startup_clone_pending;
+
+    return to;
+}
+
+DLL_PUBLIC SATSolver* SATSolver::clone()
+{
+    flush_buffered(data);
+    SATSolver* ret = new SATSolver((void*)&data->solvers[0]->conf);
+    delete ret->data;
+    ret->data = copy_private_data(data, NULL, data);
+
+    //Only the clone adds clauses through its buffer
+    if (ret->data->shared_data != NULL) {
+        ret->data->cls_lits.reserve(CACHE_SIZE);
+    }
+
+    return ret;
+}
+
+/**
+@brief Saves the state of the solver, see rollback()
+
+Nothing is copied: the clauses added from now on carry the snapshot's
+selector, a hidden variable that is assumed false when solving. Cutting the
+clause database back to a high-water mark instead would not be sound:
+learnt clauses, units, eliminated and replaced variables found since may
+all depend on the clauses that are to go. With the selector, they contain it.
+*/
+DLL_PUBLIC unsigned SATSolver::snapshot()
+{
+    if (data->solvers[0]->drat->enabled()) {
+        const char err[] = "ERROR: A solver writing a DRAT proof cannot take a snapshot";
+        std::cerr << err << endl;
+        throw std::runtime_error(err);
+    }
+    flush_buffered(data);
+
+    //Only thread 0 has the clauses until the others are cloned from it
+    const size_t num = data->startup_clone_pending ? 1 : data->solvers.size();
+    for(size_t i = 0; i < num; i++) {
+        data->solvers[i]->new_snapshot();
+    }
+
+    return data->solvers[0]->num_snapshots()-1;
+}
+
+DLL_PUBLIC void SATSolver::rollback(unsigned snapshot)
+{
+    if (snapshot >= data->solvers[0]->num_snapshots()) {
+        const char err[] = "ERROR: No such snapshot to roll back to";
+        std::cerr << err << endl;
+        throw std::runtime_error(err);
+    }
+    flush_buffered(data);
+
+    for(Solver* s: data->solvers) {
+        if (s->num_snapshots() > snapshot) {
+            s->rollback_snapshots(snapshot);
+        }
+    }
+    data->okay = data->solvers[0]->okay();
+    data->which_solved = 0;
+    data->conflict_from_cubes = false;
+}
+
 DLL_PUBLIC void SATSolver::set_max_time(double max_time)
 {
   for (size_t i = 0; i < data->solvers.size(); ++i) {
@@ -654,6 +904,56 @@ DLL_PUBLIC bool SATSolver::add_clause(const vector< Lit >& lits)
     return ret;
 }
 
+DLL_PUBLIC bool SATSolver::add_clauses(const Lit* lits, const size_t n_lits)
+{
+    if (n_lits == 0) {
+        return true;
+    }
+
+    //The last clause need not be ended
+    const size_t n = (lits[n_lits-1] == lit_Undef) ? n_lits-1 : n_lits;
+    if (data->log) {
+        for(size_t i = 0; i < n; i++) {
+            if (lits[i] == lit_Undef) {
+                (*data->log) << "0" << endl;
+            } else {
+                (*data->log) << lits[i] << " ";
+            }
+        }
+        (*data->log) << "0" << endl;
+    }
+
+    bool ret = true;
+    if (data->solvers.size() > 1) {
+        if (data->cls_lits.size() + n + 1 > CACHE_SIZE) {
+            //Too many to buffer: the threads read them from "lits" directly
+            ret = actually_add_clauses_to_threads(data, lits, n);
+        } else {
+            //Buffered clauses start with lit_Undef, so every end marker but
+            //the last one is the start marker of the next clause
+            data->cls_lits.push_back(lit_Undef);
+            data->cls_lits.insert(data->cls_lits.end(), lits, lits + n);
+        }
+    } else {
+        data->solvers[0]->new_vars(data->vars_to_add);
+        data->vars_to_add = 0;
+
+        vector<Lit>& cl = data->tmp_cl;
+        cl.clear();
+        for(size_t i = 0; i <= n && ret; i++) {
+            if (i == n || lits[i] == lit_Undef) {
+                ret = data->solvers[0]->add_clause_outer(cl);
+                data->cls++;
+                cl.clear();
+            } else {
+                cl.push_back(lits[i]);
+            }
+        }
+    }
+
+    return ret;
+}
+
 void add_xor_clause_to_log(const std::vector<unsigned>& vars, bool rhs, std::ofstream* file)
 {
     if (vars.size() == 0) {
@@ -722,14 +1022,23 @@ struct OneThreadCalc
             //data_for_thread.update_mutex->unlock();
         }
 
-        OneThreadAddCls cls_adder(data_for_thread, tid);
-        cls_adder();
+        if (data_for_thread.clone_startup && tid > 0) {
+            if (!clone_from_thread0()) {
+                return;
+            }
+        } else {
+            OneThreadAddCls cls_adder(data_for_thread, tid);
+            cls_adder();
+        }
         lbool ret;
         if (solve) {
             ret = data_for_thread.solvers[tid]->solve_with_assumptions(data_for_thread.assumptions, only_indep_solution);
         } else {
             ret = data_for_thread.solvers[tid]->simplify_with_assumptions(data_for_thread.assumptions);
         }
+        if (data_for_thread.clone_startup && tid == 0) {
+            data_for_thread.shared_data->release_startup();
+        }
 
         data_for_thread.cpu_times[tid] = cpuTime();
         if (print_thread_start_and_finish) {
@@ -754,6 +1063,30 @@ struct OneThreadCalc
         }
     }
 
+    //False if there is nothing to clone, thread 0 has the answer
+    bool clone_from_thread0()
+    {
+        SharedData& shared = *data_for_thread.shared_data;
+        if (!shared.wait_startup()) {
+            return false;
+        }
+
+        Solver& solver = *data_for_thread.solvers[tid];
+        const SharedClauses* longs = NULL;
+        if (data_for_thread.solvers[0]->conf.share_irred_longs) {
+            longs = &shared.irred_longs;
+        }
+        if (!solver.import_simplified(shared.startup_cnf, longs)) {
+            data_for_thread.update_mutex->lock();
+            *data_for_thread.which_solved = tid;
+            *data_for_thread.ret = l_False;
+            data_for_thread.solvers[0]->set_must_interrupt_asap();
+            data_for_thread.update_mutex->unlock();
+            return false;
+        }
+        return true;
+    }
+
     DataForThread& data_for_thread;
     const size_t tid;
     double start_time;
@@ -761,13 +1094,309 @@ struct OneThreadCalc
     bool only_indep_solution;
 };
 
+/**
+@brief The cubes of cube-and-conquer, one deque per thread
+
+A thread pushes and pops its own cubes at the back, so it goes deep into the
+part of the search space it has split. Idle threads steal from the front of
+the others' deques, where the shortest, i.e. largest, cubes are.
+"outstanding" counts the cubes queued or being worked on. Once it is 0,
+all of them have been refuted.
+*/
+struct CubeWork
+{
+    explicit CubeWork(const size_t num_threads) :
+        deques(num_threads)
+    {}
+
+    struct Deque {
+        std::mutex mu;
+        std::deque<vector<Lit>> cubes;
+    };
+
+    void push(const size_t tid, vector<Lit>&& cube)
+    {
+        outstanding++;
+        {
+            std::lock_guard<std::mutex> lock(deques[tid].mu);
+            deques[tid].cubes.push_back(std::move(cube));
+        }
+        wake_all();
+    }
+
+    //False if there is nothing more to do
+    bool get(const size_t tid, vector<Lit>& cube)
+    {
+        while(!stop) {
+            if (pop(tid, cube)) {
+                return true;
+            }
+            std::unique_lock<std::mutex> lock(idle_mu);
+            if (outstanding == 0 || stop) {
+                return false;
+            }
+            idle_cv.wait_for(lock, std::chrono::milliseconds(10));
+        }
+        return false;
+    }
+
+    void finished_one()
+    {
+        if (--outstanding == 0) {
+            wake_all();
+        }
+    }
+
+    void set_stop()
+    {
+        stop = true;
+        wake_all();
+    }
+
+    //Every cube that contains all of "core" is refuted, too
+    void add_core(vector<Lit>&& core, const vector<Lit>& assump_confl)
+    {
+        std::lock_guard<std::mutex> lock(cores_mu);
+        cores.push_back(std::move(core));
+        for(const Lit lit: assump_confl) {
+            if (std::find(final_confl.begin(), final_confl.end(), lit) == final_confl.end()) {
+                final_confl.push_back(lit);
+            }
+        }
+    }
+
+    bool refuted(const vector<Lit>& cube)
+    {
+        std::lock_guard<std::mutex> lock(cores_mu);
+        for(const vector<Lit>& core: cores) {
+            bool all_in = true;
+            for(const Lit lit: core) {
+                if (std::find(cube.begin(), cube.end(), lit) == cube.end()) {
+                    all_in = false;
+                    break;
+                }
+            }
+            if (all_in) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    vector<Deque> deques;
+    std::atomic<size_t> outstanding{0};
+    std::atomic<bool> stop{false};
+
+    //The assumptions (not cube literals) the refuted cubes depended on
+    std::mutex cores_mu;
+    vector<vector<Lit>> cores;
+    vector<Lit> final_confl;
+
+    private:
+        bool pop(const size_t tid, vector<Lit>& cube)
+        {
+            for(size_t i = 0; i < deques.size(); i++) {
+                Deque& d = deques[(tid+i) % deques.size()];
+                std::lock_guard<std::mutex> lock(d.mu);
+                if (d.cubes.empty()) {
+                    continue;
+                }
+                if (i == 0) {
+                    cube = std::move(d.cubes.back());
+                    d.cubes.pop_back();
+                } else {
+                    cube = std::move(d.cubes.front());
+                    d.cubes.pop_front();
+                }
+                return true;
+            }
+            return false;
+        }
+
+        void wake_all()
+        {
+            std::lock_guard<std::mutex> lock(idle_mu);
+            idle_cv.notify_all();
+        }
+
+        std::mutex idle_mu;
+        std::condition_variable idle_cv;
+};
+
+struct OneThreadCube
+{
+    OneThreadCube(
+        DataForThread& _data_for_thread,
+        CubeWork& _work,
+        size_t _tid,
+        uint32_t _split_depth,
+        bool _only_indep_solution
+    ) :
+        data_for_thread(_data_for_thread)
+        , work(_work)
+        , tid(_tid)
+        , solver(*_data_for_thread.solvers[_tid])
+        , split_depth(_split_depth)
+        , only_indep_solution(_only_indep_solution)
+        , max_confl(solver.conf.max_confl)
+        , max_time(solver.conf.maxTime)
+    {}
+
+    void operator()()
+    {
+        OneThreadAddCls cls_adder(data_for_thread, tid);
+        cls_adder();
+        if (!solver.okay()) {
+            found(l_False);
+        }
+
+        vector<Lit> cube;
+        while(work.get(tid, cube)) {
+            if (!work.refuted(cube)) {
+                solve_cube(cube);
+            }
+            work.finished_one();
+        }
+        data_for_thread.cpu_times[tid] = cpuTime();
+    }
+
+    //Cubes shorter than "split_depth" are split without trying to solve them
+    void solve_cube(vector<Lit>& cube)
+    {
+        vector<Lit> assumps;
+        if (data_for_thread.assumptions) {
+            assumps = *data_for_thread.assumptions;
+        }
+        assumps.insert(assumps.end(), cube.begin(), cube.end());
+
+        if (cube.size() >= split_depth) {
+            const int64_t budget = solver.get_stats().conflStats.numConflicts
+                + solver.conf.cube_confl_budget;
+            if (!solve_with_limit(assumps, cube, std::min<int64_t>(budget, max_confl))) {
+                return;
+            }
+        }
+
+        const uint32_t var = solver.pick_cube_var(assumps, solver.conf.cube_lookahead_vars);
+        if (var == var_Undef) {
+            //Propagation refutes it, or there is nothing left to split on
+            solve_with_limit(assumps, cube, max_confl);
+            return;
+        }
+        vector<Lit> cube2 = cube;
+        cube.push_back(Lit(var, true));
+        cube2.push_back(Lit(var, false));
+        work.push(tid, std::move(cube));
+        work.push(tid, std::move(cube2));
+    }
+
+    //False if the cube is done with, i.e. not to be split
+    bool solve_with_limit(
+        const vector<Lit>& assumps
+        , const vector<Lit>& cube
+        , const int64_t confl_limit
+    ) {
+        solver.conf.max_confl = confl_limit;
+        solver.conf.maxTime = max_time;
+        const lbool ret = solver.solve_with_assumptions(&assumps, only_indep_solution);
+        if (ret == l_True) {
+            found(l_True);
+            return false;
+        }
+        if (ret == l_False) {
+            //Conflict is the negation of the assumptions responsible
+            vector<Lit> core;
+            vector<Lit> assump_confl;
+            for(const Lit lit: solver.get_final_conflict()) {
+                if (std::find(cube.begin(), cube.end(), ~lit) != cube.end()) {
+                    core.push_back(~lit);
+                } else {
+                    assump_confl.push_back(lit);
+                }
+            }
+            if (core.empty()) {
+                found(l_False);
+            } else {
+                work.add_core(std::move(core), assump_confl);
+            }
+            return false;
+        }
+
+        if (solver.must_interrupt_asap()
+            || solver.get_stats().conflStats.numConflicts >= (uint64_t)max_confl
+            || cpuTime() >= max_time
+        ) {
+            //Out of time, the others must stop, too
+            solver.set_must_interrupt_asap();
+            work.set_stop();
+            return false;
+        }
+        return true;
+    }
+
+    void found(const lbool ret)
+    {
+        data_for_thread.update_mutex->lock();
+        if (*data_for_thread.ret == l_Undef) {
+            *data_for_thread.which_solved = tid;
+            *data_for_thread.ret = ret;
+        }
+        solver.set_must_interrupt_asap();
+        data_for_thread.update_mutex->unlock();
+        work.set_stop();
+    }
+
+    DataForThread& data_for_thread;
+    CubeWork& work;
+    const size_t tid;
+    Solver& solver;
+    const uint32_t split_depth;
+    const bool only_indep_solution;
+    const int64_t max_confl;
+    const double max_time;
+};
+
+static lbool cube_and_conquer(
+    const vector< Lit >* assumptions,
+    CMSatPrivateData *data,
+    bool only_indep_solution
+) {
+    //About 4-8 cubes per thread before any is solved
+    const size_t num_threads = data->solvers.size();
+    uint32_t split_depth = 2;
+    while((1ULL << (split_depth-2)) < num_threads) {
+        split_depth++;
+    }
+
+    DataForThread data_for_thread(data, assumptions);
+    CubeWork work(num_threads);
+    work.push(0, vector<Lit>());
+    run_threads(data, [&](const size_t tid) {
+        OneThreadCube(data_for_thread, work, tid, split_depth, only_indep_solution)();
+    });
+    lbool real_ret = *data_for_thread.ret;
+    data_for_thread.solvers[0]->unset_must_interrupt_asap();
+
+    if (real_ret == l_Undef && !work.stop && work.outstanding == 0) {
+        real_ret = l_False;
+        data->conflict_from_cubes = true;
+        data->cube_conflict = work.final_confl;
+    }
+
+    data->cls_lits.clear();
+    data->vars_to_add = 0;
+    data->okay = data->solvers[*data_for_thread.which_solved]->okay();
+    if (data->conflict_from_cubes && data->cube_conflict.empty()) {
+        data->okay = false;
+    }
+    return real_ret;
+}
+
 lbool calc(
     const vector< Lit >* assumptions,
     bool solve, CMSatPrivateData *data,
     bool only_indep_solution = false
 ) {
-    //Reset the interrupt signal if it was set
-    data->must_interrupt->store(false, std::memory_order_relaxed);
 
     //Set timeout information
     if (data->timeout != std::numeric_limits<double>::max()) {
@@ -810,22 +1439,43 @@ lbool calc(
     }
 
     //Multi-thread from now on.
-    DataForThread data_for_thread(data, assumptions);
-    std::vector<std::thread> thds;
-    for(size_t i = 0
-        ; i < data->solvers.size()
-        ; i++
-    ) {
-        thds.push_back(thread(OneThreadCalc(data_for_thread, i, solve, only_indep_solution)));
+    data->conflict_from_cubes = false;
+    if (solve && data->solvers[0]->conf.cube_and_conquer) {
+        return cube_and_conquer(assumptions, data, only_indep_solution);
     }
-    for(std::thread& thread : thds){
-        thread.join();
+
+    //When cloning, thread 0 simplifies at startup, as that's what the others
+    //will start from. It can't solve components separately, as the others
+    //would know nothing about them
+    const int orig_do_comp = data->solvers[0]->conf.doCompHandler;
+    const int orig_simp_startup = data->solvers[0]->conf.simplify_at_startup;
+    if (data->startup_clone_pending) {
+        data->shared_data->startup_pending = true;
+        data->shared_data->startup_cloned = false;
+        data->solvers[0]->conf.doCompHandler = false;
+        data->solvers[0]->conf.simplify_at_startup = true;
     }
+    //Clauses and variables added since the last call are all in data->cls_lits,
+    //which is only appended to while no thread runs, so the threads read it
+    //at the same time without locking
+    DataForThread data_for_thread(data, assumptions);
+    run_threads(data, [&](const size_t tid) {
+        OneThreadCalc(data_for_thread, tid, solve, only_indep_solution)();
+    });
     lbool real_ret = *data_for_thread.ret;
 
     //This does it for all of them, there is only one must-interrupt
     data_for_thread.solvers[0]->unset_must_interrupt_asap();
 
+    if (data->startup_clone_pending) {
+        data->solvers[0]->conf.doCompHandler = orig_do_comp;
+        data->solvers[0]->conf.simplify_at_startup = orig_simp_startup;
+        if (data->shared_data->startup_cloned) {
+            data->startup_clone_pending = false;
+            data->shared_data->startup_cnf.clear();
+        }
+    }
+
     //clear what has been added
     data->cls_lits.clear();
     data->vars_to_add = 0;
@@ -833,24 +1483,78 @@ lbool calc(
     return real_ret;
 }
 
+static lbool timed_calc(
+    const vector< Lit >* assumptions,
+    bool solve, CMSatPrivateData *data,
+    bool only_indep_solution = false
+) {
+    const auto start = std::chrono::steady_clock::now();
+    const lbool ret = calc(assumptions, solve, data, only_indep_solution);
+    const double t = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+
+    data->num_solve_calls++;
+    data->last_solve_time = t;
+    data->sum_solve_time += t;
+    data->max_solve_time = std::max(data->max_solve_time, t);
+    return ret;
+}
+
 DLL_PUBLIC lbool SATSolver::solve(const vector< Lit >* assumptions, bool only_indep_solution)
 {
+    //Reset the interrupt signal if it was set
+    data->must_interrupt->store(false, std::memory_order_relaxed);
+
     //set information data (props, confl, dec)
     data->previous_sum_conflicts = get_sum_conflicts();
     data->previous_sum_propagations = get_sum_propagations();
     data->previous_sum_decisions = get_sum_decisions();
 
-    return calc(assumptions, true, data, only_indep_solution);
+    return timed_calc(assumptions, true, data, only_indep_solution);
 }
 
 DLL_PUBLIC lbool SATSolver::simplify(const vector< Lit >* assumptions)
 {
+    //Reset the interrupt signal if it was set
+    data->must_interrupt->store(false, std::memory_order_relaxed);
+
     //set information data (props, confl, dec)
     data->previous_sum_conflicts = get_sum_conflicts();
     data->previous_sum_propagations = get_sum_propagations();
     data->previous_sum_decisions = get_sum_decisions();
 
-    return calc(assumptions, false, data);
+    return timed_calc(assumptions, false, data);
+}
+
+//The interrupt signal is reset here, not in the background, so that an
+//interrupt_asap() right after this returns is not lost
+DLL_PUBLIC std::future<lbool> SATSolver::solve_async(
+    const vector< Lit >* assumptions
+    , bool only_indep_solution
+) {
+    data->must_interrupt->store(false, std::memory_order_relaxed);
+    data->previous_sum_conflicts = get_sum_conflicts();
+    data->previous_sum_propagations = get_sum_propagations();
+    data->previous_sum_decisions = get_sum_decisions();
+
+    const bool has_assumps = (assumptions != NULL);
+    vector<Lit> assumps;
+    if (has_assumps) {
+        assumps = *assumptions;
+    }
+    CMSatPrivateData* d = data;
+    return std::async(std::launch::async, [d, has_assumps, assumps, only_indep_solution]() {
+        return timed_calc(has_assumps ? &assumps : NULL, true, d, only_indep_solution);
+    });
+}
+
+DLL_PUBLIC void SATSolver::set_progress_callback(
+    std::function<bool(const SolveProgress&)> callback
+    , uint64_t every_confl
+) {
+    data->progress_callback = callback;
+    data->progress_every_confl = every_confl;
+    set_progress_callback_of_threads(data);
 }
 
 DLL_PUBLIC const vector< lbool >& SATSolver::get_model() const
@@ -860,7 +1564,9 @@ DLL_PUBLIC const vector< lbool >& SATSolver::get_model() const
 
 DLL_PUBLIC const std::vector<Lit>& SATSolver::get_conflict() const
 {
-
+    if (data->conflict_from_cubes) {
+        return data->cube_conflict;
+    }
     return data->solvers[data->which_solved]->get_final_conflict();
 }
 
@@ -967,12 +1673,16 @@ DLL_PUBLIC void SATSolver::set_drat(std::ostream* os, bool add_ID)
         exit(-1);
     }
     Drat* drat = NULL;
+    const bool async = data->solvers[0]->conf.drat_async;
     if (add_ID) {
-        drat = new DratFile<true>;
+        drat = new DratFile<true>(async);
     } else {
-        drat = new DratFile<false>;
+        drat = new DratFile<false>(async);
     }
     drat->setFile(os);
+    #ifdef STATS_NEEDED
+    drat->cl_alloc = &data->solvers[0]->cl_alloc;
+    #endif
     if (data->solvers[0]->drat)
         delete data->solvers[0]->drat;
 
@@ -1104,6 +1814,26 @@ DLL_PUBLIC uint64_t SATSolver::get_last_decisions()
     return get_sum_decisions() - data->previous_sum_decisions;
 }
 
+DLL_PUBLIC double SATSolver::get_last_solve_time()
+{
+    return data->last_solve_time;
+}
+
+DLL_PUBLIC uint64_t SATSolver::get_num_solve_calls()
+{
+    return data->num_solve_calls;
+}
+
+DLL_PUBLIC double SATSolver::get_sum_solve_time()
+{
+    return data->sum_solve_time;
+}
+
+DLL_PUBLIC double SATSolver::get_max_solve_time()
+{
+    return data->max_solve_time;
+}
+
 DLL_PUBLIC void SATSolver::dump_irred_clauses(std::ostream *out) const
 {
     data->solvers[data->which_solved]->dump_irred_clauses(out);
@@ -24,16 +24,23 @@ THE SOFTWARE.
 #include "varreplacer.h"
 #include "solver.h"
 #include "shareddata.h"
+#include "time_mem.h"
 #include <iomanip>
 
 using namespace CMSat;
 
-DataSync::DataSync(Solver* _solver, SharedData* _sharedData) :
+DataSync::DataSync(Solver* _solver, SharedData* _sharedData, uint32_t _thread_num) :
     solver(_solver)
     , sharedData(_sharedData)
+    , thread_num(_thread_num)
     , seen(solver->seen)
     , toClear(solver->toClear)
-{}
+{
+    if (sharedData) {
+        assert(thread_num < sharedData->longs.size());
+        longSyncFinish.resize(sharedData->longs.size(), 0);
+    }
+}
 
 void DataSync::new_var(const bool bva)
 {
@@ -100,6 +107,9 @@ bool DataSync::syncData()
     sharedData->bin_mutex.unlock();
     if (!ok) return false;
 
+    //Lock-free, other threads' rings are only read
+    if (!syncLongFromOthers()) return false;
+
     lastSyncConf = solver->sumConflicts;
 
     return true;
@@ -240,6 +250,88 @@ void DataSync::syncBinToOthers()
     newBinClauses.clear();
 }
 
+bool DataSync::syncLongFromOthers()
+{
+    const uint32_t oldRecvLongData = stats.recvLongData;
+    const uint32_t oldLostLongData = stats.lostLongData;
+
+    uint32_t glue;
+    for(uint32_t t = 0; t < sharedData->longs.size(); t++) {
+        if (t == thread_num) {
+            continue;
+        }
+        const SharedData::LongRing& ring = *sharedData->longs[t];
+        const uint64_t head = ring.get_head();
+        uint64_t& finished = longSyncFinish[t];
+        if (head - finished > SharedData::LongRing::num_slots) {
+            stats.lostLongData += head - finished - SharedData::LongRing::num_slots;
+            finished = head - SharedData::LongRing::num_slots;
+        }
+
+        for(; finished < head; finished++) {
+            if (!ring.get(finished, tmp_long, glue)) {
+                stats.lostLongData++;
+                continue;
+            }
+            if (glue > solver->conf.sync_long_import_max_glue) {
+                continue;
+            }
+            if (!syncOneLongFromOthers(tmp_long, glue)) {
+                return false;
+            }
+        }
+    }
+
+    if (solver->conf.verbosity >= 3) {
+        cout
+        << "c [sync] got longs " << (stats.recvLongData - oldRecvLongData)
+        << " lost longs " << (stats.lostLongData - oldLostLongData)
+        << " sent longs so far " << stats.sentLongData
+        << endl;
+    }
+
+    return true;
+}
+
+bool DataSync::syncOneLongFromOthers(const vector<Lit>& lits, const uint32_t glue)
+{
+    vector<Lit>& ps = tmp_import;
+    ps.clear();
+    for(Lit lit: lits) {
+        if (lit.var() >= solver->nVarsOutside()) {
+            return true;
+        }
+        lit = solver->map_to_with_bva(lit);
+        lit = solver->varReplacer->get_lit_replaced_with_outer(lit);
+        lit = solver->map_outer_to_inter(lit);
+        if (solver->varData[lit.var()].removed != Removed::none) {
+            return true;
+        }
+        ps.push_back(lit);
+    }
+
+    ClauseStats cl_stats;
+    cl_stats.glue = std::min<uint32_t>(glue, ps.size());
+    cl_stats.last_touched = solver->sumConflicts;
+    cl_stats.which_red_array = 2;
+    if (glue <= solver->conf.glue_put_lev0_if_below_or_eq) {
+        cl_stats.which_red_array = 0;
+    } else if (glue <= solver->conf.glue_put_lev1_if_below_or_eq
+        && solver->conf.glue_put_lev1_if_below_or_eq != 0
+    ) {
+        cl_stats.which_red_array = 1;
+    }
+
+    //Don't add DRAT: it would add to the thread data, too
+    Clause* cl = solver->add_clause_int(ps, true, cl_stats, true, NULL, false);
+    if (cl != NULL) {
+        solver->longRedCls[cl_stats.which_red_array].push_back(solver->cl_alloc.get_offset(cl));
+    }
+    stats.recvLongData++;
+
+    return solver->okay();
+}
+
 void DataSync::addOneBinToOthers(Lit lit1, Lit lit2)
 {
     assert(lit1 < lit2);
@@ -351,3 +443,109 @@ void DataSync::signalNewBinClause(Lit lit1, Lit lit2)
     }
     newBinClauses.push_back(std::make_pair(lit1, lit2));
 }
+
+void DataSync::signalNewLongClause(const vector<Lit>& lits, const uint32_t glue)
+{
+    if (!enabled()
+        || glue > solver->conf.sync_long_max_glue
+        || lits.size() > solver->conf.sync_long_max_size
+        || lits.size() > SHARED_LONG_MAX_SIZE
+    ) {
+        return;
+    }
+
+    if (must_rebuild_bva_map) {
+        outer_to_without_bva_map = solver->build_outer_to_without_bva_map();
+        must_rebuild_bva_map = false;
+    }
+
+    tmp_long.clear();
+    for(Lit lit: lits) {
+        if (solver->varData[lit.var()].is_bva)
+            return;
+
+        lit = solver->map_inter_to_outer(lit);
+        tmp_long.push_back(map_outside_without_bva(lit));
+    }
+    sharedData->longs[thread_num]->push(tmp_long, glue);
+    stats.sentLongData++;
+}
+
+/**
+@brief Publishes this thread's score, and checks for a much better configuration
+
+If "may_switch", and the best thread's score is more than
+conf.portfolio_prune_ratio times this one's, "better" is set to the
+configuration that thread runs and true is returned. The new configuration
+starts without a score.
+*/
+bool DataSync::publish_progress(const double score, const bool may_switch, SolverConf& better)
+{
+    if (sharedData == NULL || sharedData->thread_confs.empty()) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(sharedData->progress_mutex);
+    vector<SharedData::Progress>& progress = sharedData->progress;
+    progress[thread_num].score = score;
+    if (!may_switch) {
+        return false;
+    }
+
+    uint32_t best = thread_num;
+    for(uint32_t i = 0; i < progress.size(); i++) {
+        if (progress[i].score > progress[best].score) {
+            best = i;
+        }
+    }
+    if (progress[best].conf_of == progress[thread_num].conf_of
+        || score >= solver->conf.portfolio_prune_ratio * progress[best].score
+    ) {
+        return false;
+    }
+
+    progress[thread_num].conf_of = progress[best].conf_of;
+    progress[thread_num].score = 0;
+    better = sharedData->thread_confs[progress[best].conf_of];
+    return true;
+}
+
+/**
+@brief Publishes the simplified problem of thread 0 to the waiting threads
+
+Called once the startup simplification of solve() or simplify() is over.
+If it is never reached, the library lets the waiting threads go without it.
+*/
+void DataSync::signalStartupSimplified(const lbool status)
+{
+    if (!enabled() || thread_num != 0) {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(sharedData->startup_mutex);
+    if (!sharedData->startup_pending) {
+        return;
+    }
+
+    if (status == l_Undef && solver->okay()) {
+        const double myTime = cpuTime();
+        SharedClauses* longs = NULL;
+        if (solver->conf.share_irred_longs) {
+            longs = &sharedData->irred_longs;
+        }
+        solver->export_simplified(sharedData->startup_cnf, longs);
+        sharedData->startup_cloned = true;
+        if (solver->conf.verbosity) {
+            cout
+            << "c [sync] exported simplified CNF, clauses lits: "
+            << sharedData->startup_cnf.cls.size()
+            << " elim stack lits: " << sharedData->startup_cnf.elim_stack.size()
+            << " shared long cls: " << sharedData->irred_longs.size()
+            << " lits: " << sharedData->irred_longs.lits.size()
+            << solver->conf.print_times(cpuTime() - myTime)
+            << endl;
+        }
+    }
+    sharedData->startup_pending = false;
+    sharedData->startup_cond.notify_all();
+}
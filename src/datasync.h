@@ -31,7 +31,7 @@ class Solver;
 class DataSync
 {
     public:
-        DataSync(Solver* solver, SharedData* sharedData);
+        DataSync(Solver* solver, SharedData* sharedData, uint32_t thread_num = 0);
         bool enabled();
         void new_var(const bool bva);
         void new_vars(const size_t n);
@@ -45,6 +45,9 @@ class DataSync
 
         template <class T> void signalNewBinClause(T& ps);
         void signalNewBinClause(Lit lit1, Lit lit2);
+        void signalNewLongClause(const vector<Lit>& lits, uint32_t glue);
+        void signalStartupSimplified(const lbool status);
+        bool publish_progress(const double score, const bool may_switch, SolverConf& better);
 
         struct Stats
         {
@@ -52,6 +55,9 @@ class DataSync
             uint32_t recvUnitData = 0;
             uint32_t sentBinData = 0;
             uint32_t recvBinData = 0;
+            uint32_t sentLongData = 0;
+            uint32_t recvLongData = 0;
+            uint32_t lostLongData = 0; ///<overwritten before we could read them
         };
         const Stats& get_stats() const;
 
@@ -65,6 +71,8 @@ class DataSync
         void clear_set_binary_values();
         void addOneBinToOthers(const Lit lit1, const Lit lit2);
         bool shareBinData();
+        bool syncLongFromOthers();
+        bool syncOneLongFromOthers(const vector<Lit>& lits, const uint32_t glue);
 
         //stuff to sync
         vector<std::pair<Lit, Lit> > newBinClauses;
@@ -72,17 +80,21 @@ class DataSync
         //stats
         uint64_t lastSyncConf = 0;
         vector<uint32_t> syncFinish;
+        vector<uint64_t> longSyncFinish; ///<position read up to, per thread
         Stats stats;
 
         //Other systems
         Solver* solver;
         SharedData* sharedData;
+        uint32_t thread_num;
 
         //misc
         vector<uint16_t>& seen;
         vector<Lit>& toClear;
         vector<uint32_t> outer_to_without_bva_map;
         bool must_rebuild_bva_map = false;
+        vector<Lit> tmp_long;
+        vector<Lit> tmp_import;
 };
 
 inline const DataSync::Stats& DataSync::get_stats() const
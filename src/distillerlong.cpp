@@ -166,7 +166,7 @@ bool DistillerLong::go_through_clauses(
         offset2 = try_distill_clause_and_return_new(
             offset
             , cl.red()
-            , cl.stats
+            , solver->cl_alloc.stats(cl)
         );
 
         #ifdef USE_GAUSS
@@ -24,12 +24,136 @@ THE SOFTWARE.
 #define __DRAT_H__
 
 #include "clause.h"
+#include "clauseallocator.h"
 #include <iostream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <memory>
 
 namespace CMSat {
 
 enum DratFlag{fin, deldelay, del, findelay, add};
 
+//Writes full proof buffers to the stream in a background thread, so the
+//search is not held up by a slow disk. It owns one buffer: the one being
+//written, or the free one once that is done. submit() swaps it with the
+//buffer just filled. If the previous buffer is still being written, the
+//search has to wait, which is counted as back-pressure.
+class DratWriter
+{
+    public:
+        DratWriter(std::ostream* _out, const size_t buf_size) :
+            out(_out)
+            , spare(new unsigned char[buf_size])
+        {
+            thr = std::thread(&DratWriter::write_loop, this);
+        }
+
+        ~DratWriter()
+        {
+            {
+                std::unique_lock<std::mutex> lock(mu);
+                cv.wait(lock, [&]{ return !busy; });
+                stopping = true;
+            }
+            cv.notify_all();
+            thr.join();
+            delete[] spare;
+        }
+
+        //Hands over "buf" with "len" bytes, returns the buffer to fill next
+        unsigned char* submit(unsigned char* buf, const size_t len)
+        {
+            std::unique_lock<std::mutex> lock(mu);
+            if (busy) {
+                const auto start = std::chrono::steady_clock::now();
+                cv.wait(lock, [&]{ return !busy; });
+                waits++;
+                wait_time += std::chrono::duration<double>(
+                    std::chrono::steady_clock::now() - start).count();
+            }
+            unsigned char* ret = spare;
+            spare = buf;
+            spare_len = len;
+            busy = true;
+            chunks++;
+            bytes += len;
+            lock.unlock();
+            cv.notify_all();
+            return ret;
+        }
+
+        //Waits until everything submitted is written
+        void wait_written()
+        {
+            std::unique_lock<std::mutex> lock(mu);
+            cv.wait(lock, [&]{ return !busy; });
+        }
+
+        void print_stats() const
+        {
+            print_stats_line("c DRAT written"
+                , (double)bytes/(1024.0*1024.0)
+                , "MB"
+            );
+            print_stats_line("c DRAT chunks written"
+                , chunks
+                , float_div(write_time, chunks)*1000.0
+                , "ms/chunk"
+            );
+            print_stats_line("c DRAT waited for disk"
+                , waits
+                , stats_line_percent(waits, chunks)
+                , "% chunks"
+            );
+            print_stats_line("c DRAT wait time"
+                , wait_time
+                , "s"
+            );
+        }
+
+    private:
+        void write_loop()
+        {
+            std::unique_lock<std::mutex> lock(mu);
+            for (;;) {
+                cv.wait(lock, [&]{ return busy || stopping; });
+                if (!busy) {
+                    return;
+                }
+
+                lock.unlock();
+                const auto start = std::chrono::steady_clock::now();
+                out->write((const char*)spare, spare_len);
+                const double took = std::chrono::duration<double>(
+                    std::chrono::steady_clock::now() - start).count();
+                lock.lock();
+
+                write_time += took;
+                busy = false;
+                cv.notify_all();
+            }
+        }
+
+        std::ostream* out;
+        std::thread thr;
+        std::mutex mu;
+        std::condition_variable cv;
+        unsigned char* spare;
+        size_t spare_len = 0;
+        bool busy = false;
+        bool stopping = false;
+
+        //Stats
+        uint64_t chunks = 0;
+        uint64_t bytes = 0;
+        uint64_t waits = 0;
+        double wait_time = 0;
+        double write_time = 0;
+};
+
 struct Drat
 {
     Drat()
@@ -93,15 +217,23 @@ struct Drat
     {
     }
 
+    virtual void print_stats() const
+    {
+    }
+
     int buf_len;
     unsigned char* drup_buf = 0;
     unsigned char* buf_ptr;
+    #ifdef STATS_NEEDED
+    const ClauseAllocator* cl_alloc = NULL; ///<To look up the ID of clauses
+    #endif
 };
 
 template<bool add_ID>
 struct DratFile: public Drat
 {
-    DratFile()
+    explicit DratFile(const bool _async = false) :
+        async(_async)
     {
         drup_buf = new unsigned char[2 * 1024 * 1024];
         buf_ptr = drup_buf;
@@ -115,6 +247,7 @@ struct DratFile: public Drat
 
     virtual ~DratFile()
     {
+        writer.reset();
         delete[] drup_buf;
         delete[] del_buf;
     }
@@ -169,17 +302,35 @@ struct DratFile: public Drat
     void flush() override
     {
         binDRUP_flush();
+        if (writer) {
+            writer->wait_written();
+        }
     }
 
     void binDRUP_flush() {
-        drup_file->write((const char*)drup_buf, buf_len);
+        if (writer) {
+            drup_buf = writer->submit(drup_buf, buf_len);
+        } else {
+            drup_file->write((const char*)drup_buf, buf_len);
+        }
         buf_ptr = drup_buf;
         buf_len = 0;
     }
 
     void setFile(std::ostream* _file) override
     {
+        writer.reset();
         drup_file = _file;
+        if (async) {
+            writer.reset(new DratWriter(drup_file, 2 * 1024 * 1024));
+        }
+    }
+
+    void print_stats() const override
+    {
+        if (writer) {
+            writer->print_stats();
+        }
     }
 
     bool get_conf_id() override {
@@ -234,7 +385,7 @@ struct DratFile: public Drat
             #ifdef STATS_NEEDED
             id_set = true;
             if (is_add && add_ID) {
-                ID = cl.stats.ID;
+                ID = cl_alloc->stats(cl).ID;
 
                 // actually... for on-the-fly subsumed irred clauses can have an ID.
                 //assert(!(ID != 0 && !cl.red()));
@@ -339,6 +490,8 @@ struct DratFile: public Drat
     }
 
     std::ostream* drup_file = NULL;
+    const bool async;
+    std::unique_ptr<DratWriter> writer;
     #ifdef STATS_NEEDED
     int64_t ID = 0;
     int64_t sumConflicts = std::numeric_limits<int64_t>::max();
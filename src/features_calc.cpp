@@ -85,6 +85,10 @@ void SolveFeaturesCalc::for_one_clause(
             break;
         }
 
+        case CMSat::watch_shared_t:
+            //Only the clauses of this thread are counted
+            break;
+
         case CMSat::watch_idx_t: {
              // This should never be here
             assert(false);
@@ -294,10 +298,11 @@ void SolveFeaturesCalc::calculate_cl_distributions(
     for(ClOffset off: clauses)
     {
         const Clause& cl = *solver->cl_alloc.ptr(off);
+        const ClauseStats& stats = solver->cl_alloc.stats(cl);
         size_mean += cl.size();
-        glue_mean += cl.stats.glue;
+        glue_mean += stats.glue;
         if (cl.red()) {
-            activity_mean += (double)cl.stats.activity/cla_inc;
+            activity_mean += (double)stats.activity/cla_inc;
         }
     }
     size_mean /= clauses.size();
@@ -308,9 +313,10 @@ void SolveFeaturesCalc::calculate_cl_distributions(
     for(ClOffset off: clauses)
     {
         const Clause& cl = *solver->cl_alloc.ptr(off);
+        const ClauseStats& stats = solver->cl_alloc.stats(cl);
         size_var += std::pow(size_mean-cl.size(), 2);
-        glue_var += std::pow(glue_mean-cl.stats.glue, 2);
-        activity_var += std::pow(activity_mean-(double)cl.stats.activity/cla_inc, 2);
+        glue_var += std::pow(glue_mean-stats.glue, 2);
+        activity_var += std::pow(activity_mean-(double)stats.activity/cla_inc, 2);
     }
     size_var /= clauses.size();
     glue_var /= clauses.size();
@@ -23,6 +23,9 @@ THE SOFTWARE.
 #ifndef GQUEUEDATA_H__
 #define GQUEUEDATA_H__
 
+#include <vector>
+#include "xor.h"
+
 namespace CMSat {
 
 struct GaussQData {
@@ -62,6 +65,14 @@ struct GaussQData {
 
 };
 
+//An EGaussian's matrix, kept between searches so it's not eliminated again
+struct GaussKept {
+    vector<Xor> input;          // XORs the matrix was made of
+    vector<Xor> rows;           // rows of the matrix, same space as input
+    vector<uint32_t> col_order; // basic var of each row first, then the rest
+    double elim_time;           // time the elimination took from scratch
+};
+
 }
 
 #endif
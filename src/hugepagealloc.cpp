@@ -0,0 +1,236 @@
+/******************************************
+Copyright (c) 2016, Mate Soos
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+***********************************************/
+
+#include "hugepagealloc.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#ifdef USE_HUGEPAGES
+#include <sys/mman.h>
+#endif
+
+#if defined(__linux__)
+#include <unistd.h>
+#include <sys/syscall.h>
+#endif
+
+using namespace CMSat;
+using std::string;
+
+#ifdef USE_HUGEPAGES
+static const size_t HUGE_PAGE_SIZE = 2ULL*1024ULL*1024ULL;
+
+static size_t round_to_huge(const size_t bytes)
+{
+    return ((bytes + HUGE_PAGE_SIZE - 1)/HUGE_PAGE_SIZE)*HUGE_PAGE_SIZE;
+}
+
+//mmap() only aligns to the base page size. Maps an extra huge page and
+//unmaps the parts before and after the 2MB-aligned "len" bytes.
+static void* map_aligned(const size_t len)
+{
+    void* ptr = mmap(NULL, len + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE
+        , MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ptr == MAP_FAILED) {
+        return NULL;
+    }
+
+    const uintptr_t start = (uintptr_t)ptr;
+    const uintptr_t aligned = (start + HUGE_PAGE_SIZE - 1) & ~(uintptr_t)(HUGE_PAGE_SIZE - 1);
+    if (aligned > start) {
+        munmap(ptr, aligned - start);
+    }
+    const size_t after = start + HUGE_PAGE_SIZE - aligned;
+    if (after > 0) {
+        munmap((void*)(aligned + len), after);
+    }
+    return (void*)aligned;
+}
+
+void* CMSat::huge_alloc(const size_t bytes, const bool explicit_huge)
+{
+    const size_t len = round_to_huge(bytes);
+    void* ptr = MAP_FAILED;
+    #ifdef MAP_HUGETLB
+    if (explicit_huge) {
+        ptr = mmap(NULL, len, PROT_READ | PROT_WRITE
+            , MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    }
+    #endif
+
+    //No (or not enough) reserved huge pages, fall back to transparent ones
+    if (ptr == MAP_FAILED) {
+        ptr = map_aligned(len);
+        if (ptr == NULL) {
+            return NULL;
+        }
+        #ifdef MADV_HUGEPAGE
+        madvise(ptr, len, MADV_HUGEPAGE);
+        #endif
+    }
+
+    return ptr;
+}
+
+void* CMSat::huge_realloc(
+    void* ptr
+    , const size_t old_bytes
+    , const size_t new_bytes
+    , const bool explicit_huge
+) {
+    if (ptr == NULL) {
+        return huge_alloc(new_bytes, explicit_huge);
+    }
+
+    const size_t old_len = round_to_huge(old_bytes);
+    const size_t new_len = round_to_huge(new_bytes);
+    if (old_len == new_len) {
+        return ptr;
+    }
+
+    //Grow or shrink in place, or else move the pages to a new 2MB-aligned
+    //place. The start of the mapping stays aligned either way.
+    void* new_ptr = mremap(ptr, old_len, new_len, 0);
+    if (new_ptr == MAP_FAILED) {
+        void* to = map_aligned(new_len);
+        if (to != NULL) {
+            new_ptr = mremap(ptr, old_len, new_len, MREMAP_MAYMOVE | MREMAP_FIXED, to);
+            if (new_ptr == MAP_FAILED) {
+                munmap(to, new_len);
+            }
+        }
+    }
+    if (new_ptr != MAP_FAILED) {
+        #ifdef MADV_HUGEPAGE
+        madvise(new_ptr, new_len, MADV_HUGEPAGE);
+        #endif
+        return new_ptr;
+    }
+
+    //Some kernels cannot mremap() explicit huge pages
+    new_ptr = huge_alloc(new_bytes, explicit_huge);
+    if (new_ptr == NULL) {
+        return NULL;
+    }
+    memcpy(new_ptr, ptr, std::min(old_bytes, new_bytes));
+    munmap(ptr, old_len);
+    return new_ptr;
+}
+
+void CMSat::huge_free(void* ptr, const size_t bytes)
+{
+    if (ptr == NULL) {
+        return;
+    }
+    munmap(ptr, round_to_huge(bytes));
+}
+
+#else
+void* CMSat::huge_alloc(const size_t bytes, const bool)
+{
+    return malloc(bytes);
+}
+
+void* CMSat::huge_realloc(
+    void* ptr
+    , const size_t
+    , const size_t new_bytes
+    , const bool
+) {
+    return realloc(ptr, new_bytes);
+}
+
+void CMSat::huge_free(void* ptr, const size_t)
+{
+    free(ptr);
+}
+#endif //USE_HUGEPAGES
+
+#if defined(__linux__) && defined(SYS_getcpu)
+int CMSat::current_numa_node()
+{
+    unsigned cpu = 0;
+    unsigned node = 0;
+    if (syscall(SYS_getcpu, &cpu, &node, NULL) != 0) {
+        return -1;
+    }
+    return (int)node;
+}
+#else
+int CMSat::current_numa_node()
+{
+    return -1;
+}
+#endif
+
+#if defined(__linux__)
+uint64_t CMSat::huge_bytes_backing(const std::vector<const void*>& ptrs)
+{
+    if (ptrs.empty()) {
+        return 0;
+    }
+
+    std::ifstream smaps("/proc/self/smaps");
+    bool inside = false;
+    uint64_t huge_kb = 0;
+    string line;
+    while (std::getline(smaps, line)) {
+        //Mapping header, e.g. "7f0c2a000000-7f0c2c000000 rw-p ..."
+        const size_t dash = line.find('-');
+        if (dash != string::npos
+            && line.find(':') > line.find(' ')
+        ) {
+            const uintptr_t start = std::stoull(line.substr(0, dash), NULL, 16);
+            const uintptr_t end = std::stoull(line.substr(dash+1), NULL, 16);
+            inside = false;
+            for(const void* ptr: ptrs) {
+                const uintptr_t addr = (uintptr_t)ptr;
+                inside |= (start <= addr && addr < end);
+            }
+            continue;
+        }
+
+        if (!inside) {
+            continue;
+        }
+        std::istringstream ss(line);
+        string name;
+        uint64_t kb = 0;
+        ss >> name >> kb;
+        if (name == "AnonHugePages:" || name == "Private_Hugetlb:") {
+            huge_kb += kb;
+        }
+    }
+
+    return huge_kb*1024ULL;
+}
+#else
+uint64_t CMSat::huge_bytes_backing(const std::vector<const void*>&)
+{
+    return 0;
+}
+#endif
@@ -0,0 +1,60 @@
+/******************************************
+Copyright (c) 2016, Mate Soos
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+***********************************************/
+
+#ifndef HUGEPAGEALLOC_H
+#define HUGEPAGEALLOC_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace CMSat {
+
+/**
+@brief Allocation of large buffers that are accessed randomly
+
+With USE_HUGEPAGES (Linux only) the buffers are mmap()-ed, rounded up to
+2MB and aligned to 2MB, so every page of them can be a huge one, and
+advised to be backed by transparent huge pages, which cuts the number of
+TLB misses. If explicit huge pages are requested and the system has some
+reserved, those are tried first. Growing uses mremap(), so the pages are
+moved instead of copied.
+
+Otherwise these fall back to malloc(), realloc() and free(). In both cases
+the memory is placed on the NUMA node of the thread that first touches it.
+
+The size must be passed back to huge_realloc() and huge_free(), as it is
+needed by munmap().
+*/
+void* huge_alloc(size_t bytes, bool explicit_huge = false);
+void* huge_realloc(void* ptr, size_t old_bytes, size_t new_bytes, bool explicit_huge = false);
+void huge_free(void* ptr, size_t bytes);
+
+///NUMA node of the CPU the calling thread runs on, -1 if unknown
+int current_numa_node();
+
+///Number of bytes in huge pages, of the mappings that contain any of ptrs
+uint64_t huge_bytes_backing(const std::vector<const void*>& ptrs);
+
+}
+
+#endif //HUGEPAGEALLOC_H
@@ -789,6 +789,8 @@ Lit HyperEngine::analyzeFail(const PropBy propBy)
             break;
         }
 
+        //Shared clauses are not watched while probing
+        case shared_t:
         case null_clause_t:
             assert(false);
             break;
@@ -990,13 +992,19 @@ PropResult HyperEngine::prop_normal_cl_with_ancestor_info(
         *j++ = *i;
         return PROP_NOTHING;
     }
+    #ifdef INLINE_TERNARY_WATCH
+    if (i->isTernary() && value(i->lit3()) == l_True) {
+        *j++ = *i;
+        return PROP_NOTHING;
+    }
+    #endif
 
     //Dereference pointer
     propStats.bogoProps += 4;
     const ClOffset offset = i->get_offset();
     Clause& c = *cl_alloc.ptr(offset);
     #ifdef STATS_NEEDED
-    c.stats.clause_looked_at++;
+    cl_alloc.stats(c).clause_looked_at++;
     #endif
 
     PropResult ret = prop_normal_helper(c, offset, j, p);
@@ -1011,7 +1019,7 @@ PropResult HyperEngine::prop_normal_cl_with_ancestor_info(
 
     //Update stats
     #ifdef STATS_NEEDED
-    c.stats.propagations_made++;
+    cl_alloc.stats(c).propagations_made++;
     if (c.red())
         propStats.propsLongRed++;
     else
@@ -49,8 +49,13 @@ THE SOFTWARE.
 #include "main_common.h"
 #include "time_mem.h"
 #include "dimacsparser.h"
+#include "paralleldimacsparser.h"
+#include "backgroundreader.h"
+#include "binarycnfparser.h"
+#include "compressedostream.h"
 #include "cryptominisat5/cryptominisat.h"
 #include "signalcode.h"
+#include "cpupin.h"
 
 #include <boost/lexical_cast.hpp>
 using namespace CMSat;
@@ -102,35 +107,94 @@ Main::Main(int _argc, char** _argv) :
 {
 }
 
+bool Main::parseInParallel(
+    SATSolver* solver2
+    , const string& filename
+    , vector<uint32_t>& indep
+) {
+    if (parse_threads <= 1 || !debugLib.empty()) {
+        return false;
+    }
+
+    ParallelDimacsParser parser(solver2, parse_threads, conf.verbosity);
+    if (!parser.open(filename)) {
+        //e.g. compressed, the normal parser deals with it
+        return false;
+    }
+
+    bool strict_header = conf.preprocess;
+    if (!parser.parse_DIMACS(strict_header)) {
+        exit(-1);
+    }
+    indep.swap(parser.independent_vars);
+    return true;
+}
+
+bool Main::parseBinaryCNF(
+    SATSolver* solver2
+    , const string& filename
+    , vector<uint32_t>& indep
+) {
+    BinaryCNFParser parser(solver2, conf.verbosity);
+    if (!parser.open(filename)) {
+        return false;
+    }
+    if (conf.verbosity) {
+        cout << "c Input format: binary CNF" << endl;
+    }
+
+    if (!parser.parse()) {
+        exit(-1);
+    }
+    indep.swap(parser.independent_vars);
+    return true;
+}
+
 void Main::readInAFile(SATSolver* solver2, const string& filename)
 {
     solver2->add_sql_tag("filename", filename);
     if (conf.verbosity) {
         cout << "c Reading file '" << filename << "'" << endl;
     }
-    #ifndef USE_ZLIB
-    FILE * in = fopen(filename.c_str(), "rb");
-    DimacsParser<StreamBuffer<FILE*, FN> > parser(solver2, &debugLib, conf.verbosity);
-    #else
-    gzFile in = gzopen(filename.c_str(), "rb");
-    DimacsParser<StreamBuffer<gzFile, GZ> > parser(solver2, &debugLib, conf.verbosity);
-    #endif
 
-    if (in == NULL) {
-        std::cerr
-        << "ERROR! Could not open file '"
-        << filename
-        << "' for reading: " << strerror(errno) << endl;
-
-        std::exit(1);
-    }
+    vector<uint32_t> indep_in_file;
+    if (!parseBinaryCNF(solver2, filename, indep_in_file)
+        && !parseInParallel(solver2, filename, indep_in_file)
+    ) {
+        FILE * in = fopen(filename.c_str(), "rb");
+        if (in == NULL) {
+            std::cerr
+            << "ERROR! Could not open file '"
+            << filename
+            << "' for reading: " << strerror(errno) << endl;
+
+            std::exit(1);
+        }
 
-    bool strict_header = conf.preprocess;
-    if (!parser.parse_DIMACS(in, strict_header)) {
-        exit(-1);
+        {
+            BackgroundReader reader(in, decomp_threads);
+            if (conf.verbosity) {
+                cout << "c Input format: " << reader.format() << endl;
+            }
+            if (reader.starts_with(binary_cnf_magic, sizeof(binary_cnf_magic))) {
+                BinaryCNFParser parser(solver2, conf.verbosity);
+                if (!parser.parse(&reader)) {
+                    exit(-1);
+                }
+                indep_in_file.swap(parser.independent_vars);
+            } else {
+                DimacsParser<StreamBuffer<BackgroundReader*, BG> > parser(solver2, &debugLib, conf.verbosity);
+                bool strict_header = conf.preprocess;
+                if (!parser.parse_DIMACS(&reader, strict_header)) {
+                    exit(-1);
+                }
+                indep_in_file.swap(parser.independent_vars);
+            }
+        }
+        fclose(in);
     }
 
-    if (!independent_vars_str.empty() && !parser.independent_vars.empty()) {
+    if (!independent_vars_str.empty() && !indep_in_file.empty()) {
         cerr << "ERROR! Independent vars set in console but also in CNF." << endl;
         exit(-1);
     }
@@ -149,7 +213,7 @@ void Main::readInAFile(SATSolver* solver2, const string& filename)
                 ss.ignore();
         }
     } else {
-        independent_vars.swap(parser.independent_vars);
+        independent_vars.swap(indep_in_file);
     }
 
     if (independent_vars.empty()) {
@@ -169,12 +233,6 @@ void Main::readInAFile(SATSolver* solver2, const string& filename)
         cout << endl;
     }
     call_after_parse();
-
-    #ifndef USE_ZLIB
-        fclose(in);
-    #else
-        gzclose(in);
-    #endif
 }
 
 void Main::readInStandardInput(SATSolver* solver2)
@@ -185,30 +243,18 @@ void Main::readInStandardInput(SATSolver* solver2)
         << endl;
     }
 
-    #ifndef USE_ZLIB
-    FILE * in = stdin;
-    #else
-    gzFile in = gzdopen(0, "rb"); //opens stdin, which is 0
-    #endif
-
-    if (in == NULL) {
-        std::cerr << "ERROR! Could not open standard input for reading" << endl;
-        std::exit(1);
+    BackgroundReader reader(stdin, decomp_threads);
+    if (reader.starts_with(binary_cnf_magic, sizeof(binary_cnf_magic))) {
+        BinaryCNFParser parser(solver2, conf.verbosity);
+        if (!parser.parse(&reader)) {
+            exit(-1);
+        }
+        return;
     }
-
-    #ifndef USE_ZLIB
-    DimacsParser<StreamBuffer<FILE*, FN> > parser(solver2, &debugLib, conf.verbosity);
-    #else
-    DimacsParser<StreamBuffer<gzFile, GZ> > parser(solver2, &debugLib, conf.verbosity);
-    #endif
-
-    if (!parser.parse_DIMACS(in, false)) {
+    DimacsParser<StreamBuffer<BackgroundReader*, BG> > parser(solver2, &debugLib, conf.verbosity);
+    if (!parser.parse_DIMACS(&reader, false)) {
         exit(-1);
     }
-
-    #ifdef USE_ZLIB
-        gzclose(in);
-    #endif
 }
 
 void Main::parseInAllFiles(SATSolver* solver2)
@@ -307,6 +353,10 @@ void Main::add_supported_options()
         , "[0..] Random seed")
     ("threads,t", po::value(&num_threads)->default_value(1)
         ,"Number of threads")
+    ("parsethreads", po::value(&parse_threads)->default_value(parse_threads)
+        ,"Number of threads to parse an uncompressed CNF file with")
+    ("decompthreads", po::value(&decomp_threads)->default_value(decomp_threads)
+        ,"Number of threads to decompress a BGZF (blocked gzip) CNF file with. Compressed input is always decompressed in a background thread")
     ("maxtime", po::value(&conf.maxTime)->default_value(conf.maxTime, "MAX")
         , "Stop solving after this much time (s)")
     ("maxconfl", po::value(&conf.max_confl)->default_value(conf.max_confl, "MAX")
@@ -483,6 +533,10 @@ void Main::add_supported_options()
         , "Time-out in bogoprops M of subsumption of long clauses with long clauses, after computing occur")
     ("strstimelim", po::value(&conf.strengthening_time_limitM)->default_value(conf.strengthening_time_limitM)
         , "Time-out in bogoprops M of strengthening of long clauses with long clauses, after computing occur")
+    ("substhreads", po::value(&conf.subsume_threads)->default_value(conf.subsume_threads)
+        , "Threads that search for subsumed and strengthened long clauses. Above 1, clauses are searched in parallel and the changes are made one after the other")
+    ("subsbatch", po::value(&conf.subsume_batch)->default_value(conf.subsume_batch)
+        , "Number of clauses searched in parallel at once, if substhreads is above 1")
     ;
 
     po::options_description bva_options("BVA options");
@@ -513,6 +567,10 @@ void Main::add_supported_options()
         , "Eliminate this ratio of free variables at most per variable elimination iteration")
     ("skipresol", po::value(&conf.skip_some_bve_resolvents)->default_value(conf.skip_some_bve_resolvents)
         , "Skip BVE resolvents in case they belong to a gate")
+    ("varelimthreads", po::value(&conf.varelim_threads)->default_value(conf.varelim_threads)
+        , "Threads that compute BVE resolvents. Above 1, variables that share no clause are tested in parallel and eliminated one after the other")
+    ("varelimbatch", po::value(&conf.varelim_batch)->default_value(conf.varelim_batch)
+        , "Number of independent variables tested in parallel at once, if varelimthreads is above 1")
     ("agrelimtimelim", po::value(&conf.aggressive_elim_time_limitM)->default_value(conf.aggressive_elim_time_limitM)
         , "Time-out in bogoprops M of aggressive(=uses reverse distillation) var-elimination")
     ;
@@ -594,6 +652,8 @@ void Main::add_supported_options()
         , "Update glues while analyzing")
     ("otfhyper", po::value(&conf.otfHyperbin)->default_value(conf.otfHyperbin)
         , "Perform hyper-binary resolution at dec. level 1 after every restart and during probing")
+    ("binfirst", po::value(&conf.propBinFirst)->default_value(conf.propBinFirst)
+        , "Keep binary clauses at the front of watchlists and propagate all binary implications before long clauses")
     ;
 
 
@@ -666,6 +726,12 @@ void Main::add_supported_options()
         , "Save memory by deallocating variable space after renumbering. Only works if renumbering is active.")
     ("fullwatchconseveryn", po::value(&conf.full_watch_consolidate_every_n_confl)->default_value(conf.full_watch_consolidate_every_n_confl)
         , "Consolidate watchlists fully once every N conflicts. Scheduled during simplification rounds.")
+    ("clconsact", po::value(&conf.consolidate_in_act_order)->default_value(conf.consolidate_in_act_order)
+        , "When compacting clause memory, place long clauses in the order of the watchlists of the most active variables, so clauses propagated together are close in memory")
+    #ifdef USE_HUGEPAGES
+    ("hugetlb", po::value(&conf.explicit_hugepages)->default_value(conf.explicit_hugepages)
+        , "Put long clauses into reserved 2MB pages (see /proc/sys/vm/nr_hugepages) if available, instead of transparent huge pages")
+    #endif
 
     ("implicitmanip", po::value(&conf.doStrSubImplicit)->default_value(conf.doStrSubImplicit)
         , "Subsume and strengthen implicit clauses with each other")
@@ -686,6 +752,30 @@ void Main::add_supported_options()
     hiddenOptions.add_options()
     ("sync", po::value(&conf.sync_every_confl)->default_value(conf.sync_every_confl)
         , "Sync threads every N conflicts")
+    ("synclongglue", po::value(&conf.sync_long_max_glue)->default_value(conf.sync_long_max_glue)
+        , "Share learnt long clauses with other threads if their glue is at most this. 0 = don't share")
+    ("synclongsize", po::value(&conf.sync_long_max_size)->default_value(conf.sync_long_max_size)
+        , "Share learnt long clauses with other threads if they have at most this many literals (max 16)")
+    ("synclongimport", po::value(&conf.sync_long_import_max_glue)->default_value(conf.sync_long_import_max_glue)
+        , "Import long clauses from other threads if their glue is at most this")
+    ("clonesimp", po::value(&conf.clone_startup_simplify)->default_value(conf.clone_startup_simplify)
+        , "With multiple threads, only thread 0 does the startup simplification, the others start from a copy of its result")
+    ("sharelongs", po::value(&conf.share_irred_longs)->default_value(conf.share_irred_longs)
+        , "As --clonesimp, but the other threads share one read-only copy of the long irredundant clauses. They don't eliminate, replace or renumber variables")
+    ("cube", po::value(&conf.cube_and_conquer)->default_value(conf.cube_and_conquer)
+        , "With multiple threads, split the problem into cubes by lookahead and solve them in parallel, instead of racing the threads on the whole problem. Overrides --clonesimp and --sharelongs")
+    ("cubeconfl", po::value(&conf.cube_confl_budget)->default_value(conf.cube_confl_budget)
+        , "Split a cube further if it is not solved in this many conflicts")
+    ("cubelookahead", po::value(&conf.cube_lookahead_vars)->default_value(conf.cube_lookahead_vars)
+        , "Number of most active variables the lookahead tries when splitting a cube")
+    ("pin", po::value(&conf.pin_threads)->default_value(conf.pin_threads)
+        , "Pin threads to CPUs: 'cores' (one CPU each), 'numa' (spread over NUMA nodes), 'cpus:A,B,..' or 'nodes:A,B,..' (thread i to the i-th CPU or node listed). Empty = don't pin")
+    ("adaptport", po::value(&conf.adaptive_portfolio)->default_value(conf.adaptive_portfolio)
+        , "With multiple threads, threads doing much worse than the best one switch to its search configuration")
+    ("adaptwarmup", po::value(&conf.portfolio_warmup_confl)->default_value(conf.portfolio_warmup_confl)
+        , "Conflicts a thread does with a configuration before it is compared to the others")
+    ("adaptratio", po::value(&conf.portfolio_prune_ratio)->default_value(conf.portfolio_prune_ratio)
+        , "Switch to the best configuration if the score is below this ratio of the best score")
     ("dratdebug", po::bool_switch(&dratDebug)
         , "Output DRAT verification into the console. Helpful to see where DRAT fails -- use in conjunction with --verb 20")
     ("clearinter", po::value(&need_clean_exit)->default_value(0)
@@ -697,8 +787,15 @@ void Main::add_supported_options()
         , "Print time it took for each simplification run. If set to 0, logs are easier to compare")
     ("drat,d", po::value(&dratfilname)
         , "Put DRAT verification information into this file")
+    ("dratcompress", po::value(&drat_compress)->default_value(drat_compress)
+        , std::string("Compress the DRAT file while writing it. Supported:"
+            " none" + CompressedOStream::supported_formats()).c_str())
+    ("dratasync", po::value(&conf.drat_async)->default_value(conf.drat_async)
+        , "Write the DRAT file in a background thread, so the search does not wait for the disk")
     ("savedstate", po::value(&conf.saved_state_file)->default_value(conf.saved_state_file)
         , "The file to save the saved state of the solver")
+    ("binarycnf", po::value(&conf.simplified_cnf_binary)->default_value(conf.simplified_cnf_binary)
+        , "Write the simplified CNF of '--preproc 1' in the binary CNF format, which loads much faster than DIMACS")
     ("maxsccdepth", po::value(&conf.max_scc_depth)->default_value(conf.max_scc_depth)
         , "The maximum for scc search depth")
     ("simdrat", po::value(&conf.simulate_drat)->default_value(conf.simulate_drat)
@@ -726,6 +823,8 @@ void Main::add_supported_options()
         " matrixes are discarded for reasons of efficiency")
     ("maxnummatrixes", po::value(&conf.gaussconf.max_num_matrixes)->default_value(conf.gaussconf.max_num_matrixes)
         , "Maximum number of matrixes to treat.")
+    ("m4rielim", po::value(&conf.gaussconf.m4r_eliminate)->default_value(conf.gaussconf.m4r_eliminate)
+        , "Do the initial elimination of matrixes by the Method of Four Russians, 8 columns at a time")
     ;
 #endif //USE_GAUSS
 
@@ -779,13 +878,18 @@ void Main::check_options_correctness()
         {
             cout
             << "A universal, fast SAT solver with XOR and Gaussian Elimination support. " << endl
-            << "Input "
-            #ifndef USE_ZLIB
-            << "must be plain"
-            #else
-            << "can be either plain or gzipped"
+            << "Input is DIMACS with XOR extension, either plain or compressed"
+            << " (supported:"
+            #ifdef USE_ZLIB
+            << " gzip"
+            #endif
+            #ifdef USE_ZSTD
+            << " zstd"
             #endif
-            << " DIMACS with XOR extension" << endl << endl;
+            #ifdef USE_LZMA
+            << " xz"
+            #endif
+            << ")" << endl << endl;
 
             cout
             << "cryptominisat5 [options] inputfile [drat-trim-file]" << endl << endl;
@@ -814,13 +918,17 @@ void Main::check_options_correctness()
             << "USAGE 2: " << argv[0] << " --preproc 1 [options] inputfile simplified-cnf-file" << endl
             << "USAGE 2: " << argv[0] << " --preproc 2 [options] solution-file" << endl
 
-            << " where input is "
-            #ifndef USE_ZLIB
-            << "plain"
-            #else
-            << "plain or gzipped"
+            << " where input is plain or compressed DIMACS (supported:"
+            #ifdef USE_ZLIB
+            << " gzip"
+            #endif
+            #ifdef USE_ZSTD
+            << " zstd"
             #endif
-            << " DIMACS." << endl;
+            #ifdef USE_LZMA
+            << " xz"
+            #endif
+            << ")." << endl;
 
             cout << help_options_simple << endl;
             std::exit(0);
@@ -913,6 +1021,9 @@ void Main::handle_drat_option()
     if (!conf.simulate_drat) {
         if (dratDebug) {
             dratf = &cout;
+
+            //The console is also written by the search
+            conf.drat_async = false;
         } else {
             std::ofstream* dratfTmp = new std::ofstream;
             dratfTmp->open(dratfilname.c_str(), std::ofstream::out | std::ofstream::binary);
@@ -926,6 +1037,18 @@ void Main::handle_drat_option()
                 std::exit(-1);
             }
             dratf = dratfTmp;
+
+            if (drat_compress != "none") {
+                if (!CompressedOStream::supported(drat_compress)) {
+                    std::cerr
+                    << "ERROR: DRAT compression '" << drat_compress
+                    << "' is not supported. Supported:"
+                    << " none" << CompressedOStream::supported_formats()
+                    << endl;
+                    std::exit(-1);
+                }
+                dratf = new CompressedOStream(dratfTmp, drat_compress);
+            }
         }
     }
 
@@ -1116,6 +1239,13 @@ void Main::manually_parse_some_options()
 
     parse_restart_type();
 
+    //The library only reads it once it starts the threads
+    try {
+        cpu_sets_for_threads(conf.pin_threads, num_threads);
+    } catch(std::invalid_argument&) {
+        throw WrongParam("pin", "invalid thread pinning '--pin " + conf.pin_threads + "'");
+    }
+
     if (conf.preprocess == 2) {
         if (vm.count("input") == 0) {
             cout << "ERROR: When post-processing you must give the solution as the positional argument"
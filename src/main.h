@@ -44,14 +44,15 @@ class Main
         Main(int argc, char** argv);
         ~Main()
         {
+            //The solver may still be writing the DRAT file
+            delete solver;
+
             if (dratf) {
                 *dratf << std::flush;
                 if (dratf != &std::cout) {
                     delete dratf;
                 }
             }
-
-            delete solver;
         }
 
         void parseCommandLine();
@@ -64,6 +65,7 @@ class Main
         char** argv;
         string var_elim_strategy;
         string dratfilname;
+        string drat_compress = "none";
         void check_options_correctness();
         void manually_parse_some_options();
         void handle_drat_option();
@@ -92,6 +94,8 @@ class Main
         void readInAFile(SATSolver* solver2, const string& filename);
         void readInStandardInput(SATSolver* solver2);
         void parseInAllFiles(SATSolver* solver2);
+        bool parseInParallel(SATSolver* solver2, const string& filename, vector<uint32_t>& indep);
+        bool parseBinaryCNF(SATSolver* solver2, const string& filename, vector<uint32_t>& indep);
 
         //Helper functions
         void printResultFunc(
@@ -111,6 +115,8 @@ class Main
         int printResult = true;
         string commandLine;
         unsigned num_threads = 1;
+        unsigned parse_threads = 1;
+        unsigned decomp_threads = 1;
         uint32_t max_nr_of_solutions = 1;
         int sql = 0;
         string sqlite_filename;
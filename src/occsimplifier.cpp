@@ -33,6 +33,7 @@ THE SOFTWARE.
 #include <limits>
 #include <cmath>
 #include <functional>
+#include <atomic>
 
 
 #include "popcnt.h"
@@ -55,6 +56,7 @@ THE SOFTWARE.
 #include "xorfinder.h"
 #include "bva.h"
 #include "trim.h"
+#include "threadpool.h"
 
 #ifdef USE_M4RI
 #include "toplevelgauss.h"
@@ -92,6 +94,7 @@ OccSimplifier::OccSimplifier(Solver* _solver):
     , seen2(solver->seen2)
     , toClear(solver->toClear)
     , velim_order(VarOrderLt(varElimComplexity))
+    , main_elim(solver->seen, solver->toClear)
     , topLevelGauss(NULL)
     //, gateFinder(NULL)
     , anythingHasBeenBlocked(false)
@@ -116,6 +119,10 @@ OccSimplifier::~OccSimplifier()
     delete bva;
     delete topLevelGauss;
     delete sub_str;
+    delete elim_pool;
+    for(VarElimWorker* w: elim_workers) {
+        delete w;
+    }
     //delete gateFinder;
 }
 
@@ -663,15 +670,16 @@ void OccSimplifier::add_back_to_solver()
         if (complete_clean_clause(*cl)) {
             solver->attachClause(*cl);
             if (cl->red()) {
-                if (cl->stats.glue <= solver->conf.glue_put_lev0_if_below_or_eq) {
-                    cl->stats.which_red_array = 0;
+                ClauseStats& stats = solver->cl_alloc.stats(*cl);
+                if (stats.glue <= solver->conf.glue_put_lev0_if_below_or_eq) {
+                    stats.which_red_array = 0;
                 } else if (
-                    cl->stats.glue <= solver->conf.glue_put_lev1_if_below_or_eq
+                    stats.glue <= solver->conf.glue_put_lev1_if_below_or_eq
                     && solver->conf.glue_put_lev1_if_below_or_eq != 0
                 ) {
-                    cl->stats.which_red_array = 1;
+                    stats.which_red_array = 1;
                 }
-                solver->longRedCls[cl->stats.which_red_array].push_back(offs);
+                solver->longRedCls[stats.which_red_array].push_back(offs);
             } else {
                 solver->longIrredCls.push_back(offs);
             }
@@ -891,10 +899,10 @@ bool OccSimplifier::deal_with_added_cl_to_var_lit(const Lit lit)
             Clause* cl = solver->cl_alloc.ptr(offs);
 
             //Has already been removed or added to "added_long_cl"
-            if (cl->freed() || cl->getRemoved() || cl->stats.marked_clause)
+            if (cl->freed() || cl->getRemoved() || solver->cl_alloc.stats(*cl).marked_clause)
                 continue;
 
-            cl->stats.marked_clause = 1;
+            solver->cl_alloc.stats(*cl).marked_clause = 1;
             added_long_cl.push_back(offs);
         }
     }
@@ -1047,6 +1055,12 @@ bool OccSimplifier::eliminate_vars()
                 && !solver->must_interrupt_asap()
             ) {
                 assert(limit_to_decrease == &norm_varelim_time_limit);
+                if (solver->conf.varelim_threads > 1) {
+                    if (!eliminate_batch(vars_elimed, last_elimed, wenThrough)) {
+                        goto end;
+                    }
+                    continue;
+                }
                 uint32_t var = velim_order.removeMin();
 
                 //Stats
@@ -2053,23 +2067,24 @@ void OccSimplifier::find_gate(
     Lit elim_lit
     , watch_subarray_const a
     , watch_subarray_const b
+    , VarElimWorker& w
 ) {
-    assert(toClear.empty());
-    for(const Watched w: a) {
-        if (w.isBin() && !w.red()) {
-            seen[(~w.lit2()).toInt()] = 1;
-            toClear.push_back(~w.lit2());
+    assert(w.toClear.empty());
+    for(const Watched ws: a) {
+        if (ws.isBin() && !ws.red()) {
+            w.seen[(~ws.lit2()).toInt()] = 1;
+            w.toClear.push_back(~ws.lit2());
         }
     }
 
     //Have to find the corresponding gate. Finding one is good enough
-    for(const Watched w: b) {
-        if (w.isBin()) {
+    for(const Watched ws: b) {
+        if (ws.isBin()) {
             continue;
         }
 
-        if (w.isClause()) {
-            Clause* cl = solver->cl_alloc.ptr(w.get_offset());
+        if (ws.isClause()) {
+            Clause* cl = solver->cl_alloc.ptr(ws.get_offset());
             if (cl->getRemoved()) {
                 continue;
             }
@@ -2079,7 +2094,7 @@ void OccSimplifier::find_gate(
                 bool OK = true;
                 for(const Lit lit: *cl) {
                     if (lit != ~elim_lit) {
-                        if (!seen[lit.toInt()]) {
+                        if (!w.seen[lit.toInt()]) {
                             OK = false;
                             break;
                         }
@@ -2088,36 +2103,37 @@ void OccSimplifier::find_gate(
 
                 //Found all lits inside
                 if (OK) {
-                    cl->stats.marked_clause = true;
-                    gate_varelim_clause = cl;
+                    solver->cl_alloc.stats(*cl).marked_clause = true;
+                    w.gate_varelim_clause = cl;
                     break;
                 }
             }
         }
     }
 
-    for(Lit l: toClear) {
-        seen[l.toInt()] = 0;
+    for(Lit l: w.toClear) {
+        w.seen[l.toInt()] = 0;
     }
-    toClear.clear();
+    w.toClear.clear();
 }
 
 void OccSimplifier::mark_gate_in_poss_negs(
     Lit elim_lit
     , watch_subarray_const poss
     , watch_subarray_const negs
+    , VarElimWorker& w
 ) {
     //Either of the two is OK. Let's just find ONE, not the biggest one.
     //We could find the biggest one, but it's expensive.
     bool found_pos = false;
-    gate_varelim_clause = NULL;
-    find_gate(elim_lit, poss, negs);
-    if (gate_varelim_clause == NULL) {
-        find_gate(~elim_lit, negs, poss);
+    w.gate_varelim_clause = NULL;
+    find_gate(elim_lit, poss, negs, w);
+    if (w.gate_varelim_clause == NULL) {
+        find_gate(~elim_lit, negs, poss, w);
         found_pos = true;
     }
 
-    if (gate_varelim_clause != NULL && solver->conf.verbosity >= 10) {
+    if (w.gate_varelim_clause != NULL && solver->conf.verbosity >= 10) {
         cout
         << "Lit: " << elim_lit
         << " gate_found_elim_pos:" << found_pos
@@ -2125,7 +2141,7 @@ void OccSimplifier::mark_gate_in_poss_negs(
     }
 }
 
-int OccSimplifier::test_elim_and_fill_resolvents(const uint32_t var)
+int OccSimplifier::test_elim_and_fill_resolvents(const uint32_t var, VarElimWorker& w)
 {
     assert(solver->ok);
     assert(solver->varData[var].removed == Removed::none);
@@ -2150,7 +2166,7 @@ int OccSimplifier::test_elim_and_fill_resolvents(const uint32_t var)
     const uint32_t neg = n_occurs[Lit(var, true).toInt()];
 
     //Heuristic calculation took too much time
-    if (*limit_to_decrease < 0) {
+    if (*w.limit < 0) {
         return std::numeric_limits<int>::max();
     }
 
@@ -2160,7 +2176,7 @@ int OccSimplifier::test_elim_and_fill_resolvents(const uint32_t var)
     watch_subarray negs = solver->watches[~lit];
     std::sort(poss.begin(), poss.end(), watch_sort_smallest_first());
     std::sort(negs.begin(), negs.end(), watch_sort_smallest_first());
-    resolvents.clear();
+    w.resolvents.clear();
 
     //Pure literal, no resolvents
     //we look at "pos" and "neg" (and not poss&negs) because we don't care about redundant clauses
@@ -2175,9 +2191,9 @@ int OccSimplifier::test_elim_and_fill_resolvents(const uint32_t var)
         return std::numeric_limits<int>::max();
     }
 
-    gate_varelim_clause = NULL;
+    w.gate_varelim_clause = NULL;
     if (solver->conf.skip_some_bve_resolvents) {
-        mark_gate_in_poss_negs(lit, poss, negs);
+        mark_gate_in_poss_negs(lit, poss, negs, w);
     }
 
     // Count clauses/literals after elimination
@@ -2189,7 +2205,7 @@ int OccSimplifier::test_elim_and_fill_resolvents(const uint32_t var)
         ; it != end
         ; ++it, at_poss++
     ) {
-        *limit_to_decrease -= 3;
+        *w.limit -= 3;
         if (solver->redundant_or_removed(*it))
             continue;
 
@@ -2198,22 +2214,22 @@ int OccSimplifier::test_elim_and_fill_resolvents(const uint32_t var)
             ; it2 != end2
             ; it2++, at_negs++
         ) {
-            *limit_to_decrease -= 3;
+            *w.limit -= 3;
             if (solver->redundant_or_removed(*it2))
                 continue;
 
             //Resolve the two clauses
-            bool tautological = resolve_clauses(*it, *it2, lit);
+            bool tautological = resolve_clauses(*it, *it2, lit, w);
             if (tautological) {
                 continue;
             }
 
-            if (solver->satisfied_cl(dummy)) {
+            if (solver->satisfied_cl(w.dummy)) {
                 continue;
             }
 
             #ifdef VERBOSE_DEBUG_VARELIM
-            cout << "Adding new clause due to varelim: " << dummy << endl;
+            cout << "Adding new clause due to varelim: " << w.dummy << endl;
             #endif
 
             after_clauses++;
@@ -2221,13 +2237,13 @@ int OccSimplifier::test_elim_and_fill_resolvents(const uint32_t var)
             if (after_clauses > (before_clauses + grow)
                 //Too long resolvent
                 || (solver->conf.velim_resolvent_too_large != -1
-                    && ((int)dummy.size() > solver->conf.velim_resolvent_too_large))
+                    && ((int)w.dummy.size() > solver->conf.velim_resolvent_too_large))
                 //Over-time
-                || *limit_to_decrease < -10LL*1000LL
+                || *w.limit < -10LL*1000LL
 
             ) {
-                if (gate_varelim_clause) {
-                    gate_varelim_clause->stats.marked_clause = false;
+                if (w.gate_varelim_clause) {
+                    solver->cl_alloc.stats(*w.gate_varelim_clause).marked_clause = false;
                 }
                 return std::numeric_limits<int>::max();
             }
@@ -2238,28 +2254,28 @@ int OccSimplifier::test_elim_and_fill_resolvents(const uint32_t var)
             #if defined(USE_GAUSS) || defined(STATS_NEEDED)
             if (it->isBin() && it2->isClause()) {
                 Clause* c = solver->cl_alloc.ptr(it2->get_offset());
-                stats = c->stats;
+                stats = solver->cl_alloc.stats(*c);
                 is_xor |= c->used_in_xor();
             } else if (it2->isBin() && it->isClause()) {
                 Clause* c = solver->cl_alloc.ptr(it->get_offset());
-                stats = c->stats;
+                stats = solver->cl_alloc.stats(*c);
                 is_xor |= c->used_in_xor();
             } else if (it2->isClause() && it->isClause()) {
                 Clause* c1 = solver->cl_alloc.ptr(it->get_offset());
                 Clause* c2 = solver->cl_alloc.ptr(it2->get_offset());
-                stats = ClauseStats::combineStats(c1->stats, c2->stats);
+                stats = ClauseStats::combineStats(solver->cl_alloc.stats(*c1), solver->cl_alloc.stats(*c2));
                 is_xor |= c1->used_in_xor();
                 is_xor |= c2->used_in_xor();
             }
             #endif
             //must clear marking that has been set due to gate
             stats.marked_clause = 0;
-            resolvents.add_resolvent(dummy, stats, is_xor);
+            w.resolvents.add_resolvent(w.dummy, stats, is_xor);
         }
     }
 
-    if (gate_varelim_clause) {
-        gate_varelim_clause->stats.marked_clause = false;
+    if (w.gate_varelim_clause) {
+        solver->cl_alloc.stats(*w.gate_varelim_clause).marked_clause = false;
     }
 
     return -1;
@@ -2451,16 +2467,24 @@ bool OccSimplifier::maybe_eliminate(const uint32_t var)
     assert(solver->ok);
     print_var_elim_complexity_stats(var);
     bvestats.testedToElimVars++;
-    const Lit lit = Lit(var, false);
 
     //Heuristic says no, or we ran out of time
-    if (test_elim_and_fill_resolvents(var) > 0
+    main_elim.limit = limit_to_decrease;
+    if (test_elim_and_fill_resolvents(var, main_elim) > 0
         || *limit_to_decrease < 0
     ) {
         return false;  //didn't eliminate :(
     }
-    bvestats.triedToElimVars++;
+    eliminate_with_resolvents(var, main_elim.resolvents);
+    limit_to_decrease = &norm_varelim_time_limit;
+
+    return true; //eliminated!
+}
 
+void OccSimplifier::eliminate_with_resolvents(const uint32_t var, Resolvents& res)
+{
+    bvestats.triedToElimVars++;
+    const Lit lit = Lit(var, false);
     print_var_eliminate_stat(lit);
 
     //Remove clauses
@@ -2469,41 +2493,190 @@ bool OccSimplifier::maybe_eliminate(const uint32_t var)
     rem_cls_from_watch_due_to_varelim(solver->watches[~lit], ~lit);
 
     //Add resolvents
-    while(!resolvents.empty()) {
-        if (!add_varelim_resolvent(resolvents.back_lits(),
-            resolvents.back_stats(), resolvents.back_xor())
+    while(!res.empty()) {
+        if (!add_varelim_resolvent(res.back_lits(),
+            res.back_stats(), res.back_xor())
         ) {
-            goto end;
+            break;
         }
-        resolvents.pop();
+        res.pop();
     }
-    limit_to_decrease = &norm_varelim_time_limit;
 
-end:
     set_var_as_eliminated(var, lit);
+}
 
-    return true; //eliminated!
+void OccSimplifier::mark_occ_vars(const uint32_t var, vector<uint32_t>& marked)
+{
+    for(const Lit lit: {Lit(var, false), Lit(var, true)}) {
+        watch_subarray_const ws = solver->watches[lit];
+        *limit_to_decrease -= (long)ws.size();
+        for(const Watched w: ws) {
+            if (w.isBin()) {
+                if (!seen2[w.lit2().var()]) {
+                    seen2[w.lit2().var()] = 1;
+                    marked.push_back(w.lit2().var());
+                }
+            } else if (w.isClause()) {
+                const Clause& cl = *solver->cl_alloc.ptr(w.get_offset());
+                if (cl.getRemoved()) {
+                    continue;
+                }
+                *limit_to_decrease -= (long)cl.size()/2;
+                for(const Lit l: cl) {
+                    if (!seen2[l.var()]) {
+                        seen2[l.var()] = 1;
+                        marked.push_back(l.var());
+                    }
+                }
+            }
+        }
+    }
+}
+
+//Candidates that share no clause with one another. Eliminating one of them
+//neither removes nor adds clauses of the others, so all of them can be
+//tested at the same time, and the results stay valid while they are
+//eliminated one after the other.
+bool OccSimplifier::pick_elim_batch(size_t& wenThrough)
+{
+    vector<uint32_t> marked;
+    elim_batch.clear();
+    elim_deferred.clear();
+    while(!velim_order.empty()
+        && elim_batch.size() < solver->conf.varelim_batch
+        && *limit_to_decrease > 0
+    ) {
+        const uint32_t var = velim_order.removeMin();
+        if (!can_eliminate_var(var)) {
+            continue;
+        }
+
+        //Shares a clause with an earlier pick, try it next time
+        if (seen2[var]) {
+            elim_deferred.push_back(var);
+            continue;
+        }
+        *limit_to_decrease -= 20;
+        wenThrough++;
+
+        seen2[var] = 1;
+        marked.push_back(var);
+        mark_occ_vars(var, marked);
+        elim_batch.push_back(ElimCandidate());
+        elim_batch.back().var = var;
+    }
+    for(const uint32_t var: marked) {
+        seen2[var] = 0;
+    }
+
+    return !elim_batch.empty();
+}
+
+bool OccSimplifier::eliminate_batch(
+    size_t& vars_elimed
+    , int64_t& last_elimed
+    , size_t& wenThrough
+) {
+    pick_elim_batch(wenThrough);
+
+    const size_t num_threads = solver->conf.varelim_threads;
+    if (elim_pool == NULL || elim_pool->size() != num_threads) {
+        delete elim_pool;
+        elim_pool = new ThreadPool(num_threads);
+    }
+    while(elim_workers.size() < num_threads) {
+        elim_workers.push_back(new VarElimWorker);
+    }
+    for(VarElimWorker* w: elim_workers) {
+        w->seen.resize(solver->nVars()*2, 0);
+    }
+
+    //Test in parallel. Each candidate gets an equal share of the remaining
+    //budget, so that the batch together can't overrun it, and what it used
+    //is charged once the results are back.
+    const int64_t budget = norm_varelim_time_limit/(int64_t)std::max<size_t>(elim_batch.size(), 1);
+    std::atomic<size_t> next(0);
+    elim_pool->run([&](const size_t tid) {
+        VarElimWorker& w = *elim_workers[tid];
+        w.limit = &w.own_limit;
+        for(size_t i = next++; i < elim_batch.size(); i = next++) {
+            ElimCandidate& c = elim_batch[i];
+            w.own_limit = budget;
+            c.test_result = test_elim_and_fill_resolvents(c.var, w);
+            c.limit_used = budget - w.own_limit;
+            c.over_limit = w.own_limit < 0;
+            std::swap(c.resolvents, w.resolvents);
+        }
+    });
+
+    //Eliminate in the order the heuristic picked them
+    elim_calc_need_update.clear();
+    for(ElimCandidate& c: elim_batch) {
+        *limit_to_decrease -= c.limit_used;
+        bvestats.testedToElimVars++;
+        print_var_elim_complexity_stats(c.var);
+        if (c.test_result > 0
+            || c.over_limit
+            || *limit_to_decrease < 0
+            || varelim_num_limit <= 0
+            || varelim_linkin_limit_bytes <= 0
+            || !can_eliminate_var(c.var)
+        ) {
+            continue;
+        }
+
+        eliminate_with_resolvents(c.var, c.resolvents);
+        bvestats.elimedInBatch++;
+        vars_elimed++;
+        varelim_num_limit--;
+        last_elimed++;
+        if (!solver->ok) {
+            return false;
+        }
+    }
+
+    for(const uint32_t var: elim_deferred) {
+        velim_order.insert(var);
+    }
+
+    //SUB and STR for long and short
+    limit_to_decrease = &varelim_sub_str_limit;
+    if (!deal_with_added_long_and_bin(false)) {
+        limit_to_decrease = &norm_varelim_time_limit;
+        return false;
+    }
+    limit_to_decrease = &norm_varelim_time_limit;
+
+    solver->ok = solver->propagate_occur();
+    if (!solver->okay()) {
+        return false;
+    }
+
+    update_varelim_complexity_heap();
+
+    return true;
 }
 
 void OccSimplifier::add_pos_lits_to_dummy_and_seen(
     const Watched ps
     , const Lit posLit
+    , VarElimWorker& w
 ) {
     if (ps.isBin()) {
-        *limit_to_decrease -= 1;
+        *w.limit -= 1;
         assert(ps.lit2() != posLit);
 
-        seen[ps.lit2().toInt()] = 1;
-        dummy.push_back(ps.lit2());
+        w.seen[ps.lit2().toInt()] = 1;
+        w.dummy.push_back(ps.lit2());
     }
 
     if (ps.isClause()) {
         Clause& cl = *solver->cl_alloc.ptr(ps.get_offset());
-        *limit_to_decrease -= (long)cl.size()/2;
+        *w.limit -= (long)cl.size()/2;
         for (const Lit lit : cl){
             if (lit != posLit) {
-                seen[lit.toInt()] = 1;
-                dummy.push_back(lit);
+                w.seen[lit.toInt()] = 1;
+                w.dummy.push_back(lit);
             }
         }
     }
@@ -2512,34 +2685,35 @@ void OccSimplifier::add_pos_lits_to_dummy_and_seen(
 bool OccSimplifier::add_neg_lits_to_dummy_and_seen(
     const Watched qs
     , const Lit posLit
+    , VarElimWorker& w
 ) {
     if (qs.isBin()) {
-        *limit_to_decrease -= 1;
+        *w.limit -= 1;
         assert(qs.lit2() != ~posLit);
 
-        if (seen[(~qs.lit2()).toInt()]) {
+        if (w.seen[(~qs.lit2()).toInt()]) {
             return true;
         }
-        if (!seen[qs.lit2().toInt()]) {
-            dummy.push_back(qs.lit2());
-            seen[qs.lit2().toInt()] = 1;
+        if (!w.seen[qs.lit2().toInt()]) {
+            w.dummy.push_back(qs.lit2());
+            w.seen[qs.lit2().toInt()] = 1;
         }
     }
 
     if (qs.isClause()) {
         Clause& cl = *solver->cl_alloc.ptr(qs.get_offset());
-        *limit_to_decrease -= (long)cl.size()/2;
+        *w.limit -= (long)cl.size()/2;
         for (const Lit lit: cl) {
             if (lit == ~posLit)
                 continue;
 
-            if (seen[(~lit).toInt()]) {
+            if (w.seen[(~lit).toInt()]) {
                 return true;
             }
 
-            if (!seen[lit.toInt()]) {
-                dummy.push_back(lit);
-                seen[lit.toInt()] = 1;
+            if (!w.seen[lit.toInt()]) {
+                w.dummy.push_back(lit);
+                w.seen[lit.toInt()] = 1;
             }
         }
     }
@@ -2551,6 +2725,7 @@ bool OccSimplifier::resolve_clauses(
     const Watched ps
     , const Watched qs
     , const Lit posLit
+    , VarElimWorker& w
 ) {
     //If clause has already been freed, skip
     Clause *cl1 = NULL;
@@ -2568,10 +2743,10 @@ bool OccSimplifier::resolve_clauses(
             return true;
         }
     }
-    if (gate_varelim_clause
+    if (w.gate_varelim_clause
         && cl1 && cl2
-        && !cl1->stats.marked_clause
-        && !cl2->stats.marked_clause
+        && !solver->cl_alloc.stats(*cl1).marked_clause
+        && !solver->cl_alloc.stats(*cl2).marked_clause
     ) {
         //for G (U) R, we only neede to resolve to
         // (Gx * R!x) (U) (G!x * Rx)
@@ -2583,13 +2758,13 @@ bool OccSimplifier::resolve_clauses(
         return true;
     }
 
-    dummy.clear();
-    add_pos_lits_to_dummy_and_seen(ps, posLit);
-    bool tautological = add_neg_lits_to_dummy_and_seen(qs, posLit);
+    w.dummy.clear();
+    add_pos_lits_to_dummy_and_seen(ps, posLit, w);
+    bool tautological = add_neg_lits_to_dummy_and_seen(qs, posLit, w);
 
-    *limit_to_decrease -= (long)dummy.size()/2 + 1;
-    for (const Lit lit: dummy) {
-        seen[lit.toInt()] = 0;
+    *w.limit -= (long)w.dummy.size()/2 + 1;
+    for (const Lit lit: w.dummy) {
+        w.seen[lit.toInt()] = 0;
     }
 
     return tautological;
@@ -2962,7 +3137,7 @@ void OccSimplifier::linkInClause(Clause& cl)
             added_cl_to_var.touch(l.var());
         }
     }
-    assert(cl.stats.marked_clause == 0 && "marks must always be zero at linkin");
+    assert(solver->cl_alloc.stats(cl).marked_clause == 0 && "marks must always be zero at linkin");
 
     std::sort(cl.begin(), cl.end());
     for (const Lit lit: cl) {
@@ -3021,6 +3196,7 @@ BVEStats& BVEStats::operator+=(const BVEStats& other)
     triedToElimVars += other.triedToElimVars;
     newClauses += other.newClauses;
     subsumedByVE  += other.subsumedByVE;
+    elimedInBatch += other.elimedInBatch;
 
     return *this;
 }
@@ -3102,13 +3278,80 @@ void OccSimplifier::load_state(SimpleInFile& f)
     }
 }
 
+void OccSimplifier::copy_state_from(const OccSimplifier& other)
+{
+    blockedClauses = other.blockedClauses;
+    blkcls = other.blkcls;
+    globalStats = other.globalStats;
+    anythingHasBeenBlocked = other.anythingHasBeenBlocked;
+
+    blockedMapBuilt = false;
+    buildBlockedMap();
+}
+
+/**
+@brief Writes the eliminated clauses for SimplifiedCNF::elim_stack
+
+Literals are mapped through the variable replacement, the same way
+extend_model() would map them.
+*/
+void OccSimplifier::export_elim_stack(vector<Lit>& out)
+{
+    assert(solver->decisionLevel() == 0);
+    cleanBlockedClauses();
+    for(const BlockedClauses& c: blockedClauses) {
+        assert(!c.toRemove);
+        for(uint64_t i = 0; i < c.size(); i++) {
+            Lit l = c.at(i, blkcls);
+            if (l != lit_Undef) {
+                l = solver->varReplacer->get_lit_replaced_with_outer(l);
+            }
+            out.push_back(l);
+        }
+        out.push_back(lit_Error);
+    }
+}
+
+/**
+@brief Takes over the variables another solver eliminated
+
+Must be called on a solver that has the same outer variables as the other one,
+and that got its clauses from the same SimplifiedCNF, so none of the blocked-on
+variables are in any clause here.
+*/
+void OccSimplifier::import_elim_stack(const vector<Lit>& in)
+{
+    assert(solver->decisionLevel() == 0);
+    bool at_start = true;
+    for(const Lit l: in) {
+        if (l == lit_Error) {
+            blockedClauses.back().end = blkcls.size();
+            at_start = true;
+            continue;
+        }
+
+        if (at_start) {
+            const uint32_t var = solver->map_outer_to_inter(l.var());
+            assert(solver->varData[var].removed == Removed::none);
+            assert(solver->value(var) == l_Undef);
+            solver->varData[var].removed = Removed::elimed;
+            bvestats_global.numVarsElimed++;
+            blockedClauses.push_back(BlockedClauses(blkcls.size(), blkcls.size()));
+            at_start = false;
+        }
+        blkcls.push_back(l);
+    }
+    assert(at_start);
+    blockedMapBuilt = false;
+}
+
 void OccSimplifier::check_clid_correct() const
 {
     #ifdef STATS_NEEDED
     for(auto offs: clauses) {
         Clause * cl = solver->cl_alloc.ptr(offs);
         if (!cl->freed() && !cl->getRemoved()) {
-            assert(!(cl->stats.ID == 0 && cl->red()));
+            assert(!(solver->cl_alloc.stats(*cl).ID == 0 && cl->red()));
         }
     }
     #endif
@@ -56,6 +56,7 @@ class Solver;
 class TopLevelGaussAbst;
 class SubsumeStrengthen;
 class BVA;
+class ThreadPool;
 
 struct BlockedClauses {
     BlockedClauses()
@@ -118,6 +119,7 @@ struct BVEStats
     uint64_t triedToElimVars = 0;
     uint64_t newClauses = 0;
     uint64_t subsumedByVE = 0;
+    uint64_t elimedInBatch = 0; ///<Eliminated with varelim_threads > 1
 
     BVEStats& operator+=(const BVEStats& other);
 
@@ -127,6 +129,7 @@ struct BVEStats
         cout
         << "c [occ-bve]"
         << " elimed: " << numVarsElimed
+        << " in-batch: " << elimedInBatch
         << endl;
 
         cout
@@ -195,6 +198,12 @@ struct BVEStats
         print_stats_line("c v-elim-sub"
             , subsumedByVE
         );
+
+        print_stats_line("c v-elimed in batch"
+            , elimedInBatch
+            , stats_line_percent(elimedInBatch, numVarsElimed)
+            , "% v-elimed"
+        );
     }
     void clear() {
         BVEStats tmp;
@@ -266,6 +275,9 @@ public:
     void sort_occurs_and_set_abst();
     void save_state(SimpleOutFile& f);
     void load_state(SimpleInFile& f);
+    void copy_state_from(const OccSimplifier& other);
+    void export_elim_stack(vector<Lit>& out);
+    void import_elim_stack(const vector<Lit>& in);
     vector<ClOffset> added_long_cl;
     TouchListLit added_cl_to_var;
     vector<uint32_t> n_occurs;
@@ -411,21 +423,6 @@ private:
     bool        simulate_frw_sub_str_with_added_cl_to_var();
 
 
-    TouchList   elim_calc_need_update;
-    vector<ClOffset> cl_to_free_later;
-    bool        maybe_eliminate(const uint32_t x);
-    bool        deal_with_added_long_and_bin(const bool main);
-    bool        prop_and_clean_long_and_impl_clauses();
-    vector<Lit> tmp_bin_cl;
-    void        create_dummy_blocked_clause(const Lit lit);
-    int         test_elim_and_fill_resolvents(uint32_t var);
-    void        mark_gate_in_poss_negs(Lit elim_lit, watch_subarray_const poss, watch_subarray_const negs);
-    void        find_gate(Lit elim_lit, watch_subarray_const a, watch_subarray_const b);
-    void        print_var_eliminate_stat(Lit lit) const;
-    bool        add_varelim_resolvent(vector<Lit>& finalLits, const ClauseStats& stats, bool is_xor);
-    void        update_varelim_complexity_heap();
-    void        print_var_elim_complexity_stats(const uint32_t var) const;
-
     struct ResolventData {
         ResolventData()
         {}
@@ -478,8 +475,69 @@ private:
             return at;
         }
     };
-    Resolvents resolvents;
-    Clause* gate_varelim_clause;
+
+    /**
+    @brief Where testing a variable for elimination keeps its state
+
+    The serial elimination uses the solver's "seen" and "toClear". The
+    workers of the parallel one each have their own.
+    */
+    struct VarElimWorker {
+        VarElimWorker() :
+            seen(own_seen)
+            , toClear(own_toClear)
+        {}
+        VarElimWorker(vector<uint16_t>& _seen, vector<Lit>& _toClear) :
+            seen(_seen)
+            , toClear(_toClear)
+        {}
+        VarElimWorker(const VarElimWorker&) = delete;
+        VarElimWorker& operator=(const VarElimWorker&) = delete;
+
+        vector<uint16_t> own_seen;
+        vector<Lit> own_toClear;
+        vector<uint16_t>& seen;
+        vector<Lit>& toClear;
+        vector<Lit> dummy;
+        Resolvents resolvents;
+        Clause* gate_varelim_clause = NULL;
+        int64_t* limit = NULL;
+        int64_t own_limit = 0;
+    };
+    VarElimWorker main_elim;
+
+    //Parallel BVE
+    struct ElimCandidate {
+        uint32_t var;
+        int test_result;
+        int64_t limit_used;
+        bool over_limit;
+        Resolvents resolvents;
+    };
+    ThreadPool* elim_pool = NULL;
+    vector<VarElimWorker*> elim_workers;
+    vector<ElimCandidate> elim_batch;
+    vector<uint32_t> elim_deferred;
+    bool        eliminate_batch(size_t& vars_elimed, int64_t& last_elimed, size_t& wenThrough);
+    bool        pick_elim_batch(size_t& wenThrough);
+    void        mark_occ_vars(const uint32_t var, vector<uint32_t>& marked);
+    void        eliminate_with_resolvents(const uint32_t var, Resolvents& res);
+
+    TouchList   elim_calc_need_update;
+    vector<ClOffset> cl_to_free_later;
+    bool        maybe_eliminate(const uint32_t x);
+    bool        deal_with_added_long_and_bin(const bool main);
+    bool        prop_and_clean_long_and_impl_clauses();
+    vector<Lit> tmp_bin_cl;
+    void        create_dummy_blocked_clause(const Lit lit);
+    int         test_elim_and_fill_resolvents(uint32_t var, VarElimWorker& w);
+    void        mark_gate_in_poss_negs(Lit elim_lit, watch_subarray_const poss, watch_subarray_const negs, VarElimWorker& w);
+    void        find_gate(Lit elim_lit, watch_subarray_const a, watch_subarray_const b, VarElimWorker& w);
+    void        print_var_eliminate_stat(Lit lit) const;
+    bool        add_varelim_resolvent(vector<Lit>& finalLits, const ClauseStats& stats, bool is_xor);
+    void        update_varelim_complexity_heap();
+    void        print_var_elim_complexity_stats(const uint32_t var) const;
+
     uint32_t calc_data_for_heuristic(const Lit lit);
     uint64_t time_spent_on_calc_otf_update;
     uint64_t num_otf_update_until_now;
@@ -502,14 +560,17 @@ private:
         const Watched ps
         , const Watched qs
         , const Lit noPosLit
+        , VarElimWorker& w
     );
     void add_pos_lits_to_dummy_and_seen(
         const Watched ps
         , const Lit posLit
+        , VarElimWorker& w
     );
     bool add_neg_lits_to_dummy_and_seen(
         const Watched qs
         , const Lit posLit
+        , VarElimWorker& w
     );
     bool eliminate_vars();
     void eliminate_empty_resolvent_vars();
@@ -29,8 +29,165 @@ THE SOFTWARE.
 
 #include "packedrow.h"
 
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#define ROW_KERNELS_X86
+#include <immintrin.h>
+#endif
+
 using namespace CMSat;
 
+static void xor_words_scalar(
+    uint64_t* __restrict a
+    , const uint64_t* __restrict b
+    , const uint32_t num
+) {
+    for (uint32_t i = 0; i != num; i++) {
+        a[i] ^= b[i];
+    }
+}
+
+static bool is_zero_scalar(const uint64_t* a, const uint32_t num)
+{
+    for (uint32_t i = 0; i != num; i++) {
+        if (a[i]) return false;
+    }
+    return true;
+}
+
+static uint32_t next_nonzero_scalar(
+    const uint64_t* a
+    , uint32_t from
+    , const uint32_t num
+) {
+    while (from != num && !a[from]) {
+        from++;
+    }
+    return from;
+}
+
+#ifdef ROW_KERNELS_X86
+__attribute__((target("avx2")))
+static void xor_words_avx2(
+    uint64_t* __restrict a
+    , const uint64_t* __restrict b
+    , const uint32_t num
+) {
+    uint32_t i = 0;
+    for (; i + 4 <= num; i += 4) {
+        const __m256i x = _mm256_loadu_si256((const __m256i*)(a+i));
+        const __m256i y = _mm256_loadu_si256((const __m256i*)(b+i));
+        _mm256_storeu_si256((__m256i*)(a+i), _mm256_xor_si256(x, y));
+    }
+    for (; i != num; i++) {
+        a[i] ^= b[i];
+    }
+}
+
+__attribute__((target("avx2")))
+static bool is_zero_avx2(const uint64_t* a, const uint32_t num)
+{
+    uint32_t i = 0;
+    for (; i + 4 <= num; i += 4) {
+        const __m256i x = _mm256_loadu_si256((const __m256i*)(a+i));
+        if (!_mm256_testz_si256(x, x)) return false;
+    }
+    for (; i != num; i++) {
+        if (a[i]) return false;
+    }
+    return true;
+}
+
+__attribute__((target("avx2")))
+static uint32_t next_nonzero_avx2(
+    const uint64_t* a
+    , uint32_t from
+    , const uint32_t num
+) {
+    for (; from + 4 <= num; from += 4) {
+        const __m256i x = _mm256_loadu_si256((const __m256i*)(a+from));
+        if (!_mm256_testz_si256(x, x)) break;
+    }
+    return next_nonzero_scalar(a, from, num);
+}
+
+__attribute__((target("avx512f")))
+static void xor_words_avx512(
+    uint64_t* __restrict a
+    , const uint64_t* __restrict b
+    , const uint32_t num
+) {
+    uint32_t i = 0;
+    for (; i + 8 <= num; i += 8) {
+        const __m512i x = _mm512_loadu_si512(a+i);
+        const __m512i y = _mm512_loadu_si512(b+i);
+        _mm512_storeu_si512(a+i, _mm512_xor_si512(x, y));
+    }
+
+    //Tail is done with a masked op, it's at most 7 words
+    const __mmask8 m = (__mmask8)((1U << (num-i)) - 1);
+    const __m512i x = _mm512_maskz_loadu_epi64(m, a+i);
+    const __m512i y = _mm512_maskz_loadu_epi64(m, b+i);
+    _mm512_mask_storeu_epi64(a+i, m, _mm512_xor_si512(x, y));
+}
+
+__attribute__((target("avx512f")))
+static bool is_zero_avx512(const uint64_t* a, const uint32_t num)
+{
+    uint32_t i = 0;
+    for (; i + 8 <= num; i += 8) {
+        const __m512i x = _mm512_loadu_si512(a+i);
+        if (_mm512_test_epi64_mask(x, x)) return false;
+    }
+
+    const __mmask8 m = (__mmask8)((1U << (num-i)) - 1);
+    const __m512i x = _mm512_maskz_loadu_epi64(m, a+i);
+    return _mm512_test_epi64_mask(x, x) == 0;
+}
+
+__attribute__((target("avx512f")))
+static uint32_t next_nonzero_avx512(
+    const uint64_t* a
+    , uint32_t from
+    , const uint32_t num
+) {
+    while (from < num) {
+        const uint32_t left = std::min<uint32_t>(num-from, 8);
+        const __mmask8 m = (__mmask8)((1U << left) - 1);
+        const __m512i x = _mm512_maskz_loadu_epi64(m, a+from);
+        const uint32_t nonzero = _mm512_test_epi64_mask(x, x);
+        if (nonzero) {
+            return from + __builtin_ctz(nonzero);
+        }
+        from += left;
+    }
+    return num;
+}
+#endif //ROW_KERNELS_X86
+
+vector<RowKernels> CMSat::supported_row_kernels()
+{
+    vector<RowKernels> ret;
+    ret.push_back(RowKernels{xor_words_scalar, is_zero_scalar, next_nonzero_scalar, "scalar"});
+    #ifdef ROW_KERNELS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        ret.push_back(RowKernels{xor_words_avx2, is_zero_avx2, next_nonzero_avx2, "avx2"});
+    }
+    if (__builtin_cpu_supports("avx512f")) {
+        ret.push_back(RowKernels{xor_words_avx512, is_zero_avx512, next_nonzero_avx512, "avx512"});
+    }
+    #endif
+    return ret;
+}
+
+//The widest one
+static RowKernels pick_row_kernels()
+{
+    return supported_row_kernels().back();
+}
+
+const RowKernels CMSat::row_kernels = pick_row_kernels();
+
 bool PackedRow::fill(
     vec<Lit>& tmp_clause,
     const vec<lbool>& assigns,
@@ -131,10 +288,16 @@ gret PackedRow::propGause(
     nb_var = std::numeric_limits<uint32_t>::max();
     tmp_clause.clear();
 
-    for (uint32_t i = start/64; i != size; i++) if (mp[i]) {
-        uint64_t tmp = mp[i];
-        for (uint32_t i2 = 0 ; i2 < 64; i2++) {
-            if(tmp & 1){
+    //Words from start/64 to the end, then the ones before it
+    const uint32_t ranges[2][2] = {{start/64, size}, {0, start/64}};
+    for (const auto& range: ranges) {
+        uint32_t i = row_kernels.next_nonzero(mp, range[0], range[1]);
+        for (; i != range[1]; i = row_kernels.next_nonzero(mp, i+1, range[1])) {
+            uint64_t tmp = mp[i];
+            while (tmp) {
+                const uint32_t i2 = my_ctz64(tmp);
+                tmp &= tmp-1;
+
                 const uint32_t var = col_to_var[i * 64  + i2];
                 const lbool val = assigns[var];
                 if (val == l_Undef && !GasVar_state[var]) {  // find non basic value
@@ -148,28 +311,6 @@ gret PackedRow::propGause(
                     std::swap(tmp_clause[0], tmp_clause.back());
                 }
             }
-            tmp >>= 1;
-        }
-    }
-
-    for ( uint32_t i =0; i != start/64; i++) if (likely(mp[i])) {
-        uint64_t tmp = mp[i];
-        for (uint32_t i2 = 0 ; i2 < 64; i2++) {
-            if(tmp & 1){
-                const uint32_t var = col_to_var[i * 64  + i2];
-                const lbool val = assigns[var];
-                if (val == l_Undef &&  !GasVar_state[var] ){  // find non basic value
-                    nb_var = var;
-                    return gret::nothing_fnewwatch;   // nothing
-                }
-                const bool val_bool = val == l_True;
-                final ^= val_bool;
-                tmp_clause.push_back(Lit(var, val_bool));
-                if ( GasVar_state[var] ) {
-                    std::swap(tmp_clause[0], tmp_clause.back());
-                }
-            }
-            tmp >>= 1;
         }
     }
 
@@ -44,6 +44,26 @@ using std::vector;
 
 class PackedMatrix;
 
+/**
+@brief Word-level kernels of PackedRow
+
+Picked once, at startup, depending on what the CPU supports (AVX-512, AVX2, or
+plain 64-bit words). Rows are not aligned, so all of them use unaligned loads.
+*/
+struct RowKernels {
+    void (*xor_words)(uint64_t* __restrict a, const uint64_t* __restrict b, uint32_t num);
+    bool (*is_zero)(const uint64_t* a, uint32_t num);
+    ///Index of the first non-zero word at or after "from", or "num" if none
+    uint32_t (*next_nonzero)(const uint64_t* a, uint32_t from, uint32_t num);
+    const char* name;
+};
+extern const RowKernels row_kernels;
+///All the kernels this CPU can run, the scalar one first. For testing
+vector<RowKernels> supported_row_kernels();
+
+///Rows shorter than this (in words) are not worth an indirect call
+#define ROW_KERNEL_MIN_WORDS 4
+
 class PackedRow
 {
 public:
@@ -58,7 +78,7 @@ public:
         assert(size == b.size);
         #endif
 
-        memcpy(mp-1, b.mp-1, size+1);
+        memcpy(mp-1, b.mp-1, sizeof(uint64_t)*(size+1));
         return *this;
     }
 
@@ -70,11 +90,7 @@ public:
         assert(b.size == size);
         #endif
 
-        for (uint32_t i = 0; i != size; i++) {
-            *(mp + i) ^= *(b.mp + i);
-        }
-
-        rhs_internal ^= b.rhs_internal;
+        xorBoth(b);
         return *this;
     }
 
@@ -86,8 +102,12 @@ public:
         assert(b.size == size);
         #endif
 
-        for (uint32_t i = 0; i != size; i++) {
-            *(mp + i) ^= *(b.mp + i);
+        if (size < ROW_KERNEL_MIN_WORDS) {
+            for (uint32_t i = 0; i != size; i++) {
+                *(mp + i) ^= *(b.mp + i);
+            }
+        } else {
+            row_kernels.xor_words(mp, b.mp, size);
         }
 
         rhs_internal ^= b.rhs_internal;
@@ -97,13 +117,11 @@ public:
     uint32_t popcnt() const;
     bool popcnt_is_one() const
     {
-        int ret = 0;
-        for (uint32_t i = 0; i != size; i++) {
-            ret += my_popcnt(mp[i]&0xffffffff);
-            ret += my_popcnt(mp[i]>>32);
-            if (ret > 1) return false;
+        const uint32_t at = row_kernels.next_nonzero(mp, 0, size);
+        if (at == size || (mp[at] & (mp[at]-1))) {
+            return false;
         }
-        return ret == 1;
+        return row_kernels.is_zero(mp+at+1, size-at-1);
     }
 
     bool popcnt_is_one(uint32_t from) const
@@ -114,9 +132,7 @@ public:
         tmp >>= from%64;
         if (tmp) return false;
 
-        for (uint32_t i = from/64+1; i != size; i++)
-            if (mp[i]) return false;
-        return true;
+        return row_kernels.is_zero(mp+from/64+1, size-from/64-1);
     }
 
     inline const uint64_t& rhs() const
@@ -126,10 +142,7 @@ public:
 
     inline bool isZero() const
     {
-        for (uint32_t i = 0; i != size; i++) {
-            if (mp[i]) return false;
-        }
-        return true;
+        return row_kernels.is_zero(mp, size);
     }
 
     inline void setZero()
@@ -172,6 +185,16 @@ public:
         }
     }
 
+    ///The 8 bits starting at column i, which must be a multiple of 8
+    inline uint32_t get_byte(const uint32_t i) const
+    {
+        #ifdef DEBUG_ROW
+        assert(i % 8 == 0);
+        #endif
+
+        return (mp[i/64] >> (i%64)) & 0xff;
+    }
+
     inline bool operator[](const uint32_t& i) const
     {
         #ifdef DEBUG_ROW
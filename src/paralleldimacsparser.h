@@ -0,0 +1,573 @@
+/******************************************
+Copyright (c) 2016, Mate Soos
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+***********************************************/
+
+#ifndef PARALLELDIMACSPARSER_H
+#define PARALLELDIMACSPARSER_H
+
+#include "cryptominisat5/cryptominisat.h"
+#include <string.h>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <limits>
+#include <atomic>
+#include <thread>
+#include <iostream>
+#include <iomanip>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+using namespace CMSat;
+using std::vector;
+using std::cout;
+using std::endl;
+
+//Parses an uncompressed DIMACS file with many threads. The file is
+//memory-mapped and cut into chunks at line ends that also end a clause. Each
+//thread converts its chunks into flat buffers that are then handed to the
+//solver with SATSolver::add_clauses(), in file order.
+//
+//Accepts the same input as DimacsParser, except for the debugLib comments.
+class ParallelDimacsParser
+{
+    public:
+        ParallelDimacsParser(SATSolver* solver, unsigned num_threads, unsigned verbosity);
+        ~ParallelDimacsParser();
+
+        //Returns FALSE if the file cannot be memory-mapped or is
+        //compressed, in which case DimacsParser must be used
+        bool open(const std::string& fname);
+        bool parse_DIMACS(const bool strict_header);
+
+        uint64_t max_var = std::numeric_limits<uint64_t>::max();
+        vector<uint32_t> independent_vars;
+        size_t min_chunk_bytes = 1ULL << 20;
+        const std::string please_read_dimacs = "\nPlease read DIMACS specification at http://www.satcompetition.org/2009/format-benchmarks2009.html";
+
+        //Stat
+        size_t num_chunks = 0;
+        size_t norm_clauses_added = 0;
+        size_t xor_clauses_added = 0;
+
+    private:
+        struct Chunk {
+            const char* begin;
+            const char* end;
+
+            //Each clause/XOR ended by lit_Undef
+            vector<Lit> lits;
+            vector<Lit> xor_lits;
+            size_t num_cls = 0;
+            size_t num_xors = 0;
+            vector<uint32_t> indep;
+
+            int64_t max_var = -1;
+            const char* max_var_pos = NULL;
+
+            unsigned num_headers = 0;
+            int header_vars = 0;
+            int header_cls = 0;
+            bool cls_before_header = false;
+
+            const char* err_pos = NULL;
+            std::string err;
+        };
+
+        void split_into_chunks();
+        bool ends_clause(const char* eol) const;
+        void parse_chunk(Chunk& c) const;
+        bool parse_int(Chunk& c, const char*& p, int32_t& ret) const;
+        bool read_lits(Chunk& c, const char*& p, vector<Lit>& out) const;
+        bool skip_eol(Chunk& c, const char*& p) const;
+        bool parse_header(Chunk& c, const char*& p) const;
+        bool parse_comment(Chunk& c, const char*& p) const;
+        bool error(Chunk& c, const char* p, const std::string& err) const;
+        size_t line_of(const char* pos) const;
+        void add_xors(const Chunk& c);
+
+        SATSolver* solver;
+        unsigned num_threads;
+        unsigned verbosity;
+        bool strict_header = false;
+
+        int fd = -1;
+        const char* data = NULL;
+        size_t size = 0;
+        vector<Chunk> chunks;
+};
+
+inline ParallelDimacsParser::ParallelDimacsParser(
+    SATSolver* _solver
+    , unsigned _num_threads
+    , unsigned _verbosity
+):
+    solver(_solver)
+    , num_threads(std::max(1U, _num_threads))
+    , verbosity(_verbosity)
+{
+}
+
+inline ParallelDimacsParser::~ParallelDimacsParser()
+{
+    #ifndef _WIN32
+    if (data != NULL) {
+        munmap((void*)data, size);
+    }
+    if (fd != -1) {
+        close(fd);
+    }
+    #endif
+}
+
+inline bool ParallelDimacsParser::open(const std::string& fname)
+{
+    #ifdef _WIN32
+    return false;
+    #else
+    fd = ::open(fname.c_str(), O_RDONLY);
+    if (fd == -1) {
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0) {
+        return false;
+    }
+    void* ptr = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (ptr == MAP_FAILED) {
+        return false;
+    }
+    data = (const char*)ptr;
+    size = st.st_size;
+    #ifdef MADV_WILLNEED
+    madvise(ptr, size, MADV_WILLNEED);
+    #endif
+
+    //gzip, zstd and xz magic
+    const uint8_t* b = (const uint8_t*)data;
+    if ((size >= 2 && b[0] == 0x1f && b[1] == 0x8b)
+        || (size >= 4 && b[0] == 0x28 && b[1] == 0xb5 && b[2] == 0x2f && b[3] == 0xfd)
+        || (size >= 6 && memcmp(b, "\xfd" "7zXZ\0", 6) == 0)
+    ) {
+        return false;
+    }
+    return true;
+    #endif
+}
+
+//The line ending at "eol" ends with a "0" token, so the next line cannot
+//continue a clause
+inline bool ParallelDimacsParser::ends_clause(const char* eol) const
+{
+    const char* p = eol;
+    while (p > data && (p[-1] == ' ' || p[-1] == '\t' || p[-1] == '\r')) {
+        p--;
+    }
+    if (p == data || p[-1] != '0') {
+        return false;
+    }
+    p--;
+    return p == data || p[-1] == ' ' || p[-1] == '\t' || p[-1] == '\n';
+}
+
+inline void ParallelDimacsParser::split_into_chunks()
+{
+    const char* const end = data + size;
+    const size_t want = std::max<size_t>(1,
+        std::min<size_t>(num_threads*4, size/std::max<size_t>(1, min_chunk_bytes)));
+
+    const char* start = data;
+    for(size_t i = 1; i < want; i++) {
+        const char* at = data + (size/want)*i;
+        if (at <= start) {
+            continue;
+        }
+
+        const char* eol = (const char*)memchr(at, '\n', end - at);
+        while (eol != NULL && !ends_clause(eol)) {
+            eol = (const char*)memchr(eol+1, '\n', end - (eol+1));
+        }
+        if (eol == NULL) {
+            break;
+        }
+        chunks.push_back(Chunk());
+        chunks.back().begin = start;
+        chunks.back().end = eol+1;
+        start = eol+1;
+    }
+    chunks.push_back(Chunk());
+    chunks.back().begin = start;
+    chunks.back().end = end;
+}
+
+inline bool ParallelDimacsParser::error(
+    Chunk& c
+    , const char* p
+    , const std::string& err
+) const {
+    c.err_pos = p;
+    c.err = err;
+    return false;
+}
+
+inline size_t ParallelDimacsParser::line_of(const char* pos) const
+{
+    size_t line = 1;
+    for(const char* p = data; p < pos; p++) {
+        line += (*p == '\n');
+    }
+    return line;
+}
+
+inline bool ParallelDimacsParser::parse_int(
+    Chunk& c
+    , const char*& p
+    , int32_t& ret
+) const {
+    while (p < c.end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) {
+        p++;
+    }
+
+    int32_t mult = 1;
+    if (p < c.end && *p == '-') {
+        mult = -1;
+        p++;
+    } else if (p < c.end && *p == '+') {
+        p++;
+    }
+    if (p == c.end || *p < '0' || *p > '9') {
+        return error(c, p, "Unexpected char, we expected a number");
+    }
+
+    int32_t val = 0;
+    while (p < c.end && *p >= '0' && *p <= '9') {
+        const int32_t val2 = val*10 + (*p - '0');
+        if (val2 < val) {
+            return error(c, p, "The variable number is to high");
+        }
+        val = val2;
+        p++;
+    }
+    ret = mult*val;
+    return true;
+}
+
+inline bool ParallelDimacsParser::read_lits(
+    Chunk& c
+    , const char*& p
+    , vector<Lit>& out
+) const {
+    int32_t parsed_lit;
+    for (;;) {
+        if (!parse_int(c, p, parsed_lit)) {
+            return false;
+        }
+        if (parsed_lit == 0) {
+            break;
+        }
+
+        const uint32_t var = std::abs(parsed_lit)-1;
+        if (var > max_var) {
+            return error(c, p, "Variable requested is too large for DIMACS parser parameter: "
+                + std::to_string(var));
+        }
+        if (var >= (1ULL<<28)) {
+            return error(c, p, "Variable requested is far too large: "
+                + std::to_string(var+1));
+        }
+        if ((int64_t)var > c.max_var) {
+            c.max_var = var;
+            c.max_var_pos = p;
+        }
+
+        out.push_back(Lit(var, parsed_lit < 0));
+        if (p == c.end || (*p != ' ' && *p != '\n')) {
+            return error(c, p, "After last element on the line must be 0");
+        }
+    }
+    out.push_back(lit_Undef);
+
+    return true;
+}
+
+inline bool ParallelDimacsParser::skip_eol(Chunk& c, const char*& p) const
+{
+    for (; p < c.end; p++) {
+        if (*p == '\n') {
+            p++;
+            return true;
+        }
+        if (*p != ' ' && *p != '\r') {
+            return error(c, p, "After end of clause, there is more data on the line");
+        }
+    }
+    return true;
+}
+
+inline bool ParallelDimacsParser::parse_header(Chunk& c, const char*& p) const
+{
+    const char* const str = "p cnf";
+    for(size_t i = 0; str[i] != 0; i++, p++) {
+        if (p == c.end || *p != str[i]) {
+            return error(c, p, "Unexpected char in the header");
+        }
+    }
+
+    int32_t vars;
+    int32_t cls;
+    if (!parse_int(c, p, vars) || !parse_int(c, p, cls)) {
+        return false;
+    }
+    if (vars < 0) {
+        return error(c, p, "Number of variables in header cannot be less than 0");
+    }
+    if (cls < 0) {
+        return error(c, p, "Number of clauses in header cannot be less than 0");
+    }
+
+    if (c.num_headers == 0) {
+        c.header_vars = vars;
+        c.header_cls = cls;
+    }
+    c.num_headers++;
+
+    const char* eol = (const char*)memchr(p, '\n', c.end - p);
+    p = (eol == NULL) ? c.end : eol+1;
+    return true;
+}
+
+inline bool ParallelDimacsParser::parse_comment(Chunk& c, const char*& p) const
+{
+    while (p < c.end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) {
+        p++;
+    }
+    const char* str = p;
+    while (p < c.end && *p != ' ' && *p != '\n') {
+        p++;
+    }
+
+    if (p - str == 3 && memcmp(str, "ind", 3) == 0) {
+        int32_t parsed_lit;
+        for (;;) {
+            if (!parse_int(c, p, parsed_lit)) {
+                return false;
+            }
+            if (parsed_lit == 0) {
+                break;
+            }
+            c.indep.push_back(std::abs(parsed_lit)-1);
+        }
+    }
+
+    const char* eol = (const char*)memchr(p, '\n', c.end - p);
+    p = (eol == NULL) ? c.end : eol+1;
+    return true;
+}
+
+inline void ParallelDimacsParser::parse_chunk(Chunk& c) const
+{
+    const char* p = c.begin;
+    for (;;) {
+        while (p < c.end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) {
+            p++;
+        }
+        if (p == c.end) {
+            return;
+        }
+
+        switch (*p) {
+        case 'p':
+            if (!parse_header(c, p)) {
+                return;
+            }
+            break;
+        case 'c':
+        case 'w':
+            p++;
+            if (!parse_comment(c, p)) {
+                return;
+            }
+            break;
+        case 'x': {
+            p++;
+            const size_t at = c.xor_lits.size();
+            if (!read_lits(c, p, c.xor_lits) || !skip_eol(c, p)) {
+                return;
+            }
+            if (c.xor_lits.size() == at+1) {
+                //empty XOR is ignored
+                c.xor_lits.pop_back();
+            } else {
+                c.num_xors++;
+                c.cls_before_header |= (c.num_headers == 0);
+            }
+            break;
+        }
+        default:
+            if (!read_lits(c, p, c.lits)) {
+                return;
+            }
+            while (p < c.end && (*p == ' ' || *p == '\t')) {
+                p++;
+            }
+            if (!skip_eol(c, p)) {
+                return;
+            }
+            c.num_cls++;
+            c.cls_before_header |= (c.num_headers == 0);
+            break;
+        }
+    }
+}
+
+inline void ParallelDimacsParser::add_xors(const Chunk& c)
+{
+    vector<uint32_t> vars;
+    bool rhs = true;
+    for(const Lit lit: c.xor_lits) {
+        if (lit == lit_Undef) {
+            solver->add_xor_clause(vars, rhs);
+            vars.clear();
+            rhs = true;
+            continue;
+        }
+        vars.push_back(lit.var());
+        rhs ^= lit.sign();
+    }
+}
+
+inline bool ParallelDimacsParser::parse_DIMACS(const bool _strict_header)
+{
+    strict_header = _strict_header;
+    const uint32_t origNumVars = solver->nVars();
+    chunks.clear();
+    split_into_chunks();
+    num_chunks = chunks.size();
+
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        for(size_t i = next++; i < chunks.size(); i = next++) {
+            parse_chunk(chunks[i]);
+        }
+    };
+    vector<std::thread> threads;
+    const size_t num = std::min<size_t>(num_threads, chunks.size());
+    for(size_t i = 1; i < num; i++) {
+        threads.push_back(std::thread(worker));
+    }
+    worker();
+    for(std::thread& t: threads) {
+        t.join();
+    }
+
+    //Errors and the header are checked in file order
+    const Chunk* header = NULL;
+    bool cls_before_header = false;
+    int64_t max_var_seen = -1;
+    const char* max_var_pos = NULL;
+    for(const Chunk& c: chunks) {
+        if (c.err_pos != NULL) {
+            std::cerr
+            << "PARSE ERROR! " << c.err << endl
+            << "--> At line " << line_of(c.err_pos)
+            << please_read_dimacs
+            << endl;
+            return false;
+        }
+        if (header == NULL) {
+            cls_before_header |= c.cls_before_header;
+            if (c.num_headers > 0) {
+                header = &c;
+            }
+        }
+        if (strict_header
+            && (c.num_headers > 1 || (c.num_headers == 1 && header != &c))
+        ) {
+            std::cerr << "ERROR: CNF header ('p cnf vars cls') found twice in file! Exiting." << endl;
+            return false;
+        }
+        if (c.max_var > max_var_seen) {
+            max_var_seen = c.max_var;
+            max_var_pos = c.max_var_pos;
+        }
+    }
+
+    if (strict_header && cls_before_header) {
+        std::cerr
+        << "ERROR! "
+        << "DIMACS header ('p cnf vars cls') never found!" << endl;
+        return false;
+    }
+
+    int64_t need_vars = max_var_seen+1;
+    if (header != NULL) {
+        if (verbosity) {
+            cout << "c -- header says num vars:   " << std::setw(12) << header->header_vars << endl;
+            cout << "c -- header says num clauses:" <<  std::setw(12) << header->header_cls << endl;
+        }
+        if (strict_header && max_var_seen >= header->header_vars) {
+            std::cerr
+            << "ERROR! "
+            << "Variable requested is larger than the header told us." << endl
+            << " -> var is : " << max_var_seen + 1 << endl
+            << " -> header told us maximum will be : " << header->header_vars << endl
+            << " -> At line " << line_of(max_var_pos)
+            << endl;
+            return false;
+        }
+        need_vars = std::max<int64_t>(need_vars, header->header_vars);
+    }
+    if ((int64_t)solver->nVars() < need_vars) {
+        solver->new_vars(need_vars - solver->nVars());
+    }
+
+    for(Chunk& c: chunks) {
+        solver->add_clauses(c.lits.data(), c.lits.size());
+        norm_clauses_added += c.num_cls;
+        vector<Lit>().swap(c.lits);
+
+        add_xors(c);
+        xor_clauses_added += c.num_xors;
+        vector<Lit>().swap(c.xor_lits);
+
+        independent_vars.insert(independent_vars.end(), c.indep.begin(), c.indep.end());
+    }
+
+    if (verbosity) {
+        cout
+        << "c -- clauses added: " << norm_clauses_added << endl
+        << "c -- xor clauses added: " << xor_clauses_added << endl
+        << "c -- vars added " << (solver->nVars() - origNumVars) << endl
+        << "c -- parsed in " << num_chunks << " chunks with "
+        << num << " threads"
+        << endl;
+    }
+
+    return true;
+}
+
+#endif //PARALLELDIMACSPARSER_H
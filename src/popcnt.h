@@ -30,8 +30,10 @@ THE SOFTWARE.
 
 #if defined (_MSC_VER)
 #define my_popcnt(x) __popcnt(x)
+#define my_ctz64(x) _tzcnt_u64(x)
 #else
 #define my_popcnt(x) __builtin_popcount(x)
+#define my_ctz64(x) __builtin_ctzll(x)
 #endif
 
 #endif //POPCNT__H
@@ -33,7 +33,7 @@ THE SOFTWARE.
 
 namespace CMSat {
 
-enum PropByType {null_clause_t = 0, clause_t = 1, binary_t = 2};
+enum PropByType {null_clause_t = 0, clause_t = 1, binary_t = 2, shared_t = 3};
 
 class PropBy
 {
@@ -101,6 +101,14 @@ class PropBy
                 | ((uint32_t)hyperBinNotAdded) << 2;
         }
 
+        ///Propagated by a long clause in SharedClauses
+        static PropBy shared_cl(const uint32_t at)
+        {
+            PropBy p(at);
+            p.type = shared_t;
+            return p;
+        }
+
         bool isRedStep() const
         {
             return red_step;
@@ -162,6 +170,14 @@ class PropBy
             return data1;
         }
 
+        uint32_t get_shared_at() const
+        {
+            #ifdef DEBUG_PROPAGATEFROM
+            assert(type == shared_t);
+            #endif
+            return data1;
+        }
+
         bool isNULL() const
         {
             return type == null_clause_t;
@@ -193,6 +209,10 @@ inline std::ostream& operator<<(std::ostream& os, const PropBy& pb)
             os << " clause, num= " << pb.get_offset();
             break;
 
+        case shared_t :
+            os << " shared clause, num= " << pb.get_shared_at();
+            break;
+
         case null_clause_t :
             os << " NULL";
             break;
@@ -35,6 +35,7 @@ THE SOFTWARE.
 #include "time_mem.h"
 #include "varupdatehelper.h"
 #include "watchalgos.h"
+#include "shareddata.h"
 
 using namespace CMSat;
 using std::cout;
@@ -105,8 +106,78 @@ void PropEngine::attachClause(
     #endif //DEBUG_ATTACH
 
     const Lit blocked_lit = c[2];
-    watches[c[0]].push(Watched(offset, blocked_lit));
-    watches[c[1]].push(Watched(offset, blocked_lit));
+    watches[c[0]].push(make_long_watch(c, offset, c[0], blocked_lit));
+    watches[c[1]].push(make_long_watch(c, offset, c[1], blocked_lit));
+}
+
+/**
+@brief Watches the shared long clauses, at decision level 0
+
+Satisfied ones are not watched. The units found are enqueued but not
+propagated. Returns false if one of the clauses is false.
+*/
+bool PropEngine::attach_shared_longs()
+{
+    assert(decisionLevel() == 0);
+    assert(!shared_longs_attached);
+    assert(nVars() == nVarsOuter());
+
+    shared_longs_attached = true;
+    shared_watched.resize(shared_longs->size()*2);
+    for(uint32_t at = 0; at < shared_longs->size(); at++) {
+        Lit* const w = &shared_watched[at*2];
+        w[0] = lit_Undef;
+        w[1] = lit_Undef;
+        uint32_t num_undef = 0;
+        bool satisfied = false;
+        for (const Lit *k = shared_longs->begin(at), *end = shared_longs->end(at)
+            ; k != end
+            ; k++
+        ) {
+            const lbool val = value(*k);
+            if (val == l_True) {
+                satisfied = true;
+                break;
+            }
+            if (val == l_Undef && num_undef < 2) {
+                w[num_undef++] = *k;
+            }
+        }
+
+        if (satisfied) {
+            w[0] = lit_Undef;
+            w[1] = lit_Undef;
+            continue;
+        }
+        if (num_undef == 0) {
+            ok = false;
+            return false;
+        }
+        if (num_undef == 1) {
+            enqueue<false>(w[0]);
+            w[0] = lit_Undef;
+            continue;
+        }
+        watches[w[0]].push(Watched::shared_cl(at, w[1]));
+        watches[w[1]].push(Watched::shared_cl(at, w[0]));
+    }
+
+    return true;
+}
+
+void PropEngine::detach_shared_longs()
+{
+    for(watch_subarray ws: watches) {
+        Watched* i = ws.begin();
+        Watched* j = i;
+        for(Watched* end = ws.end(); i != end; i++) {
+            if (!i->isShared()) {
+                *j++ = *i;
+            }
+        }
+        ws.shrink_(i-j);
+    }
+    shared_longs_attached = false;
 }
 
 /**
@@ -179,6 +250,12 @@ bool PropEngine::prop_long_cl_any_order(
         *j++ = *i;
         return true;
     }
+    #ifdef INLINE_TERNARY_WATCH
+    if (i->isTernary() && value(i->lit3()) == l_True) {
+        *j++ = *i;
+        return true;
+    }
+    #endif
     if (update_bogoprops) {
         propStats.bogoProps += 4;
     }
@@ -201,7 +278,7 @@ bool PropEngine::prop_long_cl_any_order(
         return false;
     } else {
         #ifdef STATS_NEEDED
-        c.stats.propagations_made++;
+        cl_alloc.stats(c).propagations_made++;
         if (c.red())
             propStats.propsLongRed++;
         else
@@ -214,6 +291,71 @@ bool PropEngine::prop_long_cl_any_order(
     return true;
 }
 
+/**
+@brief Propagates a long clause in SharedClauses
+
+The clause can't be reordered, so the two literals watching it are kept in
+"shared_watched", the false one second. Otherwise as prop_long_cl_any_order()
+*/
+template<bool update_bogoprops>
+inline
+bool PropEngine::prop_shared_cl_any_order(
+    Watched* i
+    , Watched*& j
+    , const Lit p
+    , PropBy& confl
+) {
+    //Blocked literal is satisfied, so clause is satisfied
+    if (value(i->getBlockedLit()) == l_True) {
+        *j++ = *i;
+        return true;
+    }
+    if (update_bogoprops) {
+        propStats.bogoProps += 4;
+    }
+
+    const uint32_t at = i->get_shared_at();
+    Lit* const w = &shared_watched[at*2];
+    if (w[0] == ~p) {
+        std::swap(w[0], w[1]);
+    }
+    assert(w[1] == ~p);
+
+    if (value(w[0]) == l_True) {
+        *j++ = Watched::shared_cl(at, w[0]);
+        return true;
+    }
+
+    // Look for new watch:
+    for (const Lit *k = shared_longs->begin(at), *end = shared_longs->end(at)
+        ; k != end
+        ; k++
+    ) {
+        if (*k != w[0] && value(*k) != l_False) {
+            w[1] = *k;
+            watches[*k].push(Watched::shared_cl(at, w[0]));
+            return true;
+        }
+    }
+
+    // Did not find watch -- clause is unit under assignment:
+    *j++ = *i;
+    if (value(w[0]) == l_False) {
+        confl = PropBy::shared_cl(at);
+        #ifdef STATS_NEEDED
+        lastConflictCausedBy = ConflCausedBy::longirred;
+        #endif
+        qhead = trail.size();
+        return false;
+    }
+
+    #ifdef STATS_NEEDED
+    propStats.propsLongIrred++;
+    #endif
+    enqueue<update_bogoprops>(w[0], PropBy::shared_cl(at));
+    return true;
+}
+
 PropBy PropEngine::propagate_any_order_fast()
 {
     PropBy confl;
@@ -260,6 +402,18 @@ PropBy PropEngine::propagate_any_order_fast()
                 continue;
             }
 
+            if (i->isShared()) {
+                if (!prop_shared_cl_any_order<false>(i, j, p, confl)) {
+                    i++;
+                    while (i < end) {
+                        *j++ = *i++;
+                    }
+                } else {
+                    i++;
+                }
+                continue;
+            }
+
             //propagate normal clause
             //assert(i->isClause());
             Lit blocked = i->getBlockedLit();
@@ -267,6 +421,12 @@ PropBy PropEngine::propagate_any_order_fast()
                 *j++ = *i++;
                 continue;
             }
+            #ifdef INLINE_TERNARY_WATCH
+            if (i->isTernary() && value(i->lit3()) == l_True) {
+                *j++ = *i++;
+                continue;
+            }
+            #endif
 
             const ClOffset offset = i->get_offset();
             Clause& c = *cl_alloc.ptr(offset);
@@ -278,7 +438,7 @@ PropBy PropEngine::propagate_any_order_fast()
             i++;
 
             Lit     first = c[0];
-            Watched w     = Watched(offset, first);
+            Watched w     = make_long_watch(c, offset, false_lit, first);
             if (first != blocked && value(first) == l_True) {
                 *j++ = w;
                 continue;
@@ -290,6 +450,11 @@ PropBy PropEngine::propagate_any_order_fast()
                 if (likely(value(c[k]) != l_False)) {
                     c[1] = c[k];
                     c[k] = false_lit;
+                    #ifdef INLINE_TERNARY_WATCH
+                    if (c.size() == 3) {
+                        w = make_long_watch(c, offset, c[1], first);
+                    }
+                    #endif
                     watches[c[1]].push(w);
                     goto nextClause;
                 }
@@ -329,6 +494,117 @@ PropBy PropEngine::propagate_any_order_fast()
     return confl;
 }
 
+/**
+@brief Propagates all binary implications of the trail before any long clause
+
+Relies on the watchlists being partitioned so that binary watches come first
+(see partition_watches_bin_first()). The binary prefix of each watchlist is
+walked in a tight loop without touching the clause arena. Long clauses are
+then visited one literal at a time, and any binary watches that were appended
+after the partitioning (e.g. learnt binaries) are handled there.
+*/
+PropBy PropEngine::propagate_bin_first()
+{
+    PropBy confl;
+    uint32_t binQHead = qhead;
+    int64_t num_props = 0;
+
+    while (qhead < trail.size()) {
+        //Exhaust binary implications of everything on the trail
+        while (binQHead < trail.size()) {
+            const Lit p = trail[binQHead++];
+            watch_subarray_const ws = watches[~p];
+            for (const Watched *i = ws.begin(), *end = ws.end()
+                ; i != end && i->isBin()
+                ; i++
+            ) {
+                const lbool val = value(i->lit2());
+                if (val == l_Undef) {
+                    enqueue<false>(i->lit2(), PropBy(~p, i->red()));
+                } else if (val == l_False) {
+                    confl = PropBy(~p, i->red());
+                    failBinLit = i->lit2();
+                    #ifdef STATS_NEEDED
+                    if (i->red())
+                        lastConflictCausedBy = ConflCausedBy::binred;
+                    else
+                        lastConflictCausedBy = ConflCausedBy::binirred;
+                    #endif
+                    qhead = trail.size();
+                    goto done;
+                }
+            }
+        }
+
+        //Long clauses (and late binaries) of one literal
+        const Lit p = trail[qhead++];
+        watch_subarray ws = watches[~p];
+        Watched* i = ws.begin();
+        Watched* end = ws.end();
+        num_props++;
+
+        //Binary prefix has already been propagated
+        while (i != end && i->isBin()) {
+            i++;
+        }
+        Watched* j = i;
+
+        for (; i != end; i++) {
+            if (i->isBin()) {
+                *j++ = *i;
+                if (!prop_bin_cl<false>(i, p, confl)) {
+                    i++;
+                    break;
+                }
+                continue;
+            }
+
+            if (i->isShared()) {
+                if (!prop_shared_cl_any_order<false>(i, j, p, confl)) {
+                    i++;
+                    break;
+                }
+                continue;
+            }
+
+            if (!prop_long_cl_any_order<false>(i, j, p, confl)) {
+                i++;
+                break;
+            }
+        }
+        while (i != end) {
+            *j++ = *i++;
+        }
+        ws.shrink_(end-j);
+
+        if (!confl.isNULL()) {
+            break;
+        }
+    }
+
+    done:
+    qhead = trail.size();
+    simpDB_props -= num_props;
+    propStats.propagations += (uint64_t)num_props;
+
+    return confl;
+}
+
+/**
+@brief Moves binary watches to the front of each watchlist
+
+Needed for propagate_bin_first() to be able to walk binary implications
+without checking the rest of the watchlist. Order is kept otherwise.
+*/
+void PropEngine::partition_watches_bin_first()
+{
+    for(watch_subarray ws: watches) {
+        std::stable_partition(ws.begin(), ws.end(),
+            [](const Watched& w) {return w.isBin();}
+        );
+    }
+}
+
 template<bool update_bogoprops>
 PropBy PropEngine::propagate_any_order()
 {
@@ -358,6 +634,14 @@ PropBy PropEngine::propagate_any_order()
                 continue;
             }
 
+            if (i->isShared()) {
+                if (!prop_shared_cl_any_order<update_bogoprops>(i, j, p, confl)) {
+                    i++;
+                    break;
+                }
+                continue;
+            }
+
             //propagate normal clause
             if (!prop_long_cl_any_order<update_bogoprops>(i, j, p, confl)) {
                 i++;
@@ -451,6 +735,17 @@ inline void PropEngine::updateWatch(
         } else {
             it->setBlockedLit(blocked_lit);
         }
+
+        #ifdef INLINE_TERNARY_WATCH
+        if (it->isTernary()) {
+            const Lit lit3 = getUpdatedLit(it->lit3(), outerToInter);
+            if (found && (cl[0] == lit3 || cl[1] == lit3 || cl[2] == lit3)) {
+                it->setLit3(lit3);
+            } else {
+                *it = Watched(it->get_offset(), it->getBlockedLit());
+            }
+        }
+        #endif
     }
 }
 
@@ -596,3 +891,15 @@ void PropEngine::load_state(SimpleInFile& f)
 
     CNF::load_state(f);
 }
+
+void PropEngine::copy_state_from(const PropEngine& other)
+{
+    assert(other.decisionLevel() == 0);
+    CNF::copy_state_from(other);
+
+    trail = other.trail;
+    qhead = other.qhead;
+    var_act_vsids = other.var_act_vsids;
+    var_act_maple = other.var_act_maple;
+    propStats = other.propStats;
+}
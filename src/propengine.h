@@ -118,6 +118,7 @@ protected:
     //For state saving
     void save_state(SimpleOutFile& f) const;
     void load_state(SimpleInFile& f);
+    void copy_state_from(const PropEngine& other);
 
     //Stats for conflicts
     ConflCausedBy lastConflictCausedBy;
@@ -152,7 +153,9 @@ protected:
     template<bool update_bogoprops>
     PropBy propagate_any_order();
     PropBy propagate_any_order_fast();
+    PropBy propagate_bin_first();
     PropBy propagate_strict_order();
+    void partition_watches_bin_first();
     /*template<bool update_bogoprops>
     bool handle_xor_cl(
         Watched*& i
@@ -168,6 +171,19 @@ protected:
         , const Lit p
     );
     PropResult handle_normal_prop_fail(Clause& c, ClOffset offset, PropBy& confl);
+    template<bool update_bogoprops>
+    bool prop_shared_cl_any_order(
+        Watched* i
+        , Watched*& j
+        , const Lit p
+        , PropBy& confl
+    );
+    Watched make_long_watch(
+        const Clause& c
+        , const ClOffset offset
+        , const Lit watched_lit
+        , const Lit blocked_lit
+    ) const;
 
     /////////////////
     // Operations on clauses:
@@ -176,6 +192,8 @@ protected:
         const Clause& c
         , const bool checkAttach = true
     );
+    bool attach_shared_longs();
+    void detach_shared_longs();
 
     void detach_bin_clause(
         Lit lit1
@@ -309,6 +327,40 @@ uint32_t PropEngine::calc_glue(const T& ps)
     return nblevels;
 }
 
+/**
+@brief Creates the watch of clause 'c' for the watchlist of 'watched_lit'
+
+With INLINE_TERNARY_WATCH, 3-long clauses get both of their other literals
+stored in the watch.
+*/
+inline Watched PropEngine::make_long_watch(
+    const Clause&
+    #ifdef INLINE_TERNARY_WATCH
+    c
+    #endif
+    , const ClOffset offset
+    , const Lit
+    #ifdef INLINE_TERNARY_WATCH
+    watched_lit
+    #endif
+    , const Lit blocked_lit
+) const {
+    #ifdef INLINE_TERNARY_WATCH
+    if (c.size() == 3) {
+        Lit other = c[0];
+        if (other == watched_lit || other == blocked_lit) {
+            other = c[1];
+            if (other == watched_lit || other == blocked_lit) {
+                other = c[2];
+            }
+        }
+        return Watched(offset, blocked_lit, other);
+    }
+    #endif
+
+    return Watched(offset, blocked_lit);
+}
+
 inline PropResult PropEngine::prop_normal_helper(
     Clause& c
     , ClOffset offset
@@ -316,7 +368,7 @@ inline PropResult PropEngine::prop_normal_helper(
     , const Lit p
 ) {
     #ifdef STATS_NEEDED
-    c.stats.clause_looked_at++;
+    cl_alloc.stats(c).clause_looked_at++;
     #endif
 
     // Make sure the false literal is data[1]:
@@ -328,7 +380,7 @@ inline PropResult PropEngine::prop_normal_helper(
 
     // If 0th watch is true, then clause is already satisfied.
     if (value(c[0]) == l_True) {
-        *j = Watched(offset, c[0]);
+        *j = make_long_watch(c, offset, c[1], c[0]);
         j++;
         return PROP_NOTHING;
     }
@@ -342,7 +394,7 @@ inline PropResult PropEngine::prop_normal_helper(
         if (value(*k) != l_False) {
             c[1] = *k;
             *k = ~p;
-            watches[c[1]].push(Watched(offset, c[0]));
+            watches[c[1]].push(make_long_watch(c, offset, c[1], c[0]));
             return PROP_NOTHING;
         }
     }
@@ -370,8 +422,8 @@ inline PropResult PropEngine::handle_normal_prop_fail(
 
     //Update stats
     #ifdef STATS_NEEDED
-    c.stats.conflicts_made++;
-    c.stats.sum_of_branch_depth_conflict += decisionLevel() + 1;
+    cl_alloc.stats(c).conflicts_made++;
+    cl_alloc.stats(c).sum_of_branch_depth_conflict += decisionLevel() + 1;
     if (c.red())
         lastConflictCausedBy = ConflCausedBy::longred;
     else
@@ -28,21 +28,6 @@ THE SOFTWARE.
 
 using namespace CMSat;
 
-struct SortRedClsGlue
-{
-    explicit SortRedClsGlue(ClauseAllocator& _cl_alloc) :
-        cl_alloc(_cl_alloc)
-    {}
-    ClauseAllocator& cl_alloc;
-
-    bool operator () (const ClOffset xOff, const ClOffset yOff) const
-    {
-        const Clause* x = cl_alloc.ptr(xOff);
-        const Clause* y = cl_alloc.ptr(yOff);
-        return x->stats.glue < y->stats.glue;
-    }
-};
-
 struct SortRedClsSize
 {
     explicit SortRedClsSize(ClauseAllocator& _cl_alloc) :
@@ -58,18 +43,11 @@ struct SortRedClsSize
     }
 };
 
-struct SortRedClsAct
+struct SortRedClsKey
 {
-    explicit SortRedClsAct(ClauseAllocator& _cl_alloc) :
-        cl_alloc(_cl_alloc)
-    {}
-    ClauseAllocator& cl_alloc;
-
-    bool operator () (const ClOffset xOff, const ClOffset yOff) const
+    bool operator () (const ReduceDB::ClSortKey& x, const ReduceDB::ClSortKey& y) const
     {
-        const Clause* x = cl_alloc.ptr(xOff);
-        const Clause* y = cl_alloc.ptr(yOff);
-        return x->stats.activity > y->stats.activity;
+        return x.key < y.key;
     }
 };
 
@@ -78,22 +56,38 @@ ReduceDB::ReduceDB(Solver* _solver) :
 {
 }
 
+//The keys are collected in one pass, so the sort itself only moves
+//(key, offset) pairs around and does not touch the clauses
 void ReduceDB::sort_red_cls(ClauseClean clean_type)
 {
-    switch (clean_type) {
-        case ClauseClean::glue : {
-            std::sort(solver->longRedCls[2].begin(), solver->longRedCls[2].end(), SortRedClsGlue(solver->cl_alloc));
-            break;
-        }
+    vector<ClOffset>& cls = solver->longRedCls[2];
+    sort_keys.clear();
+    sort_keys.reserve(cls.size());
+    for(const ClOffset offset: cls) {
+        const ClauseStats& stats = solver->cl_alloc.stats(*solver->cl_alloc.ptr(offset));
+        ClSortKey k;
+        k.offset = offset;
+        switch (clean_type) {
+            case ClauseClean::glue : {
+                k.key = stats.glue;
+                break;
+            }
 
-        case ClauseClean::activity : {
-            std::sort(solver->longRedCls[2].begin(), solver->longRedCls[2].end(), SortRedClsAct(solver->cl_alloc));
-            break;
-        }
+            case ClauseClean::activity : {
+                k.key = -(double)stats.activity;
+                break;
+            }
 
-        default: {
-            assert(false && "Unknown cleaning type");
+            default: {
+                assert(false && "Unknown cleaning type");
+            }
         }
+        sort_keys.push_back(k);
+    }
+
+    std::sort(sort_keys.begin(), sort_keys.end(), SortRedClsKey());
+    for(size_t i = 0; i < sort_keys.size(); i++) {
+        cls[i] = sort_keys[i].offset;
     }
 }
 
@@ -168,15 +162,16 @@ void ReduceDB::dump_sql_cl_data()
             Clause* cl = solver->cl_alloc.ptr(offs);
             assert(!cl->getRemoved());
             assert(!cl->freed());
-            if (cl->stats.dump_number < 50000) {
+            ClauseStats& stats = solver->cl_alloc.stats(*cl);
+            if (stats.dump_number < 50000) {
                 const bool locked = solver->clause_locked(*cl, offs);
                 solver->sqlStats->reduceDB(
                     solver
                     , locked
                     , cl
                 );
-                cl->stats.dump_number++;
-                cl->stats.reset_rdb_stats();
+                stats.dump_number++;
+                stats.reset_rdb_stats();
             }
         }
     }
@@ -198,18 +193,19 @@ void ReduceDB::handle_lev1()
     ) {
         const ClOffset offset = solver->longRedCls[1][i];
         Clause* cl = solver->cl_alloc.ptr(offset);
-        if (cl->stats.which_red_array == 0) {
+        ClauseStats& stats = solver->cl_alloc.stats(*cl);
+        if (stats.which_red_array == 0) {
             solver->longRedCls[0].push_back(offset);
             moved_w0++;
-        } else if (cl->stats.which_red_array == 2) {
+        } else if (stats.which_red_array == 2) {
             assert(false && "we should never move up through any other means");
         } else {
             if (!solver->clause_locked(*cl, offset)
-                && cl->stats.last_touched + solver->conf.must_touch_lev1_within < solver->sumConflicts
+                && stats.last_touched + solver->conf.must_touch_lev1_within < solver->sumConflicts
             ) {
                 solver->longRedCls[2].push_back(offset);
-                cl->stats.which_red_array = 2;
-                cl->stats.activity = 0;
+                stats.which_red_array = 2;
+                stats.activity = 0;
                 solver->bump_cl_act<false>(cl);
                 non_recent_use++;
             } else {
@@ -248,19 +244,20 @@ void ReduceDB::mark_top_N_clauses(const uint64_t keep_num)
     ) {
         const ClOffset offset = solver->longRedCls[2][i];
         Clause* cl = solver->cl_alloc.ptr(offset);
+        ClauseStats& stats = solver->cl_alloc.stats(*cl);
 
         if (cl->used_in_xor()
-            || cl->stats.ttl > 0
+            || stats.ttl > 0
             || solver->clause_locked(*cl, offset)
-            || cl->stats.which_red_array != 2
+            || stats.which_red_array != 2
         ) {
             //no need to mark, skip
             continue;
         }
 
-        if (!cl->stats.marked_clause) {
+        if (!stats.marked_clause) {
             marked++;
-            cl->stats.marked_clause = true;
+            stats.marked_clause = true;
         }
     }
 }
@@ -269,8 +266,8 @@ bool ReduceDB::cl_needs_removal(const Clause* cl, const ClOffset offset) const
 {
     assert(cl->red());
     return !cl->used_in_xor()
-         && !cl->stats.marked_clause
-         && cl->stats.ttl == 0
+         && !solver->cl_alloc.stats(*cl).marked_clause
+         && solver->cl_alloc.stats(*cl).ttl == 0
          && !solver->clause_locked(*cl, offset);
 }
 
@@ -283,30 +280,31 @@ void ReduceDB::remove_cl_from_lev2() {
         ClOffset offset = solver->longRedCls[2][i];
         Clause* cl = solver->cl_alloc.ptr(offset);
         assert(cl->size() > 2);
+        ClauseStats& stats = solver->cl_alloc.stats(*cl);
 
         //move to another array
-        if (cl->stats.which_red_array < 2) {
-            cl->stats.marked_clause = 0;
-            solver->longRedCls[cl->stats.which_red_array].push_back(offset);
+        if (stats.which_red_array < 2) {
+            stats.marked_clause = 0;
+            solver->longRedCls[stats.which_red_array].push_back(offset);
             continue;
         }
-        assert(cl->stats.which_red_array == 2);
+        assert(stats.which_red_array == 2);
 
         //Check if locked, or marked or ttl-ed
-        if (cl->stats.marked_clause) {
+        if (stats.marked_clause) {
             cl_marked++;
-        } else if (cl->stats.ttl != 0) {
+        } else if (stats.ttl != 0) {
             cl_ttl++;
         } else if (solver->clause_locked(*cl, offset)) {
             cl_locked_solver++;
         }
 
         if (!cl_needs_removal(cl, offset)) {
-            if (cl->stats.ttl > 0) {
-                cl->stats.ttl--;
+            if (stats.ttl > 0) {
+                stats.ttl--;
             }
             solver->longRedCls[2][j++] = offset;
-            cl->stats.marked_clause = 0;
+            stats.marked_clause = 0;
             continue;
         }
 
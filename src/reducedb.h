@@ -43,6 +43,11 @@ public:
     uint64_t nbReduceDB_lev1 = 0;
     uint64_t nbReduceDB_lev2 = 0;
 
+    struct ClSortKey {
+        double key;
+        ClOffset offset;
+    };
+
 private:
     Solver* solver;
     vector<ClOffset> delayed_clause_free;
@@ -60,6 +65,7 @@ private:
     void remove_cl_from_lev2();
 
     void sort_red_cls(ClauseClean clean_type);
+    vector<ClSortKey> sort_keys;
     void mark_top_N_clauses(const uint64_t keep_num);
 };
 
@@ -35,6 +35,7 @@ THE SOFTWARE.
 #include <ratio>
 #include "sqlstats.h"
 #include "datasync.h"
+#include "shareddata.h"
 #include "reducedb.h"
 #include "sqlstats.h"
 #include "watchalgos.h"
@@ -80,6 +81,8 @@ Searcher::Searcher(const SolverConf *_conf, Solver* _solver, std::atomic<bool>*
         , sum_Enpropagate(0)
         , sum_Enunit(0)
         , sum_EnGauss(0)
+        , sum_initReused(0)
+        , sum_initReusedTime(0)
         #endif //USE_GAUSS
         , solver(_solver)
         , cla_inc(1)
@@ -98,7 +101,7 @@ Searcher::Searcher(const SolverConf *_conf, Solver* _solver, std::atomic<bool>*
 Searcher::~Searcher()
 {
     #ifdef USE_GAUSS
-    clearEnGaussMatrixes();
+    clearEnGaussMatrixes(false);
     #endif
 }
 
@@ -142,6 +145,18 @@ void Searcher::updateVars(
     updateArray(var_act_maple, interToOuter);
 
     renumber_assumptions(outerToInter);
+
+    #ifdef USE_GAUSS
+    for(GaussKept& k: gmatrixes_kept) {
+        for(Xor& x: k.input) {
+            updateVarsMap(x, outerToInter);
+        }
+        for(Xor& x: k.rows) {
+            updateVarsMap(x, outerToInter);
+        }
+        updateVarsMap(k.col_order, outerToInter);
+    }
+    #endif
 }
 
 void Searcher::renumber_assumptions(const vector<uint32_t>& outerToInter)
@@ -279,7 +294,7 @@ void Searcher::create_otf_subsuming_long_clause(
         << "New smaller clause OTF:" << cl << endl;
     }
     #ifdef STATS_NEEDED
-    cl.stats.ID = clauseID;
+    cl_alloc.stats(cl).ID = clauseID;
     #endif
     *drat << add << cl
     #ifdef STATS_NEEDED
@@ -318,6 +333,7 @@ void Searcher::normalClMinim()
         const PropBy& reason = varData[learnt_clause[i].var()].reason;
         size_t size;
         Clause* cl = NULL;
+        const Lit* shared = NULL;
         PropByType type = reason.getType();
         if (type == null_clause_t) {
             learnt_clause[j++] = learnt_clause[i];
@@ -334,6 +350,11 @@ void Searcher::normalClMinim()
                 size = 1;
                 break;
 
+            case shared_t:
+                shared = shared_longs->begin(reason.get_shared_at());
+                size = shared_longs->end(reason.get_shared_at()) - shared;
+                break;
+
             default:
                 release_assert(false);
                 std::exit(-1);
@@ -350,6 +371,14 @@ void Searcher::normalClMinim()
                     p = reason.lit2();
                     break;
 
+                case shared_t:
+                    //The implied literal can be anywhere in it
+                    p = shared[k];
+                    if (p.var() == learnt_clause[i].var()) {
+                        continue;
+                    }
+                    break;
+
                 default:
                     release_assert(false);
                     std::exit(-1);
@@ -401,24 +430,25 @@ void Searcher::update_clause_glue_from_analysis(Clause* cl)
 {
     assert(cl->red());
     const unsigned new_glue = calc_glue(*cl);
+    ClauseStats& cl_stats = cl_alloc.stats(*cl);
 
-    if (new_glue < cl->stats.glue) {
-        if (cl->stats.glue <= conf.protect_cl_if_improved_glue_below_this_glue_for_one_turn) {
-            cl->stats.ttl = 1;
+    if (new_glue < cl_stats.glue) {
+        if (cl_stats.glue <= conf.protect_cl_if_improved_glue_below_this_glue_for_one_turn) {
+            cl_stats.ttl = 1;
         }
-        cl->stats.glue = new_glue;
+        cl_stats.glue = new_glue;
 
         //move to lev0 if very low glue
         if (new_glue <= conf.glue_put_lev0_if_below_or_eq
-            && cl->stats.which_red_array >= 1
+            && cl_stats.which_red_array >= 1
         ) {
-            cl->stats.which_red_array = 0;
+            cl_stats.which_red_array = 0;
         } else {
             //move to lev1 if low glue
             if (new_glue <= conf.glue_put_lev1_if_below_or_eq
                 && solver->conf.glue_put_lev1_if_below_or_eq != 0
             ) {
-                cl->stats.which_red_array = 1;
+                cl_stats.which_red_array = 1;
             }
         }
      }
@@ -452,13 +482,14 @@ Clause* Searcher::add_literals_from_confl_to_learnt(
 
         case clause_t : {
             cl = cl_alloc.ptr(confl.get_offset());
+            ClauseStats& cl_stats = cl_alloc.stats(*cl);
             if (cl->red()) {
                 stats.resolvs.longRed++;
                 #ifdef STATS_NEEDED
-                antec_data.vsids_of_ants.push(cl->stats.antec_data.vsids_vars.avg());
+                antec_data.vsids_of_ants.push(cl_stats.antec_data.vsids_vars.avg());
                 antec_data.longRed++;
-                antec_data.age_long_reds.push(sumConflicts - cl->stats.introduced_at_conflict);
-                antec_data.glue_long_reds.push(cl->stats.glue);
+                antec_data.age_long_reds.push(sumConflicts - cl_stats.introduced_at_conflict);
+                antec_data.glue_long_reds.push(cl_stats.glue);
                 #endif
             } else {
                 #ifdef STATS_NEEDED
@@ -468,21 +499,21 @@ Clause* Searcher::add_literals_from_confl_to_learnt(
             }
             #ifdef STATS_NEEDED
             antec_data.size_longs.push(cl->size());
-            cl->stats.used_for_uip_creation++;
+            cl_stats.used_for_uip_creation++;
             #endif
 
             if (!update_bogoprops
                 && cl->red()
-                && cl->stats.which_red_array != 0
+                && cl_stats.which_red_array != 0
             ) {
                 if (conf.update_glues_on_analyze) {
                     update_clause_glue_from_analysis(cl);
                 }
 
                 //If STATS_NEEDED then bump acitvity of ALL clauses
-                if (cl->stats.which_red_array == 1) {
-                    cl->stats.last_touched = sumConflicts;
-                } else if (cl->stats.which_red_array == 2) {
+                if (cl_stats.which_red_array == 1) {
+                    cl_stats.last_touched = sumConflicts;
+                } else if (cl_stats.which_red_array == 2) {
                     #ifndef STATS_NEEDED
                     bump_cl_act<update_bogoprops>(cl);
                     #endif
@@ -495,6 +526,25 @@ Clause* Searcher::add_literals_from_confl_to_learnt(
             break;
         }
 
+        case shared_t : {
+            #ifdef STATS_NEEDED
+            antec_data.longIrred++;
+            #endif
+            stats.resolvs.longIrred++;
+
+            //The implied literal can be anywhere in it
+            const uint32_t at = confl.get_shared_at();
+            for (const Lit *k = shared_longs->begin(at), *end = shared_longs->end(at)
+                ; k != end
+                ; k++
+            ) {
+                if (p == lit_Undef || k->var() != p.var()) {
+                    add_lit_to_learnt<update_bogoprops>(*k);
+                }
+            }
+            return NULL;
+        }
+
         case null_clause_t:
         default:
             assert(false && "Error in conflict analysis (otherwise should be UIP)");
@@ -521,6 +571,7 @@ Clause* Searcher::add_literals_from_confl_to_learnt(
                     cont = false;
                 }
                 break;
+            case shared_t:
             case null_clause_t:
                 assert(false);
         }
@@ -672,7 +723,7 @@ inline Clause* Searcher::create_learnt_clause(PropBy confl)
             //A long clause
             && last_resolved_cl != NULL
             //Good enough clause to try to minimize
-            && (!last_resolved_cl->red() || last_resolved_cl->stats.glue <= conf.doOTFSubsumeOnlyAtOrBelowGlue)
+            && (!last_resolved_cl->red() || cl_alloc.stats(*last_resolved_cl).glue <= conf.doOTFSubsumeOnlyAtOrBelowGlue)
             //Must subsume, so must be smaller
             && last_resolved_cl->size() > tmp_learnt_clause_size
             //Must not be a temporary clause
@@ -737,6 +788,20 @@ void Searcher::simple_create_learnt_clause(
                     seen[q.var()] = 1;
                     mypathC++;
                 }
+            } else if (confl.getType() == shared_t) {
+                const uint32_t at = confl.get_shared_at();
+                for (const Lit *k = shared_longs->begin(at), *end = shared_longs->end(at)
+                    ; k != end
+                    ; k++
+                ) {
+                    if (p != lit_Undef && k->var() == p.var()) {
+                        continue;
+                    }
+                    if (!seen[k->var()]) {
+                        seen[k->var()] = 1;
+                        mypathC++;
+                    }
+                }
             } else {
                 const Clause& c = *solver->cl_alloc.ptr(confl.get_offset());
 
@@ -899,6 +964,18 @@ Clause* Searcher::analyze_conflict(
                             toClear.push_back(l);
                         }
                     }
+                } else if (varData[v].reason.getType() == shared_t) {
+                    const uint32_t at = varData[v].reason.get_shared_at();
+                    for (const Lit *k = shared_longs->begin(at), *end = shared_longs->end(at)
+                        ; k != end
+                        ; k++
+                    ) {
+                        if (!seen[k->var()]) {
+                            seen[k->var()] = true;
+                            varData[k->var()].conflicted+=bump_by;
+                            toClear.push_back(*k);
+                        }
+                    }
                 } else if (varData[v].reason.getType() == binary_t) {
                     Lit l = varData[v].reason.lit2();
                     if (!seen[l.var()]) {
@@ -946,7 +1023,8 @@ bool Searcher::litRedundant(const Lit p, uint32_t abstract_levels)
         cout << "At point in litRedundant: " << analyze_stack.top() << endl;
         #endif
 
-        const PropBy reason = varData[analyze_stack.top().var()].reason;
+        const uint32_t implied_var = analyze_stack.top().var();
+        const PropBy reason = varData[implied_var].reason;
         PropByType type = reason.getType();
         analyze_stack.pop();
 
@@ -955,6 +1033,7 @@ bool Searcher::litRedundant(const Lit p, uint32_t abstract_levels)
 
         size_t size;
         Clause* cl = NULL;
+        const Lit* shared = NULL;
         switch (type) {
             case clause_t:
                 cl = cl_alloc.ptr(reason.get_offset());
@@ -965,6 +1044,11 @@ bool Searcher::litRedundant(const Lit p, uint32_t abstract_levels)
                 size = 1;
                 break;
 
+            case shared_t:
+                shared = shared_longs->begin(reason.get_shared_at());
+                size = shared_longs->end(reason.get_shared_at()) - shared;
+                break;
+
             case null_clause_t:
             default:
                 release_assert(false);
@@ -984,6 +1068,14 @@ bool Searcher::litRedundant(const Lit p, uint32_t abstract_levels)
                     p2 = reason.lit2();
                     break;
 
+                case shared_t:
+                    //The implied literal can be anywhere in it
+                    p2 = shared[i];
+                    if (p2.var() == implied_var) {
+                        continue;
+                    }
+                    break;
+
                 case null_clause_t:
                 default:
                     release_assert(false);
@@ -1087,6 +1179,19 @@ void Searcher::analyze_final_confl_with_assumptions(const Lit p, vector<Lit>& ou
                         break;
                     }
 
+                    case PropByType::shared_t: {
+                        const uint32_t at = reason.get_shared_at();
+                        for (const Lit *k = shared_longs->begin(at), *end = shared_longs->end(at)
+                            ; k != end
+                            ; k++
+                        ) {
+                            if (varData[k->var()].level > 0) {
+                                seen[k->var()] = 1;
+                            }
+                        }
+                        break;
+                    }
+
                     default:
                         assert(false);
                         break;
@@ -1117,17 +1222,22 @@ void Searcher::update_assump_conflict_to_orig_outside(vector<Lit>& out_conflict)
     cout << endl;*/
 
     uint32_t at_assump = 0;
+    size_t j = 0;
     for(size_t i = 0; i < out_conflict.size(); i++) {
-        Lit& lit = out_conflict[i];
+        const Lit lit = out_conflict[i];
         while(lit != ~assumptions[at_assump].lit_inter) {
             at_assump++;
             assert(at_assump < assumptions.size() && "final conflict contains literals that are not from the assumptions!");
         }
         assert(lit == ~assumptions[at_assump].lit_inter);
 
-        //Update to correct outside lit
-        lit = ~assumptions[at_assump].lit_orig_outside;
+        //Update to correct outside lit. Snapshot selectors have none, the
+        //caller doesn't know about them
+        if (assumptions[at_assump].lit_orig_outside != lit_Undef) {
+            out_conflict[j++] = ~assumptions[at_assump].lit_orig_outside;
+        }
     }
+    out_conflict.resize(j);
 }
 
 void Searcher::check_blocking_restart()
@@ -1181,6 +1291,8 @@ lbool Searcher::search()
         #endif
         if (update_bogoprops) {
             confl = propagate<update_bogoprops>();
+        } else if (conf.propBinFirst) {
+            confl = propagate_bin_first();
         } else {
             confl = propagate_any_order_fast();
         }
@@ -1422,7 +1534,7 @@ void Searcher::add_otf_subsume_long_clauses()
             if (decisionLevel() == 0) {
                 *drat << add << cl[0]
                 #ifdef STATS_NEEDED
-                << cl.stats.ID
+                << cl_alloc.stats(cl).ID
                 << sumConflicts
                 #endif
                 << fin;
@@ -1581,12 +1693,15 @@ void Searcher::attach_and_enqueue_learnt_clause(Clause* cl, bool enq)
         default:
             //Long learnt
             stats.learntLongs++;
+            if (cl->red()) {
+                solver->datasync->signalNewLongClause(learnt_clause, cl_alloc.stats(*cl).glue);
+            }
             solver->attachClause(*cl, enq);
             if (enq) enqueue(learnt_clause[0], PropBy(cl_alloc.get_offset(cl)));
             bump_cl_act<update_bogoprops>(cl);
 
             #ifdef STATS_NEEDED
-            cl->stats.antec_data = antec_data;
+            cl_alloc.stats(*cl).antec_data = antec_data;
             propStats.propsLongRed++;
             #endif
 
@@ -1702,7 +1817,8 @@ Clause* Searcher::handle_last_confl_otf_subsumption(
             , clauseID
             #endif
             );
-            cl->makeRed(glue);
+            cl->makeRed();
+            cl_alloc.stats(*cl).glue = glue;
             ClOffset offset = cl_alloc.get_offset(cl);
             unsigned which_arr = 2;
 
@@ -1722,15 +1838,15 @@ Clause* Searcher::handle_last_confl_otf_subsumption(
             }
 
             /*if (conf.guess_cl_effectiveness) {
-                unsigned lower_it = guess_clause_array(cl->stats, decisionLevel());
+                unsigned lower_it = guess_clause_array(cl_alloc.stats(*cl), decisionLevel());
                 if (lower_it) {
                     stats.guess_different++;
-                    cl->stats.ttl = 1;
+                    cl_alloc.stats(*cl).ttl = 1;
                 }
             }*/
 
-            cl->stats.which_red_array = which_arr;
-            solver->longRedCls[cl->stats.which_red_array].push_back(offset);
+            cl_alloc.stats(*cl).which_red_array = which_arr;
+            solver->longRedCls[which_arr].push_back(offset);
             *drat << add << *cl
             #ifdef STATS_NEEDED
             << sumConflicts
@@ -1752,11 +1868,11 @@ Clause* Searcher::handle_last_confl_otf_subsumption(
         assert(cl->size() == learnt_clause.size());
 
         //Update stats
-        if (cl->red() && cl->stats.glue > glue) {
-            cl->stats.glue = glue;
+        if (cl->red() && cl_alloc.stats(*cl).glue > glue) {
+            cl_alloc.stats(*cl).glue = glue;
         }
         #ifdef STATS_NEEDED
-        cl->stats.ID = clauseID;
+        cl_alloc.stats(*cl).ID = clauseID;
         #endif
 
         *(solver->drat) << add << *cl
@@ -1780,7 +1896,7 @@ Clause* Searcher::handle_last_confl_otf_subsumption(
 
         if (dump_this_many_cldata_in_stream >= 0) {
             if (cl) {
-                cl->stats.dump_number = 0;
+                cl_alloc.stats(*cl).dump_number = 0;
             }
             dump_this_many_cldata_in_stream--;
             dump_sql_clause_data(
@@ -2240,6 +2356,10 @@ lbool Searcher::solve(
     }
     #endif //USE_GAUSS
 
+    if (conf.propBinFirst) {
+        partition_watches_bin_first();
+    }
+
     assert(solver->check_order_heap_sanity());
     while(stats.conflStats.numConflicts < max_confl_per_search_solve_call
         && status == l_Undef
@@ -2256,6 +2376,7 @@ lbool Searcher::solve(
         status = search<false>();
         if (status == l_Undef) {
             adjust_phases_restarts();
+            solver->report_progress();
         }
 
         if (must_abort(status)) {
@@ -3159,7 +3280,7 @@ void Searcher::write_long_cls(
         }
         if (red) {
             assert(cl.red());
-            f.put_struct(cl.stats);
+            f.put_struct(cl_alloc.stats(cl));
         }
     }
 }
@@ -3192,22 +3313,21 @@ void Searcher::read_long_cls(
         #endif
         );
         if (red) {
-            cl->makeRed(cl_stats.glue, cla_inc);
+            cl->makeRed();
+            cl_stats.which_red_array = 2;
+            if (cl_stats.glue <= conf.glue_put_lev0_if_below_or_eq) {
+                cl_stats.which_red_array = 0;
+            } else if (cl_stats.glue <= conf.glue_put_lev1_if_below_or_eq
+                && conf.glue_put_lev1_if_below_or_eq != 0
+            ) {
+                cl_stats.which_red_array = 1;
+            }
         }
-        cl->stats = cl_stats;
+        cl_alloc.stats(*cl) = cl_stats;
         attachClause(*cl);
         const ClOffset offs = cl_alloc.get_offset(cl);
         if (red) {
-            cl->stats.which_red_array = 2;
-            if (cl->stats.glue <= conf.glue_put_lev0_if_below_or_eq) {
-                cl->stats.which_red_array = 0;
-            } else if (cl->stats.glue <= conf.glue_put_lev1_if_below_or_eq
-                && conf.glue_put_lev1_if_below_or_eq != 0
-            ) {
-                cl->stats.which_red_array = 1;
-            }
-
-            longRedCls[0].push_back(cl->stats.which_red_array);
+            longRedCls[0].push_back(cl_stats.which_red_array);
             litStats.redLits += cl->size();
         } else {
             longIrredCls.push_back(offs);
@@ -3307,6 +3427,35 @@ void Searcher::load_state(SimpleInFile& f, const lbool status)
     }
 }
 
+void Searcher::copy_state_from(const Searcher& other)
+{
+    PropEngine::copy_state_from(other);
+
+    var_inc_vsids = other.var_inc_vsids;
+    var_decay_vsids = other.var_decay_vsids;
+    step_size = other.step_size;
+    cla_inc = other.cla_inc;
+    rebuildOrderHeap();
+
+    MTRand::uint32 rand_state[MTRand::SAVE];
+    other.mtrand.save(rand_state);
+    mtrand.load(rand_state);
+
+    model = other.model;
+    conflict = other.conflict;
+    decisions_reaching_model = other.decisions_reaching_model;
+    decisions_reaching_model_valid = other.decisions_reaching_model_valid;
+    hist = other.hist;
+    stats = other.stats;
+    max_confl_phase = other.max_confl_phase;
+    max_confl_this_phase = other.max_confl_this_phase;
+    next_lev1_reduce = other.next_lev1_reduce;
+    next_lev2_reduce = other.next_lev2_reduce;
+    lastCleanZeroDepthAssigns = other.lastCleanZeroDepthAssigns;
+    more_red_minim_limit_binary_actual = other.more_red_minim_limit_binary_actual;
+    more_red_minim_limit_cache_actual = other.more_red_minim_limit_cache_actual;
+}
+
 
 //Normal running
 template
@@ -3437,7 +3586,14 @@ inline bool Searcher::check_order_heap_sanity() const
 }
 
 #ifdef USE_GAUSS
-void Searcher::clearEnGaussMatrixes()
+/**
+@brief Deletes the matrixes
+
+Unless keep is false, their rows are kept, so init_all_matrixes() can start
+from them, if it's given the same XORs again. Otherwise the kept rows are
+dropped, too -- call it so when the XORs they came from are not valid anymore.
+*/
+void Searcher::clearEnGaussMatrixes(const bool keep)
 {
     for (auto& gqd: gqueuedata) {
         if (solver->conf.verbosity && gqd.big_gaussnum > 0) {
@@ -3454,12 +3610,20 @@ void Searcher::clearEnGaussMatrixes()
             cout << "c [gauss] sum_Enpropagate: "; print_value_kilo_mega(sum_Enpropagate); cout << endl;
             cout << "c [gauss] sum_Enconflict : "; print_value_kilo_mega(sum_Enconflict); cout << endl;
             cout << "c [gauss] sum_EnGauss    : "; print_value_kilo_mega(sum_EnGauss); cout << endl;
+            cout << "c [gauss] sum_initReused : "; print_value_kilo_mega(sum_initReused); cout << endl;
+            cout << "c [gauss] reuse saved T  : " << std::fixed << std::setprecision(2) << sum_initReusedTime << endl;
         }
         gqd.reset_stats();
     }
 
     //cout << "Clearing matrixes" << endl;
+    if (!keep) {
+        gmatrixes_kept.clear();
+    }
     for(EGaussian* g: gmatrixes) {
+        if (keep && okay()) {
+            gmatrixes_kept.push_back(g->get_kept());
+        }
         delete g;
     }
     for(auto& w: gwatches) {
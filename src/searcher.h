@@ -124,10 +124,11 @@ class Searcher : public HyperEngine
 
         //Gauss
         #ifdef USE_GAUSS
-        void clearEnGaussMatrixes();  //  clear Gaussian matrixes
+        void clearEnGaussMatrixes(const bool keep = true);  //  clear Gaussian matrixes
         llbool Gauss_elimination(); // gaussian elimination in DPLL
         vector<EGaussian*> gmatrixes;   // enhance gaussian matrix
         vector<GaussQData> gqueuedata;
+        vector<GaussKept> gmatrixes_kept; // matrixes of the last search, to seed the next
 
         uint32_t sum_gauss_called;
         uint32_t sum_gauss_confl;
@@ -147,6 +148,8 @@ class Searcher : public HyperEngine
         uint32_t sum_Enpropagate;    // the total sum of propagation in gaussian matrx
         uint32_t sum_Enunit;            // the total sum of number getting two-variable xor clasue in  gaussian matrix
         uint32_t sum_EnGauss;        // the total sum of time entering gaussian matrix
+        uint32_t sum_initReused;     // the total sum of matrixes seeded from a kept one
+        double   sum_initReusedTime; // the total time saved by seeding, compared to eliminating from scratch
 
         void testing_fill_assumptions_set()
         {
@@ -184,6 +187,7 @@ class Searcher : public HyperEngine
         );
         void save_state(SimpleOutFile& f, const lbool status) const;
         void load_state(SimpleInFile& f, const lbool status);
+        void copy_state_from(const Searcher& other);
         void write_long_cls(
             const vector<ClOffset>& clauses
             , SimpleOutFile& f
@@ -403,6 +407,7 @@ class Searcher : public HyperEngine
         FRIEND_TEST(SearcherTest, pickpolar_neg);
         FRIEND_TEST(SearcherTest, pickpolar_auto);
         FRIEND_TEST(SearcherTest, pickpolar_auto_not_changed_by_simp);
+        FRIEND_TEST(SearcherTest, propagate_bin_first);
         #endif
 
         ///Decay all variables with the specified factor. Implemented by increasing the 'bump' value instead.
@@ -514,18 +519,19 @@ inline void Searcher::bump_cl_act(Clause* cl)
 
     assert(!cl->getRemoved());
 
-    double new_val = cla_inc + (double)cl->stats.activity;
-    cl->stats.activity = (float)new_val;
-    if (cl->stats.activity > 1e20F ) {
+    ClauseStats& cl_stats = cl_alloc.stats(*cl);
+    double new_val = cla_inc + (double)cl_stats.activity;
+    cl_stats.activity = (float)new_val;
+    if (cl_stats.activity > 1e20F ) {
         // Rescale. For STATS_NEEDED we rescale ALL
         #ifndef STATS_NEEDED
         for(ClOffset offs: longRedCls[2]) {
-            cl_alloc.ptr(offs)->stats.activity *= static_cast<float>(1e-20);
+            cl_alloc.stats(*cl_alloc.ptr(offs)).activity *= static_cast<float>(1e-20);
         }
         #else
         for(auto& lrcs: longRedCls) {
             for(ClOffset offs: lrcs) {
-                cl_alloc.ptr(offs)->stats.activity *= static_cast<float>(1e-20);
+                cl_alloc.stats(*cl_alloc.ptr(offs)).activity *= static_cast<float>(1e-20);
             }
         }
         #endif
@@ -24,20 +24,185 @@ THE SOFTWARE.
 #define SHARED_DATA_H
 
 #include "cryptominisat5/solvertypesmini.h"
+#include "solverconf.h"
 
 #include <vector>
 #include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <algorithm>
+#include <cassert>
 using std::vector;
 using std::mutex;
 
 namespace CMSat {
 
+//Longest learnt clause that can be shared, and number of clauses each thread
+//can have in flight before the oldest ones are overwritten
+#define SHARED_LONG_MAX_SIZE 16
+#define SHARED_LONG_RING_BITS 14
+
+/**
+@brief Irredundant long clauses that several solvers propagate, but none changes
+
+Only the watches of these live in the solvers, see CNF::shared_longs.
+Literals are in the outer numbering of the solver that exported them. The
+solvers using them never renumber, so this is their inter numbering, too.
+Clause "at" is lits[start[at]] ... lits[start[at+1]-1].
+*/
+struct SharedClauses
+{
+    vector<Lit> lits;
+    vector<uint64_t> start = vector<uint64_t>(1, 0);
+
+    uint32_t size() const
+    {
+        return start.size()-1;
+    }
+
+    const Lit* begin(const uint32_t at) const
+    {
+        return lits.data() + start[at];
+    }
+
+    const Lit* end(const uint32_t at) const
+    {
+        return lits.data() + start[at+1];
+    }
+
+    void add(const vector<Lit>& cl)
+    {
+        lits.insert(lits.end(), cl.begin(), cl.end());
+        start.push_back(lits.size());
+    }
+
+    size_t mem_used() const
+    {
+        return lits.capacity()*sizeof(Lit) + start.capacity()*sizeof(uint64_t);
+    }
+};
+
+/**
+@brief The simplified problem of a solver, in outer numbering
+
+The solver importing it first re-creates the same outer variables, including
+the ones BVA or XOR cutting added, so outer numbers match.
+Clauses are started by lit_Undef. Each entry of the elimination stack is
+the literal it is blocked on, then its clauses, each ended by lit_Undef,
+and the entry is ended by lit_Error. Entries are in elimination order.
+*/
+struct SimplifiedCNF
+{
+    uint32_t num_vars = 0;
+    vector<uint32_t> bva_vars; ///<outer numbers of BVA variables, ascending
+    vector<Lit> cls;
+    vector<Lit> elim_stack;
+    vector<Lit> snapshot_selectors; ///<outer numbering, see Solver::new_snapshot()
+
+    void clear()
+    {
+        num_vars = 0;
+        bva_vars.clear();
+        snapshot_selectors.clear();
+        cls.clear();
+        cls.shrink_to_fit();
+        elim_stack.clear();
+        elim_stack.shrink_to_fit();
+    }
+};
+
 class SharedData
 {
     public:
         SharedData(const uint32_t _num_threads) :
             num_threads(_num_threads)
-        {}
+        {
+            for(uint32_t i = 0; i < num_threads; i++) {
+                longs.push_back(new LongRing);
+                progress.push_back(Progress());
+                progress.back().conf_of = i;
+            }
+        }
+
+        ~SharedData()
+        {
+            for(LongRing* ring: longs) {
+                delete ring;
+            }
+        }
+
+        /**
+        @brief Short learnt clauses of one thread, in outside numbering
+
+        Only the owning thread writes it, the others read it without locking.
+        A slot's "seq" is odd while it is being written and 2*(pos+1) once
+        the clause at position "pos" is in it. Readers check "seq" before and
+        after copying, and skip the slot if it has been overwritten since.
+        */
+        struct LongRing {
+            struct Slot {
+                std::atomic<uint64_t> seq;
+                std::atomic<uint32_t> glue;
+                std::atomic<uint32_t> size;
+                std::atomic<uint32_t> lits[SHARED_LONG_MAX_SIZE];
+            };
+
+            LongRing() :
+                slots(new Slot[1ULL << SHARED_LONG_RING_BITS]())
+            {
+                head.store(0, std::memory_order_relaxed);
+            }
+
+            ~LongRing() {
+                delete[] slots;
+            }
+
+            void push(const vector<Lit>& lits, const uint32_t glue)
+            {
+                assert(lits.size() <= SHARED_LONG_MAX_SIZE);
+                const uint64_t pos = head.load(std::memory_order_relaxed);
+                Slot& slot = slots[pos & mask];
+                slot.seq.store(2*pos+1, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_release);
+                slot.glue.store(glue, std::memory_order_relaxed);
+                slot.size.store(lits.size(), std::memory_order_relaxed);
+                for(size_t i = 0; i < lits.size(); i++) {
+                    slot.lits[i].store(lits[i].toInt(), std::memory_order_relaxed);
+                }
+                slot.seq.store(2*pos+2, std::memory_order_release);
+                head.store(pos+1, std::memory_order_release);
+            }
+
+            //False if the clause at "pos" has been overwritten (or is being)
+            bool get(const uint64_t pos, vector<Lit>& lits, uint32_t& glue) const
+            {
+                const Slot& slot = slots[pos & mask];
+                if (slot.seq.load(std::memory_order_acquire) != 2*pos+2) {
+                    return false;
+                }
+                glue = slot.glue.load(std::memory_order_relaxed);
+                const uint32_t size = std::min<uint32_t>(
+                    slot.size.load(std::memory_order_relaxed), SHARED_LONG_MAX_SIZE);
+                lits.resize(size);
+                for(uint32_t i = 0; i < size; i++) {
+                    lits[i] = Lit::toLit(slot.lits[i].load(std::memory_order_relaxed));
+                }
+                std::atomic_thread_fence(std::memory_order_acquire);
+                return slot.seq.load(std::memory_order_relaxed) == 2*pos+2;
+            }
+
+            uint64_t get_head() const
+            {
+                return head.load(std::memory_order_acquire);
+            }
+
+            static const uint64_t num_slots = 1ULL << SHARED_LONG_RING_BITS;
+            static const uint64_t mask = num_slots - 1;
+
+            private:
+                Slot* slots;
+                std::atomic<uint64_t> head;
+        };
 
         struct Spec {
             Spec() :
@@ -71,6 +236,45 @@ class SharedData
         vector<Spec> bins;
         std::mutex unit_mutex;
         std::mutex bin_mutex;
+        vector<LongRing*> longs; ///<one per thread, indexed by thread number
+
+        //Startup simplification done once, by thread 0, for all threads
+        std::mutex startup_mutex;
+        std::condition_variable startup_cond;
+        bool startup_pending = false; ///<thread 0 has yet to publish
+        bool startup_cloned = false; ///<"startup_cnf" is valid
+        SimplifiedCNF startup_cnf;
+        SharedClauses irred_longs; ///<taken out of "startup_cnf" when shared
+
+        //Lets the waiting threads go, even if nothing was published
+        void release_startup()
+        {
+            std::unique_lock<std::mutex> lock(startup_mutex);
+            startup_pending = false;
+            startup_cond.notify_all();
+        }
+
+        //False if thread 0 finished without publishing its simplified problem
+        bool wait_startup()
+        {
+            std::unique_lock<std::mutex> lock(startup_mutex);
+            startup_cond.wait(lock, [this]{ return !startup_pending; });
+            return startup_cloned;
+        }
+
+        /**
+        @brief For the adaptive portfolio, how well each thread is doing
+
+        "score" is 0 until the thread has published one. "conf_of" is the
+        thread whose initial configuration (in "thread_confs") it now runs.
+        */
+        struct Progress {
+            double score = 0;
+            uint32_t conf_of;
+        };
+        std::mutex progress_mutex;
+        vector<Progress> progress;
+        vector<SolverConf> thread_confs;
 
         uint32_t num_threads;
 
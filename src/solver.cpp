@@ -45,6 +45,7 @@ THE SOFTWARE.
 #include "completedetachreattacher.h"
 #include "compfinder.h"
 #include "comphandler.h"
+#include "shareddata.h"
 #include "subsumestrengthen.h"
 #include "watchalgos.h"
 #include "clauseallocator.h"
@@ -107,6 +108,7 @@ Solver::Solver(const SolverConf *_conf, std::atomic<bool>* _must_interrupt_inter
     Searcher::solver = this;
     reduceDB = new ReduceDB(this);
 
+    cl_alloc.set_explicit_hugepages(conf.explicit_hugepages);
     set_up_sql_writer();
     next_lev1_reduce = conf.every_lev1_reduce;
     next_lev2_reduce =  conf.every_lev2_reduce;
@@ -151,10 +153,10 @@ void Solver::set_sqlite(string
     #endif
 }
 
-void Solver::set_shared_data(SharedData* shared_data)
+void Solver::set_shared_data(SharedData* shared_data, uint32_t thread_num)
 {
     delete datasync;
-    datasync = new DataSync(this, shared_data);
+    datasync = new DataSync(this, shared_data, thread_num);
 }
 
 bool Solver::add_xor_clause_inter(
@@ -162,6 +164,7 @@ bool Solver::add_xor_clause_inter(
     , bool rhs
     , const bool attach
     , bool addDrat
+    , const Lit selector
 ) {
     assert(ok);
     assert(!attach || qhead == trail.size());
@@ -182,12 +185,16 @@ bool Solver::add_xor_clause_inter(
     //cout << "Cleaned ps is: " << ps << endl;
 
     if (!ps.empty()) {
-        if (ps.size() > 2) {
+        //An XOR that only holds while "selector" is false can't be used by
+        //Gauss-Jordan elimination
+        if (ps.size() > 2 && selector == lit_Undef) {
             xorclauses.push_back(Xor(ps, rhs));
         }
         ps[0] ^= rhs;
     } else {
-        if (rhs) {
+        if (rhs && selector != lit_Undef) {
+            add_clause_int(vector<Lit>{selector}, false, ClauseStats(), attach, NULL, addDrat);
+        } else if (rhs) {
             *drat << add
             #ifdef STATS_NEEDED
             << clauseID++ << sumConflicts
@@ -199,7 +206,7 @@ bool Solver::add_xor_clause_inter(
     }
 
     //cout << "without rhs is: " << ps << endl;
-    add_every_combination_xor(ps, attach, addDrat);
+    add_every_combination_xor(ps, attach, addDrat, selector);
 
     return ok;
 }
@@ -208,6 +215,7 @@ void Solver::add_every_combination_xor(
     const vector<Lit>& lits
     , const bool attach
     , const bool addDrat
+    , const Lit selector
 ) {
     //cout << "add_every_combination got: " << lits << endl;
 
@@ -245,7 +253,7 @@ void Solver::add_every_combination_xor(
             lastlit_added = toadd;
         }
 
-        add_xor_clause_inter_cleaned_cut(xorlits, attach, addDrat);
+        add_xor_clause_inter_cleaned_cut(xorlits, attach, addDrat, selector);
         if (!ok)
             break;
 
@@ -257,6 +265,7 @@ void Solver::add_xor_clause_inter_cleaned_cut(
     const vector<Lit>& lits
     , const bool attach
     , const bool addDrat
+    , const Lit selector
 ) {
     //cout << "xor_inter_cleaned_cut got: " << lits << endl;
     vector<Lit> new_lits;
@@ -271,10 +280,13 @@ void Solver::add_xor_clause_inter_cleaned_cut(
             bool xorwith = (i >> at)&1;
             new_lits.push_back(lits[at] ^ xorwith);
         }
+        if (selector != lit_Undef) {
+            new_lits.push_back(selector);
+        }
         //cout << "Added. " << new_lits << endl;
         Clause* cl = add_clause_int(new_lits, false, ClauseStats(), attach, NULL, addDrat);
         if (cl) {
-            cl->set_used_in_xor(true);
+            cl->set_used_in_xor(selector == lit_Undef);
             longIrredCls.push_back(cl_alloc.get_offset(cl));
         }
 
@@ -447,11 +459,11 @@ Clause* Solver::add_clause_int(
             #endif
             );
             if (red) {
-                c->makeRed(cl_stats.glue);
+                c->makeRed();
             }
-            c->stats = cl_stats;
+            cl_alloc.stats(*c) = cl_stats;
             #ifdef STATS_NEEDED
-            c->stats.introduced_at_conflict = introduced_at_conflict;
+            cl_alloc.stats(*c).introduced_at_conflict = introduced_at_conflict;
             #endif
 
             //In class 'OccSimplifier' we don't need to attach normall
@@ -712,15 +724,16 @@ bool Solver::addClauseInt(vector<Lit>& ps, bool red)
         if (!red) {
             longIrredCls.push_back(offset);
         } else {
-            cl->stats.which_red_array = 2;
-            if (cl->stats.glue <= conf.glue_put_lev0_if_below_or_eq) {
-                cl->stats.which_red_array = 0;
-            } else if (cl->stats.glue <= conf.glue_put_lev1_if_below_or_eq
+            ClauseStats& cl_stats = cl_alloc.stats(*cl);
+            cl_stats.which_red_array = 2;
+            if (cl_stats.glue <= conf.glue_put_lev0_if_below_or_eq) {
+                cl_stats.which_red_array = 0;
+            } else if (cl_stats.glue <= conf.glue_put_lev1_if_below_or_eq
                 && conf.glue_put_lev1_if_below_or_eq != 0
             ) {
-                cl->stats.which_red_array = 1;
+                cl_stats.which_red_array = 1;
             }
-            longRedCls[cl->stats.which_red_array].push_back(offset);
+            longRedCls[cl_stats.which_red_array].push_back(offset);
         }
     }
 
@@ -860,6 +873,18 @@ bool Solver::clean_xor_clauses_from_duplicate_and_set_vars()
         }
     }
 
+    #ifdef USE_GAUSS
+    //Set variables are renumbered away, so they must be cleaned from here, too
+    size_t j = 0;
+    for(size_t i = 0; i < gmatrixes_kept.size(); i++) {
+        GaussKept& k = gmatrixes_kept[i];
+        if (clean_kept_xors(this, k.input) && clean_kept_xors(this, k.rows)) {
+            std::swap(gmatrixes_kept[j++], k);
+        }
+    }
+    gmatrixes_kept.resize(j);
+    #endif
+
     const double time_used = cpuTime() - myTime;
     if (conf.verbosity) {
         cout
@@ -1080,16 +1105,20 @@ void Solver::set_assumptions()
 
     back_number_from_outside_to_outer(outside_assumptions);
     vector<Lit> inter_assumptions = back_number_from_outside_to_outer_tmp;
+    for(const Lit selector: snapshot_selectors) {
+        inter_assumptions.push_back(~selector);
+    }
     addClauseHelper(inter_assumptions);
     assumptionsSet.resize(nVars(), false);
-    if (outside_assumptions.empty()) {
+    if (inter_assumptions.empty()) {
         return;
     }
 
-    assert(inter_assumptions.size() == outside_assumptions.size());
+    //The selectors have no outside literal, they are left out of the conflict
+    assert(inter_assumptions.size() == outside_assumptions.size() + snapshot_selectors.size());
     for(size_t i = 0; i < inter_assumptions.size(); i++) {
         const Lit inter_lit = inter_assumptions[i];
-        const Lit outside_lit = outside_assumptions[i];
+        const Lit outside_lit = i < outside_assumptions.size() ? outside_assumptions[i] : lit_Undef;
         assumptions.push_back(AssumptionPair(inter_lit, outside_lit));
     }
 
@@ -1100,6 +1129,9 @@ void Solver::check_model_for_assumptions() const
 {
     for(const AssumptionPair lit_pair: assumptions) {
         const Lit outside_lit = lit_pair.lit_orig_outside;
+        if (outside_lit == lit_Undef) {
+            continue;
+        }
         assert(outside_lit.var() < model.size());
 
         if (model_value(outside_lit) == l_Undef) {
@@ -1380,6 +1412,7 @@ lbool Solver::simplify_problem_outside()
     if (nVars() > 0 && conf.do_simplify_problem) {
         status = simplify_problem(false);
     }
+    datasync->signalStartupSimplified(status);
     unfill_assumptions_set_from(assumptions);
     assumptions.clear();
     return status;
@@ -1424,6 +1457,15 @@ lbool Solver::solve_with_assumptions(
         cout << "c " << __func__ << " called" << endl;
     }
 
+    #ifdef USE_HUGEPAGES
+    //The clauses were written by the thread that added them. If that ran on
+    //another NUMA node, copy them to memory first touched by this thread, so
+    //they are on its node
+    if (cl_alloc.touched_on_other_node()) {
+        cl_alloc.consolidate(this, true, false, true);
+    }
+    #endif
+
     //Check if adding the clauses caused UNSAT
     lbool status = l_Undef;
     if (!ok) {
@@ -1468,6 +1510,7 @@ lbool Solver::solve_with_assumptions(
     ) {
         status = simplify_problem(!conf.full_simplify_at_startup);
     }
+    datasync->signalStartupSimplified(status);
 
     if (status == l_Undef
         && conf.preprocess == 0
@@ -1494,9 +1537,10 @@ lbool Solver::solve_with_assumptions(
         save_state(conf.saved_state_file, status);
         ClauseDumper dumper(this);
         if (status == l_False) {
-            dumper.open_file_and_write_unsat(conf.simplified_cnf);
+            dumper.open_file_and_write_unsat(conf.simplified_cnf, conf.simplified_cnf_binary);
         } else {
-            dumper.open_file_and_dump_irred_clauses_preprocessor(conf.simplified_cnf);
+            dumper.open_file_and_dump_irred_clauses_preprocessor(
+                conf.simplified_cnf, conf.simplified_cnf_binary);
         }
         cout << "Wrote solver state to file " << conf.saved_state_file
         << " and simplified CNF to file " << conf.simplified_cnf
@@ -1738,6 +1782,7 @@ lbool Solver::iterate_until_solved()
         }
         if (status == l_Undef) {
             check_reconfigure();
+            check_adapt_portfolio();
         }
 
         //Iterate between VSIDS and Maple
@@ -2010,6 +2055,11 @@ lbool Solver::simplify_problem(const bool startup)
     clearEnGaussMatrixes();
     #endif
 
+    //Simplification only sees the clauses of this thread
+    if (shared_longs_attached) {
+        detach_shared_longs();
+    }
+
     if (conf.verbosity >= 6) {
         cout
         << "c " <<  __func__ << " called"
@@ -2039,6 +2089,12 @@ lbool Solver::simplify_problem(const bool startup)
 
     solveStats.numSimplify++;
 
+    if (ok && shared_longs != NULL) {
+        if (attach_shared_longs()) {
+            ok = propagate<false>().isNULL();
+        }
+    }
+
     if (!ok) {
         return l_False;
     } else {
@@ -2101,6 +2157,7 @@ void CMSat::Solver::print_stats(const double cpu_time, const double cpu_time_tot
     } else {
         print_min_stats(cpu_time, cpu_time_total);
     }
+    drat->print_stats();
 }
 
 void Solver::print_min_stats(const double cpu_time, const double cpu_time_total) const
@@ -2392,6 +2449,33 @@ void Solver::print_full_restart_stat(const double cpu_time, const double cpu_tim
     print_mem_stats();
 }
 
+//Every 4KB page needs its own TLB entry, a huge page covers 2MB
+void Solver::print_huge_page_stats(const uint64_t rss_mem_used) const
+{
+    const uint64_t cl_mem = cl_alloc.mem_used();
+    const uint64_t cl_huge = std::min<uint64_t>(cl_alloc.mem_in_huge_pages(), cl_mem);
+    print_stats_line("c Longclauses in huge pages"
+        , cl_huge/(1024UL*1024UL)
+        , "MB"
+        , stats_line_percent(cl_huge, cl_mem)
+        , "%"
+    );
+    const uint64_t huge_page = 2ULL*1024ULL*1024ULL;
+    const uint64_t page = 4096;
+    print_stats_line("c Pages for longclauses"
+        , (cl_huge+huge_page-1)/huge_page + (cl_mem-cl_huge+page-1)/page
+        , "(2MB+4KB)"
+    );
+
+    const uint64_t huge = memUsedHugePages();
+    print_stats_line("c Mem in huge pages"
+        , huge/(1024UL*1024UL)
+        , "MB"
+        , stats_line_percent(huge, rss_mem_used)
+        , "%"
+    );
+}
+
 uint64_t Solver::print_watch_mem_used(const uint64_t rss_mem_used) const
 {
     size_t alloc = watches.mem_used_alloc();
@@ -2442,6 +2526,11 @@ void Solver::print_mem_stats() const
     uint64_t account = 0;
 
     account += print_mem_used_longclauses(rss_mem_used);
+    print_huge_page_stats(rss_mem_used);
+    print_stats_line("c Avg watched longcl dist"
+        , avg_watched_cl_distance()/1024.0
+        , "KB"
+    );
     account += print_watch_mem_used(rss_mem_used);
 
     size_t mem = 0;
@@ -2871,6 +2960,7 @@ void Solver::check_implicit_propagated() const
             //Satisfied, or not implicit, skip
             if (value(lit) == l_True
                 || it2->isClause()
+                || it2->isShared()
             ) {
                 continue;
             }
@@ -3007,6 +3097,9 @@ bool Solver::add_clause_outer(const vector<Lit>& lits, bool red)
     check_too_large_variable_number(lits);
     #endif
     back_number_from_outside_to_outer(lits);
+    if (!snapshot_selectors.empty()) {
+        back_number_from_outside_to_outer_tmp.push_back(snapshot_selectors.back());
+    }
     return addClauseInt(back_number_from_outside_to_outer_tmp, red);
 }
 
@@ -3025,8 +3118,19 @@ bool Solver::add_xor_clause_outer(const vector<uint32_t>& vars, bool rhs)
     #endif
 
     back_number_from_outside_to_outer(lits);
-    addClauseHelper(back_number_from_outside_to_outer_tmp);
-    add_xor_clause_inter(back_number_from_outside_to_outer_tmp, rhs, true, false);
+    vector<Lit>& ps = back_number_from_outside_to_outer_tmp;
+    Lit selector = lit_Undef;
+    if (!snapshot_selectors.empty()) {
+        ps.push_back(snapshot_selectors.back());
+    }
+    if (!addClauseHelper(ps)) {
+        return false;
+    }
+    if (!snapshot_selectors.empty()) {
+        selector = ps.back();
+        ps.pop_back();
+    }
+    add_xor_clause_inter(ps, rhs, true, false, selector);
 
     return ok;
 }
@@ -3220,6 +3324,116 @@ SolveFeatures Solver::calculate_features()
     return feat;
 }
 
+void Solver::report_progress()
+{
+    if (!progress_callback || sumConflicts < next_progress_confl) {
+        return;
+    }
+    next_progress_confl = sumConflicts + progress_every_confl;
+
+    SolveProgress progress;
+    progress.conflicts = sumConflicts;
+    progress.propagations = sumPropStats.propagations + propStats.propagations;
+    progress.restarts = sumRestarts();
+    progress.max_trail_depth = hist.trailDepthHistLT.getMax();
+    double vm_usage;
+    progress.mem_used = memUsedTotal(vm_usage);
+    progress.cpu_time = cpuTime();
+    if (!progress_callback(progress)) {
+        set_must_interrupt_asap();
+    }
+}
+
+/**
+@brief Adaptive portfolio: take the best thread's search configuration if
+this one does much worse
+
+The score since the last check is the conflicts per CPU second, times the
+average trail depth as a ratio of the variables, divided by the average glue
+of the learnt clauses. A configuration must have done
+conf.portfolio_warmup_confl conflicts before it is switched away from.
+*/
+void Solver::check_adapt_portfolio()
+{
+    if (!conf.adaptive_portfolio
+        || datasync == NULL
+        || !datasync->enabled()
+        || nVars() == 0
+    ) {
+        return;
+    }
+
+    const double now = cpuTime();
+    PortfolioCheckpoint cur;
+    cur.confl = sumConflicts;
+    cur.cpu = now;
+    cur.glue_sum = hist.glueHistLTAll.get_sum();
+    cur.glue_num = hist.glueHistLTAll.num_data_elements();
+    cur.trail_sum = hist.trailDepthHistLT.get_sum();
+    cur.trail_num = hist.trailDepthHistLT.num_data_elements();
+    const PortfolioCheckpoint last = portfolio_last;
+    portfolio_last = cur;
+    if (cur.confl <= last.confl
+        || cur.cpu <= last.cpu
+        || cur.glue_num <= last.glue_num
+        || cur.trail_num <= last.trail_num
+    ) {
+        return;
+    }
+
+    const double avg_glue = (double)(cur.glue_sum - last.glue_sum)
+        / (double)(cur.glue_num - last.glue_num);
+    const double avg_trail = (double)(cur.trail_sum - last.trail_sum)
+        / (double)(cur.trail_num - last.trail_num);
+    const double score = (double)(cur.confl - last.confl) / (cur.cpu - last.cpu)
+        * (avg_trail / (double)nVars())
+        / std::max(avg_glue, 1.0);
+
+    const bool may_switch =
+        sumConflicts - portfolio_conf_since >= (uint64_t)conf.portfolio_warmup_confl;
+    SolverConf better;
+    if (!datasync->publish_progress(score, may_switch, better)) {
+        return;
+    }
+
+    adopt_search_conf(better);
+    portfolio_conf_since = sumConflicts;
+    if (conf.verbosity) {
+        cout << "c [adapt] score " << std::setprecision(4) << score
+        << " too low, switched to a better thread's search configuration"
+        << endl;
+    }
+}
+
+//The parts of the configuration the portfolio threads differ in, except
+//for the seed and the simplifications
+void Solver::adopt_search_conf(const SolverConf& other)
+{
+    conf.maple = other.maple;
+    conf.modulo_maple_iter = other.modulo_maple_iter;
+    conf.restartType = other.restartType;
+    conf.restart_first = other.restart_first;
+    conf.restart_inc = other.restart_inc;
+    conf.polarity_mode = other.polarity_mode;
+    conf.var_decay_vsids_max = other.var_decay_vsids_max;
+    conf.ratio_keep_clauses[0] = other.ratio_keep_clauses[0];
+    conf.ratio_keep_clauses[1] = other.ratio_keep_clauses[1];
+    conf.glue_put_lev0_if_below_or_eq = other.glue_put_lev0_if_below_or_eq;
+    conf.glue_put_lev1_if_below_or_eq = other.glue_put_lev1_if_below_or_eq;
+    conf.every_lev1_reduce = other.every_lev1_reduce;
+    conf.every_lev2_reduce = other.every_lev2_reduce;
+    conf.max_temp_lev2_learnt_clauses = other.max_temp_lev2_learnt_clauses;
+    conf.inc_max_temp_lev2_red_cls = other.inc_max_temp_lev2_red_cls;
+    conf.doMinimRedMoreMore = other.doMinimRedMoreMore;
+    conf.max_num_lits_more_more_red_min = other.max_num_lits_more_more_red_min;
+    conf.max_glue_more_minim = other.max_glue_more_minim;
+    conf.more_red_minim_limit_cache = other.more_red_minim_limit_cache;
+    conf.more_red_minim_limit_binary = other.more_red_minim_limit_binary;
+    conf.num_conflicts_of_search_inc = other.num_conflicts_of_search_inc;
+    conf.never_stop_search = other.never_stop_search;
+    reset_temp_cl_num();
+}
+
 void Solver::reconfigure(int val)
 {
     //TODO adjust distill_queue_by !!
@@ -3408,6 +3622,264 @@ lbool Solver::load_state(const string& fname)
     return status;
 }
 
+/**
+@brief Exports the irredundant clauses and the eliminated variables
+
+Replaced variables are exported as eliminated ones, blocked on the
+equivalence with the literal they are replaced with. Their entries come
+first in the elimination stack, as their value is only known once all
+others have been extended. If "longs" is given, the long clauses go there
+instead of into "out".
+*/
+void Solver::export_simplified(SimplifiedCNF& out, SharedClauses* longs)
+{
+    assert(decisionLevel() == 0);
+    assert(okay());
+    release_assert(compHandler == NULL || compHandler->get_num_vars_removed() == 0);
+
+    out.clear();
+    out.num_vars = nVarsOuter();
+    out.snapshot_selectors = snapshot_selectors;
+
+    for(uint32_t outer = 0; outer < nVarsOuter(); outer++) {
+        const uint32_t var = map_outer_to_inter(outer);
+        if (varData[var].is_bva) {
+            out.bva_vars.push_back(outer);
+        }
+        if (varData[var].removed == Removed::none && value(var) != l_Undef) {
+            out.cls.push_back(lit_Undef);
+            out.cls.push_back(Lit(outer, value(var) == l_False));
+        } else if (varData[var].removed == Removed::replaced) {
+            const Lit lit = Lit(outer, false);
+            const Lit repl = varReplacer->get_lit_replaced_with_outer(lit);
+            out.elim_stack.push_back(lit);
+            out.elim_stack.push_back(lit);
+            out.elim_stack.push_back(~repl);
+            out.elim_stack.push_back(lit_Undef);
+            out.elim_stack.push_back(~lit);
+            out.elim_stack.push_back(repl);
+            out.elim_stack.push_back(lit_Undef);
+            out.elim_stack.push_back(lit_Error);
+        }
+    }
+
+    for(size_t i = 0; i < watches.size(); i++) {
+        const Lit lit = Lit::toLit(i);
+        for(const Watched& w: watches[lit]) {
+            if (w.isBin() && !w.red() && lit < w.lit2()) {
+                out.cls.push_back(lit_Undef);
+                out.cls.push_back(map_inter_to_outer(lit));
+                out.cls.push_back(map_inter_to_outer(w.lit2()));
+            }
+        }
+    }
+
+    vector<Lit> lits;
+    for(const ClOffset offs: longIrredCls) {
+        const Clause& cl = *cl_alloc.ptr(offs);
+        if (longs != NULL) {
+            lits.clear();
+            for(const Lit lit: cl) {
+                lits.push_back(map_inter_to_outer(lit));
+            }
+            longs->add(lits);
+            continue;
+        }
+        out.cls.push_back(lit_Undef);
+        for(const Lit lit: cl) {
+            out.cls.push_back(map_inter_to_outer(lit));
+        }
+    }
+
+    if (occsimplifier) {
+        occsimplifier->export_elim_stack(out.elim_stack);
+    }
+}
+
+//Creates the outer variables of an empty solver, "bva_vars" ascending
+void Solver::new_outer_vars(const uint32_t num_vars, const vector<uint32_t>& bva_vars)
+{
+    assert(nVarsOuter() == 0);
+
+    size_t at_bva = 0;
+    for(uint32_t outer = 0; outer < num_vars; ) {
+        if (at_bva < bva_vars.size() && bva_vars[at_bva] == outer) {
+            new_var(true);
+            at_bva++;
+            outer++;
+        } else {
+            const uint32_t next = at_bva < bva_vars.size() ? bva_vars[at_bva] : num_vars;
+            new_vars(next - outer);
+            outer = next;
+        }
+    }
+    assert(nVarsOuter() == num_vars);
+    datasync->rebuild_bva_map();
+}
+
+/**
+@brief Starts this fresh solver from the problem another solver simplified
+
+The variables eliminated there are eliminated here, too. If there is no
+OccSimplifier to keep them, their clauses are added back instead.
+If "longs" is given, it is watched instead of having the long clauses here.
+As it can't be changed, nothing that would have to change it is done:
+no variable elimination, replacement, renumbering or component handling.
+*/
+bool Solver::import_simplified(const SimplifiedCNF& in, const SharedClauses* longs)
+{
+    assert(fresh_solver);
+    new_outer_vars(in.num_vars, in.bva_vars);
+    snapshot_selectors = in.snapshot_selectors;
+
+    vector<Lit> lits;
+    for(size_t at = 0; at < in.cls.size() && ok; ) {
+        assert(in.cls[at] == lit_Undef);
+        lits.clear();
+        for(at++; at < in.cls.size() && in.cls[at] != lit_Undef; at++) {
+            lits.push_back(in.cls[at]);
+        }
+        addClauseInt(lits);
+    }
+    if (!ok) {
+        return false;
+    }
+
+    if (occsimplifier) {
+        occsimplifier->import_elim_stack(in.elim_stack);
+    } else {
+        lits.clear();
+        bool at_start = true;
+        for(const Lit l: in.elim_stack) {
+            if (at_start || l == lit_Error) {
+                at_start = (l == lit_Error);
+            } else if (l == lit_Undef) {
+                if (!addClauseInt(lits)) {
+                    return false;
+                }
+                lits.clear();
+            } else {
+                lits.push_back(l);
+            }
+        }
+    }
+
+    if (longs != NULL) {
+        conf.doVarElim = false;
+        conf.doFindAndReplaceEqLits = false;
+        conf.doIntreeProbe = false;
+        conf.doRenumberVars = false;
+        conf.doCompHandler = false;
+        shared_longs = longs;
+        if (attach_shared_longs()) {
+            ok = propagate<false>().isNULL();
+        }
+    }
+
+    //This counts as the startup simplification
+    solveStats.numSimplify++;
+    if (okay()) {
+        rebuildOrderHeap();
+    }
+    return okay();
+}
+
+/**
+@brief Makes this empty solver a copy of "other", which is at decision level 0
+
+The clause arena, watches and variable data are copied in bulk, not
+re-added clause by clause, so the copy has the same internal numbering,
+learnt clauses, heuristics and elimination stack. "longs" replaces the
+shared irredundant long clauses of "other", if it has any.
+*/
+void Solver::copy_state_from(const Solver& other, const SharedClauses* longs)
+{
+    assert(fresh_solver);
+    assert(other.decisionLevel() == 0);
+    assert((longs != NULL) == (other.shared_longs != NULL));
+
+    vector<uint32_t> bva_vars;
+    for(uint32_t outer = 0; outer < other.nVarsOuter(); outer++) {
+        if (other.varData[other.map_outer_to_inter(outer)].is_bva) {
+            bva_vars.push_back(outer);
+        }
+    }
+    new_outer_vars(other.nVarsOuter(), bva_vars);
+    if (other.nVars() < nVars()) {
+        save_on_var_memory(other.nVars());
+    }
+
+    Searcher::copy_state_from(other);
+    shared_longs = longs;
+    varReplacer->copy_state_from(*other.varReplacer);
+    if (occsimplifier && other.occsimplifier) {
+        occsimplifier->copy_state_from(*other.occsimplifier);
+    }
+    if (compHandler && other.compHandler) {
+        compHandler->copy_state_from(*other.compHandler);
+    }
+
+    sumSearchStats = other.sumSearchStats;
+    sumPropStats = other.sumPropStats;
+    solveStats = other.solveStats;
+    zeroLevAssignsByCNF = other.zeroLevAssignsByCNF;
+    already_reconfigured = other.already_reconfigured;
+    snapshot_selectors = other.snapshot_selectors;
+    datasync->rebuild_bva_map();
+}
+
+/**
+@brief Starts a snapshot, see rollback_snapshots()
+
+The selector is a new hidden variable, like the ones of BVA, so it is not in
+the model, and the numbering of the variables that can be seen does not
+change. Every clause added from now on is extended with it, and it is
+assumed false when solving. Learnt clauses that depend on such a clause
+contain it, too, as assumptions are decisions.
+*/
+void Solver::new_snapshot()
+{
+    assert(decisionLevel() == 0);
+    new_var(true);
+    snapshot_selectors.push_back(Lit(nVarsOuter()-1, false));
+    datasync->rebuild_bva_map();
+}
+
+/**
+@brief Drops the clauses added since the first "keep" snapshots
+
+Their selectors are set to true, which satisfies the clauses added since,
+and the ones learnt from them. They are then removed, at the cost of a pass
+over the clauses, not of a copy of them.
+*/
+bool Solver::rollback_snapshots(const size_t keep)
+{
+    assert(decisionLevel() == 0);
+    assert(keep <= snapshot_selectors.size());
+
+    vector<Lit> unit(1);
+    for(size_t i = keep; i < snapshot_selectors.size() && ok; i++) {
+        unit[0] = snapshot_selectors[i];
+        addClauseInt(unit);
+    }
+    snapshot_selectors.resize(keep);
+    if (!ok) {
+        return false;
+    }
+
+    //The shared long clauses can't be changed, only this thread's
+    const bool reattach = shared_longs_attached;
+    if (reattach) {
+        detach_shared_longs();
+    }
+    clauseCleaner->remove_and_clean_all();
+    if (reattach && attach_shared_longs()) {
+        ok = propagate<false>().isNULL();
+    }
+
+    return ok;
+}
+
 lbool Solver::load_solution_from_file(const string& fname)
 {
     //At this point, model is set up, we just need to fill the l_Undef in
@@ -4005,6 +4477,27 @@ bool Solver::init_all_matrixes()
 {
     assert(ok);
 
+    //seed_from_kept() needs to know which vars are in some matrix
+    for (const EGaussian* g : gmatrixes) {
+        for (const Xor& x : g->xorclauses) {
+            for (uint32_t v : x) {
+                seen2[v] = 1;
+            }
+        }
+    }
+    vector<char> seeded(gmatrixes.size());
+    for (size_t at = 0; at < gmatrixes.size(); at++) {
+        seeded[at] = gmatrixes[at]->seed_from_kept(gmatrixes_kept);
+        sum_initReused += seeded[at];
+    }
+    for (const EGaussian* g : gmatrixes) {
+        for (const Xor& x : g->xorclauses) {
+            for (uint32_t v : x) {
+                seen2[v] = 0;
+            }
+        }
+    }
+
     vector<EGaussian*>::iterator i = gmatrixes.begin();
     vector<EGaussian*>::iterator j = i;
     vector<EGaussian*>::iterator gend = gmatrixes.end();
@@ -4019,6 +4512,9 @@ bool Solver::init_all_matrixes()
         if (!ok) {
             break;
         }
+        if (seeded[i - gmatrixes.begin()]) {
+            sum_initReusedTime += g->get_time_saved();
+        }
         if (created) {
             *j++=*i;
         } else {
@@ -4029,6 +4525,7 @@ bool Solver::init_all_matrixes()
         *j++ = *i++;
     }
     gmatrixes.resize(solver->gmatrixes.size()-(i-j));
+    gmatrixes_kept.clear();
     gqueuedata.resize(gmatrixes.size());
     for(auto& gqd: gqueuedata) {
         gqd.reset_stats();
@@ -4093,7 +4590,7 @@ bool Solver::get_next_small_clause(vector<Lit>& out)
         const ClOffset offs = longRedCls[0][learnt_clause_query_at];
         const Clause* cl = cl_alloc.ptr(offs);
         if (cl->size() <= learnt_clause_query_max_len
-            && cl->stats.glue <= learnt_clause_query_max_glue
+            && cl_alloc.stats(*cl).glue <= learnt_clause_query_max_glue
         ) {
             out = clause_outer_numbered(*cl);
             if (all_vars_outside(out)) {
@@ -4153,3 +4650,93 @@ void Solver::learnt_clausee_query_map_without_bva(vector<Lit>& cl)
         l = Lit(learnt_clause_query_outer_to_without_bva_map[l.var()], l.sign());
     }
 }
+
+/**
+@brief Lookahead for cube-and-conquer: the variable to split "outside_cube" on
+
+Both polarities of the "num_candidates" most active free variables are
+probed under the cube, as failed-literal probing does at level 0. The
+variable whose two branches propagate the most, by the product of the two
+counts, is returned in outside numbering. A failing branch counts as
+propagating everything, as it is refuted at once.
+Returns var_Undef if the cube propagates to a conflict, or nothing is free.
+*/
+uint32_t Solver::pick_cube_var(const vector<Lit>& outside_cube, const uint32_t num_candidates)
+{
+    if (!okay()) {
+        return var_Undef;
+    }
+    assert(decisionLevel() == 0);
+
+    back_number_from_outside_to_outer(outside_cube);
+    vector<Lit> cube = back_number_from_outside_to_outer_tmp;
+    if (!addClauseHelper(cube)) {
+        return var_Undef;
+    }
+
+    //The whole cube is on level 1, each probe on level 2
+    new_decision_level();
+    for(const Lit lit: cube) {
+        if (value(lit) == l_False) {
+            cancelUntil<false, true>(0);
+            return var_Undef;
+        }
+        if (value(lit) == l_Undef) {
+            enqueue(lit);
+            if (!propagate<true>().isNULL()) {
+                cancelUntil<false, true>(0);
+                return var_Undef;
+            }
+        }
+    }
+
+    //Most active first, the ones in more clauses at startup when all are 0
+    const vector<double>& act = VSIDS ? var_act_vsids : var_act_maple;
+    vector<uint32_t> cands;
+    for(uint32_t var = 0; var < nVars(); var++) {
+        if (value(var) == l_Undef
+            && varData[var].removed == Removed::none
+            && !varData[var].is_bva
+        ) {
+            cands.push_back(var);
+        }
+    }
+    const auto more_active = [&](const uint32_t a, const uint32_t b) {
+        if (act[a] != act[b]) {
+            return act[a] > act[b];
+        }
+        return watches[Lit(a, false)].size() + watches[Lit(a, true)].size()
+            > watches[Lit(b, false)].size() + watches[Lit(b, true)].size();
+    };
+    const size_t num = std::min<size_t>(cands.size(), num_candidates);
+    std::partial_sort(cands.begin(), cands.begin() + num, cands.end(), more_active);
+
+    uint32_t best = var_Undef;
+    uint64_t best_score = 0;
+    for(size_t i = 0; i < num; i++) {
+        const uint32_t var = cands[i];
+        uint64_t score = 1;
+        for(const bool sign: {false, true}) {
+            new_decision_level();
+            enqueue(Lit(var, sign));
+            const bool failed = !propagate<true>().isNULL();
+            const uint64_t props = trail.size() - trail_lim.back();
+            cancelUntil<false, true>(1);
+            score *= failed ? nVars() : props;
+        }
+        if (best == var_Undef || score > best_score) {
+            best = var;
+            best_score = score;
+        }
+    }
+    cancelUntil<false, true>(0);
+
+    if (best == var_Undef) {
+        return var_Undef;
+    }
+    best = map_inter_to_outer(best);
+    if (get_num_bva_vars() > 0) {
+        best = build_outer_to_without_bva_map()[best];
+    }
+    return best;
+}
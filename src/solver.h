@@ -29,6 +29,7 @@ THE SOFTWARE.
 #include <iostream>
 #include <utility>
 #include <string>
+#include <functional>
 
 #include "constants.h"
 #include "solvertypes.h"
@@ -65,6 +66,7 @@ class SubsumeStrengthen;
 class SubsumeImplicit;
 class DataSync;
 class SharedData;
+struct SimplifiedCNF;
 class ReduceDB;
 class InTree;
 
@@ -89,7 +91,7 @@ class Solver : public Searcher
 
         lbool solve_with_assumptions(const vector<Lit>* _assumptions, bool only_indep_solution);
         lbool simplify_with_assumptions(const vector<Lit>* _assumptions = NULL);
-        void  set_shared_data(SharedData* shared_data);
+        void  set_shared_data(SharedData* shared_data, uint32_t thread_num);
 
         //Querying model
         lbool model_value (const Lit p) const;  ///<Found model value for lit
@@ -99,6 +101,13 @@ class Solver : public Searcher
         const vector<lbool>& get_model() const;
         const vector<Lit>& get_decisions_reaching_model() const;
         const vector<Lit>& get_final_conflict() const;
+        uint32_t pick_cube_var(const vector<Lit>& outside_cube, const uint32_t num_candidates);
+
+        //Called at restarts, at most every "progress_every_confl" conflicts.
+        //Returning false interrupts the solving
+        std::function<bool(SolveProgress&)> progress_callback;
+        uint64_t progress_every_confl = 10000;
+        void report_progress();
         vector<pair<Lit, Lit> > get_all_binary_xors() const;
         vector<Xor> get_recovered_xors(bool elongate);
         bool get_decision_reaching_valid() const;
@@ -125,12 +134,14 @@ class Solver : public Searcher
         size_t get_num_nonfree_vars() const;
         const SolverConf& getConf() const;
         void setConf(const SolverConf& conf);
+        void adopt_search_conf(const SolverConf& other);
         const BinTriStats& getBinTriStats() const;
         size_t   get_num_long_irred_cls() const;
         size_t   get_num_long_red_cls() const;
         size_t get_num_vars_elimed() const;
         uint32_t num_active_vars() const;
         void print_mem_stats() const;
+        void print_huge_page_stats(uint64_t rss_mem_used) const;
         uint64_t print_watch_mem_used(uint64_t totalMem) const;
         unsigned long get_sql_id() const;
         const SolveStats& get_solve_stats() const;
@@ -172,6 +183,18 @@ class Solver : public Searcher
         //State load/unload
         void save_state(const string& fname, const lbool status) const;
         lbool load_state(const string& fname);
+        void export_simplified(SimplifiedCNF& out, SharedClauses* longs = NULL);
+        bool import_simplified(const SimplifiedCNF& in, const SharedClauses* longs = NULL);
+        void copy_state_from(const Solver& other, const SharedClauses* longs = NULL);
+
+        //Snapshots: the clauses added after new_snapshot() carry its selector
+        //literal, and are only in force while that is assumed false
+        void new_snapshot();
+        bool rollback_snapshots(const size_t keep);
+        size_t num_snapshots() const
+        {
+            return snapshot_selectors.size();
+        }
         template<typename A>
         void parse_v_line(A* in, const size_t lineNum);
         lbool load_solution_from_file(const string& fname);
@@ -183,6 +206,7 @@ class Solver : public Searcher
             , bool rhs
             , bool attach
             , bool addDrat = true
+            , const Lit selector = lit_Undef
         );
         void new_var(const bool bva = false, const uint32_t orig_outer = std::numeric_limits<uint32_t>::max()) override;
         void new_vars(const size_t n) override;
@@ -276,6 +300,20 @@ class Solver : public Searcher
         void check_reconfigure();
         void reconfigure(int val);
         bool already_reconfigured = false;
+
+        //Adaptive portfolio
+        void check_adapt_portfolio();
+        struct PortfolioCheckpoint {
+            uint64_t confl = 0;
+            double cpu = 0;
+            uint64_t glue_sum = 0;
+            size_t glue_num = 0;
+            uint64_t trail_sum = 0;
+            size_t trail_num = 0;
+        };
+        PortfolioCheckpoint portfolio_last;
+        uint64_t portfolio_conf_since = 0; ///<sumConflicts when the current configuration was taken
+        uint64_t next_progress_confl = 0;
         long calc_num_confl_to_do_this_iter(const size_t iteration_num) const;
 
         vector<Lit> finalCl_tmp;
@@ -291,8 +329,8 @@ class Solver : public Searcher
         void check_config_parameters() const;
         void check_xor_cut_config_sanity() const;
         void handle_found_solution(const lbool status, const bool only_indep_solution);
-        void add_every_combination_xor(const vector<Lit>& lits, bool attach, bool addDrat);
-        void add_xor_clause_inter_cleaned_cut(const vector<Lit>& lits, bool attach, bool addDrat);
+        void add_every_combination_xor(const vector<Lit>& lits, bool attach, bool addDrat, const Lit selector);
+        void add_xor_clause_inter_cleaned_cut(const vector<Lit>& lits, bool attach, bool addDrat, const Lit selector);
         unsigned num_bits_set(const size_t x, const unsigned max_size) const;
         void check_too_large_variable_number(const vector<Lit>& lits) const;
         void set_assumptions();
@@ -316,6 +354,9 @@ class Solver : public Searcher
         void check_switchoff_limits_newvar(size_t n = 1);
         vector<Lit> outside_assumptions;
 
+        ///Outer numbering, one per snapshot, the last one is added to the clauses
+        vector<Lit> snapshot_selectors;
+
         //Stats printing
         void print_norm_stats(const double cpu_time, const double cpu_time_total) const;
         void print_min_stats(const double cpu_time, const double cpu_time_total) const;
@@ -353,6 +394,7 @@ class Solver : public Searcher
         uint64_t last_full_watch_consolidate = 0;
         void save_on_var_memory(uint32_t newNumVars);
         void unSaveVarMem();
+        void new_outer_vars(const uint32_t num_vars, const vector<uint32_t>& bva_vars);
         size_t calculate_interToOuter_and_outerToInter(
             vector<uint32_t>& outerToInter
             , vector<uint32_t>& interToOuter
@@ -97,6 +97,9 @@ DLL_PUBLIC SolverConf::SolverConf() :
         //Glues
         , update_glues_on_analyze(true)
 
+        //Propagation
+        , propBinFirst(false)
+
         //OTF
         , otfHyperbin      (true)
         , doOTFSubsume     (false)
@@ -123,6 +126,8 @@ DLL_PUBLIC SolverConf::SolverConf() :
         , skip_some_bve_resolvents(true) //based on gates
         , velim_resolvent_too_large(20)
         , var_linkin_limit_MB(1000)
+        , varelim_threads(1)
+        , varelim_batch(256)
 
         //Subs, str limits for simplifier
         , subsumption_time_limitM(300)
@@ -229,6 +234,8 @@ DLL_PUBLIC SolverConf::SolverConf() :
         , maxOccurRedMB    (600)
         , maxOccurRedLitLinkedM(50)
         , subsume_gothrough_multip(2.0)
+        , subsume_threads(1)
+        , subsume_batch(4096)
 
         //Distillation
         , do_distill_clauses(true)
@@ -240,6 +247,8 @@ DLL_PUBLIC SolverConf::SolverConf() :
         , doRenumberVars   (true)
         , doSaveMem        (true)
         , full_watch_consolidate_every_n_confl (4ULL*1000ULL*1000ULL) //validated in run 8113323.wlm01
+        , consolidate_in_act_order(false)
+        , explicit_hugepages(false)
 
         //Component finding
         , doCompHandler    (false)
@@ -276,11 +285,25 @@ DLL_PUBLIC SolverConf::SolverConf() :
         //misc
         , origSeed(0)
         , sync_every_confl(20000)
+        , sync_long_max_glue(3)
+        , sync_long_max_size(12)
+        , sync_long_import_max_glue(3)
+        , clone_startup_simplify(false)
+        , share_irred_longs(false)
+        , cube_and_conquer(false)
+        , cube_confl_budget(10000)
+        , cube_lookahead_vars(20)
+        , pin_threads("")
+        , adaptive_portfolio(false)
+        , portfolio_warmup_confl(50000)
+        , portfolio_prune_ratio(0.5)
         , reconfigure_val(0)
         , reconfigure_at(2)
         , preprocess(0)
         , simulate_drat(false)
+        , drat_async(true)
         , need_decisions_reaching(false)
+        , simplified_cnf_binary(false)
         , saved_state_file("savedstate.dat")
 {
     ratio_keep_clauses[clean_to_int(ClauseClean::glue)] = 0;
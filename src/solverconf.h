@@ -124,6 +124,7 @@ class GaussConf
     uint32_t max_matrix_rows; //The maximum matrix size -- no. of rows
     uint32_t min_matrix_rows; //The minimum matrix size -- no. of rows
     uint32_t max_num_matrixes; //Maximum number of matrixes
+    bool m4r_eliminate = true; //Initial elimination by the Method of Four Russians
 
     //Matrix extraction config
     bool doMatrixFind = true;
@@ -229,6 +230,9 @@ class DLL_PUBLIC SolverConf
         //Glues
         int       update_glues_on_analyze;
 
+        //Propagation
+        int       propBinFirst; ///<Keep binaries first in watchlists and propagate them before long clauses
+
         //OTF stuff
         int       otfHyperbin;
         int       doOTFSubsume;
@@ -259,6 +263,8 @@ class DLL_PUBLIC SolverConf
         int      skip_some_bve_resolvents;
         int velim_resolvent_too_large; //-1 == no limit
         int var_linkin_limit_MB;
+        unsigned varelim_threads; ///<Test this many variables for elimination at the same time
+        unsigned varelim_batch;  ///<Candidates picked at once when varelim_threads > 1
 
         //Subs, str limits for simplifier
         long long subsumption_time_limitM;
@@ -325,6 +331,8 @@ class DLL_PUBLIC SolverConf
         double maxOccurRedMB;
         double maxOccurRedLitLinkedM;
         double   subsume_gothrough_multip;
+        unsigned subsume_threads; ///<Search for subsumed/strengthened long clauses on this many threads
+        unsigned subsume_batch;   ///<Clauses searched at once when subsume_threads > 1
 
         //Distillation
         int      do_distill_clauses;
@@ -336,6 +344,8 @@ class DLL_PUBLIC SolverConf
         int       doRenumberVars;
         int       doSaveMem;
         uint64_t  full_watch_consolidate_every_n_confl;
+        int       consolidate_in_act_order; ///<Lay out long clauses in the watchlist order of the most active variables first
+        int       explicit_hugepages; ///<Try reserved 2MB pages for clauses. Needs USE_HUGEPAGES
 
         //Component handling
         int       doCompHandler;
@@ -377,12 +387,26 @@ class DLL_PUBLIC SolverConf
         //Misc
         unsigned origSeed;
         unsigned long long sync_every_confl;
+        unsigned sync_long_max_glue;
+        unsigned sync_long_max_size;
+        unsigned sync_long_import_max_glue;
+        int      clone_startup_simplify;
+        int      share_irred_longs;
+        int      cube_and_conquer;
+        long long cube_confl_budget;
+        unsigned cube_lookahead_vars;
+        std::string pin_threads;
+        int      adaptive_portfolio;
+        long long portfolio_warmup_confl;
+        double   portfolio_prune_ratio;
         unsigned reconfigure_val;
         unsigned reconfigure_at;
         unsigned preprocess;
         int      simulate_drat;
+        int      drat_async;
         int      need_decisions_reaching;
         std::string simplified_cnf;
+        int      simplified_cnf_binary;
         std::string solution_file;
         std::string saved_state_file;
 };
@@ -897,7 +897,8 @@ void SQLiteStats::reduceDB(
     , const bool locked
     , const Clause* cl
 ) {
-    assert(cl->stats.dump_number != std::numeric_limits<uint32_t>::max());
+    const ClauseStats& stats = solver->cl_alloc.stats(*cl);
+    assert(stats.dump_number != std::numeric_limits<uint32_t>::max());
 
     int bindAt = 1;
     sqlite3_bind_int64(stmtReduceDB, bindAt++, runID);
@@ -907,28 +908,28 @@ void SQLiteStats::reduceDB(
     sqlite3_bind_double(stmtReduceDB, bindAt++, cpuTime());
 
     //data
-    sqlite3_bind_int64(stmtReduceDB, bindAt++, cl->stats.ID);
-    sqlite3_bind_int64(stmtReduceDB, bindAt++, cl->stats.dump_number);
-    sqlite3_bind_int64(stmtReduceDB, bindAt++, cl->stats.conflicts_made);
-    sqlite3_bind_int64(stmtReduceDB, bindAt++, cl->stats.sum_of_branch_depth_conflict);
-    sqlite3_bind_int64(stmtReduceDB, bindAt++, cl->stats.propagations_made);
-    sqlite3_bind_int64(stmtReduceDB, bindAt++, cl->stats.clause_looked_at);
-    sqlite3_bind_int64(stmtReduceDB, bindAt++, cl->stats.used_for_uip_creation);
+    sqlite3_bind_int64(stmtReduceDB, bindAt++, stats.ID);
+    sqlite3_bind_int64(stmtReduceDB, bindAt++, stats.dump_number);
+    sqlite3_bind_int64(stmtReduceDB, bindAt++, stats.conflicts_made);
+    sqlite3_bind_int64(stmtReduceDB, bindAt++, stats.sum_of_branch_depth_conflict);
+    sqlite3_bind_int64(stmtReduceDB, bindAt++, stats.propagations_made);
+    sqlite3_bind_int64(stmtReduceDB, bindAt++, stats.clause_looked_at);
+    sqlite3_bind_int64(stmtReduceDB, bindAt++, stats.used_for_uip_creation);
 
     uint64_t last_touched_diff;
-    if (cl->stats.last_touched == 0) {
-        last_touched_diff = solver->sumConflicts-cl->stats.introduced_at_conflict;
+    if (stats.last_touched == 0) {
+        last_touched_diff = solver->sumConflicts-stats.introduced_at_conflict;
     } else {
-        last_touched_diff = solver->sumConflicts-cl->stats.last_touched;
+        last_touched_diff = solver->sumConflicts-stats.last_touched;
     }
     sqlite3_bind_int64(stmtReduceDB, bindAt++, last_touched_diff);
 
-    sqlite3_bind_double(stmtReduceDB, bindAt++, (double)cl->stats.activity/(double)solver->get_cla_inc());
+    sqlite3_bind_double(stmtReduceDB, bindAt++, (double)stats.activity/(double)solver->get_cla_inc());
     sqlite3_bind_int(stmtReduceDB, bindAt++, locked);
     sqlite3_bind_int(stmtReduceDB, bindAt++, cl->used_in_xor());
-    sqlite3_bind_int(stmtReduceDB, bindAt++, cl->stats.glue);
+    sqlite3_bind_int(stmtReduceDB, bindAt++, stats.glue);
     sqlite3_bind_int(stmtReduceDB, bindAt++, cl->size());
-    sqlite3_bind_int(stmtReduceDB, bindAt++, cl->stats.ttl);
+    sqlite3_bind_int(stmtReduceDB, bindAt++, stats.ttl);
 
     int rc = sqlite3_step(stmtReduceDB);
     if (rc != SQLITE_DONE) {
@@ -29,7 +29,9 @@ THE SOFTWARE.
 #include "solver.h"
 #include "solvertypes.h"
 #include "subsumeimplicit.h"
+#include "threadpool.h"
 #include <array>
+#include <cmath>
 
 //#define VERBOSE_DEBUG
 
@@ -44,6 +46,11 @@ SubsumeStrengthen::SubsumeStrengthen(
 {
 }
 
+SubsumeStrengthen::~SubsumeStrengthen()
+{
+    delete pool;
+}
+
 uint32_t SubsumeStrengthen::subsume_and_unlink_and_markirred(const ClOffset offset)
 {
     Clause& cl = *solver->cl_alloc.ptr(offset);
@@ -60,11 +67,23 @@ uint32_t SubsumeStrengthen::subsume_and_unlink_and_markirred(const ClOffset offs
         , cl.abst
     );
 
+    return markirred_and_combine_stats(offset, ret);
+}
+
+uint32_t SubsumeStrengthen::markirred_and_combine_stats(
+    const ClOffset offset
+    , const Sub0Ret& ret
+) {
+    Clause& cl = *solver->cl_alloc.ptr(offset);
+
     //If irred is subsumed by redundant, make the redundant into irred
     if (cl.red()
         && ret.subsumedIrred
     ) {
         cl.makeIrred();
+        #ifdef STATS_NEEDED
+        solver->cl_alloc.stats(cl).ID = 0;
+        #endif
         solver->litStats.redLits -= cl.size();
         solver->litStats.irredLits += cl.size();
         if (!cl.getOccurLinked()) {
@@ -77,7 +96,8 @@ uint32_t SubsumeStrengthen::subsume_and_unlink_and_markirred(const ClOffset offs
     }
 
     //Combine stats
-    cl.combineStats(ret.stats);
+    ClauseStats& stats = solver->cl_alloc.stats(cl);
+    stats = ClauseStats::combineStats(stats, ret.stats);
 
     return ret.numSubsumed;
 }
@@ -110,15 +130,25 @@ SubsumeStrengthen::Sub0Ret SubsumeStrengthen::subsume_and_unlink(
     , const cl_abst_type abs
     , const bool removeImplicit
 ) {
-    Sub0Ret ret;
-
     subs.clear();
     find_subsumed(offset, ps, abs, subs, removeImplicit);
 
+    return unlink_subsumed(subs);
+}
+
+SubsumeStrengthen::Sub0Ret SubsumeStrengthen::unlink_subsumed(
+    const vector<ClOffset>& subsumed
+) {
+    Sub0Ret ret;
+
     //Go through each clause that can be subsumed
-    for (const ClOffset offs: subs) {
+    for (const ClOffset offs: subsumed) {
         Clause *tmp = solver->cl_alloc.ptr(offs);
-        ret.stats = ClauseStats::combineStats(tmp->stats, ret.stats);
+        //Subsumed by an earlier clause of the same parallel batch
+        if (tmp->getRemoved()) {
+            continue;
+        }
+        ret.stats = ClauseStats::combineStats(solver->cl_alloc.stats(*tmp), ret.stats);
         #ifdef VERBOSE_DEBUG
         cout << "-> subsume removing:" << *tmp << endl;
         #endif
@@ -142,7 +172,6 @@ SubsumeStrengthen::Sub1Ret SubsumeStrengthen::strengthen_subsume_and_unlink_and_
 {
     subs.clear();
     subsLits.clear();
-    Sub1Ret ret;
     Clause& cl = *solver->cl_alloc.ptr(offset);
     assert(!cl.getRemoved());
     assert(!cl.freed());
@@ -156,13 +185,28 @@ SubsumeStrengthen::Sub1Ret SubsumeStrengthen::strengthen_subsume_and_unlink_and_
         , cl.abst
         , subs
         , subsLits
+        , *simplifier->limit_to_decrease
     );
 
+    return apply_strengthened(offset, subs, subsLits, false);
+}
+
+//With "recheck", the clauses were found before the earlier changes of the
+//same parallel batch were made, so they may have been removed or
+//strengthened since.
+SubsumeStrengthen::Sub1Ret SubsumeStrengthen::apply_strengthened(
+    const ClOffset offset
+    , const vector<ClOffset>& subsumed
+    , const vector<Lit>& lits
+    , const bool recheck
+) {
+    Sub1Ret ret;
+    Clause& cl = *solver->cl_alloc.ptr(offset);
     for (size_t j = 0
-        ; j < subs.size() && solver->okay()
+        ; j < subsumed.size() && solver->okay()
         ; j++
     ) {
-        ClOffset offset2 = subs[j];
+        ClOffset offset2 = subsumed[j];
         Clause& cl2 = *solver->cl_alloc.ptr(offset2);
         #ifdef USE_GAUSS
         if (cl2.used_in_xor()) {
@@ -170,7 +214,18 @@ SubsumeStrengthen::Sub1Ret SubsumeStrengthen::strengthen_subsume_and_unlink_and_
         }
         #endif
 
-        if (subsLits[j] == lit_Undef) {  //Subsume
+        Lit toRemove = lits[j];
+        if (recheck) {
+            if (cl2.getRemoved() || cl.size() > cl2.size()) {
+                continue;
+            }
+            toRemove = subset1(cl, cl2, *simplifier->limit_to_decrease);
+            if (toRemove == lit_Error) {
+                continue;
+            }
+        }
+
+        if (toRemove == lit_Undef) {  //Subsume
             #ifdef VERBOSE_DEBUG
             if (solver->conf.verbosity >= 6)
                 cout << "subsumed clause " << cl2 << endl;
@@ -181,6 +236,9 @@ SubsumeStrengthen::Sub1Ret SubsumeStrengthen::strengthen_subsume_and_unlink_and_
                 && !cl2.red()
             ) {
                 cl.makeIrred();
+                #ifdef STATS_NEEDED
+                solver->cl_alloc.stats(cl).ID = 0;
+                #endif
                 solver->litStats.redLits -= cl.size();
                 solver->litStats.irredLits += cl.size();
                 if (!cl.getOccurLinked()) {
@@ -193,7 +251,8 @@ SubsumeStrengthen::Sub1Ret SubsumeStrengthen::strengthen_subsume_and_unlink_and_
             }
 
             //Update stats
-            cl.combineStats(cl2.stats);
+            ClauseStats& stats = solver->cl_alloc.stats(cl);
+            stats = ClauseStats::combineStats(stats, solver->cl_alloc.stats(cl2));
 
             simplifier->unlink_clause(offset2, true, false, true);
             ret.sub++;
@@ -208,7 +267,7 @@ SubsumeStrengthen::Sub1Ret SubsumeStrengthen::strengthen_subsume_and_unlink_and_
                 continue;
             }
             #endif
-            remove_literal(offset2, subsLits[j]);
+            remove_literal(offset2, toRemove);
 
             ret.str++;
             if (!solver->ok)
@@ -251,6 +310,26 @@ void SubsumeStrengthen::backw_sub_long_with_long()
     while (*simplifier->limit_to_decrease > 0
         && (double)wenThrough < solver->conf.subsume_gothrough_multip*(double)simplifier->clauses.size()
     ) {
+        if (solver->conf.subsume_threads > 1) {
+            const double left = solver->conf.subsume_gothrough_multip*(double)simplifier->clauses.size() - wenThrough;
+            const size_t num = find_in_parallel(wenThrough+1, std::ceil(left), false);
+            for(size_t i = 0; i < num; i++) {
+                *simplifier->limit_to_decrease -= 3;
+                wenThrough++;
+                const size_t at = wenThrough % simplifier->clauses.size();
+                const ClOffset offset = simplifier->clauses[at];
+                Clause* cl = solver->cl_alloc.ptr(offset);
+                if (cl->freed() || cl->getRemoved())
+                    continue;
+
+                *simplifier->limit_to_decrease -= 10;
+                const Sub0Ret ret = unlink_subsumed(par_found[i].subs);
+                subsumed += markirred_and_combine_stats(offset, ret);
+                runStats.foundInParallel += ret.numSubsumed;
+            }
+            continue;
+        }
+
         *simplifier->limit_to_decrease -= 3;
         wenThrough++;
 
@@ -316,6 +395,25 @@ bool SubsumeStrengthen::backw_str_long_with_long()
         && wenThrough < 1.5*(double)2*simplifier->clauses.size()
         && solver->okay()
     ) {
+        if (solver->conf.subsume_threads > 1) {
+            const double left = 1.5*(double)2*simplifier->clauses.size() - wenThrough;
+            const size_t num = find_in_parallel(wenThrough+1, std::ceil(left), true);
+            for(size_t i = 0; i < num && solver->okay(); i++) {
+                *simplifier->limit_to_decrease -= 10;
+                wenThrough++;
+                const size_t at = wenThrough % simplifier->clauses.size();
+                const ClOffset offset = simplifier->clauses[at];
+                Clause* cl = solver->cl_alloc.ptr(offset);
+                if (cl->freed() || cl->getRemoved())
+                    continue;
+
+                const Sub1Ret found = apply_strengthened(offset, par_found[i].subs, par_found[i].lits, true);
+                runStats.foundInParallel += found.sub + found.str;
+                ret += found;
+            }
+            continue;
+        }
+
         *simplifier->limit_to_decrease -= 10;
         wenThrough++;
 
@@ -371,6 +469,78 @@ bool SubsumeStrengthen::backw_str_long_with_long()
     return solver->okay();
 }
 
+/**
+@brief Searches a batch of clauses on the thread pool
+
+The batch starts at simplifier->clauses[first], wrapping around, and has at
+most max_num clauses. The search
+does not change anything, the results go to par_found, and the work done is
+charged to limit_to_decrease at the end. Each thread gets an equal share of
+the remaining budget, so that together they can't overrun it. Clauses are
+handed out by the variable of their shortest occur list, so clauses that
+walk the same list are searched by the same thread.
+
+@return The number of clauses in the batch
+*/
+size_t SubsumeStrengthen::find_in_parallel(
+    const size_t first
+    , const size_t max_num
+    , const bool strengthen
+) {
+    const size_t num_threads = solver->conf.subsume_threads;
+    if (pool == NULL || pool->size() != num_threads) {
+        delete pool;
+        pool = new ThreadPool(num_threads);
+    }
+
+    const vector<ClOffset>& cls = simplifier->clauses;
+    size_t num = std::min<size_t>(solver->conf.subsume_batch, cls.size());
+    num = std::min(num, max_num);
+    if (par_found.size() < num) {
+        par_found.resize(num);
+    }
+    par_owner.resize(num);
+    for(size_t i = 0; i < num; i++) {
+        par_found[i].subs.clear();
+        par_found[i].lits.clear();
+        const Clause& cl = *solver->cl_alloc.ptr(cls[(first+i) % cls.size()]);
+        if (cl.freed() || cl.getRemoved()) {
+            par_owner[i] = num_threads;
+            continue;
+        }
+        const size_t smallest = find_smallest_watchlist_for_clause(
+            cl, *simplifier->limit_to_decrease);
+        par_owner[i] = cl[smallest].var() % num_threads;
+    }
+
+    const int64_t budget = *simplifier->limit_to_decrease/(int64_t)num_threads;
+    vector<int64_t> used(num_threads, 0);
+    pool->run([&](const size_t tid) {
+        int64_t limit = budget;
+        for(size_t i = 0; i < num && limit > 0; i++) {
+            if (par_owner[i] != tid) {
+                continue;
+            }
+
+            const ClOffset offset = cls[(first+i) % cls.size()];
+            const Clause& cl = *solver->cl_alloc.ptr(offset);
+            if (strengthen) {
+                findStrengthened(offset, cl, cl.abst
+                    , par_found[i].subs, par_found[i].lits, limit);
+            } else {
+                fill_subsumed(offset, cl, cl.abst
+                    , par_found[i].subs, limit, false);
+            }
+        }
+        used[tid] = budget - limit;
+    });
+    for(const int64_t u: used) {
+        *simplifier->limit_to_decrease -= u;
+    }
+
+    return num;
+}
+
 /**
 @brief Helper function for findStrengthened
 
@@ -384,10 +554,11 @@ void inline SubsumeStrengthen::fillSubs(
     , vector<ClOffset>& out_subsumed
     , vector<Lit>& out_lits
     , const Lit lit
+    , int64_t& limit
 ) {
     Lit litSub;
     watch_subarray_const cs = solver->watches[lit];
-    *simplifier->limit_to_decrease -= (long)cs.size()*2+ 40;
+    limit -= (long)cs.size()*2+ 40;
     for (const Watched *it = cs.begin(), *end = cs.end()
         ; it != end
         ; ++it
@@ -409,8 +580,8 @@ void inline SubsumeStrengthen::fillSubs(
             continue;
         }
 
-        *simplifier->limit_to_decrease -= (long)((cl.size() + cl2.size())/4);
-        litSub = subset1(cl, cl2);
+        limit -= (long)((cl.size() + cl2.size())/4);
+        litSub = subset1(cl, cl2, limit);
         if (litSub != lit_Error) {
             out_subsumed.push_back(it->get_offset());
             out_lits.push_back(litSub);
@@ -447,6 +618,7 @@ void SubsumeStrengthen::findStrengthened(
     , const cl_abst_type abs
     , vector<ClOffset>& out_subsumed
     , vector<Lit>& out_lits
+    , int64_t& limit
 )
 {
     #ifdef VERBOSE_DEBUG
@@ -466,10 +638,10 @@ void SubsumeStrengthen::findStrengthened(
         }
     }
     assert(minVar != var_Undef);
-    *simplifier->limit_to_decrease -= (long)cl.size();
+    limit -= (long)cl.size();
 
-    fillSubs(offset, cl, abs, out_subsumed, out_lits, Lit(minVar, true));
-    fillSubs(offset, cl, abs, out_subsumed, out_lits, Lit(minVar, false));
+    fillSubs(offset, cl, abs, out_subsumed, out_lits, Lit(minVar, true), limit);
+    fillSubs(offset, cl, abs, out_subsumed, out_lits, Lit(minVar, false), limit);
 }
 
 bool SubsumeStrengthen::handle_added_long_cl(
@@ -492,7 +664,7 @@ bool SubsumeStrengthen::handle_added_long_cl(
         if (cl->freed() || cl->getRemoved())
             continue;
 
-        cl->stats.marked_clause = 0;
+        solver->cl_alloc.stats(*cl).marked_clause = 0;
         auto ret = strengthen_subsume_and_unlink_and_markirred(offs);
         stat += ret;
         if (!solver->ok) {
@@ -519,7 +691,7 @@ bool SubsumeStrengthen::handle_added_long_cl(
             if (cl->freed() || cl->getRemoved())
                 continue;
 
-            cl->stats.marked_clause = 0;
+            solver->cl_alloc.stats(*cl).marked_clause = 0;
         }
     }
 
@@ -600,7 +772,7 @@ bool SubsumeStrengthen::subsetAbst(const cl_abst_type A, const cl_abst_type B)
 
 //A subsumes B (A <= B)
 template<class T1, class T2>
-bool SubsumeStrengthen::subset(const T1& A, const T2& B)
+bool SubsumeStrengthen::subset(const T1& A, const T2& B, int64_t& limit)
 {
     #ifdef MORE_DEUBUG
     cout << "A:" << A << endl;
@@ -641,7 +813,7 @@ bool SubsumeStrengthen::subset(const T1& A, const T2& B)
     ret = false;
 
     end:
-    *simplifier->limit_to_decrease -= (long)i2*4 + (long)i*4;
+    limit -= (long)i2*4 + (long)i*4;
     return ret;
 }
 
@@ -659,7 +831,7 @@ clause B
 and returns the literal to remove if (2) is true
 */
 template<class T1, class T2>
-Lit SubsumeStrengthen::subset1(const T1& A, const T2& B)
+Lit SubsumeStrengthen::subset1(const T1& A, const T2& B, int64_t& limit)
 {
     Lit retLit = lit_Undef;
 
@@ -691,12 +863,12 @@ Lit SubsumeStrengthen::subset1(const T1& A, const T2& B)
     retLit = lit_Error;
 
     end:
-    *simplifier->limit_to_decrease -= (long)i2*4 + (long)i*4;
+    limit -= (long)i2*4 + (long)i*4;
     return retLit;
 }
 
 template<class T>
-size_t SubsumeStrengthen::find_smallest_watchlist_for_clause(const T& ps) const
+size_t SubsumeStrengthen::find_smallest_watchlist_for_clause(const T& ps, int64_t& limit) const
 {
     size_t min_i = 0;
     size_t min_num = solver->watches[ps[min_i]].size();
@@ -707,7 +879,7 @@ size_t SubsumeStrengthen::find_smallest_watchlist_for_clause(const T& ps) const
             min_num = this_num;
         }
     }
-    *simplifier->limit_to_decrease -= (long)ps.size();
+    limit -= (long)ps.size();
 
     return min_i;
 }
@@ -724,6 +896,24 @@ template<class T> void SubsumeStrengthen::find_subsumed(
     , const cl_abst_type abs //Abstraction of literals in clause
     , vector<ClOffset>& out_subsumed //List of clause indexes subsumed
     , bool removeImplicit
+) {
+    fill_subsumed(offset, ps, abs, out_subsumed
+        , *simplifier->limit_to_decrease, removeImplicit);
+}
+
+/**
+@brief Does the work of find_subsumed()
+
+Only writes the occur list if removeImplicit is set, so without it this can
+run on many threads at the same time.
+*/
+template<class T> void SubsumeStrengthen::fill_subsumed(
+    const ClOffset offset
+    , const T& ps
+    , const cl_abst_type abs
+    , vector<ClOffset>& out_subsumed
+    , int64_t& limit
+    , const bool removeImplicit
 ) {
     #ifdef VERBOSE_DEBUG
     cout << "find_subsumed: ";
@@ -733,11 +923,11 @@ template<class T> void SubsumeStrengthen::find_subsumed(
     cout << endl;
     #endif
 
-    const size_t smallest = find_smallest_watchlist_for_clause(ps);
+    const size_t smallest = find_smallest_watchlist_for_clause(ps, limit);
 
     //Go through the occur list of the literal that has the smallest occur list
     watch_subarray occ = solver->watches[ps[smallest]];
-    *simplifier->limit_to_decrease -= (long)occ.size()*8 + 40;
+    limit -= (long)occ.size()*8 + 40;
 
     Watched* it = occ.begin();
     Watched* it2 = occ.begin();
@@ -766,13 +956,16 @@ template<class T> void SubsumeStrengthen::find_subsumed(
                 }
             }
         }
-        *it2++ = *it;
+        if (it2 != it) {
+            *it2 = *it;
+        }
+        it2++;
 
         if (!it->isClause()) {
             continue;
         }
 
-        *simplifier->limit_to_decrease -= 15;
+        limit -= 15;
 
         if (it->get_offset() == offset
             || !subsetAbst(abs, it->getAbst())
@@ -786,15 +979,17 @@ template<class T> void SubsumeStrengthen::find_subsumed(
         if (ps.size() > cl2.size() || cl2.getRemoved())
             continue;
 
-        *simplifier->limit_to_decrease -= 50;
-        if (subset(ps, cl2)) {
+        limit -= 50;
+        if (subset(ps, cl2, limit)) {
             out_subsumed.push_back(offset2);
             #ifdef VERBOSE_DEBUG
             cout << "subsumed cl offset: " << offset2 << endl;
             #endif
         }
     }
-    occ.shrink(it-it2);
+    if (it != it2) {
+        occ.shrink(it-it2);
+    }
 }
 template void SubsumeStrengthen::find_subsumed(
     const ClOffset offset
@@ -809,6 +1004,12 @@ size_t SubsumeStrengthen::mem_used() const
     size_t b = 0;
     b += subs.capacity()*sizeof(ClOffset);
     b += subsLits.capacity()*sizeof(Lit);
+    for(const FoundSubs& f: par_found) {
+        b += f.subs.capacity()*sizeof(ClOffset);
+        b += f.lits.capacity()*sizeof(Lit);
+    }
+    b += par_found.capacity()*sizeof(FoundSubs);
+    b += par_owner.capacity()*sizeof(uint32_t);
 
     return b;
 }
@@ -839,6 +1040,10 @@ void SubsumeStrengthen::Stats::print() const
         , litsRemStrengthen
         , " Lits"
     );
+    print_stats_line("c cl-sub-str in parallel"
+        , foundInParallel
+        , " Clauses"
+    );
     print_stats_line("c cl-sub T"
         , subsumeTime
         , " s"
@@ -855,6 +1060,7 @@ SubsumeStrengthen::Stats& SubsumeStrengthen::Stats::operator+=(const Stats& othe
     subsumedBySub += other.subsumedBySub;
     subsumedByStr += other.subsumedByStr;
     litsRemStrengthen += other.litsRemStrengthen;
+    foundInParallel += other.foundInParallel;
 
     subsumeTime += other.subsumeTime;
     strengthenTime += other.strengthenTime;
@@ -874,6 +1080,7 @@ SubsumeStrengthen::Sub1Ret SubsumeStrengthen::backw_sub_str_long_with_implicit(
         , calcAbstraction(lits)
         , subs
         , subsLits
+        , *simplifier->limit_to_decrease
     );
 
     Sub1Ret ret;
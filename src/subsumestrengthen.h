@@ -35,11 +35,13 @@ namespace CMSat {
 class OccSimplifier;
 class GateFinder;
 class Solver;
+class ThreadPool;
 
 class SubsumeStrengthen
 {
 public:
     SubsumeStrengthen(OccSimplifier* simplifier, Solver* solver);
+    ~SubsumeStrengthen();
     size_t mem_used() const;
 
     void backw_sub_long_with_long();
@@ -87,6 +89,7 @@ public:
         uint64_t subsumedBySub = 0;
         uint64_t subsumedByStr = 0;
         uint64_t litsRemStrengthen = 0;
+        uint64_t foundInParallel = 0; ///<Clauses subsumed or strengthened with subsume_threads > 1
 
         double subsumeTime = 0.0;
         double strengthenTime = 0.0;
@@ -120,12 +123,44 @@ private:
         , const cl_abst_type abs
         , const bool removeImplicit = false
     );
+    Sub0Ret unlink_subsumed(const vector<ClOffset>& subsumed);
+    uint32_t markirred_and_combine_stats(const ClOffset offset, const Sub0Ret& ret);
+    Sub1Ret apply_strengthened(
+        const ClOffset offset
+        , const vector<ClOffset>& subsumed
+        , const vector<Lit>& lits
+        , const bool recheck
+    );
+
+    //Parallel search, the changes are made on the calling thread
+    struct FoundSubs {
+        vector<ClOffset> subs;
+        vector<Lit> lits;
+    };
+    ThreadPool* pool = NULL;
+    vector<FoundSubs> par_found;
+    vector<uint32_t> par_owner;
+    size_t find_in_parallel(
+        const size_t first
+        , const size_t max_num
+        , const bool strengthen
+    );
 
     void randomise_clauses_order();
     void remove_literal(ClOffset c, const Lit toRemoveLit);
 
     template<class T>
-    size_t find_smallest_watchlist_for_clause(const T& ps) const;
+    size_t find_smallest_watchlist_for_clause(const T& ps, int64_t& limit) const;
+
+    template<class T>
+    void fill_subsumed(
+        const ClOffset offset
+        , const T& ps
+        , const cl_abst_type abs
+        , vector<ClOffset>& out_subsumed
+        , int64_t& limit
+        , const bool removeImplicit
+    );
 
     template<class T>
     void findStrengthened(
@@ -134,6 +169,7 @@ private:
         , const cl_abst_type abs
         , vector<ClOffset>& out_subsumed
         , vector<Lit>& out_lits
+        , int64_t& limit
     );
 
     template<class T>
@@ -144,13 +180,14 @@ private:
         , vector<ClOffset>& out_subsumed
         , vector<Lit>& out_lits
         , const Lit lit
+        , int64_t& limit
     );
 
     template<class T1, class T2>
-    bool subset(const T1& A, const T2& B);
+    bool subset(const T1& A, const T2& B, int64_t& limit);
 
     template<class T1, class T2>
-    Lit subset1(const T1& A, const T2& B);
+    Lit subset1(const T1& A, const T2& B, int64_t& limit);
     bool subsetAbst(const cl_abst_type A, const cl_abst_type B);
 
     vector<ClOffset> subs;
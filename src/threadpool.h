@@ -0,0 +1,141 @@
+/******************************************
+Copyright (c) 2016, Mate Soos
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+***********************************************/
+
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <cstdint>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+namespace CMSat {
+
+/**
+@brief Worker threads that are created once and parked between jobs
+
+run() executes job(tid) for every tid, with the calling thread doing tid 0,
+and returns once all of them have finished. Incremental use calls solve()
+many times on small changes, and starting fresh threads each time would
+dominate the time taken.
+*/
+class ThreadPool
+{
+    public:
+        explicit ThreadPool(const size_t _num_threads) :
+            num_threads(_num_threads)
+        {
+            for(size_t tid = 1; tid < num_threads; tid++) {
+                workers.push_back(std::thread(&ThreadPool::work, this, tid));
+            }
+        }
+
+        ~ThreadPool()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mu);
+                stop = true;
+            }
+            start_cv.notify_all();
+            for(std::thread& t: workers) {
+                t.join();
+            }
+        }
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        void run(const std::function<void(size_t)>& _job)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mu);
+                job = &_job;
+                num_running = num_threads-1;
+                generation++;
+            }
+            start_cv.notify_all();
+
+            //The workers still use _job, so even if tid 0 throws, wait for
+            //them before _job can go out of scope
+            try {
+                _job(0);
+            } catch (...) {
+                wait_done();
+                throw;
+            }
+            wait_done();
+        }
+
+        size_t size() const
+        {
+            return num_threads;
+        }
+
+    private:
+        void wait_done()
+        {
+            std::unique_lock<std::mutex> lock(mu);
+            done_cv.wait(lock, [this]{return num_running == 0;});
+            job = NULL;
+        }
+
+        void work(const size_t tid)
+        {
+            uint64_t seen = 0;
+            while(true) {
+                const std::function<void(size_t)>* to_run;
+                {
+                    std::unique_lock<std::mutex> lock(mu);
+                    start_cv.wait(lock, [&]{return stop || generation != seen;});
+                    if (stop) {
+                        return;
+                    }
+                    seen = generation;
+                    to_run = job;
+                }
+
+                (*to_run)(tid);
+
+                std::lock_guard<std::mutex> lock(mu);
+                if (--num_running == 0) {
+                    done_cv.notify_one();
+                }
+            }
+        }
+
+        const size_t num_threads;
+        std::vector<std::thread> workers;
+        std::mutex mu;
+        std::condition_variable start_cv;
+        std::condition_variable done_cv;
+        const std::function<void(size_t)>* job = NULL;
+        uint64_t generation = 0;
+        size_t num_running = 0;
+        bool stop = false;
+};
+
+}
+
+#endif //THREADPOOL_H
@@ -118,6 +118,26 @@ static inline uint64_t memUsedTotal(double& vm_usage)
 
    return resident_set;
 }
+
+//Bytes of the process in transparent or explicit huge pages
+static inline uint64_t memUsedHugePages()
+{
+    std::ifstream rollup("/proc/self/smaps_rollup");
+    std::string name;
+    uint64_t kb;
+    uint64_t total_kb = 0;
+    while (rollup >> name) {
+        if (name == "AnonHugePages:"
+            || name == "Shared_Hugetlb:"
+            || name == "Private_Hugetlb:"
+        ) {
+            rollup >> kb;
+            total_kb += kb;
+        }
+    }
+
+    return total_kb*1024ULL;
+}
 #elif defined(__FreeBSD__)
 #include <sys/types.h>
 inline uint64_t memUsedTotal(double& vm_usage)
@@ -128,12 +148,22 @@ inline uint64_t memUsedTotal(double& vm_usage)
     getrusage(RUSAGE_SELF, &ru);
     return ru.ru_maxrss*1024;
 }
+
+inline uint64_t memUsedHugePages()
+{
+    return 0;
+}
 #else //Windows
 static inline size_t memUsedTotal(double& vm_usage)
 {
     vm_usage = 0;
     return 0;
 }
+
+static inline uint64_t memUsedHugePages()
+{
+    return 0;
+}
 #endif
 
 #endif //TIME_MEM_H
@@ -28,6 +28,9 @@ THE SOFTWARE.
 #include "clauseallocator.h"
 #include "sqlstats.h"
 #include "sccfinder.h"
+#ifdef USE_GAUSS
+#include "EGaussian.h"
+#endif
 #include <iostream>
 #include <iomanip>
 #include <set>
@@ -316,26 +319,51 @@ end:
     return solver->okay();
 }
 
-bool VarReplacer::replace_xor_clauses()
+void VarReplacer::replace_xor(Xor& x)
 {
-    for(Xor& x: solver->xorclauses) {
-        for(uint32_t i = 0, end = x.size(); i < end; i++) {
-            assert(x[i] < solver->nVars());
-            Lit l = Lit(x[i], false);
-            if (get_lit_replaced_with_fast(l) != l) {
-                l = get_lit_replaced_with_fast(l);
-                x.rhs ^= l.sign();
-                x[i] = l.var();
-                runStats.replacedLits++;
-            }
+    for(uint32_t i = 0, end = x.size(); i < end; i++) {
+        assert(x[i] < solver->nVars());
+        Lit l = Lit(x[i], false);
+        if (get_lit_replaced_with_fast(l) != l) {
+            l = get_lit_replaced_with_fast(l);
+            x.rhs ^= l.sign();
+            x[i] = l.var();
+            runStats.replacedLits++;
         }
+    }
+}
 
+bool VarReplacer::replace_xor_clauses()
+{
+    for(Xor& x: solver->xorclauses) {
+        replace_xor(x);
         solver->clean_xor_vars_no_prop(x.get_vars(), x.rhs);
         if (x.size() == 0 && x.rhs == true) {
             solver->ok = false;
         }
     }
 
+    #ifdef USE_GAUSS
+    //Matrixes kept from the last search
+    size_t j = 0;
+    for(size_t i = 0; i < solver->gmatrixes_kept.size(); i++) {
+        GaussKept& k = solver->gmatrixes_kept[i];
+        for(Xor& x: k.input) {
+            replace_xor(x);
+        }
+        for(Xor& x: k.rows) {
+            replace_xor(x);
+        }
+        for(uint32_t& v: k.col_order) {
+            v = get_lit_replaced_with_fast(Lit(v, false)).var();
+        }
+        if (clean_kept_xors(solver, k.input) && clean_kept_xors(solver, k.rows)) {
+            std::swap(solver->gmatrixes_kept[j++], k);
+        }
+    }
+    solver->gmatrixes_kept.resize(j);
+    #endif
+
     return solver->okay();
 }
 
@@ -1073,8 +1101,13 @@ size_t VarReplacer::mem_used() const
     return b;
 }
 
-uint32_t VarReplacer::print_equivalent_literals(bool outer_numbering, std::ostream *os) const
-{
+//If "bin_cls" is given, the two binary clauses of each equivalence are also
+//appended to it, two literals each
+uint32_t VarReplacer::print_equivalent_literals(
+    bool outer_numbering
+    , std::ostream *os
+    , vector<Lit>* bin_cls
+) const {
     uint32_t num = 0;
     vector<Lit> tmpCl;
     for (uint32_t var = 0; var < table.size(); var++) {
@@ -1118,6 +1151,12 @@ uint32_t VarReplacer::print_equivalent_literals(bool outer_numbering, std::ostre
             << tmpCl[1]
             << " 0\n";
         }
+        if (bin_cls) {
+            bin_cls->push_back(~lit1);
+            bin_cls->push_back(lit2);
+            bin_cls->push_back(lit1);
+            bin_cls->push_back(~lit2);
+        }
         num++;
     }
     return num;
@@ -1296,6 +1335,14 @@ void VarReplacer::load_state(SimpleInFile& f)
     }
 }
 
+void VarReplacer::copy_state_from(const VarReplacer& other)
+{
+    table = other.table;
+    replacedVars = other.replacedVars;
+    reverseTable = other.reverseTable;
+    globalStats = other.globalStats;
+}
+
 bool VarReplacer::get_scc_depth_warning_triggered() const
 {
     return scc_finder->depth_warning_triggered();
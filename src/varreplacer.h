@@ -41,6 +41,7 @@ using std::map;
 using std::vector;
 class Solver;
 class SCCFinder;
+class Xor;
 
 /**
 @brief Replaces variables with their anti/equivalents
@@ -54,7 +55,7 @@ class VarReplacer
         void new_vars(const size_t n);
         void save_on_var_memory();
         bool replace_if_enough_is_found(const size_t limit = 0, uint64_t* bogoprops = NULL, bool* replaced = NULL);
-        uint32_t print_equivalent_literals(bool outer_numbering, std::ostream *os = NULL) const;
+        uint32_t print_equivalent_literals(bool outer_numbering, std::ostream *os = NULL, vector<Lit>* bin_cls = NULL) const;
         void print_some_stats(const double global_cpu_time) const;
         const SCCFinder* get_scc_finder() const;
 
@@ -107,6 +108,7 @@ class VarReplacer
 
         void save_state(SimpleOutFile& f) const;
         void load_state(SimpleInFile& f);
+        void copy_state_from(const VarReplacer& other);
 
     private:
         Solver* solver;
@@ -124,6 +126,7 @@ class VarReplacer
             return fast_inter_replace_lookup[var].var();
         }
         bool replace_xor_clauses();
+        void replace_xor(Xor& x);
 
         vector<Lit> ps_tmp;
         bool perform_replace();
@@ -39,6 +39,14 @@ static inline bool findWCl(watch_subarray_const ws, const ClOffset c)
     return i != end;
 }
 
+static inline Watched& findWatchedOfCl(watch_subarray ws, const ClOffset c)
+{
+    Watched* i = ws.begin(), *end = ws.end();
+    for (; i != end && (!i->isClause() || i->get_offset() != c); i++);
+    assert(i != end);
+    return *i;
+}
+
 static inline void removeWCl(watch_subarray ws, const ClOffset c)
 {
     Watched* i = ws.begin(), *end = ws.end();
@@ -94,6 +94,15 @@ public:
         smudged.resize(new_size, false);
     }
 
+    void copy_from(const watch_array& other)
+    {
+        assert(smudged_list.empty());
+        resize(other.size());
+        for(size_t i = 0; i < other.size(); i++) {
+            other.watches[i].copyTo(watches[i]);
+        }
+    }
+
     void insert(uint32_t num)
     {
         smudged.insert(smudged.end(), num, false);
@@ -25,6 +25,7 @@ THE SOFTWARE.
 
 #include <stdlib.h>
 #include "watched.h"
+#include "hugepagealloc.h"
 #include <vector>
 
 namespace CMSat {
@@ -148,7 +149,7 @@ struct watch_array
         //We need at least 1
         Mem new_mem;
         size_t elems = WATCH_MIN_SIZE_ONE_ALLOC_FIRST;
-        new_mem.base_ptr = (Watched*)malloc(elems*sizeof(Watched));
+        new_mem.base_ptr = (Watched*)huge_alloc(elems*sizeof(Watched));
         new_mem.alloc = elems;
         mems.push_back(new_mem);
 
@@ -158,7 +159,7 @@ struct watch_array
     ~watch_array()
     {
         for(size_t i = 0; i < mems.size(); i++) {
-            free(mems[i].base_ptr);
+            huge_free(mems[i].base_ptr, mems[i].alloc*sizeof(Watched));
         }
     }
 
@@ -179,7 +180,7 @@ struct watch_array
         Mem new_mem;
         new_mem.alloc = std::max<size_t>(3*last_alloc, WATCH_MIN_SIZE_ONE_ALLOC_LATER);
         new_mem.alloc = std::min<size_t>(3*last_alloc, WATCH_MAX_SIZE_ONE_ALLOC);
-        new_mem.base_ptr = (Watched*)malloc(new_mem.alloc*sizeof(Watched));
+        new_mem.base_ptr = (Watched*)huge_alloc(new_mem.alloc*sizeof(Watched));
         assert(new_mem.base_ptr != NULL);
         mems.push_back(new_mem);
         return mems.size()-1;
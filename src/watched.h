@@ -39,6 +39,7 @@ namespace CMSat {
 enum WatchType {
     watch_clause_t = 0
     , watch_binary_t = 1
+    , watch_shared_t = 2
     , watch_idx_t = 3
 };
 
@@ -50,6 +51,13 @@ This class contains two 32-bit datapieces. They are either used as:
 \li Two literals, in the case of tertiary clauses
 \li One blocking literal (i.e. an example literal from the clause) and a clause
 offset (as per ClauseAllocator ), in the case of long clauses
+\li One blocking literal and the index of the clause in SharedClauses, in the
+case of long clauses shared between threads
+
+If compiled with INLINE_TERNARY_WATCH, a third 32-bit datapiece is present,
+and watches of 3-long clauses store both of the other literals of the clause
+(the blocked literal and lit3()). This way, a satisfied 3-long clause is never
+dereferenced during propagation.
 */
 class Watched {
     public:
@@ -60,9 +68,25 @@ class Watched {
             data1(blockedLit.toInt())
             , type(watch_clause_t)
             , data2(offset)
+            #ifdef INLINE_TERNARY_WATCH
+            , data3(std::numeric_limits<uint32_t>::max())
+            #endif
         {
         }
 
+        #ifdef INLINE_TERNARY_WATCH
+        /**
+        @brief Constructor for a 3-long clause, storing both other literals
+        */
+        Watched(const ClOffset offset, Lit blockedLit, Lit _lit3) :
+            data1(blockedLit.toInt())
+            , type(watch_clause_t)
+            , data2(offset)
+            , data3(_lit3.toInt())
+        {
+        }
+        #endif
+
         /**
         @brief Constructor for a long (>3) clause
         */
@@ -70,6 +94,9 @@ class Watched {
             data1(abst)
             , type(watch_clause_t)
             , data2(offset)
+            #ifdef INLINE_TERNARY_WATCH
+            , data3(std::numeric_limits<uint32_t>::max())
+            #endif
         {
         }
 
@@ -77,6 +104,9 @@ class Watched {
             data1 (std::numeric_limits<uint32_t>::max())
             , type(watch_clause_t) // initialize type with most generic type of clause
             , data2(std::numeric_limits<uint32_t>::max() >> 2)
+            #ifdef INLINE_TERNARY_WATCH
+            , data3(std::numeric_limits<uint32_t>::max())
+            #endif
         {}
 
         /**
@@ -86,6 +116,9 @@ class Watched {
             data1(lit.toInt())
             , type(watch_binary_t)
             , data2(red)
+            #ifdef INLINE_TERNARY_WATCH
+            , data3(std::numeric_limits<uint32_t>::max())
+            #endif
         {
         }
 
@@ -95,7 +128,20 @@ class Watched {
         explicit Watched(const uint32_t idx) :
             data1(idx)
             , type(watch_idx_t)
+            #ifdef INLINE_TERNARY_WATCH
+            , data3(std::numeric_limits<uint32_t>::max())
+            #endif
+        {
+        }
+
+        /**
+        @brief Constructor for a long clause in SharedClauses
+        */
+        static Watched shared_cl(const uint32_t at, const Lit blockedLit)
         {
+            Watched w(at, blockedLit);
+            w.type = watch_shared_t;
+            return w;
         }
 
         /**
@@ -104,7 +150,7 @@ class Watched {
         void setBlockedLit(const Lit blockedLit)
         {
             #ifdef DEBUG_WATCHED
-            assert(type == watch_clause_t);
+            assert(type == watch_clause_t || type == watch_shared_t);
             #endif
             data1 = blockedLit.toInt();
         }
@@ -130,6 +176,38 @@ class Watched {
             return (type == watch_idx_t);
         }
 
+        bool isShared() const
+        {
+            return (type == watch_shared_t);
+        }
+
+        #ifdef INLINE_TERNARY_WATCH
+        bool isTernary() const
+        {
+            return (type == watch_clause_t
+                && data3 != std::numeric_limits<uint32_t>::max());
+        }
+
+        /**
+        @brief Get the 2nd non-watched literal of a 3-long clause
+        */
+        Lit lit3() const
+        {
+            #ifdef DEBUG_WATCHED
+            assert(isTernary());
+            #endif
+            return Lit::toLit(data3);
+        }
+
+        void setLit3(const Lit lit)
+        {
+            #ifdef DEBUG_WATCHED
+            assert(isTernary());
+            #endif
+            data3 = lit.toInt();
+        }
+        #endif
+
         uint32_t get_idx() const
         {
             #ifdef DEBUG_WATCHED
@@ -208,7 +286,7 @@ class Watched {
         Lit getBlockedLit() const
         {
             #ifdef DEBUG_WATCHED
-            assert(isClause());
+            assert(isClause() || isShared());
             #endif
             return Lit::toLit(data1);
         }
@@ -232,9 +310,24 @@ class Watched {
             return data2;
         }
 
+        /**
+        @brief Get index of a clause in SharedClauses
+        */
+        uint32_t get_shared_at() const
+        {
+            #ifdef DEBUG_WATCHED
+            assert(isShared());
+            #endif
+            return data2;
+        }
+
         bool operator==(const Watched& other) const
         {
-            return data1 == other.data1 && data2 == other.data2 && type == other.type;
+            return data1 == other.data1 && data2 == other.data2 && type == other.type
+            #ifdef INLINE_TERNARY_WATCH
+                && data3 == other.data3
+            #endif
+            ;
         }
 
         bool operator!=(const Watched& other) const
@@ -249,6 +342,9 @@ class Watched {
         // in case if WatchType extended type size won't be enough.
         ClOffset type:2;
         ClOffset data2:EFFECTIVELY_USEABLE_BITS;
+        #ifdef INLINE_TERNARY_WATCH
+        uint32_t data3;
+        #endif
 };
 
 inline std::ostream& operator<<(std::ostream& os, const Watched& ws)
@@ -256,12 +352,21 @@ inline std::ostream& operator<<(std::ostream& os, const Watched& ws)
 
     if (ws.isClause()) {
         os << "Clause offset " << ws.get_offset();
+        #ifdef INLINE_TERNARY_WATCH
+        if (ws.isTernary()) {
+            os << " (ternary, other lit: " << ws.lit3() << ")";
+        }
+        #endif
     }
 
     if (ws.isBin()) {
         os << "Bin lit " << ws.lit2() << " (red: " << ws.red() << " )";
     }
 
+    if (ws.isShared()) {
+        os << "Shared clause " << ws.get_shared_at();
+    }
+
     return os;
 }
 
@@ -23,6 +23,10 @@ THE SOFTWARE.
 #include "gtest/gtest.h"
 
 #include <fstream>
+#include <sstream>
+#include <random>
+#include <thread>
+#include <chrono>
 
 #include "cryptominisat5/cryptominisat.h"
 #include "src/solverconf.h"
@@ -110,6 +114,347 @@ TEST(normal_interface, solve_multi_thread)
     EXPECT_EQ(s.get_model()[1], l_True);
 }
 
+TEST(normal_interface, cube_and_conquer)
+{
+    SolverConf conf;
+    conf.cube_and_conquer = true;
+    conf.cube_confl_budget = 0;
+    SATSolver s(&conf);
+    s.set_num_threads(3);
+    s.new_vars(4);
+
+    s.add_clause(str_to_cl("1, 2"));
+    s.add_clause(str_to_cl("-1, 3"));
+    s.add_clause(str_to_cl("-2, 3"));
+    s.add_clause(str_to_cl("3, 4"));
+    lbool ret = s.solve();
+    EXPECT_EQ(ret, l_True);
+    EXPECT_EQ(s.get_model()[2], l_True);
+
+    vector<Lit> assumps = str_to_cl("-3, 4");
+    ret = s.solve(&assumps);
+    EXPECT_EQ(ret, l_False);
+    EXPECT_EQ(s.get_conflict(), str_to_cl("3"));
+    EXPECT_EQ(s.okay(), true);
+
+    s.add_clause(str_to_cl("-3"));
+    ret = s.solve();
+    EXPECT_EQ(ret, l_False);
+    EXPECT_EQ(s.okay(), false);
+}
+
+TEST(normal_interface, solve_async)
+{
+    SATSolver s;
+    s.new_vars(3);
+    s.add_clause(str_to_cl("1, 2"));
+    s.add_clause(str_to_cl("-1"));
+    std::future<lbool> ret = s.solve_async();
+    EXPECT_EQ(ret.get(), l_True);
+    EXPECT_EQ(s.get_model()[1], l_True);
+
+    vector<Lit> assumps = str_to_cl("-2");
+    ret = s.solve_async(&assumps);
+    EXPECT_EQ(ret.get(), l_False);
+}
+
+TEST(normal_interface, progress_callback_interrupts)
+{
+    SATSolver s;
+    s.set_num_threads(2);
+    std::mt19937 mtrand(1);
+    s.new_vars(250);
+    for(uint32_t i = 0; i < 1065; i++) {
+        vector<Lit> cl;
+        for(uint32_t j = 0; j < 3; j++) {
+            cl.push_back(Lit(mtrand() % 250, mtrand() % 2));
+        }
+        s.add_clause(cl);
+    }
+
+    uint32_t calls = 0;
+    s.set_progress_callback([&](const SolveProgress& p) {
+        EXPECT_LT(p.thread, 2U);
+        EXPECT_GT(p.restarts, 0U);
+        calls++;
+        return false;
+    }, 0);
+    lbool ret = s.solve();
+    EXPECT_EQ(ret, l_Undef);
+    EXPECT_GE(calls, 1U);
+}
+
+TEST(normal_interface, progress_max_trail_depth)
+{
+    SATSolver s;
+    std::mt19937 mtrand(1);
+    s.new_vars(250);
+    for(uint32_t i = 0; i < 1065; i++) {
+        vector<Lit> cl;
+        for(uint32_t j = 0; j < 3; j++) {
+            cl.push_back(Lit(mtrand() % 250, mtrand() % 2));
+        }
+        s.add_clause(cl);
+    }
+
+    //Not reset by restarts or by the next solve()
+    vector<uint32_t> depths;
+    s.set_progress_callback([&](const SolveProgress& p) {
+        depths.push_back(p.max_trail_depth);
+        return true;
+    }, 100);
+    for(uint32_t i = 0; i < 2; i++) {
+        s.set_max_confl(3000);
+        s.solve();
+    }
+    ASSERT_GE(depths.size(), 2U);
+    EXPECT_GT(depths[0], 0U);
+    for(size_t i = 1; i < depths.size(); i++) {
+        EXPECT_GE(depths[i], depths[i-1]);
+    }
+}
+
+TEST(normal_interface, clone)
+{
+    SATSolver s;
+    s.new_vars(3);
+    s.add_clause(str_to_cl("1, 2, 3"));
+    s.add_clause(str_to_cl("-1, 2"));
+    EXPECT_EQ(s.solve(), l_True);
+
+    SATSolver* c = s.clone();
+    s.add_clause(str_to_cl("-2"));
+    EXPECT_EQ(s.solve(), l_True);
+    EXPECT_EQ(s.get_model()[2], l_True);
+
+    vector<Lit> assumps = str_to_cl("-3");
+    EXPECT_EQ(c->solve(&assumps), l_True);
+    EXPECT_EQ(c->get_model()[1], l_True);
+    EXPECT_EQ(c->nVars(), 3U);
+    delete c;
+}
+
+TEST(normal_interface, clone_multi_thread)
+{
+    SATSolver s;
+    s.set_num_threads(3);
+    s.new_vars(2);
+    s.add_clause(str_to_cl("1, 2"));
+    s.add_clause(str_to_cl("-1, 2"));
+
+    SATSolver* c = s.clone();
+    c->add_clause(str_to_cl("1, -2"));
+    c->add_clause(str_to_cl("-1, -2"));
+    EXPECT_EQ(c->solve(), l_False);
+    EXPECT_EQ(s.solve(), l_True);
+    delete c;
+}
+
+TEST(normal_interface, snapshot_rollback)
+{
+    SATSolver s;
+    s.new_vars(2);
+    s.add_clause(str_to_cl("1, 2"));
+    const unsigned snap = s.snapshot();
+    s.add_clause(str_to_cl("-1"));
+    s.add_clause(str_to_cl("-2"));
+    EXPECT_EQ(s.solve(), l_False);
+
+    s.rollback(snap);
+    EXPECT_EQ(s.okay(), true);
+    EXPECT_EQ(s.solve(), l_True);
+    EXPECT_THROW(s.rollback(snap), std::runtime_error);
+}
+
+TEST(normal_interface, snapshot_rollback_nested)
+{
+    SATSolver s;
+    s.new_vars(3);
+    s.add_clause(str_to_cl("1, 2"));
+    const unsigned snap1 = s.snapshot();
+    s.add_clause(str_to_cl("-1"));
+    const unsigned snap2 = s.snapshot();
+    s.add_xor_clause(vector<unsigned>{1U, 2U}, true);
+    s.add_clause(str_to_cl("-3"));
+    EXPECT_EQ(s.nVars(), 3u);
+    EXPECT_EQ(s.solve(), l_True);
+    EXPECT_EQ(s.get_model()[1], l_True);
+    EXPECT_EQ(s.get_model()[2], l_False);
+
+    //The conflict only has the caller's assumptions
+    vector<Lit> assumps = str_to_cl("3");
+    EXPECT_EQ(s.solve(&assumps), l_False);
+    EXPECT_EQ(s.get_conflict(), str_to_cl("-3"));
+
+    s.rollback(snap2);
+    EXPECT_EQ(s.solve(&assumps), l_True);
+    assumps = str_to_cl("-2");
+    EXPECT_EQ(s.solve(&assumps), l_False);
+    EXPECT_EQ(s.get_conflict(), str_to_cl("2"));
+
+    s.rollback(snap1);
+    EXPECT_EQ(s.solve(&assumps), l_True);
+    EXPECT_EQ(s.get_model()[0], l_True);
+    EXPECT_EQ(s.nVars(), 3u);
+    EXPECT_EQ(s.get_model().size(), 3u);
+}
+
+TEST(normal_interface, snapshot_rollback_threads)
+{
+    SATSolver s;
+    s.set_num_threads(3);
+    s.new_vars(3);
+    s.add_clause(str_to_cl("1, 2, 3"));
+
+    //Before the first solve(), only thread 0 has the clauses
+    const unsigned snap1 = s.snapshot();
+    s.add_clause(str_to_cl("-3"));
+    EXPECT_EQ(s.solve(), l_True);
+    EXPECT_EQ(s.get_model()[2], l_False);
+
+    const unsigned snap2 = s.snapshot();
+    s.add_clause(str_to_cl("-1"));
+    s.add_clause(str_to_cl("-2"));
+    EXPECT_EQ(s.solve(), l_False);
+    EXPECT_EQ(s.okay(), true);
+
+    s.rollback(snap2);
+    s.add_clause(str_to_cl("-1"));
+    EXPECT_EQ(s.solve(), l_True);
+    EXPECT_EQ(s.get_model()[0], l_False);
+    EXPECT_EQ(s.get_model()[1], l_True);
+
+    s.rollback(snap1);
+    vector<Lit> assumps = str_to_cl("-1, -2");
+    EXPECT_EQ(s.solve(&assumps), l_True);
+    EXPECT_EQ(s.get_model()[2], l_True);
+}
+
+//Simplifying once in thread 0 and cloning the result to the others must not
+//change the results
+TEST(normal_interface, clone_startup_simplify)
+{
+    std::mt19937 mtrand(7);
+    uint32_t num_sat = 0;
+    uint32_t num_unsat = 0;
+    for(uint32_t at = 0; at < 20; at++) {
+        SolverConf conf;
+        conf.simplify_at_startup = true;
+        SATSolver ref(&conf);
+        conf.clone_startup_simplify = true;
+        SATSolver s(&conf);
+        ref.set_num_threads(3);
+        s.set_num_threads(3);
+        ref.new_vars(100);
+        s.new_vars(100);
+
+        //Around the SAT/UNSAT threshold, with some equivalent variables so
+        //that some are replaced, too
+        vector<vector<Lit>> cls;
+        for(uint32_t i = 0; i < 10; i++) {
+            const Lit a = Lit(mtrand() % 100, false);
+            const Lit b = Lit(mtrand() % 100, mtrand() % 2);
+            if (a.var() != b.var()) {
+                cls.push_back(vector<Lit>{a, b});
+                cls.push_back(vector<Lit>{~a, ~b});
+            }
+        }
+        for(uint32_t i = 0; i < 410; i++) {
+            vector<Lit> cl;
+            for(uint32_t j = 0; j < 3; j++) {
+                cl.push_back(Lit(mtrand() % 100, mtrand() % 2));
+            }
+            cls.push_back(cl);
+        }
+        for(const vector<Lit>& cl: cls) {
+            ref.add_clause(cl);
+            s.add_clause(cl);
+        }
+
+        //The second solve() is after the clone
+        for(uint32_t i = 0; i < 2; i++) {
+            const vector<Lit> assumps{Lit(i, false)};
+            const lbool ret = s.solve(i == 0 ? NULL : &assumps);
+            EXPECT_EQ(ret, ref.solve(i == 0 ? NULL : &assumps));
+            if (ret != l_True) {
+                num_unsat += (i == 0);
+                break;
+            }
+            num_sat += (i == 0);
+            if (i == 1) {
+                EXPECT_EQ(s.get_model()[1], l_True);
+            }
+            for(const vector<Lit>& cl: cls) {
+                bool sat = false;
+                for(const Lit l: cl) {
+                    sat |= (s.get_model()[l.var()] == (l.sign() ? l_False : l_True));
+                }
+                EXPECT_TRUE(sat);
+            }
+        }
+    }
+    EXPECT_GT(num_sat, 0U);
+    EXPECT_GT(num_unsat, 0U);
+}
+
+TEST(normal_interface, add_clauses_flat)
+{
+    for(unsigned threads = 1; threads <= 2; threads++) {
+        SATSolver s;
+        s.set_num_threads(threads);
+        s.new_vars(3);
+        EXPECT_TRUE(s.add_clauses(NULL, 0));
+
+        //Last clause is not terminated
+        vector<Lit> lits = str_to_cl("1, 2, 3");
+        lits.push_back(lit_Undef);
+        lits.push_back(Lit(0, true));
+        lits.push_back(lit_Undef);
+        lits.push_back(Lit(1, true));
+        s.add_clauses(lits.data(), lits.size());
+
+        EXPECT_EQ(s.solve(), l_True);
+        EXPECT_EQ(s.get_model()[2], l_True);
+
+        lits.clear();
+        lits.push_back(Lit(2, true));
+        lits.push_back(lit_Undef);
+        s.add_clauses(lits.data(), lits.size());
+        EXPECT_EQ(s.solve(), l_False);
+    }
+}
+
+//Too many to buffer, the threads read them from the caller's buffer
+TEST(normal_interface, add_clauses_flat_large)
+{
+    SATSolver s;
+    s.set_num_threads(2);
+    s.new_vars(1000);
+    s.add_clause(str_to_cl("-3"));
+
+    vector<Lit> lits;
+    while(lits.size() < 11ULL*1000ULL*1000ULL) {
+        for(uint32_t i = 0; i < 1000; i++) {
+            lits.push_back(Lit(i, false));
+            lits.push_back(Lit((i+1) % 1000, false));
+            lits.push_back(lit_Undef);
+        }
+    }
+    //Last clause is not terminated
+    lits.push_back(Lit(0, true));
+    EXPECT_TRUE(s.add_clauses(lits.data(), lits.size()));
+
+    EXPECT_EQ(s.solve(), l_True);
+    EXPECT_EQ(s.get_model()[0], l_False);
+    EXPECT_EQ(s.get_model()[1], l_True);
+    EXPECT_EQ(s.get_model()[2], l_False);
+    EXPECT_EQ(s.get_model()[3], l_True);
+    EXPECT_EQ(s.get_model()[999], l_True);
+
+    s.add_clause(str_to_cl("-2"));
+    EXPECT_EQ(s.solve(), l_False);
+}
+
 TEST(normal_interface, logfile)
 {
     SATSolver* s = new SATSolver();
@@ -803,6 +1148,26 @@ TEST(statistics, last_vs_sum_conflicts)
     EXPECT_EQ(s.get_last_conflicts(), 2);
 }
 
+TEST(statistics, solve_time_multi_thread)
+{
+    SATSolver s;
+    s.set_num_threads(3);
+    s.new_vars(10);
+    EXPECT_EQ(s.get_num_solve_calls(), 0);
+    EXPECT_EQ(s.get_sum_solve_time(), 0);
+
+    for(unsigned i = 0; i < 20; i++) {
+        s.add_clause(vector<Lit>{Lit(i % 10, false), Lit((i+1) % 10, true)});
+        vector<Lit> assumps{Lit(i % 10, i % 2)};
+        lbool ret = s.solve(&assumps);
+        EXPECT_EQ(ret, l_True);
+        EXPECT_GE(s.get_last_solve_time(), 0);
+        EXPECT_LE(s.get_last_solve_time(), s.get_max_solve_time());
+    }
+    EXPECT_EQ(s.get_num_solve_calls(), 20);
+    EXPECT_LE(s.get_max_solve_time(), s.get_sum_solve_time());
+}
+
 TEST(propagate, trivial_1)
 {
     SATSolver s;
@@ -1102,6 +1467,47 @@ TEST(xor_recovery, DISABLED_find_xor_renumber)
     EXPECT_EQ(xors[0].first, (vector<uint32_t>{1U, 2U, 3U, 4U, 5U, 6U, 7U, 8U, 9U}));
 }
 
+//Stringbuf that is slow to write to, like a slow disk
+struct slow_stringbuf: public std::stringbuf {
+    std::streamsize xsputn(const char* data, std::streamsize n) override
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        return std::stringbuf::xsputn(data, n);
+    }
+};
+
+static string drat_of_random_unsat(const bool async)
+{
+    SolverConf conf;
+    conf.drat_async = async;
+    conf.doFindXors = false;
+    //Gauss can't be used with DRAT
+    conf.gaussconf.decision_until = 0;
+    SATSolver s(&conf);
+    slow_stringbuf buf;
+    std::ostream os(&buf);
+    s.set_drat(&os, false);
+
+    std::mt19937 mtrand(3);
+    s.new_vars(150);
+    for(int i = 0; i < 800; i++) {
+        vector<Lit> cl;
+        for(int j = 0; j < 3; j++) {
+            cl.push_back(Lit(mtrand() % 150, mtrand() % 2));
+        }
+        s.add_clause(cl);
+    }
+    EXPECT_EQ(s.solve(), l_False);
+    return buf.str();
+}
+
+TEST(drat, async_same_as_sync)
+{
+    const string sync = drat_of_random_unsat(false);
+    const string async = drat_of_random_unsat(true);
+    EXPECT_GT(sync.size(), 0U);
+    EXPECT_EQ(sync, async);
+}
 
 int main(int argc, char **argv) {
   ::testing::InitGoogleTest(&argc, argv);
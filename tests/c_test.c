@@ -57,6 +57,29 @@ int main(void) {
     assert(model.vals[1].x == L_FALSE);
     assert(model.vals[2].x == L_TRUE);
 
+    cmsat_free(solver);
+
+    // same clauses in one go
+    solver = cmsat_new();
+    cmsat_new_vars(solver, 3);
+    c_Lit undef;
+    undef.x = CMSAT_LIT_UNDEF;
+    c_Lit clauses[8];
+    clauses[0] = new_lit(0, false);
+    clauses[1] = undef;
+    clauses[2] = new_lit(1, true);
+    clauses[3] = undef;
+    clauses[4] = new_lit(0, true);
+    clauses[5] = new_lit(1, false);
+    clauses[6] = new_lit(2, false);
+    clauses[7] = undef;
+    cmsat_add_clauses(solver, clauses, 8);
+
+    ret = cmsat_solve(solver);
+    assert(ret.x == L_TRUE);
+    model = cmsat_get_model(solver);
+    assert(model.vals[2].x == L_TRUE);
+
     cmsat_free(solver);
     return 0;
 }
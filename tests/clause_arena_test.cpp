@@ -0,0 +1,357 @@
+/******************************************
+Copyright (c) 2016, Mate Soos
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+***********************************************/
+
+#include "gtest/gtest.h"
+
+#include <random>
+#include <set>
+
+#include "src/solver.h"
+#include "src/clauseallocator.h"
+#include "src/solverconf.h"
+using namespace CMSat;
+#include "test_helper.h"
+
+//Configure with a small ARENA_SEG_BITS to run these fast, and to also cross
+//segments in the consolidate tests of clause_arena_solver
+static const uint64_t SLOT_BYTES = sizeof(BASE_DATA_TYPE);
+
+static void fill(BASE_DATA_TYPE* p, const uint64_t num, const uint64_t seed)
+{
+    unsigned char* bytes = (unsigned char*)p;
+    for(uint64_t i = 0; i < num*SLOT_BYTES; i += 64) {
+        bytes[i] = (unsigned char)(seed + i/64);
+    }
+}
+
+static bool filled(const BASE_DATA_TYPE* p, const uint64_t num, const uint64_t seed)
+{
+    const unsigned char* bytes = (const unsigned char*)p;
+    for(uint64_t i = 0; i < num*SLOT_BYTES; i += 64) {
+        if (bytes[i] != (unsigned char)(seed + i/64)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+TEST(clause_arena, crosses_segments)
+{
+    ClauseArena arena;
+    vector<std::pair<uint64_t, uint64_t> > allocs;
+    std::mt19937 mtrand(1);
+    while (arena.size() < 3*ARENA_SEG_SLOTS) {
+        const uint64_t num = 1 + mtrand() % (ARENA_SEG_SLOTS/7);
+        const uint64_t at = arena.place(num);
+        BASE_DATA_TYPE* p = arena.alloc(num, false);
+        ASSERT_TRUE(p != NULL);
+        EXPECT_EQ(arena.ptr(at), p);
+        EXPECT_EQ(arena.get_offset(p), at);
+        EXPECT_EQ(arena.get_offset(p + num - 1), at + num - 1);
+
+        //Never straddles two segments
+        EXPECT_EQ(at >> ARENA_SEG_BITS, (at + num - 1) >> ARENA_SEG_BITS);
+        fill(p, num, allocs.size());
+        allocs.push_back(std::make_pair(at, num));
+    }
+
+    for(size_t i = 0; i < allocs.size(); i++) {
+        EXPECT_TRUE(filled(arena.ptr(allocs[i].first), allocs[i].second, i));
+    }
+
+    ClauseArena copy;
+    ASSERT_TRUE(copy.copy_from(arena, false));
+    EXPECT_EQ(copy.size(), arena.size());
+    for(size_t i = 0; i < allocs.size(); i++) {
+        EXPECT_TRUE(filled(copy.ptr(allocs[i].first), allocs[i].second, i));
+    }
+}
+
+TEST(clause_arena, larger_than_segment)
+{
+    ClauseArena arena;
+    ASSERT_TRUE(arena.alloc(10, false) != NULL);
+
+    const uint64_t num = 2*ARENA_SEG_SLOTS + 10;
+    const uint64_t at = arena.place(num);
+    EXPECT_EQ(at, ARENA_SEG_SLOTS);
+    BASE_DATA_TYPE* p = arena.alloc(num, false);
+    ASSERT_TRUE(p != NULL);
+    EXPECT_EQ(arena.ptr(at), p);
+
+    //Its segments are contiguous
+    EXPECT_EQ(arena.ptr(at + ARENA_SEG_SLOTS + 5), p + ARENA_SEG_SLOTS + 5);
+    EXPECT_EQ(arena.get_offset(p + num - 1), at + num - 1);
+    fill(p, num, 3);
+
+    //The rest of its last segment is used
+    const uint64_t at2 = arena.place(10);
+    EXPECT_EQ(at2, at + num);
+    BASE_DATA_TYPE* p2 = arena.alloc(10, false);
+    ASSERT_TRUE(p2 != NULL);
+    EXPECT_EQ(arena.get_offset(p2), at2);
+    EXPECT_TRUE(filled(p, num, 3));
+}
+
+TEST(clause_arena, truncate_frees_segments)
+{
+    ClauseArena arena;
+    while (arena.size() < 3*ARENA_SEG_SLOTS) {
+        ASSERT_TRUE(arena.alloc(ARENA_SEG_SLOTS/2, false) != NULL);
+    }
+    EXPECT_GE(arena.capacity(), 3*ARENA_SEG_SLOTS);
+    fill(arena.ptr(0), 10, 5);
+
+    arena.truncate(ARENA_SEG_SLOTS + 1, false);
+    EXPECT_EQ(arena.size(), ARENA_SEG_SLOTS + 1);
+    EXPECT_EQ(arena.capacity(), 2*ARENA_SEG_SLOTS);
+
+    arena.truncate(10, false);
+    EXPECT_EQ(arena.size(), 10U);
+    EXPECT_LE(arena.capacity(), ARENA_SEG_SLOTS);
+    EXPECT_TRUE(filled(arena.ptr(0), 10, 5));
+
+    //Grows again as usual
+    while (arena.size() < 2*ARENA_SEG_SLOTS) {
+        ASSERT_TRUE(arena.alloc(ARENA_SEG_SLOTS/3, false) != NULL);
+    }
+    EXPECT_TRUE(filled(arena.ptr(0), 10, 5));
+
+    arena.truncate(0, false);
+    EXPECT_TRUE(arena.empty());
+}
+
+TEST(clause_arena, free_between_leaves_holes)
+{
+    ClauseArena arena;
+    while (arena.size() < 3*ARENA_SEG_SLOTS) {
+        ASSERT_TRUE(arena.alloc(ARENA_SEG_SLOTS/2, false) != NULL);
+    }
+    fill(arena.ptr(0), 10, 5);
+    const uint64_t num = ARENA_SEG_SLOTS + 10;
+    const uint64_t at = arena.place(num);
+    BASE_DATA_TYPE* p = arena.alloc(num, false);
+    ASSERT_TRUE(p != NULL);
+    fill(p, num, 3);
+    const uint64_t cap = arena.capacity();
+
+    //The 2nd and 3rd segments are freed, the 1st one is partly used
+    arena.free_between(10, at);
+    EXPECT_EQ(arena.capacity(), cap - 2*ARENA_SEG_SLOTS);
+    EXPECT_TRUE(arena.backed(0));
+    EXPECT_FALSE(arena.backed(ARENA_SEG_SLOTS));
+    EXPECT_FALSE(arena.backed(2*ARENA_SEG_SLOTS));
+    EXPECT_TRUE(arena.backed(at));
+    EXPECT_TRUE(filled(arena.ptr(0), 10, 5));
+    EXPECT_TRUE(filled(p, num, 3));
+    EXPECT_EQ(arena.get_offset(p), at);
+
+    //Allocates after the end, as usual
+    BASE_DATA_TYPE* p2 = arena.alloc(10, false);
+    ASSERT_TRUE(p2 != NULL);
+    EXPECT_EQ(arena.get_offset(p2), at + num);
+
+    //A copy has the same holes
+    ClauseArena copy;
+    ASSERT_TRUE(copy.copy_from(arena, false));
+    EXPECT_EQ(copy.capacity(), arena.capacity());
+    EXPECT_FALSE(copy.backed(ARENA_SEG_SLOTS));
+    EXPECT_TRUE(filled(copy.ptr(at), num, 3));
+
+    arena.truncate(10, false);
+    EXPECT_LE(arena.capacity(), ARENA_SEG_SLOTS);
+    EXPECT_TRUE(filled(arena.ptr(0), 10, 5));
+}
+
+struct clause_arena_solver : public ::testing::Test {
+    clause_arena_solver()
+    {
+        must_inter.store(false, std::memory_order_relaxed);
+    }
+    ~clause_arena_solver()
+    {
+        delete s;
+    }
+
+    void make_solver(const uint32_t num_vars)
+    {
+        s = new Solver(&conf, &must_inter);
+        s->new_vars(num_vars);
+    }
+
+    //Long clauses until the arena is "slots" long, but at most "max_cls" of
+    //them, every 3rd one freed
+    void add_clauses(const uint64_t slots, const uint64_t max_cls)
+    {
+        std::mt19937 mtrand(2);
+        for(uint64_t i = 0; i < max_cls && last_offs < slots; i++) {
+            vector<Lit> lits;
+            const uint32_t size = 3 + mtrand() % 40;
+            std::set<uint32_t> vars;
+            while (vars.size() < size) {
+                vars.insert(mtrand() % s->nVars());
+            }
+            for(const uint32_t v: vars) {
+                lits.push_back(Lit(v, mtrand() % 2));
+            }
+            add_long(lits, mtrand() % 3 == 0);
+        }
+    }
+
+    void add_long(const vector<Lit>& lits, const bool to_free)
+    {
+        Clause* c = s->add_clause_int(lits);
+        ASSERT_TRUE(c != NULL);
+        last_offs = s->cl_alloc.get_offset(c);
+        if (to_free) {
+            s->detachClause(*c);
+            s->cl_alloc.clauseFree(c);
+        } else {
+            s->longIrredCls.push_back(last_offs);
+            expected.push_back(lits);
+        }
+    }
+
+    void check_clauses()
+    {
+        ASSERT_EQ(s->longIrredCls.size(), expected.size());
+        std::multiset<vector<Lit> > want;
+        for(vector<Lit> lits: expected) {
+            std::sort(lits.begin(), lits.end());
+            want.insert(lits);
+        }
+        std::set<std::pair<uint32_t, ClOffset> > watched;
+        for(uint32_t i = 0; i < s->nVars()*2; i++) {
+            for(const Watched& w: s->watches[Lit::toLit(i)]) {
+                if (w.isClause()) {
+                    watched.insert(std::make_pair(i, w.get_offset()));
+                }
+            }
+        }
+        std::multiset<vector<Lit> > have;
+        for(const ClOffset offs: s->longIrredCls) {
+            const Clause& cl = *s->cl_alloc.ptr(offs);
+            vector<Lit> lits(cl.begin(), cl.end());
+            std::sort(lits.begin(), lits.end());
+            have.insert(lits);
+
+            //Both watches point to it
+            for(size_t i = 0; i < 2; i++) {
+                EXPECT_EQ(watched.count(std::make_pair(cl[i].toInt(), offs)), 1U);
+            }
+        }
+        EXPECT_TRUE(want == have);
+    }
+
+    SolverConf conf;
+    Solver* s = NULL;
+    std::atomic<bool> must_inter;
+    vector<vector<Lit> > expected;
+    uint64_t last_offs = 0;
+};
+
+//Crosses segments only with a small ARENA_SEG_BITS, the number of clauses
+//is capped so that it stays fast with the default
+TEST_F(clause_arena_solver, consolidate_in_place_across_segments)
+{
+    make_solver(3000);
+    add_clauses(ARENA_SEG_SLOTS + ARENA_SEG_SLOTS/2, 20000);
+    check_clauses();
+    const uint64_t before = s->cl_alloc.arena_size();
+    const uint64_t before_mem = s->cl_alloc.mem_used();
+
+    s->cl_alloc.consolidate(s, true);
+    check_clauses();
+    EXPECT_LT(s->cl_alloc.arena_size(), before);
+    EXPECT_LE(s->cl_alloc.mem_used(), before_mem);
+    EXPECT_EQ(s->solve_with_assumptions(NULL, false), l_True);
+}
+
+TEST_F(clause_arena_solver, consolidate_by_copy_across_segments)
+{
+    conf.consolidate_in_act_order = true;
+    make_solver(3000);
+    add_clauses(ARENA_SEG_SLOTS + ARENA_SEG_SLOTS/2, 20000);
+    s->cl_alloc.consolidate(s, true);
+    check_clauses();
+
+    s->cl_alloc.consolidate(s, true, false, true);
+    check_clauses();
+}
+
+TEST_F(clause_arena_solver, clause_longer_than_segment)
+{
+    const uint64_t lits_per_seg = ARENA_SEG_SLOTS*SLOT_BYTES/sizeof(Lit);
+    make_solver(1000);
+
+    vector<Lit> small = {Lit(0, false), Lit(1, false), Lit(2, true)};
+    add_long(small, true);
+    add_long(small, false);
+
+    //Whole segments of freed clauses before the huge one
+    while (last_offs < 3*ARENA_SEG_SLOTS) {
+        add_long(small, true);
+    }
+    //Repeats its variables, so it does not need millions of them. It's only
+    //moved around, never propagated or simplified
+    vector<Lit> huge;
+    for(uint32_t i = 0; i < lits_per_seg + 100; i++) {
+        huge.push_back(Lit(i % 1000, false));
+    }
+    Clause* hc = s->cl_alloc.Clause_new(huge, 0
+        #ifdef STATS_NEEDED
+        , 0
+        #endif
+    );
+    s->attachClause(*hc);
+    const ClOffset huge_offs = s->cl_alloc.get_offset(hc);
+    s->longIrredCls.push_back(huge_offs);
+    expected.push_back(huge);
+    add_long(small, true);
+    add_long(small, false);
+    check_clauses();
+    const uint64_t before = s->cl_alloc.mem_used();
+
+    //The empty segments are freed, the huge clause stays
+    s->cl_alloc.consolidate(s, true);
+    check_clauses();
+    EXPECT_LE(s->cl_alloc.mem_used() + 2*ARENA_SEG_SLOTS*SLOT_BYTES, before);
+
+    //Without the huge clause, the ones after it are moved past the holes
+    Clause* c = s->cl_alloc.ptr(huge_offs);
+    s->detachClause(*c);
+    s->cl_alloc.clauseFree(c);
+    s->longIrredCls.erase(std::find(s->longIrredCls.begin(), s->longIrredCls.end(), huge_offs));
+    expected.erase(std::find(expected.begin(), expected.end(), huge));
+    const uint64_t start = last_offs;
+    while (last_offs < start + ARENA_SEG_SLOTS) {
+        add_long(small, false);
+    }
+    s->cl_alloc.consolidate(s, true);
+    check_clauses();
+    EXPECT_EQ(s->solve_with_assumptions(NULL, false), l_True);
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
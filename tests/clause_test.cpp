@@ -42,12 +42,8 @@ struct F : public ::testing::Test {
         for(size_t i = 0; i < n ; i++) {
             lits.push_back(Lit(i, false));
         }
-        Clause* c_ptr = new(tmp) Clause(lits
-        , 0
-        #ifdef STATS_NEEDED
-        , 0
-        #endif
-        );
+        //Its stats are kept by the ClauseAllocator, not needed here
+        Clause* c_ptr = new(tmp) Clause(lits);
         return c_ptr;
     }
 };
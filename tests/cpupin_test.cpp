@@ -0,0 +1,158 @@
+/******************************************
+Copyright (c) 2016, Mate Soos
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+***********************************************/
+
+#include "gtest/gtest.h"
+
+#include <stdexcept>
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+#include "cryptominisat5/cryptominisat.h"
+#include "src/cpupin.h"
+#include "src/solverconf.h"
+
+using namespace CMSat;
+using std::vector;
+
+TEST(cpupin, empty_spec_pins_nothing)
+{
+    const vector<vector<int> > sets = cpu_sets_for_threads("", 3);
+    ASSERT_EQ(sets.size(), 3U);
+    for(const vector<int>& s: sets) {
+        EXPECT_TRUE(s.empty());
+    }
+    EXPECT_TRUE(pin_this_thread(sets[0]));
+}
+
+TEST(cpupin, unknown_spec_throws)
+{
+    EXPECT_THROW(cpu_sets_for_threads("bogus", 2), std::invalid_argument);
+    EXPECT_THROW(cpu_sets_for_threads("cpu:1", 2), std::invalid_argument);
+}
+
+#if defined(__linux__)
+TEST(cpupin, cpus_list_with_ranges)
+{
+    const vector<vector<int> > sets = cpu_sets_for_threads("cpus:0,2-3", 5);
+    ASSERT_EQ(sets.size(), 5U);
+    EXPECT_EQ(sets[0], vector<int>{0});
+    EXPECT_EQ(sets[1], vector<int>{2});
+    EXPECT_EQ(sets[2], vector<int>{3});
+    EXPECT_EQ(sets[3], vector<int>{0});
+    EXPECT_EQ(sets[4], vector<int>{2});
+}
+
+TEST(cpupin, bad_list_throws)
+{
+    EXPECT_THROW(cpu_sets_for_threads("cpus:0-x", 2), std::invalid_argument);
+    EXPECT_THROW(cpu_sets_for_threads("cpus:1,a", 2), std::invalid_argument);
+    EXPECT_THROW(cpu_sets_for_threads("cpus:-1", 2), std::invalid_argument);
+    EXPECT_THROW(cpu_sets_for_threads("cpus:99999999999", 2), std::invalid_argument);
+    EXPECT_THROW(cpu_sets_for_threads("nodes:0-", 2), std::invalid_argument);
+}
+
+TEST(cpupin, cpus_empty_list)
+{
+    const vector<vector<int> > sets = cpu_sets_for_threads("cpus:", 2);
+    ASSERT_EQ(sets.size(), 2U);
+    EXPECT_TRUE(sets[0].empty());
+    EXPECT_TRUE(sets[1].empty());
+}
+
+TEST(cpupin, cores_one_cpu_each)
+{
+    const vector<vector<int> > sets = cpu_sets_for_threads("cores", 4);
+    ASSERT_EQ(sets.size(), 4U);
+    for(const vector<int>& s: sets) {
+        EXPECT_EQ(s.size(), 1U);
+    }
+}
+
+TEST(cpupin, numa_covers_every_thread)
+{
+    const vector<vector<int> > sets = cpu_sets_for_threads("numa", 3);
+    ASSERT_EQ(sets.size(), 3U);
+    for(const vector<int>& s: sets) {
+        EXPECT_FALSE(s.empty());
+    }
+}
+
+static vector<int> my_cpus()
+{
+    vector<int> ret;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for(int i = 0; i < CPU_SETSIZE; i++) {
+            if (CPU_ISSET(i, &set)) {
+                ret.push_back(i);
+            }
+        }
+    }
+    return ret;
+}
+
+TEST(cpupin, scoped_pin_restores)
+{
+    const vector<int> before = my_cpus();
+    ASSERT_FALSE(before.empty());
+    EXPECT_EQ(this_thread_cpus(), before);
+    {
+        ScopedPin pin(vector<int>{before.back()});
+        EXPECT_TRUE(pin.pinned());
+        EXPECT_EQ(my_cpus(), vector<int>{before.back()});
+    }
+    EXPECT_EQ(my_cpus(), before);
+
+    //Nothing to pin to, nothing changes
+    {
+        ScopedPin pin(vector<int>{});
+        EXPECT_TRUE(pin.pinned());
+        EXPECT_EQ(my_cpus(), before);
+    }
+    EXPECT_EQ(my_cpus(), before);
+}
+
+//Thread 0 of the library runs on the caller's thread, which is pinned
+//only while the threads run
+TEST(cpupin, caller_gets_its_cpus_back)
+{
+    const vector<int> before = my_cpus();
+    SolverConf conf;
+    conf.pin_threads = "cores";
+    {
+        SATSolver s(&conf);
+        s.set_num_threads(3);
+        s.new_vars(3);
+        s.add_clause(vector<Lit>{Lit(0, false), Lit(1, false)});
+        s.add_clause(vector<Lit>{Lit(1, true), Lit(2, false)});
+        EXPECT_EQ(s.solve(), l_True);
+    }
+    EXPECT_EQ(my_cpus(), before);
+}
+#endif
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,125 @@
+/******************************************
+Copyright (c) 2016, Mate Soos
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+***********************************************/
+
+//Timings of the parsers on 1M clauses. Not run by ctest, run it by hand
+
+#include "dimacs_parse_helper.h"
+
+TEST_F(dimacs_parse, bench_parse_1M_clauses)
+{
+    write_cnf(100000, 1000000, false);
+    std::ifstream f(fname.c_str(), std::ios::binary | std::ios::ate);
+    const double mb = (double)f.tellg()/(1024.0*1024.0);
+
+    {
+        SATSolver s;
+        const double t = wall_time();
+        FILE* in = fopen(fname.c_str(), "rb");
+        DimacsParser<StreamBuffer<FILE*, FN> > serial(&s, NULL, 0);
+        ASSERT_TRUE(serial.parse_DIMACS(in, true));
+        fclose(in);
+        const double took = wall_time() - t;
+        cout << "c serial      T: " << took
+        << " MB/s: " << mb/took
+        << " clauses/s: " << 1e6/took
+        << endl;
+    }
+
+    for(unsigned threads: {1U, 2U, 4U, 8U}) {
+        SATSolver s;
+        const double t = wall_time();
+        ParallelDimacsParser parallel(&s, threads, 0);
+        ASSERT_TRUE(parallel.open(fname));
+        ASSERT_TRUE(parallel.parse_DIMACS(true));
+        const double took = wall_time() - t;
+        cout << "c threads: " << threads << " T: " << took
+        << " MB/s: " << mb/took
+        << " clauses/s: " << 1e6/took
+        << endl;
+        EXPECT_EQ(parallel.norm_clauses_added, 1000000U);
+    }
+}
+
+TEST_F(dimacs_parse, bench_binary_1M_clauses)
+{
+    const string bin = write_cnf_and_binary(100000, 1000000);
+    write_file(fname_z, bin);
+    const double mb = (double)bin.size()/(1024.0*1024.0);
+    cout << "c DIMACS size: " << read_file(fname).size()
+    << " binary size: " << bin.size() << endl;
+
+    SATSolver s;
+    const double t = wall_time();
+    BinaryCNFParser parser(&s, 0);
+    ASSERT_TRUE(parser.open(fname_z));
+    ASSERT_TRUE(parser.parse());
+    const double took = wall_time() - t;
+    cout << "c binary T: " << took
+    << " MB/s: " << mb/took
+    << " clauses/s: " << 1e6/took
+    << endl;
+    EXPECT_EQ(parser.norm_clauses_added, 1000000U);
+    std::remove(fname_z.c_str());
+}
+
+#ifdef USE_ZLIB
+//Decompression runs in the background, at the same time as parsing
+TEST_F(dimacs_parse, bench_bgzf_1M_clauses)
+{
+    write_cnf(100000, 1000000, false);
+    const string cnf = read_file(fname);
+    const double mb = (double)cnf.size()/(1024.0*1024.0);
+    write_file(fname_z, gzip(cnf, 65280, true));
+
+    for(unsigned threads: {1U, 2U, 4U}) {
+        for(int parse = 0; parse < 2; parse++) {
+            SATSolver s;
+            const double t = wall_time();
+            FILE* in = fopen(fname_z.c_str(), "rb");
+            {
+                BackgroundReader reader(in, threads);
+                if (parse) {
+                    DimacsParser<StreamBuffer<BackgroundReader*, BG> > parser(&s, NULL, 0);
+                    ASSERT_TRUE(parser.parse_DIMACS(&reader, true));
+                } else {
+                    vector<char> buf(1 << 20);
+                    while (reader.read(buf.data(), buf.size()) > 0) {
+                    }
+                }
+            }
+            fclose(in);
+            const double took = wall_time() - t;
+            cout << "c threads: " << threads
+            << (parse ? " decompress+parse" : " decompress only")
+            << " T: " << took
+            << " MB/s: " << mb/took
+            << endl;
+        }
+    }
+    std::remove(fname_z.c_str());
+}
+#endif
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,370 @@
+/******************************************
+Copyright (c) 2016, Mate Soos
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+***********************************************/
+
+#ifndef DIMACS_PARSE_HELPER_H
+#define DIMACS_PARSE_HELPER_H
+
+#include "gtest/gtest.h"
+
+#include <fstream>
+#include <sstream>
+#include <random>
+#include <algorithm>
+#include <chrono>
+#include <stdio.h>
+
+#include "cryptominisat5/cryptominisat.h"
+#include "src/solverconf.h"
+#include "src/dimacsparser.h"
+#include "src/paralleldimacsparser.h"
+#include "src/backgroundreader.h"
+#include "src/binarycnf.h"
+#include "src/binarycnfparser.h"
+#include "src/compressedostream.h"
+using namespace CMSat;
+using std::string;
+
+//Fixture of dimacs_parse_test and dimacs_parse_bench
+struct dimacs_parse : public ::testing::Test {
+    ~dimacs_parse()
+    {
+        std::remove(fname.c_str());
+        std::remove(log_serial.c_str());
+        std::remove(log_parallel.c_str());
+    }
+
+    //Random CNF with the odd bits DIMACS allows: comments, clauses over more
+    //lines, XORs, independent set, CRLF line ends
+    void write_cnf(const uint32_t num_vars, const uint32_t num_cls, const bool extras)
+    {
+        std::ofstream f(fname.c_str());
+        f << "c generated" << endl;
+        f << "p cnf " << num_vars << " " << num_cls << endl;
+        if (extras) {
+            f << "c ind 1 2 3 0" << endl;
+        }
+        for(uint32_t i = 0; i < num_cls; i++) {
+            const uint32_t sz = 1 + mtrand() % 8;
+            const bool is_xor = extras && mtrand() % 20 == 0;
+            if (is_xor) {
+                f << "x";
+            }
+            for(uint32_t j = 0; j < sz; j++) {
+                const int32_t var = 1 + mtrand() % num_vars;
+                f << ((mtrand() % 2) ? "-" : "") << var << " ";
+                if (extras && !is_xor && mtrand() % 30 == 0) {
+                    f << "\n";
+                }
+            }
+            f << "0" << ((extras && mtrand() % 10 == 0) ? " \r\n" : "\n");
+            if (extras && mtrand() % 50 == 0) {
+                f << "c comment " << i << " 0" << endl;
+            }
+        }
+    }
+
+    vector<string> sorted_lines(const string& log) const
+    {
+        std::ifstream f(log.c_str());
+        vector<string> lines;
+        string line;
+        while (std::getline(f, line)) {
+            lines.push_back(line);
+        }
+        std::sort(lines.begin(), lines.end());
+        return lines;
+    }
+
+    //The clauses in "log", the binary format sorts their literals
+    vector<string> sorted_clauses(const string& log) const
+    {
+        vector<string> ret;
+        for(const string& line: sorted_lines(log)) {
+            if (line.empty() || line[0] == 'c') {
+                continue;
+            }
+            std::stringstream ss(line);
+            vector<int> lits;
+            int lit;
+            while (ss >> lit && lit != 0) {
+                lits.push_back(lit);
+            }
+            std::sort(lits.begin(), lits.end());
+            string cl;
+            for(const int l: lits) {
+                cl += std::to_string(l) + " ";
+            }
+            ret.push_back(cl);
+        }
+        std::sort(ret.begin(), ret.end());
+        return ret;
+    }
+
+    void check_same(const unsigned threads, const size_t chunk_bytes)
+    {
+        SATSolver s1;
+        s1.log_to_file(log_serial);
+        FILE* in = fopen(fname.c_str(), "rb");
+        ASSERT_TRUE(in != NULL);
+        DimacsParser<StreamBuffer<FILE*, FN> > serial(&s1, NULL, 0);
+        ASSERT_TRUE(serial.parse_DIMACS(in, true));
+        fclose(in);
+
+        SATSolver s2;
+        s2.log_to_file(log_parallel);
+        ParallelDimacsParser parallel(&s2, threads, 0);
+        parallel.min_chunk_bytes = chunk_bytes;
+        ASSERT_TRUE(parallel.open(fname));
+        ASSERT_TRUE(parallel.parse_DIMACS(true));
+        EXPECT_GT(parallel.num_chunks, 1U);
+
+        EXPECT_EQ(s1.nVars(), s2.nVars());
+        EXPECT_EQ(serial.independent_vars, parallel.independent_vars);
+
+        //Only the order of XORs vs clauses may differ
+        EXPECT_EQ(sorted_lines(log_serial), sorted_lines(log_parallel));
+    }
+
+    string read_file(const string& f) const
+    {
+        std::ifstream in(f.c_str(), std::ios::binary);
+        return string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+    void write_file(const string& f, const string& data) const
+    {
+        std::ofstream out(f.c_str(), std::ios::binary);
+        out << data;
+    }
+
+    //Parses "compressed" through BackgroundReader, which must give the same
+    //as parsing the plain CNF
+    void check_compressed(const string& compressed, const unsigned threads)
+    {
+        SATSolver s1;
+        s1.log_to_file(log_serial);
+        FILE* in = fopen(fname.c_str(), "rb");
+        DimacsParser<StreamBuffer<FILE*, FN> > serial(&s1, NULL, 0);
+        ASSERT_TRUE(serial.parse_DIMACS(in, true));
+        fclose(in);
+
+        write_file(fname_z, compressed);
+        SATSolver s2;
+        s2.log_to_file(log_parallel);
+        in = fopen(fname_z.c_str(), "rb");
+        {
+            BackgroundReader reader(in, threads);
+            DimacsParser<StreamBuffer<BackgroundReader*, BG> > parser(&s2, NULL, 0);
+            EXPECT_TRUE(parser.parse_DIMACS(&reader, true));
+        }
+        fclose(in);
+        std::remove(fname_z.c_str());
+
+        EXPECT_EQ(read_file(log_serial), read_file(log_parallel));
+    }
+
+    void parse_through_reader(const string& f, const unsigned threads)
+    {
+        SATSolver s;
+        FILE* in = fopen(f.c_str(), "rb");
+        BackgroundReader reader(in, threads);
+        DimacsParser<StreamBuffer<BackgroundReader*, BG> > parser(&s, NULL, 0);
+        parser.parse_DIMACS(&reader, false);
+    }
+
+    #ifdef USE_ZLIB
+    //Gzip made of members of "member_len" bytes each, BGZF if "bgzf" is set
+    string gzip(const string& data, const size_t member_len, const bool bgzf) const
+    {
+        string out;
+        for(size_t at = 0; at <= data.size(); at += member_len) {
+            const size_t len = std::min(member_len, data.size() - at);
+            string comp(compressBound(len) + 64, 0);
+            z_stream s;
+            memset(&s, 0, sizeof(s));
+            deflateInit2(&s, 6, Z_DEFLATED, bgzf ? -15 : 15+16, 8, Z_DEFAULT_STRATEGY);
+            s.next_in = (Bytef*)data.data() + at;
+            s.avail_in = len;
+            s.next_out = (Bytef*)&comp[0];
+            s.avail_out = comp.size();
+            deflate(&s, Z_FINISH);
+            comp.resize(s.total_out);
+            deflateEnd(&s);
+
+            if (bgzf) {
+                const size_t bsize = 18 + comp.size() + 8 - 1;
+                const uint32_t crc = crc32(crc32(0, Z_NULL, 0), (const Bytef*)data.data() + at, len);
+                const char hdr[18] = {
+                    0x1f, (char)0x8b, 8, 4, 0, 0, 0, 0, 0, (char)0xff, 6, 0
+                    , 'B', 'C', 2, 0, (char)(bsize & 0xff), (char)(bsize >> 8)};
+                out.append(hdr, 18);
+                out += comp;
+                for(uint32_t x: {crc, (uint32_t)len}) {
+                    for(int i = 0; i < 4; i++) {
+                        out.push_back((char)(x >> (8*i)));
+                    }
+                }
+            } else {
+                out += comp;
+            }
+            if (len == 0) {
+                break;
+            }
+        }
+        return out;
+    }
+    #endif
+
+    #ifdef USE_LZMA
+    string xz(const string& data) const
+    {
+        string out(lzma_stream_buffer_bound(data.size()), 0);
+        size_t out_pos = 0;
+        lzma_easy_buffer_encode(6, LZMA_CHECK_CRC64, NULL
+            , (const uint8_t*)data.data(), data.size()
+            , (uint8_t*)&out[0], &out_pos, out.size());
+        out.resize(out_pos);
+        return out;
+    }
+    #endif
+
+    #ifdef USE_ZSTD
+    string zstd(const string& data) const
+    {
+        string out(ZSTD_compressBound(data.size()), 0);
+        out.resize(ZSTD_compress(&out[0], out.size(), data.data(), data.size(), 3));
+        return out;
+    }
+    #endif
+
+    //Random CNF written both as DIMACS (to "fname") and in the binary
+    //format. Literals are sorted, as the binary format sorts them.
+    string write_cnf_and_binary(const uint32_t num_vars, const uint32_t num_cls)
+    {
+        std::ofstream f(fname.c_str());
+        std::stringstream bin;
+        BinaryCNFWriter writer(&bin);
+        const uint32_t num_xors = num_cls/20;
+        const vector<uint32_t> indep = {0, 4, 9};
+        writer.header(num_vars, num_cls, num_xors, indep.size());
+
+        f << "p cnf " << num_vars << " " << num_cls << endl;
+        f << "c ind 1 5 10 0" << endl;
+        vector<Lit> lits;
+        for(uint32_t i = 0; i < num_cls; i++) {
+            lits.clear();
+            const uint32_t sz = 1 + mtrand() % 8;
+            for(uint32_t j = 0; j < sz; j++) {
+                lits.push_back(Lit(mtrand() % num_vars, mtrand() % 2));
+            }
+            std::sort(lits.begin(), lits.end());
+            for(const Lit l: lits) {
+                f << l << " ";
+            }
+            f << "0" << endl;
+            writer.clause(lits);
+        }
+
+        vector<uint32_t> vars;
+        for(uint32_t i = 0; i < num_xors; i++) {
+            vars.clear();
+            for(uint32_t v = 0; v < num_vars && vars.size() < 5; v += 1 + mtrand() % 7) {
+                vars.push_back(v);
+            }
+            const bool rhs = mtrand() % 2;
+            f << "x" << (rhs ? "" : "-");
+            for(const uint32_t v: vars) {
+                f << v+1 << " ";
+            }
+            f << "0" << endl;
+            writer.xor_clause(vars, rhs);
+        }
+        writer.independent_vars(indep);
+        writer.flush();
+        return bin.str();
+    }
+
+    //Parses the binary CNF "bin" from a file and through BackgroundReader,
+    //both must give the same as parsing the DIMACS CNF
+    void check_binary(const string& bin, const string& stored)
+    {
+        SATSolver s1;
+        s1.log_to_file(log_serial);
+        FILE* in = fopen(fname.c_str(), "rb");
+        DimacsParser<StreamBuffer<FILE*, FN> > dimacs(&s1, NULL, 0);
+        ASSERT_TRUE(dimacs.parse_DIMACS(in, true));
+        fclose(in);
+
+        write_file(fname_z, stored);
+        for(int from_reader = 0; from_reader < 2; from_reader++) {
+            SATSolver s2;
+            s2.log_to_file(log_parallel);
+            BinaryCNFParser parser(&s2, 0);
+            parser.batch_lits = 1000;
+            if (from_reader) {
+                in = fopen(fname_z.c_str(), "rb");
+                {
+                    BackgroundReader reader(in, 1);
+                    EXPECT_TRUE(reader.starts_with(binary_cnf_magic, sizeof(binary_cnf_magic)));
+                    EXPECT_TRUE(parser.parse(&reader));
+                }
+                fclose(in);
+            } else {
+                if (stored != bin) {
+                    EXPECT_FALSE(parser.open(fname_z));
+                    continue;
+                }
+                ASSERT_TRUE(parser.open(fname_z));
+                EXPECT_TRUE(parser.parse());
+            }
+            EXPECT_EQ(s1.nVars(), s2.nVars());
+            EXPECT_EQ(dimacs.independent_vars, parser.independent_vars);
+            EXPECT_EQ(read_file(log_serial), read_file(log_parallel));
+        }
+        std::remove(fname_z.c_str());
+    }
+
+    bool parse_binary(const string& bin)
+    {
+        write_file(fname_z, bin);
+        SATSolver s;
+        BinaryCNFParser parser(&s, 0);
+        const bool ret = parser.open(fname_z) && parser.parse();
+        std::remove(fname_z.c_str());
+        return ret;
+    }
+
+    //Wall clock, as the parallel parser uses many cores
+    double wall_time() const
+    {
+        return std::chrono::duration<double>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    const string fname = "dimacs_parse_test.cnf";
+    const string fname_z = "dimacs_parse_test.cnf.z";
+    const string log_serial = "dimacs_parse_test_serial.log";
+    const string log_parallel = "dimacs_parse_test_parallel.log";
+    std::mt19937 mtrand{1};
+};
+
+#endif //DIMACS_PARSE_HELPER_H
@@ -0,0 +1,369 @@
+/******************************************
+Copyright (c) 2016, Mate Soos
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+***********************************************/
+
+#include "dimacs_parse_helper.h"
+
+TEST_F(dimacs_parse, same_as_serial)
+{
+    for(uint32_t i = 0; i < 10; i++) {
+        write_cnf(50 + mtrand() % 200, 500 + mtrand() % 2000, true);
+        check_same(1 + i % 4, 256);
+    }
+}
+
+TEST_F(dimacs_parse, same_as_serial_plain)
+{
+    write_cnf(1000, 20000, false);
+    check_same(4, 4096);
+}
+
+TEST_F(dimacs_parse, same_result_multithreaded_solver)
+{
+    for(uint32_t i = 0; i < 5; i++) {
+        write_cnf(60, 250, true);
+
+        SATSolver s1;
+        FILE* in = fopen(fname.c_str(), "rb");
+        DimacsParser<StreamBuffer<FILE*, FN> > serial(&s1, NULL, 0);
+        ASSERT_TRUE(serial.parse_DIMACS(in, false));
+        fclose(in);
+
+        SATSolver s2;
+        s2.set_num_threads(2);
+        ParallelDimacsParser parallel(&s2, 3, 0);
+        parallel.min_chunk_bytes = 128;
+        ASSERT_TRUE(parallel.open(fname));
+        ASSERT_TRUE(parallel.parse_DIMACS(false));
+
+        EXPECT_EQ(s1.solve(), s2.solve());
+    }
+}
+
+TEST_F(dimacs_parse, error_in_late_chunk)
+{
+    write_cnf(100, 1000, false);
+    {
+        std::ofstream f(fname.c_str(), std::ios::app);
+        f << "1 2 a 0" << endl;
+    }
+    SATSolver s;
+    ParallelDimacsParser parallel(&s, 4, 0);
+    parallel.min_chunk_bytes = 256;
+    ASSERT_TRUE(parallel.open(fname));
+    EXPECT_FALSE(parallel.parse_DIMACS(false));
+}
+
+TEST_F(dimacs_parse, var_above_header)
+{
+    {
+        std::ofstream f(fname.c_str());
+        f << "p cnf 3 2" << endl << "1 2 0" << endl << "-3 4 0" << endl;
+    }
+    SATSolver s;
+    ParallelDimacsParser strict(&s, 2, 0);
+    ASSERT_TRUE(strict.open(fname));
+    EXPECT_FALSE(strict.parse_DIMACS(true));
+
+    SATSolver s2;
+    ParallelDimacsParser relaxed(&s2, 2, 0);
+    ASSERT_TRUE(relaxed.open(fname));
+    EXPECT_TRUE(relaxed.parse_DIMACS(false));
+    EXPECT_EQ(s2.nVars(), 4U);
+}
+
+TEST_F(dimacs_parse, compressed_is_refused)
+{
+    {
+        std::ofstream f(fname.c_str(), std::ios::binary);
+        f << (char)0x1f << (char)0x8b << "rest";
+    }
+    SATSolver s;
+    ParallelDimacsParser parallel(&s, 2, 0);
+    EXPECT_FALSE(parallel.open(fname));
+}
+
+TEST_F(dimacs_parse, background_plain)
+{
+    write_cnf(300, 3000, true);
+    check_compressed(read_file(fname), 1);
+}
+
+#ifdef USE_ZLIB
+TEST_F(dimacs_parse, background_gzip_many_members)
+{
+    write_cnf(300, 3000, true);
+    const string cnf = read_file(fname);
+    check_compressed(gzip(cnf, cnf.size(), false), 1);
+    check_compressed(gzip(cnf, 1000, false), 1);
+}
+
+TEST_F(dimacs_parse, background_bgzf)
+{
+    write_cnf(300, 20000, true);
+    const string cnf = read_file(fname);
+    for(unsigned threads: {1U, 3U}) {
+        check_compressed(gzip(cnf, 5000, true), threads);
+        check_compressed(gzip(cnf, 65280, true), threads);
+    }
+}
+
+TEST_F(dimacs_parse, background_gzip_corrupt_first_member)
+{
+    write_cnf(300, 3000, false);
+    for(const size_t member_len: {(size_t)1000000, (size_t)1000}) {
+        string gz = gzip(read_file(fname), member_len, false);
+        for(size_t i = 40; i < 60; i++) {
+            gz[i] ^= 0x55;
+        }
+        write_file(fname_z, gz);
+        EXPECT_EXIT(parse_through_reader(fname_z, 1)
+            , ::testing::ExitedWithCode(255), "Could not read input");
+    }
+    std::remove(fname_z.c_str());
+}
+
+TEST_F(dimacs_parse, background_truncated)
+{
+    write_cnf(300, 20000, false);
+    const string bgzf = gzip(read_file(fname), 5000, true);
+    write_file(fname_z, bgzf.substr(0, bgzf.size()/2));
+    EXPECT_EXIT(parse_through_reader(fname_z, 2)
+        , ::testing::ExitedWithCode(255), "Could not read input");
+    std::remove(fname_z.c_str());
+}
+
+TEST_F(dimacs_parse, bgzf_bad_member_size)
+{
+    write_cnf(300, 3000, false);
+    const string bgzf = gzip(read_file(fname), 5000, true);
+    const size_t sz = BgzfInput::member_size(bgzf.data(), bgzf.size());
+    ASSERT_GT(sz, 26U);
+    EXPECT_EQ(BgzfInput::member_size(bgzf.data(), sz), sz);
+    EXPECT_EQ(BgzfInput::member_size(bgzf.data(), sz-1), 0U);
+    EXPECT_EQ(BgzfInput::member_size(bgzf.data(), 20), 0U);
+
+    //XLEN past the end of the member
+    string bad = bgzf;
+    bad[10] = (char)0xff;
+    bad[11] = (char)0x7f;
+    EXPECT_EQ(BgzfInput::member_size(bad.data(), bad.size()), 0U);
+
+    //BSIZE too small for the header and the trailer
+    bad = bgzf;
+    bad[16] = 20;
+    bad[17] = 0;
+    EXPECT_EQ(BgzfInput::member_size(bad.data(), bad.size()), 0U);
+
+    //ISIZE over the 64KB a block can inflate to
+    bad = bgzf;
+    bad[sz - 2] = 1;
+    EXPECT_EQ(BgzfInput::member_size(bad.data(), bad.size()), 0U);
+
+    //The same in the second member, where it's found by the reader
+    bad = bgzf;
+    bad[sz + 10] = (char)0xff;
+    bad[sz + 11] = (char)0x7f;
+    write_file(fname_z, bad);
+    EXPECT_EXIT(parse_through_reader(fname_z, 2)
+        , ::testing::ExitedWithCode(255), "Could not read input");
+
+    bad = bgzf;
+    const size_t sz2 = BgzfInput::member_size(bgzf.data() + sz, bgzf.size() - sz);
+    ASSERT_GT(sz2, 0U);
+    for(size_t i = sz + sz2 - 4; i < sz + sz2; i++) {
+        bad[i] = (char)0xff;
+    }
+    write_file(fname_z, bad);
+    EXPECT_EXIT(parse_through_reader(fname_z, 2)
+        , ::testing::ExitedWithCode(255), "Could not read input");
+
+    //Truncated in the header of the second member
+    write_file(fname_z, bgzf.substr(0, sz + 14));
+    EXPECT_EXIT(parse_through_reader(fname_z, 2)
+        , ::testing::ExitedWithCode(255), "Could not read input");
+    std::remove(fname_z.c_str());
+}
+#endif
+
+#ifdef USE_LZMA
+TEST_F(dimacs_parse, background_xz)
+{
+    write_cnf(300, 3000, true);
+    const string cnf = read_file(fname);
+    check_compressed(xz(cnf) + xz(cnf.substr(0, 0)), 1);
+}
+#endif
+
+#ifdef USE_ZSTD
+TEST_F(dimacs_parse, background_zstd)
+{
+    write_cnf(300, 3000, true);
+    check_compressed(zstd(read_file(fname)), 1);
+}
+#endif
+
+TEST_F(dimacs_parse, binary_same_as_dimacs)
+{
+    const string bin = write_cnf_and_binary(300, 5000);
+    EXPECT_LT(bin.size(), read_file(fname).size()/2);
+    check_binary(bin, bin);
+    #ifdef USE_ZLIB
+    check_binary(bin, gzip(bin, 1000, false));
+    #endif
+}
+
+TEST_F(dimacs_parse, binary_unsat)
+{
+    std::stringstream ss;
+    BinaryCNFWriter writer(&ss);
+    writer.header(2, 2, 0, 0);
+    const Lit l = Lit(1, false);
+    writer.clause(&l, 1);
+    writer.clause(NULL, 0);
+    writer.flush();
+
+    write_file(fname_z, ss.str());
+    SATSolver s;
+    BinaryCNFParser parser(&s, 0);
+    ASSERT_TRUE(parser.open(fname_z));
+    EXPECT_TRUE(parser.parse());
+    EXPECT_EQ(parser.norm_clauses_added, 2U);
+    EXPECT_EQ(s.solve(), l_False);
+    std::remove(fname_z.c_str());
+}
+
+TEST_F(dimacs_parse, binary_errors)
+{
+    const string bin = write_cnf_and_binary(300, 500);
+    EXPECT_TRUE(parse_binary(bin));
+    EXPECT_FALSE(parse_binary(bin.substr(0, bin.size()/2)));
+    EXPECT_FALSE(parse_binary(bin + "x"));
+
+    //Literal of var 3 in a CNF of 2 vars
+    std::stringstream ss;
+    BinaryCNFWriter writer(&ss);
+    writer.header(2, 1, 0, 0);
+    const Lit l = Lit(2, true);
+    writer.clause(&l, 1);
+    writer.flush();
+    EXPECT_FALSE(parse_binary(ss.str()));
+
+    //Not binary at all
+    SATSolver s;
+    BinaryCNFParser parser(&s, 0);
+    EXPECT_FALSE(parser.open(fname));
+}
+
+//The simplified CNF of '--preproc 1' must be the same in both formats,
+//independent set included
+TEST_F(dimacs_parse, preproc_dump_text_and_binary)
+{
+    vector<uint32_t> indep;
+    for(uint32_t i = 0; i < 50; i++) {
+        indep.push_back(i*3);
+    }
+
+    vector<uint32_t> indep_read[2];
+    const string logs[2] = {log_serial, log_parallel};
+    for(int binary = 0; binary < 2; binary++) {
+        {
+            SolverConf conf;
+            conf.verbosity = 0;
+            conf.preprocess = 1;
+            conf.simplify_at_startup = 1;
+            conf.doCompHandler = false;
+            conf.simplified_cnf = fname_z;
+            conf.simplified_cnf_binary = binary;
+            conf.saved_state_file = fname;
+            SATSolver s(&conf);
+            s.new_vars(300);
+            s.set_independent_vars(&indep);
+
+            //Same CNF both times, with some equivalent literals
+            mtrand.seed(1);
+            for(uint32_t i = 0; i < 900; i++) {
+                vector<Lit> cl;
+                for(uint32_t j = 0; j < 3; j++) {
+                    cl.push_back(Lit(mtrand() % 300, mtrand() % 2));
+                }
+                s.add_clause(cl);
+            }
+            for(uint32_t i = 0; i < 10; i++) {
+                s.add_clause({Lit(i*7, false), Lit(i*7+1, true)});
+                s.add_clause({Lit(i*7, true), Lit(i*7+1, false)});
+            }
+            EXPECT_EQ(s.solve(), l_Undef);
+        }
+
+        SATSolver s2;
+        s2.log_to_file(logs[binary]);
+        if (binary) {
+            BinaryCNFParser parser(&s2, 0);
+            ASSERT_TRUE(parser.open(fname_z));
+            ASSERT_TRUE(parser.parse());
+            indep_read[binary] = parser.independent_vars;
+        } else {
+            FILE* in = fopen(fname_z.c_str(), "rb");
+            ASSERT_TRUE(in != NULL);
+            DimacsParser<StreamBuffer<FILE*, FN> > parser(&s2, NULL, 0);
+            ASSERT_TRUE(parser.parse_DIMACS(in, true));
+            fclose(in);
+            indep_read[binary] = parser.independent_vars;
+        }
+        EXPECT_EQ(s2.solve(), l_True);
+        std::remove(fname_z.c_str());
+    }
+
+    EXPECT_FALSE(indep_read[0].empty());
+    EXPECT_LE(indep_read[0].size(), indep.size());
+    EXPECT_EQ(indep_read[0], indep_read[1]);
+    EXPECT_EQ(sorted_clauses(log_serial), sorted_clauses(log_parallel));
+}
+
+//What CompressedOStream writes, BackgroundReader must read back
+TEST_F(dimacs_parse, compressed_ostream_round_trip)
+{
+    write_cnf(300, 30000, true);
+    const string cnf = read_file(fname);
+    for(const string format: {"gzip", "zstd", "xz"}) {
+        if (!CompressedOStream::supported(format)) {
+            continue;
+        }
+        {
+            CompressedOStream out(new std::ofstream(fname_z.c_str(), std::ios::binary), format);
+            out.write(cnf.data(), 1000);
+            for(size_t at = 1000; at < cnf.size()/2; at++) {
+                out << cnf[at];
+            }
+            out.write(cnf.data() + cnf.size()/2, cnf.size() - cnf.size()/2);
+            EXPECT_TRUE(out.good());
+        }
+        const string compressed = read_file(fname_z);
+        EXPECT_LT(compressed.size(), cnf.size()/2);
+        check_compressed(compressed, 1);
+    }
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
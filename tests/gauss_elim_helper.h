@@ -0,0 +1,147 @@
+/******************************************
+Copyright (c) 2016, Mate Soos
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+***********************************************/
+
+#ifndef GAUSS_ELIM_HELPER_H
+#define GAUSS_ELIM_HELPER_H
+
+#include "gtest/gtest.h"
+
+#include <random>
+#include <algorithm>
+
+#include "src/solver.h"
+#include "src/EGaussian.h"
+#include "src/solverconf.h"
+#include "src/time_mem.h"
+using namespace CMSat;
+#include "test_helper.h"
+
+//Gives access to the two elimination methods
+struct EGaussianTester : public EGaussian {
+    EGaussianTester(Solver* s, const vector<Xor>& xs) :
+        EGaussian(s, s->conf.gaussconf, 0, xs)
+    {}
+
+    double fill_and_eliminate(const bool m4r)
+    {
+        fill_matrix(matrix);
+        const double t = cpuTime();
+        if (m4r) {
+            eliminate_m4r(matrix);
+        } else {
+            eliminate_plain(matrix);
+        }
+        return cpuTime() - t;
+    }
+
+    bool same_as(const EGaussianTester& other) const
+    {
+        if (matrix.num_rows != other.matrix.num_rows
+            || matrix.num_cols != other.matrix.num_cols
+        ) {
+            return false;
+        }
+        for(uint32_t i = 0; i < matrix.num_rows; i++) {
+            if (matrix.matrix.getMatrixAt(i) != other.matrix.matrix.getMatrixAt(i)) {
+                return false;
+            }
+        }
+        for(uint32_t i = 0; i < GasVar_state.size(); i++) {
+            if (GasVar_state[i] != other.GasVar_state[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+struct gauss_elim : public ::testing::Test {
+    gauss_elim()
+    {
+        must_inter.store(false, std::memory_order_relaxed);
+        SolverConf conf;
+        s = new Solver(&conf, &must_inter);
+        s->new_vars(num_vars);
+    }
+    ~gauss_elim()
+    {
+        delete s;
+    }
+
+    //Runs both and checks they agree. Prints how long they took if "name"
+    //is given
+    void check_both(const string& name = string())
+    {
+        EGaussianTester plain(s, xs);
+        EGaussianTester m4r(s, xs);
+        const double t_plain = plain.fill_and_eliminate(false);
+        const double t_m4r = m4r.fill_and_eliminate(true);
+        if (!name.empty()) {
+            cout << "c " << name << " rows: " << xs.size()
+            << " plain T: " << t_plain
+            << " m4r T: " << t_m4r
+            << endl;
+        }
+        EXPECT_TRUE(plain.same_as(m4r));
+    }
+
+    void random_xors(
+        const uint32_t num_xors
+        , const uint32_t num_cols
+        , const uint32_t min_sz
+        , const uint32_t max_sz
+    ) {
+        vector<uint32_t> vars;
+        for(uint32_t i = 0; i < num_cols; i++) {
+            vars.push_back(i);
+        }
+        for(uint32_t i = 0; i < num_xors; i++) {
+            std::shuffle(vars.begin(), vars.end(), mtrand);
+            const uint32_t sz = min_sz + mtrand() % (max_sz - min_sz + 1);
+            xs.push_back(Xor(vector<uint32_t>(vars.begin(), vars.begin() + sz), mtrand() % 2));
+            xs.back().sort();
+        }
+    }
+
+    //Shift-register, like the ones in stream ciphers
+    void lfsr_xors(const uint32_t num_cols)
+    {
+        const uint32_t state = 128;
+        for(uint32_t t = 0; t + state < num_cols; t++) {
+            xs.push_back(Xor(str_to_vars(
+                std::to_string(t+1) + ", "
+                + std::to_string(t+8) + ", "
+                + std::to_string(t+39) + ", "
+                + std::to_string(t+71) + ", "
+                + std::to_string(t+state+1)
+            ), mtrand() % 2));
+        }
+    }
+
+    const uint32_t num_vars = 6000;
+    Solver* s;
+    std::atomic<bool> must_inter;
+    std::mt19937 mtrand{1};
+    vector<Xor> xs;
+};
+
+#endif //GAUSS_ELIM_HELPER_H
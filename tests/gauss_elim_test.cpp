@@ -0,0 +1,188 @@
+/******************************************
+Copyright (c) 2016, Mate Soos
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+***********************************************/
+
+#include "gauss_elim_helper.h"
+
+TEST_F(gauss_elim, small_by_hand)
+{
+    xs = str_to_xors("1, 2, 3 = 0; 1, 2, 3, 4 = 1; 2, 5, 9 = 1; 1, 9 = 0; 3, 4, 5, 9 = 1");
+    check_both();
+}
+
+TEST_F(gauss_elim, random_sparse)
+{
+    for(uint32_t i = 0; i < 20; i++) {
+        xs.clear();
+        random_xors(10 + mtrand() % 200, 10 + mtrand() % 300, 2, 8);
+        check_both();
+    }
+}
+
+TEST_F(gauss_elim, random_dense_more_rows_than_cols)
+{
+    for(uint32_t i = 0; i < 20; i++) {
+        xs.clear();
+        const uint32_t cols = 5 + mtrand() % 100;
+        random_xors(cols + mtrand() % 50, cols, cols/3+1, cols/2+1);
+        check_both();
+    }
+}
+
+//Rows that are sums of others, so some become zero
+TEST_F(gauss_elim, dependent_rows)
+{
+    random_xors(300, 400, 3, 6);
+    for(uint32_t i = 0; i < 100; i++) {
+        const Xor& x = xs[mtrand() % xs.size()];
+        const Xor& y = xs[mtrand() % xs.size()];
+        vector<uint32_t> sum;
+        std::set_symmetric_difference(
+            x.begin(), x.end(), y.begin(), y.end(), std::back_inserter(sum));
+        if (!sum.empty()) {
+            xs.push_back(Xor(sum, x.rhs ^ y.rhs ^ (i % 7 == 0)));
+        }
+    }
+    check_both();
+}
+
+TEST_F(gauss_elim, lfsr)
+{
+    lfsr_xors(600);
+    check_both();
+}
+
+//Matrixes kept from the last search must seed the next one, and give the
+//same results as a matrix built from scratch
+struct gauss_reuse : public ::testing::Test {
+    gauss_reuse()
+    {
+        must_inter.store(false, std::memory_order_relaxed);
+        SolverConf conf;
+        //So no variable of the XORs is eliminated
+        conf.do_simplify_problem = false;
+        conf.gaussconf.autodisable = false;
+        s = new Solver(&conf, &must_inter);
+        s->new_vars(num_vars);
+    }
+    ~gauss_reuse()
+    {
+        delete s;
+    }
+
+    void add_xors(const uint32_t num)
+    {
+        vector<uint32_t> vars;
+        for(uint32_t i = 0; i < num_vars; i++) {
+            vars.push_back(i);
+        }
+        for(uint32_t i = 0; i < num; i++) {
+            std::shuffle(vars.begin(), vars.end(), mtrand);
+            add_xor(vector<uint32_t>(vars.begin(), vars.begin() + 4), mtrand() % 2);
+        }
+    }
+
+    void add_xor(const vector<uint32_t>& vars, const bool rhs)
+    {
+        xs.push_back(Xor(vars, rhs));
+        s->add_xor_clause_outer(vars, rhs);
+    }
+
+    lbool solve()
+    {
+        return s->solve_with_assumptions(NULL, false);
+    }
+
+    void check_model() const
+    {
+        const vector<lbool>& model = s->get_model();
+        for(const Xor& x: xs) {
+            bool val = false;
+            for(const uint32_t v: x) {
+                val ^= (model[v] == l_True);
+            }
+            EXPECT_EQ(val, x.rhs);
+        }
+    }
+
+    const uint32_t num_vars = 60;
+    Solver* s;
+    std::atomic<bool> must_inter;
+    std::mt19937 mtrand{1};
+    vector<Xor> xs;
+};
+
+TEST_F(gauss_reuse, reused_after_new_xors)
+{
+    add_xors(30);
+    ASSERT_EQ(solve(), l_True);
+    check_model();
+    EXPECT_EQ(s->sum_initReused, 0U);
+    EXPECT_FALSE(s->gmatrixes_kept.empty());
+
+    add_xors(5);
+    ASSERT_EQ(solve(), l_True);
+    check_model();
+    EXPECT_EQ(s->sum_initReused, 1U);
+}
+
+TEST_F(gauss_reuse, reused_after_new_clauses)
+{
+    add_xors(30);
+    ASSERT_EQ(solve(), l_True);
+    check_model();
+
+    //Agrees with the model, so it stays SAT, but sets variables of the
+    //kept matrix
+    const vector<lbool> model = s->get_model();
+    for(uint32_t v = 0; v < 5; v++) {
+        s->add_clause_outer(vector<Lit>{Lit(v, model[v] == l_False)});
+    }
+    s->add_clause_outer(vector<Lit>{Lit(10, false), Lit(11, false)});
+    ASSERT_EQ(solve(), l_True);
+    check_model();
+    EXPECT_EQ(s->get_model()[0], model[0]);
+    EXPECT_EQ(s->sum_initReused, 1U);
+}
+
+TEST_F(gauss_reuse, reused_and_unsat)
+{
+    add_xors(30);
+    ASSERT_EQ(solve(), l_True);
+
+    //Sum of the first two XORs, with the rhs flipped
+    vector<uint32_t> sum;
+    Xor x = xs[0];
+    Xor y = xs[1];
+    x.sort();
+    y.sort();
+    std::set_symmetric_difference(
+        x.begin(), x.end(), y.begin(), y.end(), std::back_inserter(sum));
+    ASSERT_GT(sum.size(), 2U);
+    add_xor(sum, !(x.rhs ^ y.rhs));
+    EXPECT_EQ(solve(), l_False);
+    EXPECT_EQ(s->sum_initReused, 1U);
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,129 @@
+/******************************************
+Copyright (c) 2016, Mate Soos
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+***********************************************/
+
+#include "gtest/gtest.h"
+
+#include <cstdint>
+#include <cstring>
+
+#include "src/hugepagealloc.h"
+
+using namespace CMSat;
+
+static const size_t MB = 1024ULL*1024ULL;
+
+static void fill(char* ptr, const size_t bytes, const char seed)
+{
+    for(size_t i = 0; i < bytes; i += 4096) {
+        ptr[i] = (char)(seed + i/4096);
+    }
+    ptr[bytes-1] = seed;
+}
+
+static bool filled(const char* ptr, const size_t bytes, const char seed)
+{
+    for(size_t i = 0; i < bytes-1; i += 4096) {
+        if (ptr[i] != (char)(seed + i/4096)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool aligned_to_huge(const void* ptr)
+{
+    #ifdef USE_HUGEPAGES
+    return ((uintptr_t)ptr & (2*MB - 1)) == 0;
+    #else
+    (void)ptr;
+    return true;
+    #endif
+}
+
+TEST(hugepagealloc, alloc_and_free)
+{
+    for(const size_t bytes: {(size_t)100, 2*MB, 5*MB + 3}) {
+        char* ptr = (char*)huge_alloc(bytes);
+        ASSERT_TRUE(ptr != NULL);
+        EXPECT_TRUE(aligned_to_huge(ptr));
+        fill(ptr, bytes, 1);
+        EXPECT_TRUE(filled(ptr, bytes, 1));
+        huge_free(ptr, bytes);
+    }
+    huge_free(NULL, 0);
+}
+
+TEST(hugepagealloc, realloc_null_allocates)
+{
+    char* ptr = (char*)huge_realloc(NULL, 0, 3*MB);
+    ASSERT_TRUE(ptr != NULL);
+    EXPECT_TRUE(aligned_to_huge(ptr));
+    fill(ptr, 3*MB, 7);
+    huge_free(ptr, 3*MB);
+}
+
+TEST(hugepagealloc, realloc_grow_keeps_data)
+{
+    size_t bytes = 1*MB;
+    char* ptr = (char*)huge_alloc(bytes);
+    ASSERT_TRUE(ptr != NULL);
+    fill(ptr, bytes, 3);
+
+    //Something right after it, so growing in place may not be possible
+    char* blocker = (char*)huge_alloc(2*MB);
+    ASSERT_TRUE(blocker != NULL);
+    fill(blocker, 2*MB, 9);
+
+    for(const size_t new_bytes: {3*MB, 3*MB + 100, 17*MB}) {
+        ptr = (char*)huge_realloc(ptr, bytes, new_bytes);
+        ASSERT_TRUE(ptr != NULL);
+        EXPECT_TRUE(aligned_to_huge(ptr));
+        EXPECT_TRUE(filled(ptr, 1*MB, 3));
+        ptr[new_bytes-1] = 1;
+        bytes = new_bytes;
+    }
+    EXPECT_TRUE(filled(blocker, 2*MB, 9));
+    huge_free(blocker, 2*MB);
+    huge_free(ptr, bytes);
+}
+
+TEST(hugepagealloc, realloc_shrink_keeps_data)
+{
+    char* ptr = (char*)huge_alloc(9*MB);
+    ASSERT_TRUE(ptr != NULL);
+    fill(ptr, 9*MB, 5);
+    ptr = (char*)huge_realloc(ptr, 9*MB, 2*MB + 1);
+    ASSERT_TRUE(ptr != NULL);
+    EXPECT_TRUE(aligned_to_huge(ptr));
+    EXPECT_TRUE(filled(ptr, 2*MB, 5));
+    huge_free(ptr, 2*MB + 1);
+}
+
+TEST(hugepagealloc, numa_node)
+{
+    EXPECT_GE(current_numa_node(), -1);
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,144 @@
+/******************************************
+Copyright (c) 2016, Mate Soos
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+***********************************************/
+
+#include "gtest/gtest.h"
+
+#include <random>
+#include "src/packedrow.h"
+using namespace CMSat;
+
+//Every kernel must give the same result as the scalar one, including on
+//lengths that are not a multiple of the vector width
+struct row_kernels_test : public ::testing::Test {
+    row_kernels_test() :
+        kernels(supported_row_kernels())
+        , mtrand(1)
+    {}
+
+    //Mostly zero words, so that next_nonzero() has something to skip
+    vector<uint64_t> random_row(const uint32_t num, const double density)
+    {
+        std::bernoulli_distribution nonzero(density);
+        vector<uint64_t> row(num);
+        for(uint64_t& w: row) {
+            if (nonzero(mtrand)) {
+                w = 1ULL << (mtrand() % 64);
+            }
+        }
+        return row;
+    }
+
+    vector<RowKernels> kernels;
+    std::mt19937_64 mtrand;
+};
+
+TEST_F(row_kernels_test, scalar_is_first)
+{
+    ASSERT_FALSE(kernels.empty());
+    EXPECT_STREQ(kernels[0].name, "scalar");
+}
+
+TEST_F(row_kernels_test, xor_words)
+{
+    const RowKernels& scalar = kernels[0];
+    for(const RowKernels& k: kernels) {
+        for(uint32_t num = 0; num <= 41; num++) {
+            const vector<uint64_t> a = random_row(num, 0.5);
+            const vector<uint64_t> b = random_row(num, 0.5);
+
+            //One past the end, must not be touched
+            vector<uint64_t> expect(a);
+            expect.push_back(0xdeadbeef);
+            vector<uint64_t> got(expect);
+            scalar.xor_words(expect.data(), b.data(), num);
+            k.xor_words(got.data(), b.data(), num);
+            EXPECT_EQ(got, expect) << k.name << " num: " << num;
+        }
+    }
+}
+
+TEST_F(row_kernels_test, is_zero)
+{
+    const RowKernels& scalar = kernels[0];
+    for(const RowKernels& k: kernels) {
+        for(uint32_t num = 0; num <= 41; num++) {
+            for(const double density: {0.0, 0.02, 0.5}) {
+                vector<uint64_t> a = random_row(num, density);
+                //Non-zero past the end, must not be read
+                a.push_back(1);
+                EXPECT_EQ(k.is_zero(a.data(), num), scalar.is_zero(a.data(), num))
+                    << k.name << " num: " << num << " density: " << density;
+            }
+
+            //Only the last word set
+            if (num > 0) {
+                vector<uint64_t> a(num, 0);
+                a[num-1] = 1ULL << 63;
+                EXPECT_FALSE(k.is_zero(a.data(), num)) << k.name << " num: " << num;
+            }
+        }
+    }
+}
+
+TEST_F(row_kernels_test, next_nonzero)
+{
+    const RowKernels& scalar = kernels[0];
+    for(const RowKernels& k: kernels) {
+        for(uint32_t num = 0; num <= 41; num++) {
+            for(const double density: {0.0, 0.05, 0.5}) {
+                vector<uint64_t> a = random_row(num, density);
+                a.push_back(1);
+                for(uint32_t from = 0; from <= num; from++) {
+                    EXPECT_EQ(k.next_nonzero(a.data(), from, num)
+                        , scalar.next_nonzero(a.data(), from, num))
+                        << k.name << " num: " << num << " from: " << from
+                        << " density: " << density;
+                }
+            }
+        }
+    }
+}
+
+//Rows are not aligned, so the kernels must work from any word
+TEST_F(row_kernels_test, unaligned)
+{
+    const RowKernels& scalar = kernels[0];
+    for(const RowKernels& k: kernels) {
+        for(uint32_t off = 0; off < 8; off++) {
+            const uint32_t num = 29;
+            vector<uint64_t> a = random_row(num+off, 0.1);
+            const vector<uint64_t> b = random_row(num+off, 0.1);
+            vector<uint64_t> a2(a);
+            scalar.xor_words(a.data()+off, b.data()+off, num);
+            k.xor_words(a2.data()+off, b.data()+off, num);
+            EXPECT_EQ(a2, a) << k.name << " off: " << off;
+            EXPECT_EQ(k.is_zero(a.data()+off, num), scalar.is_zero(a.data()+off, num));
+            EXPECT_EQ(k.next_nonzero(a.data()+off, 0, num)
+                , scalar.next_nonzero(a.data()+off, 0, num));
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -172,6 +172,42 @@ TEST_F(SearcherTest, pickpolar_auto_not_changed_by_simp)
     }
 }
 
+TEST_F(SearcherTest, propagate_bin_first)
+{
+    conf.propBinFirst = true;
+    s = new Solver(&conf, &must_inter);
+    s->new_vars(30);
+    ss = (Searcher*)s;
+    s->add_clause_outer(str_to_cl(" -3,  4, 5"));
+    s->add_clause_outer(str_to_cl(" -1,  2"));
+    s->add_clause_outer(str_to_cl(" -2,  3"));
+    s->add_clause_outer(str_to_cl(" -1,  -4"));
+    s->add_clause_outer(str_to_cl(" -5,  6"));
+
+    ss->partition_watches_bin_first();
+    for(watch_subarray_const ws: s->watches) {
+        bool seen_long = false;
+        for(const Watched& w: ws) {
+            if (w.isClause()) {
+                seen_long = true;
+            } else {
+                ASSERT_FALSE(seen_long);
+            }
+        }
+    }
+
+    ss->new_decision_level();
+    ss->enqueue<false>(Lit(0, false));
+    PropBy confl = ss->propagate_bin_first();
+    ASSERT_TRUE(confl.isNULL());
+    ASSERT_EQ(s->value(Lit(1, false)), l_True);
+    ASSERT_EQ(s->value(Lit(2, false)), l_True);
+    ASSERT_EQ(s->value(Lit(3, false)), l_False);
+    ASSERT_EQ(s->value(Lit(4, false)), l_True);
+    ASSERT_EQ(s->value(Lit(5, false)), l_True);
+    ASSERT_EQ(ss->qhead, ss->trail.size());
+}
+
 }
 
 int main(int argc, char **argv) {
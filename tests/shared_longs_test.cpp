@@ -0,0 +1,252 @@
+/******************************************
+Copyright (c) 2016, Mate Soos
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+***********************************************/
+
+#include "gtest/gtest.h"
+
+#include <random>
+#include <algorithm>
+
+#include "src/solver.h"
+#include "src/shareddata.h"
+#include "src/solverconf.h"
+using namespace CMSat;
+#include "test_helper.h"
+
+//To call every propagation routine directly
+struct PropSolver : public Solver {
+    PropSolver(const SolverConf* _conf, std::atomic<bool>* _must_interrupt_inter) :
+        Solver(_conf, _must_interrupt_inter)
+    {}
+
+    using Solver::propagate_any_order_fast;
+    using Solver::propagate_any_order;
+    using Solver::propagate_bin_first;
+};
+
+struct shared_longs : public ::testing::Test {
+    shared_longs()
+    {
+        must_inter.store(false, std::memory_order_relaxed);
+        s = new PropSolver(NULL, &must_inter);
+    }
+    ~shared_longs()
+    {
+        delete s;
+    }
+
+    //"longs" are shared, "own" are the solver's own clauses
+    bool import(const uint32_t num_vars, const vector<vector<Lit> >& own)
+    {
+        SimplifiedCNF in;
+        in.num_vars = num_vars;
+        for(const vector<Lit>& cl: own) {
+            in.cls.push_back(lit_Undef);
+            in.cls.insert(in.cls.end(), cl.begin(), cl.end());
+        }
+        return s->import_simplified(in, &longs);
+    }
+
+    PropBy propagate(const int prop)
+    {
+        if (prop == 0) {
+            return s->propagate_any_order_fast();
+        } else if (prop == 1) {
+            return s->propagate_any_order<true>();
+        }
+        return s->propagate_bin_first();
+    }
+
+    //Every shared clause not satisfied at level 0 must be watched by
+    //exactly the two literals in shared_watched, which are in the clause
+    void check_watches()
+    {
+        vector<vector<Lit> > watched_by(longs.size());
+        for(size_t i = 0; i < s->watches.size(); i++) {
+            for(const Watched& w: s->watches[Lit::toLit(i)]) {
+                if (w.isShared()) {
+                    watched_by[w.get_shared_at()].push_back(Lit::toLit(i));
+                }
+            }
+        }
+
+        for(uint32_t at = 0; at < longs.size(); at++) {
+            const Lit* w = &s->shared_watched[at*2];
+            if (w[0] == lit_Undef) {
+                EXPECT_EQ(w[1], lit_Undef);
+                EXPECT_TRUE(watched_by[at].empty()) << "clause " << at;
+                continue;
+            }
+            vector<Lit> exp = {w[0], w[1]};
+            std::sort(exp.begin(), exp.end());
+            std::sort(watched_by[at].begin(), watched_by[at].end());
+            EXPECT_EQ(watched_by[at], exp) << "clause " << at;
+            EXPECT_NE(w[0], w[1]);
+            for(const Lit l: exp) {
+                EXPECT_NE(std::find(longs.begin(at), longs.end(at), l), longs.end(at))
+                    << "clause " << at << " watched by " << l;
+            }
+        }
+    }
+
+    PropSolver* s = NULL;
+    SharedClauses longs;
+    std::atomic<bool> must_inter;
+};
+
+TEST_F(shared_longs, attach)
+{
+    longs.add(str_to_cl("1, 2, 3"));
+    longs.add(str_to_cl("-1, 4, 5, 6"));
+    longs.add(str_to_cl("7, 8, 9"));
+    ASSERT_TRUE(import(10, {str_to_cl("9"), str_to_cl("-2"), str_to_cl("-3")}));
+
+    //Satisfied one is not watched, the unit one is propagated
+    EXPECT_EQ(s->shared_watched[4], lit_Undef);
+    EXPECT_EQ(s->value(Lit(0, false)), l_True);
+    EXPECT_EQ(s->conf.doVarElim, false);
+    check_watches();
+}
+
+TEST_F(shared_longs, propagate)
+{
+    for(int prop = 0; prop < 3; prop++) {
+        delete s;
+        s = new PropSolver(NULL, &must_inter);
+        longs = SharedClauses();
+        longs.add(str_to_cl("1, 2, 3, 4"));
+        longs.add(str_to_cl("-4, 5, 6"));
+        ASSERT_TRUE(import(10, {}));
+        check_watches();
+
+        //Falsify all but the last literal, one by one
+        for(const Lit l: str_to_cl("1, 2, 3")) {
+            s->new_decision_level();
+            s->enqueue<false>(~l);
+            ASSERT_TRUE(propagate(prop).isNULL());
+            check_watches();
+        }
+        EXPECT_EQ(s->value(Lit(3, false)), l_True);
+        const PropBy reason = s->varData[3].reason;
+        ASSERT_EQ(reason.getType(), shared_t);
+        EXPECT_EQ(reason.get_shared_at(), 0U);
+
+        s->cancelUntil(0);
+        check_watches();
+        EXPECT_EQ(s->value(Lit(3, false)), l_Undef);
+    }
+}
+
+TEST_F(shared_longs, conflict)
+{
+    for(int prop = 0; prop < 3; prop++) {
+        delete s;
+        s = new PropSolver(NULL, &must_inter);
+        longs = SharedClauses();
+        longs.add(str_to_cl("1, 2, 3, 4"));
+        ASSERT_TRUE(import(10, {}));
+
+        s->new_decision_level();
+        for(const Lit l: str_to_cl("1, 2, 3, 4")) {
+            s->enqueue<false>(~l);
+        }
+        const PropBy confl = propagate(prop);
+        ASSERT_EQ(confl.getType(), shared_t);
+        EXPECT_EQ(confl.get_shared_at(), 0U);
+        s->cancelUntil(0);
+        check_watches();
+    }
+}
+
+//Searching with the long clauses shared gives the same results as with them
+//in the clause arena, and the shared clauses are not changed
+TEST_F(shared_longs, solve)
+{
+    std::mt19937 mtrand(3);
+    uint32_t num_sat = 0;
+    uint32_t num_unsat = 0;
+    uint64_t resolvs_shared = 0;
+    for(uint32_t at = 0; at < 20; at++) {
+        delete s;
+        s = new PropSolver(NULL, &must_inter);
+        Solver ref(NULL, &must_inter);
+        ref.new_vars(50);
+
+        longs = SharedClauses();
+        vector<vector<Lit> > own;
+        vector<vector<Lit> > cls;
+        for(uint32_t i = 0; i < 220; i++) {
+            vector<Lit> cl;
+            const uint32_t sz = i < 20 ? 2 : 3;
+            while (cl.size() < sz) {
+                const Lit l = Lit(mtrand() % 50, mtrand() % 2);
+                if (std::find(cl.begin(), cl.end(), l) == cl.end()
+                    && std::find(cl.begin(), cl.end(), ~l) == cl.end()
+                ) {
+                    cl.push_back(l);
+                }
+            }
+            cls.push_back(cl);
+            ref.add_clause_outer(cl);
+            if (sz == 2) {
+                own.push_back(cl);
+            } else {
+                longs.add(cl);
+            }
+        }
+        const SharedClauses orig = longs;
+        if (!import(50, own)) {
+            EXPECT_EQ(ref.solve_with_assumptions(NULL, false), l_False);
+            continue;
+        }
+
+        //Then with an assumption, after simplifying
+        for(uint32_t i = 0; i < 2; i++) {
+            const vector<Lit> assumps{Lit(i, false)};
+            const lbool ret = s->solve_with_assumptions(i == 0 ? NULL : &assumps, false);
+            EXPECT_EQ(ret, ref.solve_with_assumptions(i == 0 ? NULL : &assumps, false));
+            EXPECT_EQ(longs.lits, orig.lits);
+            EXPECT_EQ(longs.start, orig.start);
+            if (ret != l_True) {
+                num_unsat += (i == 0);
+                break;
+            }
+            num_sat += (i == 0);
+            for(const vector<Lit>& cl: cls) {
+                bool sat = false;
+                for(const Lit l: cl) {
+                    sat |= (s->get_model()[l.var()] == (l.sign() ? l_False : l_True));
+                }
+                EXPECT_TRUE(sat);
+            }
+        }
+        EXPECT_TRUE(s->longIrredCls.empty());
+        resolvs_shared += s->get_stats().resolvs.longIrred;
+    }
+    EXPECT_GT(num_sat, 0U);
+    EXPECT_GT(num_unsat, 0U);
+    EXPECT_GT(resolvs_shared, 0U);
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -23,10 +23,15 @@ THE SOFTWARE.
 #include "gtest/gtest.h"
 
 #include <set>
+#include <random>
 using std::set;
 
 #include "src/solver.h"
 #include "src/solverconf.h"
+#include "src/shareddata.h"
+#include "src/datasync.h"
+#include "src/occsimplifier.h"
+#include "src/subsumestrengthen.h"
 using namespace CMSat;
 #include "test_helper.h"
 
@@ -238,6 +243,378 @@ TEST_F(SolverTest, get_bin_and_long)
     s->end_getting_small_clauses();
 }
 
+TEST_F(SolverTest, stats_follow_consolidate)
+{
+    s = new Solver(&conf, &must_inter);
+    s->new_vars(30);
+    ClauseStats stats;
+
+    s->add_clause_outer(str_to_cl(" 2,  3"));
+    stats.glue = 7;
+    stats.activity = 3;
+    Clause* c = s->add_clause_int(str_to_cl(" 6,  2, 3, 4"), true, stats);
+    s->longRedCls[2].push_back(s->cl_alloc.get_offset(c));
+    stats.glue = 4;
+    stats.activity = 9;
+    c = s->add_clause_int(str_to_cl(" -5,  -2, 3"), true, stats);
+    s->longRedCls[2].push_back(s->cl_alloc.get_offset(c));
+    s->cl_alloc.consolidate(s, true);
+
+    ASSERT_EQ(s->longRedCls[2].size(), 2U);
+    for(ClOffset offs: s->longRedCls[2]) {
+        const Clause& cl = *s->cl_alloc.ptr(offs);
+        const ClauseStats& cl_stats = s->cl_alloc.stats(cl);
+        if (cl.size() == 4) {
+            EXPECT_EQ(cl_stats.glue, 7U);
+            EXPECT_EQ(cl_stats.activity, 3);
+        } else {
+            EXPECT_EQ(cl.size(), 3U);
+            EXPECT_EQ(cl_stats.glue, 4U);
+            EXPECT_EQ(cl_stats.activity, 9);
+        }
+    }
+}
+
+TEST_F(SolverTest, consolidate_in_act_order)
+{
+    conf.consolidate_in_act_order = true;
+    s = new Solver(&conf, &must_inter);
+    s->new_vars(30);
+
+    Clause* c = s->add_clause_int(str_to_cl(" 1,  2, 3"));
+    s->longIrredCls.push_back(s->cl_alloc.get_offset(c));
+    c = s->add_clause_int(str_to_cl(" 10,  11, 12"));
+    s->longIrredCls.push_back(s->cl_alloc.get_offset(c));
+    s->var_act_vsids[10] = 100;
+    s->cl_alloc.consolidate(s, true);
+
+    ASSERT_EQ(s->longIrredCls.size(), 2U);
+    const ClOffset first = s->longIrredCls[0];
+    const ClOffset second = s->longIrredCls[1];
+    EXPECT_EQ((*s->cl_alloc.ptr(second))[0], str_to_cl("10")[0]);
+    EXPECT_LT(second, first);
+}
+
+//Random CNFs solved by "s", which simplifies with "conf", and by a solver
+//that simplifies with "serial_conf". The results must agree.
+struct ParallelSimpTest : public SolverTest {
+    ParallelSimpTest()
+    {
+        conf.simplify_at_startup = true;
+        serial_conf = conf;
+    }
+
+    void solve_random_cnf(
+        const uint32_t num_vars
+        , const uint32_t num_cls
+        , const uint32_t min_size
+        , const uint32_t max_size
+    ) {
+        delete s;
+        s = new Solver(&conf, &must_inter);
+        Solver ref(&serial_conf, &must_inter);
+        s->new_vars(num_vars);
+        ref.new_vars(num_vars);
+
+        vector<vector<Lit> > cls;
+        for(uint32_t i = 0; i < num_cls; i++) {
+            vector<Lit> cl;
+            const uint32_t size = min_size + mtrand() % (max_size - min_size + 1);
+            for(uint32_t j = 0; j < size; j++) {
+                cl.push_back(Lit(mtrand() % num_vars, mtrand() % 2));
+            }
+            cls.push_back(cl);
+            s->add_clause_outer(cl);
+            ref.add_clause_outer(cl);
+        }
+
+        const lbool ret = s->solve_with_assumptions(NULL, false);
+        EXPECT_EQ(ret, ref.solve_with_assumptions(NULL, false));
+        if (ret != l_True) {
+            num_unsat += (ret == l_False);
+            return;
+        }
+        num_sat++;
+        for(const vector<Lit>& cl: cls) {
+            bool sat = false;
+            for(const Lit l: cl) {
+                sat |= (s->get_model()[l.var()] == (l.sign() ? l_False : l_True));
+            }
+            EXPECT_TRUE(sat);
+        }
+    }
+
+    SolverConf serial_conf;
+    std::mt19937 mtrand{3};
+    uint32_t num_sat = 0;
+    uint32_t num_unsat = 0;
+};
+
+TEST_F(ParallelSimpTest, varelim)
+{
+    conf.varelim_threads = 3;
+    conf.varelim_batch = 16;
+    uint64_t elimed_in_batch = 0;
+    for(uint32_t at = 0; at < 20; at++) {
+        solve_random_cnf(200, 500, 2, 4);
+        elimed_in_batch += s->occsimplifier->bvestats_global.elimedInBatch;
+    }
+    EXPECT_GT(elimed_in_batch, 0U);
+    EXPECT_GT(num_sat, 0U);
+    EXPECT_GT(num_unsat, 0U);
+}
+
+//Many long clauses over few variables, so that some subsume or strengthen
+//others
+TEST_F(ParallelSimpTest, subsume)
+{
+    conf.doVarElim = false;
+    serial_conf.doVarElim = false;
+    conf.subsume_threads = 3;
+    conf.subsume_batch = 32;
+    uint64_t found_in_parallel = 0;
+    for(uint32_t at = 0; at < 20; at++) {
+        solve_random_cnf(40, 330, 3, 5);
+        found_in_parallel += s->occsimplifier->getSubsumeStrengthen()->get_stats().foundInParallel;
+    }
+    EXPECT_GT(found_in_parallel, 0U);
+    EXPECT_GT(num_sat, 0U);
+    EXPECT_GT(num_unsat, 0U);
+}
+
+//Two solvers of a portfolio, thread 1 running "other_conf"
+struct PortfolioTest : public SolverTest {
+    PortfolioTest() :
+        shared(2)
+    {
+        conf.adaptive_portfolio = true;
+        conf.portfolio_warmup_confl = 0;
+        other_conf = conf;
+        other_conf.restartType = Restart::luby;
+        other_conf.maple = !conf.maple;
+        other_conf.polarity_mode = PolarityMode::polarmode_pos;
+        other_conf.origSeed = conf.origSeed + 1;
+        other_conf.do_simplify_problem = !conf.do_simplify_problem;
+        shared.thread_confs.push_back(conf);
+        shared.thread_confs.push_back(other_conf);
+
+        s = new Solver(&conf, &must_inter);
+        s->set_shared_data(&shared, 0);
+        s2 = new Solver(&other_conf, &must_inter);
+        s2->set_shared_data(&shared, 1);
+    }
+    ~PortfolioTest()
+    {
+        delete s2;
+    }
+
+    SolverConf other_conf;
+    SharedData shared;
+    Solver* s2 = NULL;
+};
+
+TEST_F(PortfolioTest, adopt_search_conf_keeps_seed_and_simp)
+{
+    s->adopt_search_conf(other_conf);
+    EXPECT_EQ(s->getConf().restartType, Restart::luby);
+    EXPECT_EQ(s->getConf().maple, other_conf.maple);
+    EXPECT_EQ(s->getConf().polarity_mode, PolarityMode::polarmode_pos);
+    EXPECT_EQ(s->getConf().origSeed, conf.origSeed);
+    EXPECT_EQ(s->getConf().do_simplify_problem, conf.do_simplify_problem);
+}
+
+TEST_F(PortfolioTest, switch_only_if_much_worse)
+{
+    SolverConf better;
+    EXPECT_FALSE(s2->datasync->publish_progress(100, true, better));
+
+    //Not allowed to switch yet
+    EXPECT_FALSE(s->datasync->publish_progress(10, false, better));
+
+    //Within the prune ratio of the best
+    EXPECT_FALSE(s->datasync->publish_progress(60, true, better));
+
+    EXPECT_TRUE(s->datasync->publish_progress(10, true, better));
+    EXPECT_EQ(better.restartType, Restart::luby);
+    EXPECT_EQ(shared.progress[0].conf_of, 1U);
+    EXPECT_EQ(shared.progress[0].score, 0);
+
+    //Already runs the best configuration
+    EXPECT_FALSE(s->datasync->publish_progress(10, true, better));
+}
+
+TEST_F(PortfolioTest, check_adapt_portfolio_switches)
+{
+    //Thread 1 does much better, and the score is checked often
+    shared.progress[1].score = 1e30;
+    SolverConf short_iters = s->getConf();
+    short_iters.num_conflicts_of_search = 1000;
+    s->setConf(short_iters);
+    s->new_vars(200);
+    std::mt19937 mtrand(7);
+    for(size_t i = 0; i < 900; i++) {
+        vector<Lit> cl;
+        for(size_t j = 0; j < 3; j++) {
+            cl.push_back(Lit(mtrand() % 200, mtrand() % 2));
+        }
+        s->add_clause_outer(cl);
+    }
+    EXPECT_NE(s->solve_with_assumptions(NULL, false), l_Undef);
+    EXPECT_EQ(shared.progress[0].conf_of, 1U);
+    EXPECT_EQ(s->getConf().restartType, Restart::luby);
+    EXPECT_EQ(s->getConf().origSeed, conf.origSeed);
+}
+
+
+//Thread 0 exports learnt long clauses, thread 1 imports them
+struct LongSyncTest : public SolverTest {
+    LongSyncTest() :
+        shared(2)
+    {
+        conf.sync_every_confl = 0;
+        conf.sync_long_max_glue = 3;
+        conf.sync_long_max_size = 5;
+        conf.sync_long_import_max_glue = 2;
+
+        s = new Solver(&conf, &must_inter);
+        s->set_shared_data(&shared, 0);
+        s->new_vars(300);
+        s->datasync->rebuild_bva_map();
+        s2 = new Solver(&conf, &must_inter);
+        s2->set_shared_data(&shared, 1);
+        s2->new_vars(300);
+        s2->datasync->rebuild_bva_map();
+    }
+    ~LongSyncTest()
+    {
+        delete s2;
+    }
+
+    //Thread 1 reads the ring of thread 0
+    void sync()
+    {
+        s2->sumConflicts++;
+        EXPECT_TRUE(s2->datasync->syncData());
+    }
+
+    //The i-th of many different clauses, sorted
+    vector<Lit> nth_cl(const uint32_t i) const
+    {
+        vector<Lit> lits {Lit(i % 100, false), Lit(100 + (i/100) % 100, true)
+            , Lit(200 + i/10000, false)};
+        return lits;
+    }
+
+    //Redundant long clauses of thread 1, sorted
+    set<vector<Lit> > red_cls() const
+    {
+        set<vector<Lit> > ret;
+        for(const auto& lredcls: s2->longRedCls) {
+            for(const ClOffset offs: lredcls) {
+                const Clause& cl = *s2->cl_alloc.ptr(offs);
+                vector<Lit> lits(cl.begin(), cl.end());
+                std::sort(lits.begin(), lits.end());
+                ret.insert(lits);
+            }
+        }
+        return ret;
+    }
+
+    SharedData shared;
+    Solver* s2 = NULL;
+};
+
+TEST_F(LongSyncTest, ring_get)
+{
+    SharedData::LongRing& ring = *shared.longs[0];
+    vector<Lit> lits;
+    uint32_t glue;
+    EXPECT_FALSE(ring.get(0, lits, glue));
+
+    ring.push(str_to_cl("1, -2, 3"), 2);
+    ring.push(str_to_cl("4, 5, 6, -7"), 3);
+    EXPECT_EQ(ring.get_head(), 2U);
+    EXPECT_TRUE(ring.get(1, lits, glue));
+    EXPECT_EQ(lits, str_to_cl("4, 5, 6, -7"));
+    EXPECT_EQ(glue, 3U);
+    EXPECT_TRUE(ring.get(0, lits, glue));
+    EXPECT_EQ(lits, str_to_cl("1, -2, 3"));
+    EXPECT_EQ(glue, 2U);
+    EXPECT_FALSE(ring.get(2, lits, glue));
+
+    //Overwrites positions 0 and 1
+    for(uint64_t i = 0; i < SharedData::LongRing::num_slots; i++) {
+        ring.push(str_to_cl("8, 9, 10"), 1);
+    }
+    EXPECT_FALSE(ring.get(0, lits, glue));
+    EXPECT_FALSE(ring.get(1, lits, glue));
+    EXPECT_TRUE(ring.get(2, lits, glue));
+    EXPECT_TRUE(ring.get(ring.get_head()-1, lits, glue));
+    EXPECT_EQ(lits, str_to_cl("8, 9, 10"));
+}
+
+TEST_F(LongSyncTest, export_filters)
+{
+    //Glue too high
+    s->datasync->signalNewLongClause(str_to_cl("1, 2, 3"), 4);
+    //Too long
+    s->datasync->signalNewLongClause(str_to_cl("1, 2, 3, 4, 5, 6"), 2);
+    EXPECT_EQ(shared.longs[0]->get_head(), 0U);
+    EXPECT_EQ(s->datasync->get_stats().sentLongData, 0U);
+
+    s->datasync->signalNewLongClause(str_to_cl("1, 2, 3, 4, 5"), 3);
+    EXPECT_EQ(shared.longs[0]->get_head(), 1U);
+    EXPECT_EQ(s->datasync->get_stats().sentLongData, 1U);
+    EXPECT_EQ(shared.longs[1]->get_head(), 0U);
+}
+
+TEST_F(LongSyncTest, import_filter)
+{
+    s->datasync->signalNewLongClause(str_to_cl("1, -2, 3"), 2);
+    s->datasync->signalNewLongClause(str_to_cl("4, -5, 6"), 3);
+    sync();
+
+    EXPECT_EQ(s2->datasync->get_stats().recvLongData, 1U);
+    EXPECT_EQ(s2->datasync->get_stats().lostLongData, 0U);
+    set<vector<Lit> > expected;
+    expected.insert(str_to_cl("1, -2, 3"));
+    EXPECT_EQ(red_cls(), expected);
+    EXPECT_EQ(s2->longIrredCls.size(), 0U);
+
+    //Only new ones are read
+    sync();
+    EXPECT_EQ(s2->datasync->get_stats().recvLongData, 1U);
+
+    //Own ring is not read
+    s2->datasync->signalNewLongClause(str_to_cl("7, 8, 9"), 1);
+    sync();
+    EXPECT_EQ(s2->datasync->get_stats().recvLongData, 1U);
+    EXPECT_EQ(red_cls(), expected);
+}
+
+TEST_F(LongSyncTest, reader_falls_behind)
+{
+    const uint64_t num_slots = SharedData::LongRing::num_slots;
+    for(uint32_t i = 0; i < num_slots + 10; i++) {
+        shared.longs[0]->push(nth_cl(i), 1);
+    }
+    sync();
+    EXPECT_EQ(s2->datasync->get_stats().lostLongData, 10U);
+    EXPECT_EQ(s2->datasync->get_stats().recvLongData, num_slots);
+
+    //The oldest were lost, the newest were not
+    const set<vector<Lit> > cls = red_cls();
+    EXPECT_EQ(cls.size(), num_slots);
+    EXPECT_EQ(cls.count(nth_cl(9)), 0U);
+    EXPECT_EQ(cls.count(nth_cl(10)), 1U);
+    EXPECT_EQ(cls.count(nth_cl(num_slots + 9)), 1U);
+
+    //Caught up, nothing more is lost
+    shared.longs[0]->push(nth_cl(num_slots + 10), 1);
+    sync();
+    EXPECT_EQ(s2->datasync->get_stats().lostLongData, 10U);
+    EXPECT_EQ(s2->datasync->get_stats().recvLongData, num_slots + 1);
+}
 }
 
 int main(int argc, char **argv) {
@@ -0,0 +1,246 @@
+/******************************************
+Copyright (c) 2016, Mate Soos
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+***********************************************/
+
+#include "gtest/gtest.h"
+
+#include <random>
+#include <algorithm>
+
+#include "src/solver.h"
+#include "src/clausecleaner.h"
+#include "src/solverconf.h"
+using namespace CMSat;
+#include "test_helper.h"
+
+#ifdef INLINE_TERNARY_WATCH
+//To call every propagation routine directly
+struct PropSolver : public Solver {
+    PropSolver(const SolverConf* _conf, std::atomic<bool>* _must_interrupt_inter) :
+        Solver(_conf, _must_interrupt_inter)
+    {}
+
+    using Solver::propagate_any_order_fast;
+    using Solver::propagate_any_order;
+    using Solver::propagate_bin_first;
+};
+
+struct ternary_watch : public ::testing::Test {
+    ternary_watch()
+    {
+        must_inter.store(false, std::memory_order_relaxed);
+        SolverConf conf;
+        conf.doCache = false;
+        s = new Solver(&conf, &must_inter);
+        s->new_vars(30);
+    }
+    ~ternary_watch()
+    {
+        delete s;
+    }
+
+    //Every watch of a 3-long clause must be ternary and hold exactly the two
+    //other literals of the clause. Returns the number of ternary watches.
+    size_t check_watches()
+    {
+        size_t num = 0;
+        for(size_t i = 0; i < s->watches.size(); i++) {
+            const Lit lit = Lit::toLit(i);
+            for(const Watched& w: s->watches[lit]) {
+                if (!w.isClause()) {
+                    continue;
+                }
+                const Clause& cl = *s->cl_alloc.ptr(w.get_offset());
+                if (cl.size() != 3) {
+                    EXPECT_FALSE(w.isTernary()) << "watch of " << lit << " of " << cl;
+                    continue;
+                }
+
+                EXPECT_TRUE(w.isTernary()) << "watch of " << lit << " of " << cl;
+                if (!w.isTernary()) {
+                    continue;
+                }
+                num++;
+                vector<Lit> got = {lit, w.getBlockedLit(), w.lit3()};
+                vector<Lit> exp(cl.begin(), cl.end());
+                std::sort(got.begin(), got.end());
+                std::sort(exp.begin(), exp.end());
+                EXPECT_EQ(got, exp) << "watch of " << lit << " of " << cl;
+            }
+        }
+        return num;
+    }
+
+    size_t num_3long() const
+    {
+        size_t num = 0;
+        for(const ClOffset offs: s->longIrredCls) {
+            num += s->cl_alloc.ptr(offs)->size() == 3;
+        }
+        for(const auto& cls: s->longRedCls) {
+            for(const ClOffset offs: cls) {
+                num += s->cl_alloc.ptr(offs)->size() == 3;
+            }
+        }
+        return num;
+    }
+
+    void add_random_clauses(const uint32_t num, const uint32_t max_size)
+    {
+        for(uint32_t i = 0; i < num; i++) {
+            vector<Lit> cl;
+            const uint32_t sz = 3 + mtrand() % (max_size-2);
+            while (cl.size() < sz) {
+                const Lit l = Lit(mtrand() % s->nVars(), mtrand() % 2);
+                if (std::find(cl.begin(), cl.end(), l) == cl.end()
+                    && std::find(cl.begin(), cl.end(), ~l) == cl.end()
+                ) {
+                    cl.push_back(l);
+                }
+            }
+            s->add_clause_outer(cl);
+        }
+    }
+
+    Solver* s = NULL;
+    std::atomic<bool> must_inter;
+    std::mt19937 mtrand{1};
+};
+
+TEST_F(ternary_watch, attach)
+{
+    s->add_clause_outer(str_to_cl("1, 2, 3"));
+    s->add_clause_outer(str_to_cl("1, 2, 3, 4"));
+    EXPECT_EQ(check_watches(), 2U);
+}
+
+//ClauseCleaner upgrades the watches of clauses it shrinks to 3 literals
+TEST_F(ternary_watch, clean_shrinks_to_3)
+{
+    s->add_clause_outer(str_to_cl("1, 2, 3, 4"));
+    s->add_clause_outer(str_to_cl("5, 6, 7, 8, 9"));
+    s->add_clause_outer(str_to_cl("-4"));
+    s->add_clause_outer(str_to_cl("-8"));
+    s->add_clause_outer(str_to_cl("-9"));
+    EXPECT_EQ(num_3long(), 0U);
+
+    s->clauseCleaner->remove_and_clean_all();
+    check_irred_cls_eq(s, "1, 2, 3; 5, 6, 7");
+    EXPECT_EQ(num_3long(), 2U);
+    EXPECT_EQ(check_watches(), 4U);
+}
+
+TEST_F(ternary_watch, consolidate)
+{
+    for(int to_new_memory = 0; to_new_memory < 2; to_new_memory++) {
+        add_random_clauses(300, 6);
+        s->add_clause_outer(vector<Lit>{Lit(s->nVars()-1, false)});
+
+        //Satisfied ones are freed, leaving holes to compact
+        s->clauseCleaner->remove_and_clean_all();
+        s->cl_alloc.consolidate(s, true, true, to_new_memory);
+        EXPECT_GT(num_3long(), 0U);
+        EXPECT_EQ(check_watches(), 2*num_3long());
+    }
+}
+
+//The watch moved to a new literal must hold the other two, for every
+//propagation routine
+TEST_F(ternary_watch, watch_moves_during_propagation)
+{
+    for(int prop = 0; prop < 3; prop++) {
+        delete s;
+        PropSolver* ps = new PropSolver(NULL, &must_inter);
+        s = ps;
+        s->new_vars(30);
+        s->add_clause_outer(str_to_cl("1, 2, 3"));
+        s->add_clause_outer(str_to_cl("1, 2, 4, 5"));
+        const ClOffset offs = s->longIrredCls[0];
+        EXPECT_EQ(check_watches(), 2U);
+
+        //Falsify both watched literals, in turn
+        const Clause& cl = *s->cl_alloc.ptr(offs);
+        vector<Lit> watched = {cl[0], cl[1]};
+        for(const Lit l: watched) {
+            s->new_decision_level();
+            s->enqueue<false>(~l);
+            PropBy confl;
+            if (prop == 0) {
+                confl = ps->propagate_any_order_fast();
+            } else if (prop == 1) {
+                confl = ps->propagate_any_order<true>();
+            } else {
+                confl = ps->propagate_bin_first();
+            }
+            ASSERT_TRUE(confl.isNULL());
+            EXPECT_EQ(check_watches(), 2U);
+        }
+
+        //The last literal is propagated
+        EXPECT_EQ(s->value(cl[0]), l_True);
+        s->cancelUntil(0);
+        EXPECT_EQ(check_watches(), 2U);
+    }
+}
+
+//updateWatch() maps the inline pair when the variables are renumbered
+TEST_F(ternary_watch, renumber)
+{
+    add_random_clauses(100, 5);
+    s->add_clause_outer(str_to_cl("1"));
+    s->add_clause_outer(str_to_cl("-2"));
+    s->clauseCleaner->remove_and_clean_all();
+    const size_t num = num_3long();
+    EXPECT_GT(num, 0U);
+
+    EXPECT_TRUE(s->renumber_variables(true));
+    EXPECT_NE(s->map_outer_to_inter(0U), 0U);
+    EXPECT_EQ(num_3long(), num);
+    EXPECT_EQ(check_watches(), 2*num);
+}
+
+//Learnt clauses, reduceDB, consolidation, renumbering of a whole search
+TEST_F(ternary_watch, after_solve)
+{
+    delete s;
+    SolverConf conf;
+    conf.doCache = false;
+    conf.every_lev1_reduce = 200;
+    s = new Solver(&conf, &must_inter);
+    s->new_vars(120);
+    add_random_clauses(520, 3);
+    s->solve_with_assumptions(NULL, false);
+    s->cancelUntil(0);
+    EXPECT_GT(num_3long(), 0U);
+    EXPECT_EQ(check_watches(), 2*num_3long());
+}
+
+#else
+TEST(ternary_watch, not_compiled_in)
+{
+    GTEST_SKIP() << "Built without INLINE_TERNARY";
+}
+#endif
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
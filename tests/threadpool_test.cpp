@@ -0,0 +1,80 @@
+/******************************************
+Copyright (c) 2016, Mate Soos
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+***********************************************/
+
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+#include "src/threadpool.h"
+
+using CMSat::ThreadPool;
+
+TEST(threadpool, runs_every_tid)
+{
+    ThreadPool pool(4);
+    std::vector<int> ran(4, 0);
+    for(int i = 0; i < 10; i++) {
+        pool.run([&](size_t tid) {ran[tid]++;});
+    }
+    for(size_t tid = 0; tid < 4; tid++) {
+        EXPECT_EQ(ran[tid], 10);
+    }
+}
+
+TEST(threadpool, single_thread)
+{
+    ThreadPool pool(1);
+    int ran = 0;
+    pool.run([&](size_t tid) {EXPECT_EQ(tid, 0U); ran++;});
+    EXPECT_EQ(ran, 1);
+}
+
+TEST(threadpool, tid0_throws)
+{
+    ThreadPool pool(4);
+    std::atomic<int> workers_done(0);
+    EXPECT_THROW(
+        pool.run([&](size_t tid) {
+            if (tid == 0) {
+                throw std::runtime_error("tid 0 failed");
+            }
+            //Still running when tid 0 throws: run() must wait for us
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            workers_done++;
+        })
+        , std::runtime_error
+    );
+    EXPECT_EQ(workers_done, 3);
+
+    //The pool is still usable
+    std::atomic<int> ran(0);
+    pool.run([&](size_t) {ran++;});
+    EXPECT_EQ(ran, 4);
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}